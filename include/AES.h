@@ -0,0 +1,1108 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+
+#include <type_traits>
+
+/**
+ * @class AES
+ * @brief Implementa AES-128/192/256 con ruta AES-NI y respaldo por tablas T.
+ *
+ * Al construirse expande la clave una sola vez y consulta CpuFeatures: si la CPU
+ * soporta AES-NI y PCLMULQDQ se usan esas instrucciones (con 8 bloques en paralelo
+ * en ECB, descifrado CBC, CTR y GCM); en caso contrario se usa la implementación
+ * clásica de tablas T, portable a cualquier plataforma.
+ *
+ * Los modos trabajan sobre buffers (puntero + longitud) y tienen además versiones
+ * que reciben std::vector<uint8_t>, compatibles con las claves e IVs que produce
+ * CryptoGenerator.
+ */
+class AES {
+public:
+    /**
+     * @brief Tamaño de bloque en bytes.
+     */
+    static constexpr size_t BLOCK_SIZE = 16;
+
+    /**
+     * @brief Tamaño de la etiqueta de autenticación GCM en bytes.
+     */
+    static constexpr size_t TAG_SIZE = 16;
+
+    /**
+     * @brief Cifrador sin clave (p. ej. para asignarle otro después). Cifrar o descifrar
+     *        con él lanza std::runtime_error.
+     */
+    AES() = default;
+
+    /**
+     * @brief Construye el cifrador y expande la clave.
+     *
+     * @param key Clave de 16, 24 o 32 bytes (AES-128/192/256).
+     * @throws std::invalid_argument Si la clave no tiene un tamaño válido.
+     */
+    explicit AES(const std::vector<uint8_t>& key) {
+        setKey(key.data(), key.size());
+    }
+
+    /**
+     * @brief Construye el cifrador a partir de un buffer de clave.
+     */
+    AES(const uint8_t* key, size_t keyLength) {
+        setKey(key, keyLength);
+    }
+
+    /**
+     * @brief Borra las subclaves antes de liberar el objeto.
+     */
+    ~AES() {
+        volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(m_encKeys);
+        for (size_t i = 0; i < sizeof(m_encKeys); ++i) p[i] = 0;
+        p = reinterpret_cast<volatile uint8_t*>(m_decKeys);
+        for (size_t i = 0; i < sizeof(m_decKeys); ++i) p[i] = 0;
+    }
+
+    /**
+     * @brief Indica si se está usando la ruta AES-NI.
+     */
+    bool
+        usesHardware() const {
+        return m_useHardware;
+    }
+
+    /**
+     * @brief Activa o desactiva la ruta AES-NI (sólo se activa si la CPU la soporta).
+     *
+     * Útil para comparar el rendimiento de ambas implementaciones.
+     */
+    void
+        setHardwareAcceleration(bool enable) {
+        const CpuFeatures& cpu = CpuFeatures::get();
+        m_useHardware = enable && cpu.aesni && cpu.pclmul && cpu.sse41;
+    }
+
+    /**
+     * @brief Número de rondas (10, 12 o 14).
+     */
+    int
+        rounds() const {
+        return m_rounds;
+    }
+
+    /**
+     * @brief Cifra un único bloque de 16 bytes.
+     */
+    void
+        encodeBlock(const uint8_t* in, uint8_t* out) const {
+        encodeBlocks(in, out, 1);
+    }
+
+    /**
+     * @brief Descifra un único bloque de 16 bytes.
+     */
+    void
+        decodeBlock(const uint8_t* in, uint8_t* out) const {
+        decodeBlocks(in, out, 1);
+    }
+
+    /**
+     * @brief Cifra @p count bloques independientes (ECB).
+     */
+    void
+        encodeBlocks(const uint8_t* in, uint8_t* out, size_t count) const {
+        requireKey();
+#if TTC_X86
+        if (m_useHardware) {
+            withRounds(m_rounds, [&](auto rounds) { hwEncryptBlocks<decltype(rounds)::value>(m_encKeys, in, out, count); });
+            return;
+        }
+#endif
+        for (size_t i = 0; i < count; ++i) {
+            swEncrypt(in + i * BLOCK_SIZE, out + i * BLOCK_SIZE);
+        }
+    }
+
+    /**
+     * @brief Descifra @p count bloques independientes (ECB).
+     */
+    void
+        decodeBlocks(const uint8_t* in, uint8_t* out, size_t count) const {
+        requireKey();
+#if TTC_X86
+        if (m_useHardware) {
+            withRounds(m_rounds, [&](auto rounds) { hwDecryptBlocks<decltype(rounds)::value>(m_decKeys, in, out, count); });
+            return;
+        }
+#endif
+        for (size_t i = 0; i < count; ++i) {
+            swDecrypt(in + i * BLOCK_SIZE, out + i * BLOCK_SIZE);
+        }
+    }
+
+    /**
+     * @brief Cifra un buffer en modo ECB.
+     *
+     * @throws std::invalid_argument Si la longitud no es múltiplo de 16.
+     */
+    void
+        encodeECB(const uint8_t* in, uint8_t* out, size_t length) const {
+        checkLength(length);
+        encodeBlocks(in, out, length / BLOCK_SIZE);
+    }
+
+    /**
+     * @brief Descifra un buffer en modo ECB.
+     */
+    void
+        decodeECB(const uint8_t* in, uint8_t* out, size_t length) const {
+        checkLength(length);
+        decodeBlocks(in, out, length / BLOCK_SIZE);
+    }
+
+    /**
+     * @brief Cifra un buffer en modo CBC (secuencial por definición).
+     *
+     * @param in     Texto plano (longitud múltiplo de 16).
+     * @param out    Texto cifrado.
+     * @param length Longitud en bytes.
+     * @param iv     IV de 16 bytes.
+     */
+    void
+        encodeCBC(const uint8_t* in, uint8_t* out, size_t length, const uint8_t* iv) const {
+        requireKey();
+        checkLength(length);
+#if TTC_X86
+        if (m_useHardware) {
+            withRounds(m_rounds, [&](auto rounds) { hwEncryptCBC<decltype(rounds)::value>(m_encKeys, in, out, length / BLOCK_SIZE, iv); });
+            return;
+        }
+#endif
+        uint8_t chain[BLOCK_SIZE];
+        std::memcpy(chain, iv, BLOCK_SIZE);
+        for (size_t i = 0; i < length; i += BLOCK_SIZE) {
+            for (size_t j = 0; j < BLOCK_SIZE; ++j) chain[j] ^= in[i + j];
+            swEncrypt(chain, chain);
+            std::memcpy(out + i, chain, BLOCK_SIZE);
+        }
+    }
+
+    /**
+     * @brief Descifra un buffer en modo CBC (bloques en paralelo).
+     */
+    void
+        decodeCBC(const uint8_t* in, uint8_t* out, size_t length, const uint8_t* iv) const {
+        requireKey();
+        checkLength(length);
+#if TTC_X86
+        if (m_useHardware) {
+            withRounds(m_rounds, [&](auto rounds) { hwDecryptCBC<decltype(rounds)::value>(m_decKeys, in, out, length / BLOCK_SIZE, iv); });
+            return;
+        }
+#endif
+        uint8_t previous[BLOCK_SIZE];
+        uint8_t current[BLOCK_SIZE];
+        std::memcpy(previous, iv, BLOCK_SIZE);
+        for (size_t i = 0; i < length; i += BLOCK_SIZE) {
+            std::memcpy(current, in + i, BLOCK_SIZE);
+            swDecrypt(current, out + i);
+            for (size_t j = 0; j < BLOCK_SIZE; ++j) out[i + j] ^= previous[j];
+            std::memcpy(previous, current, BLOCK_SIZE);
+        }
+    }
+
+    /**
+     * @brief Cifra o descifra un buffer en modo CTR (contador big-endian de 128 bits).
+     *
+     * @param in     Datos de entrada (cualquier longitud).
+     * @param out    Datos de salida (puede coincidir con @p in).
+     * @param length Longitud en bytes.
+     * @param iv     Bloque contador inicial de 16 bytes.
+     */
+    void
+        cryptCTR(const uint8_t* in, uint8_t* out, size_t length, const uint8_t* iv) const {
+        requireKey();
+        Counter ctr = Counter::load(iv, false);
+        ctrXor(ctr, in, out, length);
+    }
+
+    /**
+     * @brief Cifra con AES-GCM y calcula la etiqueta de autenticación.
+     *
+     * @param iv        IV (se recomiendan 12 bytes).
+     * @param ivLength  Longitud del IV.
+     * @param aad       Datos adicionales autenticados (pueden ser nullptr si aadLength es 0).
+     * @param aadLength Longitud de los datos adicionales.
+     * @param in        Texto plano.
+     * @param out       Texto cifrado (misma longitud).
+     * @param length    Longitud del texto.
+     * @param tag       Etiqueta de 16 bytes (salida).
+     */
+    void
+        encodeGCM(const uint8_t* iv, size_t ivLength, const uint8_t* aad, size_t aadLength,
+            const uint8_t* in, uint8_t* out, size_t length, uint8_t* tag) const {
+        gcm(iv, ivLength, aad, aadLength, in, out, length, tag, true);
+    }
+
+    /**
+     * @brief Descifra con AES-GCM y verifica la etiqueta.
+     *
+     * @return true si la etiqueta es válida; false si los datos fueron alterados
+     *         (en ese caso @p out se rellena con ceros).
+     */
+    bool
+        decodeGCM(const uint8_t* iv, size_t ivLength, const uint8_t* aad, size_t aadLength,
+            const uint8_t* in, uint8_t* out, size_t length, const uint8_t* tag) const {
+        uint8_t expected[TAG_SIZE];
+        gcm(iv, ivLength, aad, aadLength, in, out, length, expected, false);
+
+        uint8_t diff = 0;
+        for (size_t i = 0; i < TAG_SIZE; ++i) diff |= expected[i] ^ tag[i];
+        if (diff != 0) {
+            std::fill(out, out + length, 0);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Cifra un vector en modo CBC.
+     */
+    std::vector<uint8_t>
+        encodeCBC(const std::vector<uint8_t>& data, const std::vector<uint8_t>& iv) const {
+        checkIV(iv, BLOCK_SIZE);
+        std::vector<uint8_t> out(data.size());
+        encodeCBC(data.data(), out.data(), data.size(), iv.data());
+        return out;
+    }
+
+    /**
+     * @brief Descifra un vector en modo CBC.
+     */
+    std::vector<uint8_t>
+        decodeCBC(const std::vector<uint8_t>& data, const std::vector<uint8_t>& iv) const {
+        checkIV(iv, BLOCK_SIZE);
+        std::vector<uint8_t> out(data.size());
+        decodeCBC(data.data(), out.data(), data.size(), iv.data());
+        return out;
+    }
+
+    /**
+     * @brief Cifra o descifra un vector en modo CTR.
+     */
+    std::vector<uint8_t>
+        cryptCTR(const std::vector<uint8_t>& data, const std::vector<uint8_t>& iv) const {
+        checkIV(iv, BLOCK_SIZE);
+        std::vector<uint8_t> out(data.size());
+        cryptCTR(data.data(), out.data(), data.size(), iv.data());
+        return out;
+    }
+
+    /**
+     * @brief Cifra un vector con GCM; devuelve texto cifrado seguido de la etiqueta.
+     */
+    std::vector<uint8_t>
+        encodeGCM(const std::vector<uint8_t>& data, const std::vector<uint8_t>& iv,
+            const std::vector<uint8_t>& aad = {}) const {
+        std::vector<uint8_t> out(data.size() + TAG_SIZE);
+        encodeGCM(iv.data(), iv.size(), aad.data(), aad.size(),
+            data.data(), out.data(), data.size(), out.data() + data.size());
+        return out;
+    }
+
+    /**
+     * @brief Descifra un vector GCM (texto cifrado + etiqueta).
+     *
+     * @param data   Texto cifrado seguido de la etiqueta de 16 bytes.
+     * @param iv     IV usado al cifrar.
+     * @param output Texto plano recuperado.
+     * @param aad    Datos adicionales autenticados.
+     * @return true si la etiqueta es válida.
+     */
+    bool
+        decodeGCM(const std::vector<uint8_t>& data, const std::vector<uint8_t>& iv,
+            std::vector<uint8_t>& output, const std::vector<uint8_t>& aad = {}) const {
+        if (data.size() < TAG_SIZE) {
+            return false;
+        }
+        size_t length = data.size() - TAG_SIZE;
+        output.assign(length, 0);
+        return decodeGCM(iv.data(), iv.size(), aad.data(), aad.size(),
+            data.data(), output.data(), length, data.data() + length);
+    }
+
+private:
+    /**
+     * @brief Tablas T y S-Box generadas una sola vez.
+     */
+    struct Tables {
+        uint8_t sbox[256];
+        uint8_t invSbox[256];
+        uint32_t te[4][256];
+        uint32_t td[4][256];
+    };
+
+    /**
+     * @brief Contador de 128 bits en dos mitades big-endian.
+     *
+     * En GCM sólo se incrementan los 32 bits inferiores (inc32).
+     */
+    struct Counter {
+        uint64_t hi;
+        uint64_t lo;
+        bool wrap32;
+
+        static Counter
+            load(const uint8_t* block, bool wrap32) {
+            Counter c{ 0, 0, wrap32 };
+            for (int i = 0; i < 8; ++i) {
+                c.hi = (c.hi << 8) | block[i];
+                c.lo = (c.lo << 8) | block[8 + i];
+            }
+            return c;
+        }
+
+        void
+            store(uint8_t* block) const {
+            for (int i = 0; i < 8; ++i) {
+                block[i] = static_cast<uint8_t>(hi >> (56 - 8 * i));
+                block[8 + i] = static_cast<uint8_t>(lo >> (56 - 8 * i));
+            }
+        }
+
+        void
+            increment() {
+            if (wrap32) {
+                lo = (lo & 0xFFFFFFFF00000000ULL) | ((lo + 1) & 0xFFFFFFFFULL);
+            }
+            else if (++lo == 0) {
+                ++hi;
+            }
+        }
+    };
+
+    int m_rounds = 0;
+    bool m_useHardware = false;
+    uint32_t m_encWords[60] = {};                 ///< Subclaves de cifrado (tablas T).
+    uint32_t m_decWords[60] = {};                 ///< Subclaves de descifrado equivalente.
+    alignas(16) uint8_t m_encKeys[15 * 16] = {};  ///< Subclaves de cifrado en bytes (AES-NI).
+    alignas(16) uint8_t m_decKeys[15 * 16] = {};  ///< Subclaves de descifrado en bytes (AES-NI).
+    uint8_t m_hashKey[16] = {};                   ///< H = E(0) para GHASH.
+    uint64_t m_ghashHigh[16] = {};                ///< Tabla de 4 bits de GHASH (parte alta).
+    uint64_t m_ghashLow[16] = {};                 ///< Tabla de 4 bits de GHASH (parte baja).
+
+    static const Tables&
+        tables() {
+        static const Tables t = buildTables();
+        return t;
+    }
+
+    static uint8_t
+        xtime(uint8_t x) {
+        return static_cast<uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+    }
+
+    static uint8_t
+        gmul(uint8_t a, uint8_t b) {
+        uint8_t r = 0;
+        while (b) {
+            if (b & 1) r ^= a;
+            a = xtime(a);
+            b >>= 1;
+        }
+        return r;
+    }
+
+    static uint32_t
+        rotr8(uint32_t x) {
+        return (x >> 8) | (x << 24);
+    }
+
+    static Tables
+        buildTables() {
+        Tables t{};
+
+        // S-Box: inverso multiplicativo en GF(2^8) seguido de la transformación afín.
+        uint8_t p = 1, q = 1;
+        do {
+            p = static_cast<uint8_t>(p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0));
+            q ^= static_cast<uint8_t>(q << 1);
+            q ^= static_cast<uint8_t>(q << 2);
+            q ^= static_cast<uint8_t>(q << 4);
+            if (q & 0x80) q ^= 0x09;
+            uint8_t x = static_cast<uint8_t>(q ^ ((q << 1) | (q >> 7)) ^ ((q << 2) | (q >> 6))
+                ^ ((q << 3) | (q >> 5)) ^ ((q << 4) | (q >> 4)));
+            t.sbox[p] = static_cast<uint8_t>(x ^ 0x63);
+        } while (p != 1);
+        t.sbox[0] = 0x63;
+
+        for (int i = 0; i < 256; ++i) {
+            t.invSbox[t.sbox[i]] = static_cast<uint8_t>(i);
+        }
+
+        for (int i = 0; i < 256; ++i) {
+            uint8_t s = t.sbox[i];
+            uint32_t e = (static_cast<uint32_t>(xtime(s)) << 24) | (static_cast<uint32_t>(s) << 16)
+                | (static_cast<uint32_t>(s) << 8) | static_cast<uint32_t>(xtime(s) ^ s);
+            uint8_t v = t.invSbox[i];
+            uint32_t d = (static_cast<uint32_t>(gmul(v, 14)) << 24) | (static_cast<uint32_t>(gmul(v, 9)) << 16)
+                | (static_cast<uint32_t>(gmul(v, 13)) << 8) | static_cast<uint32_t>(gmul(v, 11));
+            for (int k = 0; k < 4; ++k) {
+                t.te[k][i] = e;
+                t.td[k][i] = d;
+                e = rotr8(e);
+                d = rotr8(d);
+            }
+        }
+        return t;
+    }
+
+    /**
+     * @throws std::runtime_error Si no se ha expandido ninguna clave (AES por defecto).
+     */
+    void
+        requireKey() const {
+        if (m_rounds == 0) {
+            throw std::runtime_error("AES sin clave: construya el cifrador con una clave.");
+        }
+    }
+
+    static void
+        checkLength(size_t length) {
+        if (length % BLOCK_SIZE != 0) {
+            throw std::invalid_argument("La longitud debe ser multiplo de 16 bytes.");
+        }
+    }
+
+    static void
+        checkIV(const std::vector<uint8_t>& iv, size_t size) {
+        if (iv.size() != size) {
+            throw std::invalid_argument("El IV debe tener 16 bytes.");
+        }
+    }
+
+    static uint32_t
+        load32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+            | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    static void
+        store32(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    void
+        setKey(const uint8_t* key, size_t keyLength) {
+        if (keyLength != 16 && keyLength != 24 && keyLength != 32) {
+            throw std::invalid_argument("La clave AES debe tener 16, 24 o 32 bytes.");
+        }
+        const Tables& t = tables();
+        int nk = static_cast<int>(keyLength / 4);
+        m_rounds = nk + 6;
+        int total = 4 * (m_rounds + 1);
+
+        for (int i = 0; i < nk; ++i) {
+            m_encWords[i] = load32(key + 4 * i);
+        }
+        uint32_t rcon = 0x01;
+        for (int i = nk; i < total; ++i) {
+            uint32_t temp = m_encWords[i - 1];
+            if (i % nk == 0) {
+                temp = (temp << 8) | (temp >> 24);
+                temp = subWord(temp, t) ^ (rcon << 24);
+                rcon = xtime(static_cast<uint8_t>(rcon));
+            }
+            else if (nk > 6 && i % nk == 4) {
+                temp = subWord(temp, t);
+            }
+            m_encWords[i] = m_encWords[i - nk] ^ temp;
+        }
+
+        // Subclaves del descifrado equivalente: orden inverso e InvMixColumns en las rondas internas.
+        for (int r = 0; r <= m_rounds; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                uint32_t w = m_encWords[4 * (m_rounds - r) + c];
+                if (r != 0 && r != m_rounds) {
+                    w = t.td[0][t.sbox[w >> 24]] ^ t.td[1][t.sbox[(w >> 16) & 0xFF]]
+                        ^ t.td[2][t.sbox[(w >> 8) & 0xFF]] ^ t.td[3][t.sbox[w & 0xFF]];
+                }
+                m_decWords[4 * r + c] = w;
+            }
+        }
+
+        for (int i = 0; i < total; ++i) {
+            store32(m_encKeys + 4 * i, m_encWords[i]);
+            store32(m_decKeys + 4 * i, m_decWords[i]);
+        }
+
+        setHardwareAcceleration(true);
+
+        // H y tabla de 4 bits para GHASH por software.
+        uint8_t zero[BLOCK_SIZE] = {};
+        swEncrypt(zero, m_hashKey);
+        buildGhashTable();
+    }
+
+    static uint32_t
+        subWord(uint32_t w, const Tables& t) {
+        return (static_cast<uint32_t>(t.sbox[w >> 24]) << 24) | (static_cast<uint32_t>(t.sbox[(w >> 16) & 0xFF]) << 16)
+            | (static_cast<uint32_t>(t.sbox[(w >> 8) & 0xFF]) << 8) | t.sbox[w & 0xFF];
+    }
+
+    void
+        swEncrypt(const uint8_t* in, uint8_t* out) const {
+        const Tables& t = tables();
+        const uint32_t* rk = m_encWords;
+        uint32_t s0 = load32(in) ^ rk[0];
+        uint32_t s1 = load32(in + 4) ^ rk[1];
+        uint32_t s2 = load32(in + 8) ^ rk[2];
+        uint32_t s3 = load32(in + 12) ^ rk[3];
+
+        for (int r = 1; r < m_rounds; ++r) {
+            rk += 4;
+            uint32_t t0 = t.te[0][s0 >> 24] ^ t.te[1][(s1 >> 16) & 0xFF] ^ t.te[2][(s2 >> 8) & 0xFF] ^ t.te[3][s3 & 0xFF] ^ rk[0];
+            uint32_t t1 = t.te[0][s1 >> 24] ^ t.te[1][(s2 >> 16) & 0xFF] ^ t.te[2][(s3 >> 8) & 0xFF] ^ t.te[3][s0 & 0xFF] ^ rk[1];
+            uint32_t t2 = t.te[0][s2 >> 24] ^ t.te[1][(s3 >> 16) & 0xFF] ^ t.te[2][(s0 >> 8) & 0xFF] ^ t.te[3][s1 & 0xFF] ^ rk[2];
+            uint32_t t3 = t.te[0][s3 >> 24] ^ t.te[1][(s0 >> 16) & 0xFF] ^ t.te[2][(s1 >> 8) & 0xFF] ^ t.te[3][s2 & 0xFF] ^ rk[3];
+            s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+        }
+
+        rk += 4;
+        const uint8_t* s = t.sbox;
+        store32(out, ((uint32_t)s[s0 >> 24] << 24 | (uint32_t)s[(s1 >> 16) & 0xFF] << 16 | (uint32_t)s[(s2 >> 8) & 0xFF] << 8 | s[s3 & 0xFF]) ^ rk[0]);
+        store32(out + 4, ((uint32_t)s[s1 >> 24] << 24 | (uint32_t)s[(s2 >> 16) & 0xFF] << 16 | (uint32_t)s[(s3 >> 8) & 0xFF] << 8 | s[s0 & 0xFF]) ^ rk[1]);
+        store32(out + 8, ((uint32_t)s[s2 >> 24] << 24 | (uint32_t)s[(s3 >> 16) & 0xFF] << 16 | (uint32_t)s[(s0 >> 8) & 0xFF] << 8 | s[s1 & 0xFF]) ^ rk[2]);
+        store32(out + 12, ((uint32_t)s[s3 >> 24] << 24 | (uint32_t)s[(s0 >> 16) & 0xFF] << 16 | (uint32_t)s[(s1 >> 8) & 0xFF] << 8 | s[s2 & 0xFF]) ^ rk[3]);
+    }
+
+    void
+        swDecrypt(const uint8_t* in, uint8_t* out) const {
+        const Tables& t = tables();
+        const uint32_t* rk = m_decWords;
+        uint32_t s0 = load32(in) ^ rk[0];
+        uint32_t s1 = load32(in + 4) ^ rk[1];
+        uint32_t s2 = load32(in + 8) ^ rk[2];
+        uint32_t s3 = load32(in + 12) ^ rk[3];
+
+        for (int r = 1; r < m_rounds; ++r) {
+            rk += 4;
+            uint32_t t0 = t.td[0][s0 >> 24] ^ t.td[1][(s3 >> 16) & 0xFF] ^ t.td[2][(s2 >> 8) & 0xFF] ^ t.td[3][s1 & 0xFF] ^ rk[0];
+            uint32_t t1 = t.td[0][s1 >> 24] ^ t.td[1][(s0 >> 16) & 0xFF] ^ t.td[2][(s3 >> 8) & 0xFF] ^ t.td[3][s2 & 0xFF] ^ rk[1];
+            uint32_t t2 = t.td[0][s2 >> 24] ^ t.td[1][(s1 >> 16) & 0xFF] ^ t.td[2][(s0 >> 8) & 0xFF] ^ t.td[3][s3 & 0xFF] ^ rk[2];
+            uint32_t t3 = t.td[0][s3 >> 24] ^ t.td[1][(s2 >> 16) & 0xFF] ^ t.td[2][(s1 >> 8) & 0xFF] ^ t.td[3][s0 & 0xFF] ^ rk[3];
+            s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+        }
+
+        rk += 4;
+        const uint8_t* s = t.invSbox;
+        store32(out, ((uint32_t)s[s0 >> 24] << 24 | (uint32_t)s[(s3 >> 16) & 0xFF] << 16 | (uint32_t)s[(s2 >> 8) & 0xFF] << 8 | s[s1 & 0xFF]) ^ rk[0]);
+        store32(out + 4, ((uint32_t)s[s1 >> 24] << 24 | (uint32_t)s[(s0 >> 16) & 0xFF] << 16 | (uint32_t)s[(s3 >> 8) & 0xFF] << 8 | s[s2 & 0xFF]) ^ rk[1]);
+        store32(out + 8, ((uint32_t)s[s2 >> 24] << 24 | (uint32_t)s[(s1 >> 16) & 0xFF] << 16 | (uint32_t)s[(s0 >> 8) & 0xFF] << 8 | s[s3 & 0xFF]) ^ rk[2]);
+        store32(out + 12, ((uint32_t)s[s3 >> 24] << 24 | (uint32_t)s[(s2 >> 16) & 0xFF] << 16 | (uint32_t)s[(s1 >> 8) & 0xFF] << 8 | s[s0 & 0xFF]) ^ rk[3]);
+    }
+
+    void
+        ctrXor(Counter& ctr, const uint8_t* in, uint8_t* out, size_t length) const {
+#if TTC_X86
+        if (m_useHardware) {
+            withRounds(m_rounds, [&](auto rounds) { hwCTR<decltype(rounds)::value>(m_encKeys, ctr, in, out, length); });
+            return;
+        }
+#endif
+        uint8_t block[BLOCK_SIZE];
+        uint8_t stream[BLOCK_SIZE];
+        for (size_t i = 0; i < length; i += BLOCK_SIZE) {
+            ctr.store(block);
+            ctr.increment();
+            swEncrypt(block, stream);
+            size_t n = (length - i < BLOCK_SIZE) ? length - i : BLOCK_SIZE;
+            for (size_t j = 0; j < n; ++j) out[i + j] = in[i + j] ^ stream[j];
+        }
+    }
+
+    void
+        gcm(const uint8_t* iv, size_t ivLength, const uint8_t* aad, size_t aadLength,
+            const uint8_t* in, uint8_t* out, size_t length, uint8_t* tag, bool encrypt) const {
+        requireKey();
+        uint8_t j0[BLOCK_SIZE] = {};
+        if (ivLength == 12) {
+            std::memcpy(j0, iv, 12);
+            j0[15] = 1;
+        }
+        else {
+            ghash(j0, iv, ivLength);
+            uint8_t lengths[BLOCK_SIZE] = {};
+            storeBits(lengths + 8, ivLength);
+            ghash(j0, lengths, BLOCK_SIZE);
+        }
+
+        uint8_t state[BLOCK_SIZE] = {};
+        ghash(state, aad, aadLength);
+
+        Counter ctr = Counter::load(j0, true);
+        ctr.increment();
+        if (encrypt) {
+            ctrXor(ctr, in, out, length);
+            ghash(state, out, length);
+        }
+        else {
+            ghash(state, in, length);
+            ctrXor(ctr, in, out, length);
+        }
+
+        uint8_t lengths[BLOCK_SIZE] = {};
+        storeBits(lengths, aadLength);
+        storeBits(lengths + 8, length);
+        ghash(state, lengths, BLOCK_SIZE);
+
+        encodeBlock(j0, tag);
+        for (size_t i = 0; i < TAG_SIZE; ++i) tag[i] ^= state[i];
+    }
+
+    static void
+        storeBits(uint8_t* p, size_t bytes) {
+        uint64_t bits = static_cast<uint64_t>(bytes) * 8;
+        for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+
+    /**
+     * @brief Acumula datos en el estado GHASH (el último bloque parcial se rellena con ceros).
+     */
+    void
+        ghash(uint8_t* state, const uint8_t* data, size_t length) const {
+        if (length == 0) return;
+#if TTC_X86
+        if (m_useHardware) {
+            hwGhash(m_hashKey, state, data, length);
+            return;
+        }
+#endif
+        for (size_t i = 0; i < length; i += BLOCK_SIZE) {
+            size_t n = (length - i < BLOCK_SIZE) ? length - i : BLOCK_SIZE;
+            for (size_t j = 0; j < n; ++j) state[j] ^= data[i + j];
+            ghashMultiply(state);
+        }
+    }
+
+    void
+        buildGhashTable() {
+        uint64_t vh = 0, vl = 0;
+        for (int i = 0; i < 8; ++i) {
+            vh = (vh << 8) | m_hashKey[i];
+            vl = (vl << 8) | m_hashKey[8 + i];
+        }
+        m_ghashLow[8] = vl;
+        m_ghashHigh[8] = vh;
+        m_ghashLow[0] = 0;
+        m_ghashHigh[0] = 0;
+        for (int i = 4; i > 0; i >>= 1) {
+            uint64_t reduce = (vl & 1) ? 0xE100000000000000ULL : 0;
+            vl = (vh << 63) | (vl >> 1);
+            vh = (vh >> 1) ^ reduce;
+            m_ghashLow[i] = vl;
+            m_ghashHigh[i] = vh;
+        }
+        for (int i = 2; i <= 8; i *= 2) {
+            for (int j = 1; j < i; ++j) {
+                m_ghashHigh[i + j] = m_ghashHigh[i] ^ m_ghashHigh[j];
+                m_ghashLow[i + j] = m_ghashLow[i] ^ m_ghashLow[j];
+            }
+        }
+    }
+
+    /**
+     * @brief state = state * H en GF(2^128) con la tabla de 4 bits (método de Shoup).
+     */
+    void
+        ghashMultiply(uint8_t* state) const {
+        static const uint64_t last4[16] = {
+            0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+            0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+        };
+
+        uint8_t lo = state[15] & 0x0F;
+        uint64_t zh = m_ghashHigh[lo];
+        uint64_t zl = m_ghashLow[lo];
+
+        for (int i = 15; i >= 0; --i) {
+            lo = state[i] & 0x0F;
+            uint8_t hi = (state[i] >> 4) & 0x0F;
+            uint8_t rem;
+            if (i != 15) {
+                rem = static_cast<uint8_t>(zl & 0x0F);
+                zl = (zh << 60) | (zl >> 4);
+                zh = (zh >> 4) ^ (last4[rem] << 48);
+                zh ^= m_ghashHigh[lo];
+                zl ^= m_ghashLow[lo];
+            }
+            rem = static_cast<uint8_t>(zl & 0x0F);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (last4[rem] << 48);
+            zh ^= m_ghashHigh[hi];
+            zl ^= m_ghashLow[hi];
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            state[i] = static_cast<uint8_t>(zh >> (56 - 8 * i));
+            state[8 + i] = static_cast<uint8_t>(zl >> (56 - 8 * i));
+        }
+    }
+
+#if TTC_X86
+    // ===================== Ruta AES-NI / PCLMULQDQ =====================
+
+    /**
+     * @brief Llama a @p kernel con el número de rondas como constante de compilación
+     *        (std::integral_constant), para que cada núcleo AES-NI se genere ya
+     *        desenrollado para 10, 12 o 14 rondas sin depender del optimizador.
+     *
+     * @throws std::runtime_error Si @p rounds no es 10, 12 ni 14 (requireKey() lo garantiza
+     *         en las rutas públicas).
+     */
+    template <class Kernel>
+    static void
+        withRounds(int rounds, Kernel&& kernel) {
+        switch (rounds) {
+        case 10: kernel(std::integral_constant<int, 10>{}); return;
+        case 12: kernel(std::integral_constant<int, 12>{}); return;
+        case 14: kernel(std::integral_constant<int, 14>{}); return;
+        }
+        throw std::runtime_error("AES: numero de rondas invalido.");
+    }
+
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        loadRoundKeys(const uint8_t* keys, __m128i* rk) {
+        for (int r = 0; r <= Rounds; ++r) rk[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(keys + 16 * r));
+    }
+
+    /**
+     * @brief Cifra los 8 bloques de @p b (ya combinados con la subclave 0).
+     *
+     * Las 8 vías están escritas una a una con índices constantes: se quedan en registros
+     * y cada aesenc de una ronda es independiente de las otras 7, aunque el compilador no
+     * desenrolle bucles (GCC -O2, MSVC /O2).
+     */
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwEncrypt8(__m128i* b, const __m128i* rk) {
+        __m128i b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3], b4 = b[4], b5 = b[5], b6 = b[6], b7 = b[7];
+        for (int r = 1; r < Rounds; ++r) {
+            const __m128i k = rk[r];
+            b0 = _mm_aesenc_si128(b0, k);
+            b1 = _mm_aesenc_si128(b1, k);
+            b2 = _mm_aesenc_si128(b2, k);
+            b3 = _mm_aesenc_si128(b3, k);
+            b4 = _mm_aesenc_si128(b4, k);
+            b5 = _mm_aesenc_si128(b5, k);
+            b6 = _mm_aesenc_si128(b6, k);
+            b7 = _mm_aesenc_si128(b7, k);
+        }
+        const __m128i last = rk[Rounds];
+        b[0] = _mm_aesenclast_si128(b0, last);
+        b[1] = _mm_aesenclast_si128(b1, last);
+        b[2] = _mm_aesenclast_si128(b2, last);
+        b[3] = _mm_aesenclast_si128(b3, last);
+        b[4] = _mm_aesenclast_si128(b4, last);
+        b[5] = _mm_aesenclast_si128(b5, last);
+        b[6] = _mm_aesenclast_si128(b6, last);
+        b[7] = _mm_aesenclast_si128(b7, last);
+    }
+
+    /**
+     * @brief Descifra los 8 bloques de @p b (ya combinados con la subclave 0).
+     */
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwDecrypt8(__m128i* b, const __m128i* rk) {
+        __m128i b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3], b4 = b[4], b5 = b[5], b6 = b[6], b7 = b[7];
+        for (int r = 1; r < Rounds; ++r) {
+            const __m128i k = rk[r];
+            b0 = _mm_aesdec_si128(b0, k);
+            b1 = _mm_aesdec_si128(b1, k);
+            b2 = _mm_aesdec_si128(b2, k);
+            b3 = _mm_aesdec_si128(b3, k);
+            b4 = _mm_aesdec_si128(b4, k);
+            b5 = _mm_aesdec_si128(b5, k);
+            b6 = _mm_aesdec_si128(b6, k);
+            b7 = _mm_aesdec_si128(b7, k);
+        }
+        const __m128i last = rk[Rounds];
+        b[0] = _mm_aesdeclast_si128(b0, last);
+        b[1] = _mm_aesdeclast_si128(b1, last);
+        b[2] = _mm_aesdeclast_si128(b2, last);
+        b[3] = _mm_aesdeclast_si128(b3, last);
+        b[4] = _mm_aesdeclast_si128(b4, last);
+        b[5] = _mm_aesdeclast_si128(b5, last);
+        b[6] = _mm_aesdeclast_si128(b6, last);
+        b[7] = _mm_aesdeclast_si128(b7, last);
+    }
+
+    /**
+     * @brief Carga 8 bloques consecutivos de @p in combinados con la subclave 0.
+     */
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwLoad8(const uint8_t* in, __m128i key, __m128i* b) {
+        const __m128i* src = reinterpret_cast<const __m128i*>(in);
+        b[0] = _mm_xor_si128(_mm_loadu_si128(src + 0), key);
+        b[1] = _mm_xor_si128(_mm_loadu_si128(src + 1), key);
+        b[2] = _mm_xor_si128(_mm_loadu_si128(src + 2), key);
+        b[3] = _mm_xor_si128(_mm_loadu_si128(src + 3), key);
+        b[4] = _mm_xor_si128(_mm_loadu_si128(src + 4), key);
+        b[5] = _mm_xor_si128(_mm_loadu_si128(src + 5), key);
+        b[6] = _mm_xor_si128(_mm_loadu_si128(src + 6), key);
+        b[7] = _mm_xor_si128(_mm_loadu_si128(src + 7), key);
+    }
+
+    /**
+     * @brief Guarda 8 bloques consecutivos en @p out.
+     */
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwStore8(uint8_t* out, const __m128i* b) {
+        __m128i* dst = reinterpret_cast<__m128i*>(out);
+        _mm_storeu_si128(dst + 0, b[0]);
+        _mm_storeu_si128(dst + 1, b[1]);
+        _mm_storeu_si128(dst + 2, b[2]);
+        _mm_storeu_si128(dst + 3, b[3]);
+        _mm_storeu_si128(dst + 4, b[4]);
+        _mm_storeu_si128(dst + 5, b[5]);
+        _mm_storeu_si128(dst + 6, b[6]);
+        _mm_storeu_si128(dst + 7, b[7]);
+    }
+
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwEncryptBlocks(const uint8_t* keys, const uint8_t* in, uint8_t* out, size_t count) {
+        __m128i rk[Rounds + 1];
+        loadRoundKeys<Rounds>(keys, rk);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i b[8];
+            hwLoad8(in + 16 * i, rk[0], b);
+            hwEncrypt8<Rounds>(b, rk);
+            hwStore8(out + 16 * i, b);
+        }
+        for (; i < count; ++i) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)), rk[0]);
+            for (int r = 1; r < Rounds; ++r) b = _mm_aesenc_si128(b, rk[r]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), _mm_aesenclast_si128(b, rk[Rounds]));
+        }
+    }
+
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwDecryptBlocks(const uint8_t* keys, const uint8_t* in, uint8_t* out, size_t count) {
+        __m128i rk[Rounds + 1];
+        loadRoundKeys<Rounds>(keys, rk);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i b[8];
+            hwLoad8(in + 16 * i, rk[0], b);
+            hwDecrypt8<Rounds>(b, rk);
+            hwStore8(out + 16 * i, b);
+        }
+        for (; i < count; ++i) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)), rk[0]);
+            for (int r = 1; r < Rounds; ++r) b = _mm_aesdec_si128(b, rk[r]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), _mm_aesdeclast_si128(b, rk[Rounds]));
+        }
+    }
+
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwEncryptCBC(const uint8_t* keys, const uint8_t* in, uint8_t* out, size_t count, const uint8_t* iv) {
+        __m128i rk[Rounds + 1];
+        loadRoundKeys<Rounds>(keys, rk);
+
+        __m128i chain = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+        for (size_t i = 0; i < count; ++i) {
+            chain = _mm_xor_si128(chain, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)));
+            chain = _mm_xor_si128(chain, rk[0]);
+            for (int r = 1; r < Rounds; ++r) chain = _mm_aesenc_si128(chain, rk[r]);
+            chain = _mm_aesenclast_si128(chain, rk[Rounds]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), chain);
+        }
+    }
+
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwDecryptCBC(const uint8_t* keys, const uint8_t* in, uint8_t* out, size_t count, const uint8_t* iv) {
+        __m128i rk[Rounds + 1];
+        loadRoundKeys<Rounds>(keys, rk);
+
+        __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i* src = reinterpret_cast<const __m128i*>(in + 16 * i);
+            __m128i b[8];
+            hwLoad8(in + 16 * i, rk[0], b);
+            hwDecrypt8<Rounds>(b, rk);
+            // Se vuelven a leer los cifrados anteriores en vez de guardarlos: con in == out
+            // cada bloque se lee antes de sobrescribirlo.
+            __m128i last = _mm_loadu_si128(src + 7);
+            b[7] = _mm_xor_si128(b[7], _mm_loadu_si128(src + 6));
+            b[6] = _mm_xor_si128(b[6], _mm_loadu_si128(src + 5));
+            b[5] = _mm_xor_si128(b[5], _mm_loadu_si128(src + 4));
+            b[4] = _mm_xor_si128(b[4], _mm_loadu_si128(src + 3));
+            b[3] = _mm_xor_si128(b[3], _mm_loadu_si128(src + 2));
+            b[2] = _mm_xor_si128(b[2], _mm_loadu_si128(src + 1));
+            b[1] = _mm_xor_si128(b[1], _mm_loadu_si128(src + 0));
+            b[0] = _mm_xor_si128(b[0], previous);
+            hwStore8(out + 16 * i, b);
+            previous = last;
+        }
+        for (; i < count; ++i) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i));
+            __m128i b = _mm_xor_si128(c, rk[0]);
+            for (int r = 1; r < Rounds; ++r) b = _mm_aesdec_si128(b, rk[r]);
+            b = _mm_xor_si128(_mm_aesdeclast_si128(b, rk[Rounds]), previous);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), b);
+            previous = c;
+        }
+    }
+
+    template <int Rounds>
+    TTC_TARGET("aes,sse4.1")
+        static void
+        hwCTR(const uint8_t* keys, Counter& ctr, const uint8_t* in, uint8_t* out, size_t length) {
+        __m128i rk[Rounds + 1];
+        loadRoundKeys<Rounds>(keys, rk);
+        const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+        size_t i = 0;
+        // Ruta de 8 bloques: los contadores son independientes y se cifran en paralelo.
+        for (; i + 128 <= length; i += 128) {
+            __m128i b[8];
+            uint64_t limit = ctr.wrap32 ? (ctr.lo & 0xFFFFFFFFULL) : ctr.lo;
+            uint64_t max = ctr.wrap32 ? 0xFFFFFFFFULL : ~0ULL;
+            if (limit <= max - 8) {
+                // Caso habitual: los 8 contadores no desbordan y se generan con sumas SIMD.
+                const __m128i base = _mm_set_epi64x(static_cast<long long>(ctr.hi), static_cast<long long>(ctr.lo));
+                b[0] = _mm_xor_si128(_mm_shuffle_epi8(base, bswap), rk[0]);
+                b[1] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 1)), bswap), rk[0]);
+                b[2] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 2)), bswap), rk[0]);
+                b[3] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 3)), bswap), rk[0]);
+                b[4] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 4)), bswap), rk[0]);
+                b[5] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 5)), bswap), rk[0]);
+                b[6] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 6)), bswap), rk[0]);
+                b[7] = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi64(base, _mm_set_epi64x(0, 7)), bswap), rk[0]);
+                ctr.lo += 8;
+            }
+            else {
+                for (int j = 0; j < 8; ++j) {
+                    b[j] = _mm_shuffle_epi8(_mm_set_epi64x(static_cast<long long>(ctr.hi), static_cast<long long>(ctr.lo)), bswap);
+                    b[j] = _mm_xor_si128(b[j], rk[0]);
+                    ctr.increment();
+                }
+            }
+            hwEncrypt8<Rounds>(b, rk);
+            const __m128i* src = reinterpret_cast<const __m128i*>(in + i);
+            b[0] = _mm_xor_si128(b[0], _mm_loadu_si128(src + 0));
+            b[1] = _mm_xor_si128(b[1], _mm_loadu_si128(src + 1));
+            b[2] = _mm_xor_si128(b[2], _mm_loadu_si128(src + 2));
+            b[3] = _mm_xor_si128(b[3], _mm_loadu_si128(src + 3));
+            b[4] = _mm_xor_si128(b[4], _mm_loadu_si128(src + 4));
+            b[5] = _mm_xor_si128(b[5], _mm_loadu_si128(src + 5));
+            b[6] = _mm_xor_si128(b[6], _mm_loadu_si128(src + 6));
+            b[7] = _mm_xor_si128(b[7], _mm_loadu_si128(src + 7));
+            hwStore8(out + i, b);
+        }
+        for (; i < length; i += 16) {
+            __m128i b = _mm_shuffle_epi8(_mm_set_epi64x(static_cast<long long>(ctr.hi), static_cast<long long>(ctr.lo)), bswap);
+            ctr.increment();
+            b = _mm_xor_si128(b, rk[0]);
+            for (int r = 1; r < Rounds; ++r) b = _mm_aesenc_si128(b, rk[r]);
+            b = _mm_aesenclast_si128(b, rk[Rounds]);
+
+            alignas(16) uint8_t stream[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(stream), b);
+            size_t n = (length - i < 16) ? length - i : 16;
+            for (size_t j = 0; j < n; ++j) out[i + j] = in[i + j] ^ stream[j];
+        }
+    }
+
+    /**
+     * @brief Multiplicación en GF(2^128) con PCLMULQDQ (operandos con bytes invertidos).
+     */
+    TTC_TARGET("pclmul,sse4.1")
+        static __m128i
+        hwGfMul(__m128i a, __m128i b) {
+        __m128i t3 = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i t4 = _mm_clmulepi64_si128(a, b, 0x10);
+        __m128i t5 = _mm_clmulepi64_si128(a, b, 0x01);
+        __m128i t6 = _mm_clmulepi64_si128(a, b, 0x11);
+
+        t4 = _mm_xor_si128(t4, t5);
+        t5 = _mm_slli_si128(t4, 8);
+        t4 = _mm_srli_si128(t4, 8);
+        t3 = _mm_xor_si128(t3, t5);
+        t6 = _mm_xor_si128(t6, t4);
+
+        // Desplazamiento de 1 bit del producto de 256 bits (representación reflejada).
+        __m128i t7 = _mm_srli_epi32(t3, 31);
+        __m128i t8 = _mm_srli_epi32(t6, 31);
+        t3 = _mm_slli_epi32(t3, 1);
+        t6 = _mm_slli_epi32(t6, 1);
+        __m128i t9 = _mm_srli_si128(t7, 12);
+        t8 = _mm_slli_si128(t8, 4);
+        t7 = _mm_slli_si128(t7, 4);
+        t3 = _mm_or_si128(t3, t7);
+        t6 = _mm_or_si128(t6, t8);
+        t6 = _mm_or_si128(t6, t9);
+
+        // Reducción módulo x^128 + x^7 + x^2 + x + 1.
+        t7 = _mm_slli_epi32(t3, 31);
+        t8 = _mm_slli_epi32(t3, 30);
+        t9 = _mm_slli_epi32(t3, 25);
+        t7 = _mm_xor_si128(t7, t8);
+        t7 = _mm_xor_si128(t7, t9);
+        t8 = _mm_srli_si128(t7, 4);
+        t7 = _mm_slli_si128(t7, 12);
+        t3 = _mm_xor_si128(t3, t7);
+
+        __m128i t2 = _mm_srli_epi32(t3, 1);
+        t4 = _mm_srli_epi32(t3, 2);
+        t5 = _mm_srli_epi32(t3, 7);
+        t2 = _mm_xor_si128(t2, t4);
+        t2 = _mm_xor_si128(t2, t5);
+        t2 = _mm_xor_si128(t2, t8);
+        t3 = _mm_xor_si128(t3, t2);
+        return _mm_xor_si128(t6, t3);
+    }
+
+    TTC_TARGET("pclmul,sse4.1")
+        static void
+        hwGhash(const uint8_t* hashKey, uint8_t* state, const uint8_t* data, size_t length) {
+        const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        __m128i h = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hashKey)), bswap);
+        __m128i x = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), bswap);
+
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            __m128i block = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), bswap);
+            x = hwGfMul(_mm_xor_si128(x, block), h);
+        }
+        if (i < length) {
+            alignas(16) uint8_t last[16] = {};
+            std::memcpy(last, data + i, length - i);
+            __m128i block = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(last)), bswap);
+            x = hwGfMul(_mm_xor_si128(x, block), h);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi8(x, bswap));
+    }
+#endif
+};
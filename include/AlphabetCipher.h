@@ -0,0 +1,557 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+
+#include <bit>
+#include <unordered_map>
+
+/**
+ * @class Alphabet
+ * @brief Alfabeto ordenado de letras Unicode (minúsculas y sus mayúsculas) para los
+ *        cifrados por desplazamiento.
+ *
+ * Las letras se dan en UTF-8. Se busca cualquier letra en O(1): tabla directa para ASCII
+ * y para los puntos de código de 2 bytes (U+0080..U+07FF, donde están ñ, á, ü...), y un
+ * mapa para el resto.
+ */
+class Alphabet {
+public:
+    /**
+     * @brief Representación UTF-8 de una letra, lista para copiar 4 bytes de golpe.
+     */
+    struct Glyph {
+        char bytes[4] = {};
+        uint8_t length = 0;
+    };
+
+    static constexpr int16_t UPPER = 0x100;     ///< Bit de mayúscula en el resultado de indexOf.
+
+    /**
+     * @brief Crea un alfabeto a partir de sus letras en orden.
+     *
+     * @param lower Minúsculas en UTF-8, en el orden del alfabeto.
+     * @param upper Mayúsculas correspondientes (misma cantidad de letras).
+     * @throws std::invalid_argument Si no son UTF-8 válido, no tienen el mismo número de
+     *         letras, están vacías o repiten alguna letra.
+     */
+    Alphabet(const std::string& lower, const std::string& upper) {
+        std::vector<char32_t> lowerPoints = codePoints(lower);
+        std::vector<char32_t> upperPoints = codePoints(upper);
+        if (lowerPoints.empty() || lowerPoints.size() != upperPoints.size() || lowerPoints.size() > 0xFF) {
+            throw std::invalid_argument("El alfabeto necesita entre 1 y 255 letras, con la misma cantidad de minusculas y mayusculas.");
+        }
+        m_ascii.fill(-1);
+        m_twoByte.assign(0x800, -1);
+        for (size_t i = 0; i < lowerPoints.size(); ++i) {
+            m_lower.push_back(glyph(lowerPoints[i]));
+            m_upper.push_back(glyph(upperPoints[i]));
+            m_maxLength = std::max<size_t>({ m_maxLength, m_lower.back().length, m_upper.back().length });
+            define(lowerPoints[i], static_cast<int16_t>(i));
+            define(upperPoints[i], static_cast<int16_t>(i | UPPER));
+        }
+    }
+
+    /**
+     * @brief Alfabeto inglés de 26 letras (el de CesarEncryption y Vigenere).
+     */
+    static Alphabet
+        english() {
+        return Alphabet("abcdefghijklmnopqrstuvwxyz", "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+    }
+
+    /**
+     * @brief Alfabeto español de 27 letras: la ñ va entre la n y la o.
+     */
+    static Alphabet
+        spanish() {
+        return Alphabet("abcdefghijklmn\xC3\xB1opqrstuvwxyz", "ABCDEFGHIJKLMN\xC3\x91OPQRSTUVWXYZ");
+    }
+
+    size_t
+        size() const {
+        return m_lower.size();
+    }
+
+    /**
+     * @brief Bytes UTF-8 de la letra más larga (1 si todas son ASCII).
+     */
+    size_t
+        maxLength() const {
+        return m_maxLength;
+    }
+
+    /**
+     * @brief Posición de una letra en el alfabeto, con el bit UPPER si es mayúscula.
+     *
+     * @return int16_t -1 si no pertenece al alfabeto.
+     */
+    int16_t
+        indexOf(char32_t codePoint) const {
+        if (codePoint < 0x80) return m_ascii[codePoint];
+        if (codePoint < 0x800) return m_twoByte[codePoint];
+        auto it = m_other.find(codePoint);
+        return it == m_other.end() ? -1 : it->second;
+    }
+
+    /**
+     * @brief Índice de un byte ASCII (sin pasar por el decodificador UTF-8).
+     */
+    int16_t
+        asciiIndex(uint8_t byte) const {
+        return m_ascii[byte & 0x7F];
+    }
+
+    const Glyph&
+        letter(size_t index, bool upper) const {
+        return upper ? m_upper[index] : m_lower[index];
+    }
+
+    /**
+     * @brief Decodifica un punto de código y avanza @p p.
+     *
+     * Rechaza secuencias truncadas, bytes de continuación sueltos, formas largas,
+     * sustitutos (U+D800..U+DFFF) y valores por encima de U+10FFFF.
+     *
+     * @return bool false si la secuencia no es UTF-8 válido (@p p no se mueve).
+     */
+    static bool
+        decode(const uint8_t*& p, const uint8_t* end, char32_t& codePoint) {
+        uint8_t first = p[0];
+        if (first < 0x80) {
+            codePoint = first;
+            ++p;
+            return true;
+        }
+        size_t length;
+        char32_t minimum;
+        if ((first & 0xE0) == 0xC0) { length = 2; codePoint = first & 0x1F; minimum = 0x80; }
+        else if ((first & 0xF0) == 0xE0) { length = 3; codePoint = first & 0x0F; minimum = 0x800; }
+        else if ((first & 0xF8) == 0xF0) { length = 4; codePoint = first & 0x07; minimum = 0x10000; }
+        else return false;
+        if (static_cast<size_t>(end - p) < length) return false;
+        for (size_t i = 1; i < length; ++i) {
+            if ((p[i] & 0xC0) != 0x80) return false;
+            codePoint = (codePoint << 6) | (p[i] & 0x3F);
+        }
+        if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return false;
+        }
+        p += length;
+        return true;
+    }
+
+    /**
+     * @brief Puntos de código de un texto UTF-8.
+     *
+     * @throws std::invalid_argument Si el texto no es UTF-8 válido.
+     */
+    static std::vector<char32_t>
+        codePoints(const std::string& text) {
+        std::vector<char32_t> points;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(text.data());
+        const uint8_t* end = p + text.size();
+        while (p < end) {
+            char32_t codePoint;
+            if (!decode(p, end, codePoint)) {
+                throw invalidUtf8(p - reinterpret_cast<const uint8_t*>(text.data()));
+            }
+            points.push_back(codePoint);
+        }
+        return points;
+    }
+
+    static std::invalid_argument
+        invalidUtf8(ptrdiff_t offset) {
+        return std::invalid_argument("UTF-8 no valido en el byte " + std::to_string(offset) + ".");
+    }
+
+private:
+    std::vector<Glyph> m_lower;
+    std::vector<Glyph> m_upper;
+    std::array<int16_t, 128> m_ascii{};
+    std::vector<int16_t> m_twoByte;
+    std::unordered_map<char32_t, int16_t> m_other;
+    size_t m_maxLength = 1;
+
+    void
+        define(char32_t codePoint, int16_t value) {
+        if (indexOf(codePoint) != -1) {
+            throw std::invalid_argument("El alfabeto repite una letra.");
+        }
+        if (codePoint < 0x80) m_ascii[codePoint] = value;
+        else if (codePoint < 0x800) m_twoByte[codePoint] = value;
+        else m_other[codePoint] = value;
+    }
+
+    static Glyph
+        glyph(char32_t c) {
+        Glyph g;
+        if (c < 0x80) {
+            g.bytes[0] = static_cast<char>(c);
+            g.length = 1;
+        }
+        else if (c < 0x800) {
+            g.bytes[0] = static_cast<char>(0xC0 | (c >> 6));
+            g.bytes[1] = static_cast<char>(0x80 | (c & 0x3F));
+            g.length = 2;
+        }
+        else if (c < 0x10000) {
+            g.bytes[0] = static_cast<char>(0xE0 | (c >> 12));
+            g.bytes[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            g.bytes[2] = static_cast<char>(0x80 | (c & 0x3F));
+            g.length = 3;
+        }
+        else {
+            g.bytes[0] = static_cast<char>(0xF0 | (c >> 18));
+            g.bytes[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            g.bytes[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            g.bytes[3] = static_cast<char>(0x80 | (c & 0x3F));
+            g.length = 4;
+        }
+        return g;
+    }
+};
+
+/**
+ * @class AlphabetCipher
+ * @brief César y Vigenère sobre un alfabeto configurable, procesando el texto como UTF-8.
+ *
+ * A diferencia de CesarEncryption y Vigenere, que trabajan con char sueltos y std::isalpha
+ * (dependiente del locale), aquí las letras se reconocen por punto de código: la ñ del
+ * alfabeto español se desplaza como cualquier otra letra y los caracteres que no están en
+ * el alfabeto (á, ü, signos...) se copian intactos sin partir sus secuencias multibyte.
+ * La clave de Vigenère solo avanza con las letras del alfabeto.
+ *
+ * El texto suele ser casi todo ASCII: cada bloque de 32 bytes se clasifica con AVX2 (o con
+ * aritmética de palabra de 64 bits) y se traduce con una tabla por posición de clave (256
+ * entradas de hasta 4 bytes). Las secuencias de 2 bytes con el byte inicial más común del
+ * alfabeto (0xC3 en español: ñ, á, ü...) también salen de la tabla: el byte inicial no
+ * escribe nada y el de continuación escribe la letra completa, así que un bloque con ñ o
+ * acentos se recorre igual que uno solo ASCII. Solo los bloques con otras secuencias pasan
+ * por el decodificador.
+ *
+ * @throws std::invalid_argument Desde los métodos de cifrado si el texto no es UTF-8 válido.
+ */
+class AlphabetCipher {
+public:
+    explicit AlphabetCipher(Alphabet alphabet = Alphabet::spanish())
+        : m_alphabet(std::move(alphabet)), m_lead(commonLead(m_alphabet)) {
+        setHardwareAcceleration(true);
+    }
+
+    const Alphabet&
+        alphabet() const {
+        return m_alphabet;
+    }
+
+    /**
+     * @brief Indica si la clasificación de bloques ASCII usa AVX2.
+     */
+    bool
+        usesHardware() const {
+        return m_useHardware;
+    }
+
+    /**
+     * @brief Activa o desactiva AVX2 (solo se activa si la CPU lo soporta).
+     */
+    void
+        setHardwareAcceleration(bool enable) {
+        m_useHardware = enable && CpuFeatures::get().avx2;
+    }
+
+    /**
+     * @brief Cifrado César: desplaza cada letra @p shift posiciones en el alfabeto.
+     */
+    std::string
+        encodeCaesar(const std::string& text, int shift) const {
+        int s = normalize(shift);
+        return transform(text, &s, 1);
+    }
+
+    std::string
+        decodeCaesar(const std::string& text, int shift) const {
+        return encodeCaesar(text, -shift);
+    }
+
+    /**
+     * @brief Cifrado Vigenère con una clave de letras del alfabeto (en UTF-8).
+     *
+     * @throws std::invalid_argument Si la clave no contiene ninguna letra del alfabeto.
+     */
+    std::string
+        encodeVigenere(const std::string& text, const std::string& key) const {
+        std::vector<int> shifts = keyShifts(key);
+        return transform(text, shifts.data(), shifts.size());
+    }
+
+    std::string
+        decodeVigenere(const std::string& text, const std::string& key) const {
+        std::vector<int> shifts = keyShifts(key);
+        for (int& s : shifts) s = normalize(-s);
+        return transform(text, shifts.data(), shifts.size());
+    }
+
+private:
+    static constexpr size_t BLOCK = 32;     ///< Bytes por bloque (un registro AVX2).
+    static constexpr size_t PIECE = 128;    ///< Bloques entre comprobaciones de espacio en la salida.
+
+    /**
+     * @brief Máscaras de un bloque de 32 bytes, un bit por byte.
+     */
+    struct BlockMasks {
+        uint32_t high = 0;      ///< Bytes no ASCII.
+        uint32_t lead = 0;      ///< Bytes iguales a m_lead.
+        uint32_t cont = 0;      ///< Bytes de continuación (10xxxxxx).
+    };
+
+    Alphabet m_alphabet;
+    uint8_t m_lead = 0xC3;      ///< Byte inicial de 2 bytes que se traduce con la tabla.
+    bool m_useHardware = false;
+
+    /**
+     * @brief Byte inicial más repetido entre las letras de 2 bytes del alfabeto (0xC3, el
+     *        de Latin-1, si no tiene ninguna).
+     */
+    static uint8_t
+        commonLead(const Alphabet& alphabet) {
+        std::array<size_t, 32> uses{};
+        for (size_t i = 0; i < alphabet.size(); ++i) {
+            for (bool upper : { false, true }) {
+                const Alphabet::Glyph& g = alphabet.letter(i, upper);
+                if (g.length == 2) ++uses[static_cast<uint8_t>(g.bytes[0]) & 0x1F];
+            }
+        }
+        size_t best = 0x03;
+        for (size_t i = 2; i < uses.size(); ++i) {
+            if (uses[i] > uses[best]) best = i;
+        }
+        return static_cast<uint8_t>(0xC0 | best);
+    }
+
+    int
+        normalize(int shift) const {
+        int n = static_cast<int>(m_alphabet.size());
+        return ((shift % n) + n) % n;
+    }
+
+    std::vector<int>
+        keyShifts(const std::string& key) const {
+        std::vector<int> shifts;
+        for (char32_t c : Alphabet::codePoints(key)) {
+            int16_t index = m_alphabet.indexOf(c);
+            if (index >= 0) shifts.push_back(index & 0xFF);
+        }
+        if (shifts.empty()) {
+            throw std::invalid_argument("La clave no puede estar vacia o sin letras del alfabeto.");
+        }
+        return shifts;
+    }
+
+    /**
+     * @brief Desplaza las letras de @p text; la posición de clave k usa @p shifts[k].
+     *
+     * El texto se recorre en bloques de 32 bytes. Si los bytes no ASCII del bloque son solo
+     * secuencias completas m_lead + continuación, el bloque entero se traduce con la tabla
+     * sin saltos que dependan de los datos. Si no, una máscara con un bit por byte no ASCII
+     * indica dónde hay que decodificar UTF-8 y los tramos ASCII entre esos bytes se
+     * traducen con la tabla.
+     */
+    std::string
+        transform(const std::string& text, const int* shifts, size_t count) const {
+        const size_t n = m_alphabet.size();
+
+        // Tabla por posición de clave: letra desplazada (o el propio texto) y avance. Los
+        // bytes ASCII se traducen solos; m_lead no escribe nada y cada byte de continuación
+        // escribe la secuencia m_lead + continuación ya traducida. El resto de bytes no
+        // ASCII nunca se busca en la tabla.
+        std::vector<Alphabet::Glyph> table(count * 256);
+        std::array<uint8_t, 256> advance{};
+        for (int b = 0; b < 256; ++b) {
+            int16_t index = -1;
+            Alphabet::Glyph same;
+            if (b < 0x80) {
+                index = m_alphabet.asciiIndex(static_cast<uint8_t>(b));
+                same.bytes[0] = static_cast<char>(b);
+                same.length = 1;
+            }
+            else if (b < 0xC0) {
+                index = m_alphabet.indexOf((static_cast<char32_t>(m_lead & 0x1F) << 6) | (b & 0x3F));
+                same.bytes[0] = static_cast<char>(m_lead);
+                same.bytes[1] = static_cast<char>(b);
+                same.length = 2;
+            }
+            advance[b] = index >= 0 ? 1 : 0;
+            for (size_t k = 0; k < count; ++k) {
+                table[k * 256 + b] = index >= 0
+                    ? m_alphabet.letter(((index & 0xFF) + shifts[k]) % n, (index & Alphabet::UPPER) != 0)
+                    : same;
+            }
+        }
+
+        // La salida crece por tramos: reservar el peor caso (letras de varios bytes) de una
+        // vez obligaría a inicializar varias veces el tamaño del texto.
+        const size_t blockRoom = (BLOCK + 3) * m_alphabet.maxLength() + 4;  // Bloque + secuencia partida
+        std::string out(text.size() + text.size() / 4 + PIECE * blockRoom, '\0');
+        size_t used = 0;
+        const uint8_t* begin = reinterpret_cast<const uint8_t*>(text.data());
+        const uint8_t* p = begin;
+        const uint8_t* end = p + text.size();
+        size_t k = 0;
+        const Alphabet::Glyph* row = table.data();
+
+        // Traduce bytes con la tabla sin comprobarlos
+        auto ascii = [&](char*& dst, const uint8_t* stop) {
+            if (count == 1) {
+                for (; p < stop; ++p) {
+                    const Alphabet::Glyph& g = row[*p];
+                    std::memcpy(dst, g.bytes, 4);
+                    dst += g.length;
+                }
+                return;
+            }
+            for (; p < stop; ++p) {
+                const Alphabet::Glyph& g = row[*p];
+                std::memcpy(dst, g.bytes, 4);
+                dst += g.length;
+                if (advance[*p]) {
+                    if (++k == count) k = 0;
+                    row = &table[k * 256];
+                }
+            }
+        };
+
+        while (p < end) {
+            if (out.size() - used < PIECE * blockRoom) {
+                out.resize(out.size() + out.size() / 2 + PIECE * blockRoom);
+            }
+            char* dst = &out[used];
+            for (size_t piece = 0; piece < PIECE && p < end; ++piece) {
+                if (end - p < static_cast<ptrdiff_t>(BLOCK)) {
+                    // Cola: byte a byte
+                    const uint8_t* stop = p;
+                    while (stop < end && *stop < 0x80) ++stop;
+                    ascii(dst, stop);
+                    if (p < end) decodeOne(p, begin, end, dst, shifts, count, k);
+                    row = &table[k * 256];
+                    continue;
+                }
+                const uint8_t* block = p;
+                BlockMasks masks = classify(block);
+                uint32_t mask = masks.high;
+                // Solo secuencias m_lead + continuación; la del último byte puede acabar en el
+                // siguiente bloque, que entonces empieza un byte más tarde.
+                if (mask == (masks.lead | masks.cont) && masks.cont == masks.lead << 1) {
+                    size_t spill = masks.lead >> 31;
+                    if (!spill || (end - block > static_cast<ptrdiff_t>(BLOCK) && (block[BLOCK] & 0xC0) == 0x80)) {
+                        ascii(dst, block + BLOCK + spill);
+                        continue;
+                    }
+                }
+                while (p < block + BLOCK) {
+                    const uint8_t* stop = mask ? block + std::countr_zero(mask) : block + BLOCK;
+                    ascii(dst, stop);
+                    if (!mask) break;
+                    decodeOne(p, begin, end, dst, shifts, count, k);
+                    row = &table[k * 256];
+                    size_t consumed = static_cast<size_t>(p - block);
+                    mask = consumed >= BLOCK ? 0 : mask & (~0u << consumed);
+                }
+            }
+            used = static_cast<size_t>(dst - out.data());
+        }
+        out.resize(used);
+        return out;
+    }
+
+    /**
+     * @brief Procesa la secuencia UTF-8 que empieza en @p p (no ASCII) y la avanza.
+     *
+     * @throws std::invalid_argument Si la secuencia no es válida.
+     */
+    void
+        decodeOne(const uint8_t*& p, const uint8_t* begin, const uint8_t* end, char*& dst,
+            const int* shifts, size_t count, size_t& k) const {
+        const uint8_t* start = p;
+        char32_t codePoint;
+        if (p[0] >= 0xC2 && p[0] < 0xE0 && end - p >= 2 && (p[1] & 0xC0) == 0x80) {
+            // Secuencia de 2 bytes (á, ñ, ü...): el caso habitual, sin pasar por decode()
+            codePoint = (static_cast<char32_t>(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+            p += 2;
+        }
+        else if (!Alphabet::decode(p, end, codePoint)) {
+            throw Alphabet::invalidUtf8(start - begin);
+        }
+        int16_t index = m_alphabet.indexOf(codePoint);
+        if (index >= 0) {
+            size_t shifted = static_cast<size_t>((index & 0xFF) + shifts[k]);   // Ambos < tamaño: sin división
+            if (shifted >= m_alphabet.size()) shifted -= m_alphabet.size();
+            const Alphabet::Glyph& g = m_alphabet.letter(shifted, (index & Alphabet::UPPER) != 0);
+            std::memcpy(dst, g.bytes, 4);
+            dst += g.length;
+            if (++k == count) k = 0;
+        }
+        else {
+            // Solo p - start bytes: al final del texto no hay 4 bytes legibles
+            std::memcpy(dst, start, static_cast<size_t>(p - start));
+            dst += p - start;
+        }
+    }
+
+    /**
+     * @brief Máscaras de bytes no ASCII, m_lead y continuación de los 32 bytes de @p p.
+     *
+     * Las de m_lead y continuación solo se calculan si hay algún byte no ASCII.
+     */
+    BlockMasks
+        classify(const uint8_t* p) const {
+#if TTC_X86
+        if (m_useHardware) {
+            return classifyAvx2(p, m_lead);
+        }
+#endif
+        BlockMasks masks;
+        uint64_t words[4];
+        std::memcpy(words, p, sizeof(words));
+        for (int w = 0; w < 4; ++w) {
+            masks.high |= gather(words[w]) << (8 * w);
+        }
+        if (!masks.high) return masks;
+        const uint64_t lead = 0x0101010101010101ULL * m_lead;
+        for (int w = 0; w < 4; ++w) {
+            // Byte igual a m_lead: el XOR da cero (bit alto de cada byte no nulo, negado)
+            uint64_t diff = words[w] ^ lead;
+            uint64_t nonZero = ((diff & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | diff;
+            masks.lead |= gather(~nonZero) << (8 * w);
+            // Continuación: bit 7 a uno y bit 6 a cero
+            masks.cont |= gather(words[w] & ~(words[w] << 1)) << (8 * w);
+        }
+        return masks;
+    }
+
+    /**
+     * @brief Junta el bit alto de cada byte de @p word en 8 bits (little-endian).
+     */
+    static uint32_t
+        gather(uint64_t word) {
+        uint64_t high = (word & 0x8080808080808080ULL) >> 7;
+        return static_cast<uint32_t>((high * 0x0102040810204080ULL) >> 56);
+    }
+
+#if TTC_X86
+    TTC_TARGET("avx2")
+        static BlockMasks
+        classifyAvx2(const uint8_t* p, uint8_t lead) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        BlockMasks masks;
+        masks.high = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+        if (!masks.high) return masks;
+        __m256i isLead = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(lead)));
+        // 0x80..0xBF son -128..-65 con signo
+        __m256i isCont = _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), v);
+        masks.lead = static_cast<uint32_t>(_mm256_movemask_epi8(isLead));
+        masks.cont = static_cast<uint32_t>(_mm256_movemask_epi8(isCont));
+        return masks;
+    }
+#endif
+};
@@ -0,0 +1,570 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CesarEncryption.h"
+#include "Vigenere.h"
+#include "XOREncoder.h"
+#include "AsciiBinary.h"
+#include "MappedFile.h"
+#include "SubstitutionSolver.h"
+#include <filesystem>
+
+/**
+ * @brief Tipo de cifrado o codificación detectado en un blob.
+ */
+enum class BlobKind {
+    Empty,
+    Plaintext,
+    Caesar,
+    Vigenere,
+    Substitution,
+    RepeatingXor,
+    BinaryText,
+    Hex,
+    Base64,
+    HighEntropy
+};
+
+/**
+ * @brief Estadísticas de un blob calculadas en una sola pasada.
+ */
+struct BlobFeatures {
+    size_t length = 0;
+    std::array<uint32_t, 256> histogram{};
+    std::array<uint32_t, 26> letters{};  ///< Letras sin distinguir mayúsculas.
+    size_t letterCount = 0;
+    size_t printable = 0;                ///< Imprimibles ASCII y espacios en blanco.
+    double entropy = 0.0;                ///< Bits por byte (0-8).
+    double indexOfCoincidence = 0.0;     ///< Sobre las letras (≈0.038 aleatorio, ≈0.07 idioma).
+};
+
+/**
+ * @brief Resultado del triaje de un blob.
+ */
+struct BlobReport {
+    std::string name;
+    BlobKind kind = BlobKind::Empty;
+    double confidence = 0.0;  ///< 0-1: seguridad de la clasificación y del descifrado.
+    BlobFeatures features;
+    std::string breaker;      ///< Atacante usado.
+    std::string key;          ///< Clave recuperada (si la hay).
+    std::string plaintext;    ///< Texto recuperado (si lo hay).
+};
+
+/**
+ * @class BlobClassifier
+ * @brief Clasifica blobs desconocidos y los envía al atacante adecuado.
+ *
+ * analyze() recorre el blob una sola vez llenando cuatro histogramas intercalados (evita
+ * que bytes repetidos serialicen los incrementos) y todo lo demás -conjunto de
+ * caracteres, entropía, índice de coincidencia, ajuste a la frecuencia del idioma- se
+ * deriva de esos 256 contadores sin volver a leer los datos.
+ *
+ * Según el tipo, process() usa CesarEncryption, Vigenere, XOR de clave repetida,
+ * AsciiBinary, hexadecimal o Base64 (estos dos se decodifican y se vuelven a clasificar)
+ * y, si se dio un modelo de n-gramas, SubstitutionSolver.
+ * processDirectory() reparte los archivos entre hilos y devuelve un informe ordenado.
+ */
+class BlobClassifier {
+public:
+    BlobClassifier() = default;
+
+    /**
+     * @param model          Modelo de n-gramas para romper sustituciones (debe vivir más que el clasificador).
+     * @param substitutionMs Presupuesto por blob del resolvedor de sustitución.
+     */
+    explicit BlobClassifier(const NGramModel& model, std::chrono::milliseconds substitutionMs = std::chrono::milliseconds(300))
+        : m_model(&model), m_substitutionBudget(substitutionMs) {
+    }
+
+    ~BlobClassifier() = default;
+
+    /**
+     * @brief Nombre legible del tipo.
+     */
+    static const char*
+        kindName(BlobKind kind) {
+        switch (kind) {
+        case BlobKind::Empty: return "vacio";
+        case BlobKind::Plaintext: return "texto plano";
+        case BlobKind::Caesar: return "Cesar";
+        case BlobKind::Vigenere: return "Vigenere";
+        case BlobKind::Substitution: return "sustitucion";
+        case BlobKind::RepeatingXor: return "XOR";
+        case BlobKind::BinaryText: return "binario ASCII";
+        case BlobKind::Hex: return "hexadecimal";
+        case BlobKind::Base64: return "Base64";
+        case BlobKind::HighEntropy: return "alta entropia";
+        }
+        return "?";
+    }
+
+    /**
+     * @brief Calcula las estadísticas del blob en una sola pasada.
+     */
+    static BlobFeatures
+        analyze(const uint8_t* data, size_t length) {
+        BlobFeatures f;
+        f.length = length;
+        uint32_t partial[4][256] = {};
+        size_t i = 0;
+        for (; i + 4 <= length; i += 4) {
+            ++partial[0][data[i]];
+            ++partial[1][data[i + 1]];
+            ++partial[2][data[i + 2]];
+            ++partial[3][data[i + 3]];
+        }
+        for (; i < length; ++i) ++partial[0][data[i]];
+
+        double entropy = 0.0;
+        for (int c = 0; c < 256; ++c) {
+            uint32_t n = partial[0][c] + partial[1][c] + partial[2][c] + partial[3][c];
+            f.histogram[c] = n;
+            if (n == 0) continue;
+            double p = static_cast<double>(n) / length;
+            entropy -= p * std::log2(p);
+            if ((c >= 0x20 && c < 0x7F) || c == '\n' || c == '\r' || c == '\t') f.printable += n;
+        }
+        f.entropy = entropy;
+        for (int l = 0; l < 26; ++l) {
+            f.letters[l] = f.histogram['A' + l] + f.histogram['a' + l];
+            f.letterCount += f.letters[l];
+        }
+        f.indexOfCoincidence = indexOfCoincidence(f.letters.data(), f.letterCount);
+        return f;
+    }
+
+    /**
+     * @brief Clasifica a partir de las estadísticas.
+     *
+     * @return std::pair<BlobKind, double> Tipo y confianza (0-1).
+     */
+    static std::pair<BlobKind, double>
+        classify(const BlobFeatures& f) {
+        if (f.length == 0) return { BlobKind::Empty, 1.0 };
+        const auto& h = f.histogram;
+        size_t whitespace = h[' '] + h['\n'] + h['\r'] + h['\t'];
+
+        if (h['0'] + h['1'] + whitespace == f.length && h['0'] + h['1'] >= 8) {
+            return { BlobKind::BinaryText, 0.99 };
+        }
+        size_t hex = whitespace;
+        for (int c = '0'; c <= '9'; ++c) hex += h[c];
+        for (int c = 'a'; c <= 'f'; ++c) hex += h[c] + h[c - 'a' + 'A'];
+        if (hex == f.length && (f.length - whitespace) % 2 == 0 && f.length - whitespace >= 2) {
+            return { BlobKind::Hex, whitespace > 0 ? 0.95 : 0.85 };
+        }
+        size_t base64 = h['+'] + h['/'] + h['='] + h['\n'] + h['\r'];
+        for (int c = 0; c < 26; ++c) base64 += h['A' + c] + h['a' + c];
+        for (int c = '0'; c <= '9'; ++c) base64 += h[c];
+        size_t significant = f.length - h['\n'] - h['\r'];
+        if (base64 == f.length && significant % 4 == 0 && significant >= 8) {
+            return { BlobKind::Base64, 0.9 };
+        }
+
+        // Texto: casi todo imprimible y al menos la mitad letras. XOR con una clave de
+        // letras también da bytes imprimibles, pero pocas letras.
+        if (f.printable >= f.length * 95 / 100 && f.letterCount * 2 >= f.length) {
+            if (f.letterCount < 20) return { BlobKind::Plaintext, 0.3 };
+            int shift = 0;
+            double fit = bestLanguageShift(f.letters.data(), shift);
+            if (fit >= 0.92) {
+                return { shift == 0 ? BlobKind::Plaintext : BlobKind::Caesar, std::min(1.0, fit) };
+            }
+            if (f.indexOfCoincidence >= 0.055) {
+                return { BlobKind::Substitution, std::min(1.0, f.indexOfCoincidence / 0.07) };
+            }
+            return { BlobKind::Vigenere, std::min(1.0, 0.5 + (0.06 - f.indexOfCoincidence) * 20.0) };
+        }
+
+        double maxEntropy = std::min(8.0, std::log2(static_cast<double>(f.length)));
+        if (f.entropy >= 0.9 * maxEntropy) {
+            return { BlobKind::HighEntropy, std::min(1.0, f.entropy / maxEntropy) };
+        }
+        return { BlobKind::RepeatingXor, std::min(1.0, 1.0 - f.entropy / 8.0 + 0.3) };
+    }
+
+    /**
+     * @brief Clasifica un blob y ejecuta el atacante correspondiente.
+     */
+    BlobReport
+        process(const std::string& name, const uint8_t* data, size_t length) const {
+        return processLevel(name, data, length, 0);
+    }
+
+    /**
+     * @brief Procesa en paralelo todos los archivos de un directorio (recursivo).
+     *
+     * @param directory Directorio con blobs.
+     * @param threads   Hilos (0 = núcleos disponibles).
+     * @return std::vector<BlobReport> Informes ordenados por confianza descendente.
+     * @throws std::runtime_error Si el directorio no existe.
+     */
+    std::vector<BlobReport>
+        processDirectory(const std::string& directory, unsigned threads = 0) const {
+        namespace fs = std::filesystem;
+        if (!fs::is_directory(directory)) {
+            throw std::runtime_error("No existe el directorio: " + directory);
+        }
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::recursive_directory_iterator(directory)) {
+            if (entry.is_regular_file()) files.push_back(entry.path());
+        }
+
+        std::vector<BlobReport> reports(files.size());
+        std::atomic<size_t> next{ 0 };
+        unsigned count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < count; ++t) {
+            workers.emplace_back([&] {
+                for (size_t i = next++; i < files.size(); i = next++) {
+                    std::string name = fs::relative(files[i], directory).generic_string();
+                    try {
+                        MappedFile file(files[i].string());
+                        reports[i] = process(name, file.data(), file.size());
+                    }
+                    catch (const std::exception& e) {
+                        reports[i].name = name;
+                        reports[i].breaker = e.what();
+                    }
+                }
+                });
+        }
+        for (auto& worker : workers) worker.join();
+
+        std::stable_sort(reports.begin(), reports.end(),
+            [](const BlobReport& a, const BlobReport& b) { return a.confidence > b.confidence; });
+        return reports;
+    }
+
+    /**
+     * @brief Escribe el informe como tabla.
+     */
+    static void
+        printReport(const std::vector<BlobReport>& reports, std::ostream& out) {
+        out << std::left << std::setw(4) << "#" << std::setw(22) << "Blob" << std::setw(26) << "Tipo"
+            << std::setw(7) << "Conf." << std::setw(8) << "Entr." << std::setw(8) << "IoC"
+            << std::setw(14) << "Clave" << "Vista previa\n";
+        for (size_t i = 0; i < reports.size(); ++i) {
+            const BlobReport& r = reports[i];
+            std::string preview = r.plaintext.substr(0, 40);
+            for (char& c : preview) {
+                if (static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) >= 0x7F) c = '.';
+            }
+            out << std::left << std::setw(4) << i + 1 << std::setw(22) << r.name.substr(0, 21)
+                << std::setw(26) << r.breaker.substr(0, 25)
+                << std::setw(7) << std::fixed << std::setprecision(2) << r.confidence
+                << std::setw(8) << std::setprecision(2) << r.features.entropy
+                << std::setw(8) << std::setprecision(3) << r.features.indexOfCoincidence
+                << std::setw(14) << r.key.substr(0, 13) << preview << "\n";
+        }
+        out << std::defaultfloat << std::right;
+    }
+
+private:
+    static constexpr int MAX_KEY_LENGTH = 16;
+
+    const NGramModel* m_model = nullptr;
+    std::chrono::milliseconds m_substitutionBudget{ 300 };
+
+    /**
+     * @brief Frecuencias de letras del español y del inglés (%).
+     */
+    static const double*
+        languageFrequencies(int language) {
+        static const double spanish[26] = {
+            12.53, 1.42, 4.68, 5.86, 13.68, 0.69, 1.01, 0.70, 6.25, 0.44, 0.02, 4.97, 3.15,
+            7.02, 8.68, 2.51, 0.88, 6.87, 7.98, 4.63, 3.93, 0.90, 0.01, 0.22, 0.90, 0.52 };
+        static const double english[26] = {
+            8.17, 1.49, 2.78, 4.25, 12.70, 2.23, 2.02, 6.09, 6.97, 0.15, 0.77, 4.03, 2.41,
+            6.75, 7.51, 1.93, 0.10, 5.99, 6.33, 9.06, 2.76, 0.98, 2.36, 0.15, 1.97, 0.07 };
+        return language == 0 ? spanish : english;
+    }
+
+    static double
+        indexOfCoincidence(const uint32_t* counts, size_t total) {
+        if (total < 2) return 0.0;
+        double sum = 0.0;
+        for (int i = 0; i < 26; ++i) sum += static_cast<double>(counts[i]) * (counts[i] - 1);
+        return sum / (static_cast<double>(total) * (total - 1));
+    }
+
+    /**
+     * @brief Mejor desplazamiento César según la similitud coseno con el idioma.
+     *
+     * @param counts Frecuencias de las 26 letras del texto cifrado.
+     * @param shift  Desplazamiento con mejor ajuste (salida).
+     * @return double Similitud coseno (≈0.9+ para texto del idioma, ≈0.75 para letras aleatorias).
+     */
+    static double
+        bestLanguageShift(const uint32_t* counts, int& shift) {
+        double best = -1.0;
+        for (int language = 0; language < 2; ++language) {
+            const double* expected = languageFrequencies(language);
+            for (int s = 0; s < 26; ++s) {
+                double dot = 0.0, a = 0.0, b = 0.0;
+                for (int i = 0; i < 26; ++i) {
+                    double observed = counts[(i + s) % 26];
+                    dot += observed * expected[i];
+                    a += observed * observed;
+                    b += expected[i] * expected[i];
+                }
+                double cosine = a > 0 ? dot / std::sqrt(a * b) : 0.0;
+                if (cosine > best) {
+                    best = cosine;
+                    shift = s;
+                }
+            }
+        }
+        return best;
+    }
+
+    BlobReport
+        processLevel(const std::string& name, const uint8_t* data, size_t length, int depth) const {
+        BlobReport report;
+        report.name = name;
+        report.features = analyze(data, length);
+        auto classification = classify(report.features);
+        report.kind = classification.first;
+        report.confidence = classification.second;
+        report.breaker = kindName(report.kind);
+        std::string text(reinterpret_cast<const char*>(data), length);
+
+        switch (report.kind) {
+        case BlobKind::Plaintext:
+            report.plaintext = text;
+            break;
+        case BlobKind::Caesar: {
+            CesarEncryption cesar;
+            int shift = 0;
+            bestLanguageShift(report.features.letters.data(), shift);
+            report.key = std::to_string(shift);
+            report.plaintext = cesar.encode(text, 26 - shift);
+            break;
+        }
+        case BlobKind::Vigenere:
+            breakVigenere(text, report);
+            break;
+        case BlobKind::RepeatingXor:
+            breakXor(data, length, report);
+            break;
+        case BlobKind::BinaryText: {
+            AsciiBinary ab;
+            report.plaintext = ab.binaryToString(text);
+            break;
+        }
+        case BlobKind::Hex:
+        case BlobKind::Base64: {
+            std::vector<uint8_t> decoded;
+            if (report.kind == BlobKind::Hex) {
+                XOREncoder xorEncoder;
+                std::string spaced;
+                for (size_t i = 0; i < text.size(); ++i) {
+                    if (std::isxdigit(static_cast<unsigned char>(text[i]))) {
+                        spaced += text[i];
+                        if (spaced.size() % 3 == 2) spaced += ' ';
+                    }
+                }
+                auto bytes = xorEncoder.HexToBytes(spaced);
+                decoded.assign(bytes.begin(), bytes.end());
+            }
+            else {
+                decoded = decodeBase64(text);
+            }
+            if (depth == 0) {
+                BlobReport inner = processLevel(name, decoded.data(), decoded.size(), 1);
+                report.breaker = std::string(kindName(report.kind)) + " > " + inner.breaker;
+                report.key = inner.key;
+                report.plaintext = inner.plaintext;
+                report.confidence *= inner.confidence;
+            }
+            else {
+                report.plaintext.assign(decoded.begin(), decoded.end());
+            }
+            break;
+        }
+        case BlobKind::Substitution:
+            if (m_model) {
+                // Un hilo por blob: processDirectory ya reparte los blobs entre núcleos.
+                SubstitutionSolver solver(*m_model);
+                SubstitutionSolver::Options options;
+                options.timeBudget = m_substitutionBudget;
+                options.threads = 1;
+                options.topK = 1;
+                auto results = solver.solve(text, options);
+                if (!results.empty()) {
+                    report.key = results[0].key;
+                    report.plaintext = results[0].plaintext;
+                }
+            }
+            break;
+        case BlobKind::HighEntropy:
+        case BlobKind::Empty:
+            break;
+        }
+        return report;
+    }
+
+    /**
+     * @brief Longitud de clave por índice de coincidencia de columnas y cada letra de la
+     *        clave por ajuste de frecuencias.
+     */
+    void
+        breakVigenere(const std::string& text, BlobReport& report) const {
+        std::vector<uint8_t> letters;
+        for (char c : text) {
+            if (std::isalpha(static_cast<unsigned char>(c))) {
+                letters.push_back(static_cast<uint8_t>(std::toupper(static_cast<unsigned char>(c)) - 'A'));
+            }
+        }
+        int bestLength = 1;
+        double bestIoc = 0.0;
+        for (int length = 1; length <= MAX_KEY_LENGTH && static_cast<size_t>(length) * 4 <= letters.size(); ++length) {
+            double ioc = 0.0;
+            for (int column = 0; column < length; ++column) {
+                uint32_t counts[26] = {};
+                size_t total = 0;
+                for (size_t i = column; i < letters.size(); i += length, ++total) ++counts[letters[i]];
+                ioc += indexOfCoincidence(counts, total);
+            }
+            ioc /= length;
+            // La primera longitud que parece idioma: sus múltiplos también lo parecen.
+            if (ioc >= 0.060) {
+                bestLength = length;
+                break;
+            }
+            if (ioc > bestIoc) {
+                bestIoc = ioc;
+                bestLength = length;
+            }
+        }
+
+        std::string key;
+        double fit = 0.0;
+        for (int column = 0; column < bestLength; ++column) {
+            uint32_t counts[26] = {};
+            for (size_t i = column; i < letters.size(); i += bestLength) ++counts[letters[i]];
+            int shift = 0;
+            fit += bestLanguageShift(counts, shift);
+            key += static_cast<char>('A' + shift);
+        }
+        if (m_model && letters.size() >= 4) {
+            refineVigenereKey(letters, key);
+        }
+        report.key = key;
+        report.plaintext = Vigenere(key).decode(text);
+        report.confidence = std::min(report.confidence, fit / bestLength);
+    }
+
+    /**
+     * @brief Con columnas cortas el ajuste de frecuencias falla alguna letra: se corrige
+     *        cada columna probando los 26 desplazamientos con la puntuación de cuadrigramas.
+     */
+    void
+        refineVigenereKey(const std::vector<uint8_t>& letters, std::string& key) const {
+        NGramScorer scorer(*m_model, 4);
+        const size_t period = key.size();
+        std::vector<uint8_t> plain(letters.size());
+        auto decrypt = [&] {
+            for (size_t i = 0; i < letters.size(); ++i) {
+                plain[i] = static_cast<uint8_t>((letters[i] + 26 - (key[i % period] - 'A')) % 26);
+            }
+            return scorer.scoreIndices(plain.data(), plain.size());
+        };
+        double best = decrypt();
+        for (int round = 0; round < 2; ++round) {
+            for (size_t column = 0; column < period; ++column) {
+                char original = key[column];
+                char chosen = original;
+                for (int shift = 0; shift < 26; ++shift) {
+                    key[column] = static_cast<char>('A' + shift);
+                    if (key[column] == original) continue;
+                    double score = decrypt();
+                    if (score > best) {
+                        best = score;
+                        chosen = key[column];
+                    }
+                }
+                key[column] = chosen;
+            }
+        }
+    }
+
+    /**
+     * @brief XOR de clave repetida: para cada longitud elige en cada columna el byte que
+     *        produce más letras y espacios, y se queda con la longitud más corta cercana al máximo.
+     */
+    static void
+        breakXor(const uint8_t* data, size_t length, BlobReport& report) {
+        static const std::array<uint8_t, 256> weight = [] {
+            std::array<uint8_t, 256> w{};
+            for (int c = 0; c < 256; ++c) {
+                if (std::isalpha(c)) w[c] = 3;
+                else if (c == ' ') w[c] = 4;
+                else if (c >= 0x20 && c < 0x7F) w[c] = 1;
+                else if (c == '\n') w[c] = 1;
+            }
+            return w;
+            }();
+
+        std::vector<std::string> keys;
+        std::vector<double> scores;
+        for (int keyLength = 1; keyLength <= MAX_KEY_LENGTH && static_cast<size_t>(keyLength) * 2 <= length; ++keyLength) {
+            std::string key;
+            double total = 0.0;
+            for (int column = 0; column < keyLength; ++column) {
+                uint32_t counts[256] = {};
+                for (size_t i = column; i < length; i += keyLength) ++counts[data[i]];
+                double bestColumn = -1.0;
+                int bestByte = 0;
+                for (int k = 0; k < 256; ++k) {
+                    double s = 0.0;
+                    for (int c = 0; c < 256; ++c) {
+                        if (counts[c]) s += counts[c] * static_cast<double>(weight[c ^ k]);
+                    }
+                    if (s > bestColumn) {
+                        bestColumn = s;
+                        bestByte = k;
+                    }
+                }
+                total += bestColumn;
+                key += static_cast<char>(bestByte);
+            }
+            keys.push_back(key);
+            scores.push_back(total / length);
+        }
+        if (keys.empty()) return;
+
+        double best = *std::max_element(scores.begin(), scores.end());
+        size_t chosen = 0;
+        while (scores[chosen] < 0.97 * best) ++chosen;
+        XOREncoder xorEncoder;
+        report.key = keys[chosen];
+        report.plaintext = xorEncoder.encode(std::string(reinterpret_cast<const char*>(data), length), report.key);
+        report.confidence = std::min(report.confidence, best / 3.2);
+    }
+
+    static std::vector<uint8_t>
+        decodeBase64(const std::string& text) {
+        static const std::array<int8_t, 256> table = [] {
+            std::array<int8_t, 256> t{};
+            t.fill(-1);
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 64; ++i) t[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+            return t;
+            }();
+        std::vector<uint8_t> out;
+        uint32_t buffer = 0;
+        int bits = 0;
+        for (char c : text) {
+            int8_t v = table[static_cast<uint8_t>(c)];
+            if (v < 0) continue;
+            buffer = (buffer << 6) | static_cast<uint32_t>(v);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                out.push_back(static_cast<uint8_t>(buffer >> bits));
+            }
+        }
+        return out;
+    }
+};
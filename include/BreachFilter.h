@@ -0,0 +1,399 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include "EncryptedContainer.h"
+#include "MappedFile.h"
+#include "SHA1.h"
+
+/**
+ * @class BreachFilter
+ * @brief Filtro de Bloom por bloques, proyectado en memoria, con las contraseñas de una
+ *        lista de filtraciones.
+ *
+ * Cada contraseña se identifica por su SHA-1 (el formato en que se publican estas listas).
+ * Los 4 primeros bytes del resumen eligen un bloque de 32 bytes (8 palabras de 32 bits) y
+ * los 4 siguientes, multiplicados por 8 constantes, eligen un bit en cada palabra: una
+ * consulta toca una sola línea de caché y con AVX2 se comprueban las 8 palabras con una
+ * multiplicación, un desplazamiento variable y un vptest.
+ *
+ * No hay falsos negativos; la tasa de falsos positivos depende de los bits por entrada
+ * (≈0.1 % con 16) y se puede consultar con falsePositiveRate().
+ */
+class BreachFilter {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t BLOCK_WORDS = 8;
+    static constexpr size_t BLOCK_SIZE = BLOCK_WORDS * sizeof(uint32_t);
+
+    BreachFilter() = default;
+
+    /**
+     * @brief Abre un filtro compilado con BreachFilterBuilder.
+     *
+     * @throws std::runtime_error Si el archivo no existe o no es un filtro válido.
+     */
+    explicit BreachFilter(const std::string& path) {
+        load(path);
+    }
+
+    ~BreachFilter() = default;
+
+    /**
+     * @brief Proyecta el archivo del filtro.
+     */
+    void
+        load(const std::string& path) {
+        m_file.open(path);
+        const uint8_t* base = m_file.data();
+        if (m_file.size() < HEADER_SIZE
+            || std::memcmp(base, "TTCBLOOM", 8) != 0
+            || EncryptedContainer::get32(base + 8) != VERSION) {
+            m_file.close();
+            throw std::runtime_error("El archivo no es un filtro de contrasenas valido: " + path);
+        }
+        m_blocks = EncryptedContainer::get64(base + 16);
+        m_entries = EncryptedContainer::get64(base + 24);
+        // Se acota m_blocks antes de multiplicar: un valor enorme desbordaría el producto
+        if (m_blocks == 0 || m_blocks > (1ULL << 32)
+            || m_blocks > (m_file.size() - HEADER_SIZE) / BLOCK_SIZE
+            || m_file.size() != HEADER_SIZE + m_blocks * BLOCK_SIZE) {
+            m_file.close();
+            throw std::runtime_error("El filtro de contrasenas esta truncado: " + path);
+        }
+        m_words = reinterpret_cast<const uint32_t*>(base + HEADER_SIZE);
+    }
+
+    bool
+        isLoaded() const {
+        return m_words != nullptr;
+    }
+
+    /**
+     * @brief Indica si la contraseña está (probablemente) en la lista.
+     */
+    bool
+        contains(const std::string& password) const {
+        uint8_t digest[SHA1::DIGEST_SIZE];
+        SHA1::hash(reinterpret_cast<const uint8_t*>(password.data()), password.size(), digest);
+        return containsSha1(digest);
+    }
+
+    /**
+     * @brief Consulta por el SHA-1 de la contraseña.
+     */
+    bool
+        containsSha1(const uint8_t* digest) const {
+        if (!m_words) return false;
+        uint32_t high = readHigh(digest);
+        uint32_t low = readLow(digest);
+        return probe(m_words + blockIndex(high, m_blocks) * BLOCK_WORDS, low);
+    }
+
+    /**
+     * @brief Consulta un lote: calcula primero todos los resúmenes y adelanta la carga de
+     *        sus bloques, de modo que los fallos de caché de un filtro grande se solapan.
+     *
+     * @param passwords Contraseñas.
+     * @param count     Número de contraseñas.
+     * @param results   Destino: results[i] = contains(passwords[i]).
+     */
+    void
+        containsBatch(const std::string* passwords, size_t count, bool* results) const {
+        constexpr size_t BATCH = 16;
+        uint8_t digests[BATCH][SHA1::DIGEST_SIZE];
+        for (size_t start = 0; start < count; start += BATCH) {
+            size_t n = std::min(BATCH, count - start);
+            for (size_t i = 0; i < n; ++i) {
+                const std::string& p = passwords[start + i];
+                SHA1::hash(reinterpret_cast<const uint8_t*>(p.data()), p.size(), digests[i]);
+                if (m_words) {
+                    prefetch(m_words + blockIndex(readHigh(digests[i]), m_blocks) * BLOCK_WORDS);
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                results[start + i] = containsSha1(digests[i]);
+            }
+        }
+    }
+
+    uint64_t
+        entryCount() const {
+        return m_entries;
+    }
+
+    uint64_t
+        blockCount() const {
+        return m_blocks;
+    }
+
+    /**
+     * @brief Tasa de falsos positivos esperada con las entradas y el tamaño del filtro.
+     */
+    double
+        falsePositiveRate() const {
+        return estimateFalsePositiveRate(m_entries, m_blocks);
+    }
+
+    /**
+     * @brief Tasa de falsos positivos de un filtro de bloques de 8 palabras.
+     *
+     * La carga de cada bloque sigue una Poisson de media entries / blocks; con j entradas
+     * en el bloque, cada palabra tiene un bit concreto puesto con probabilidad
+     * 1 - (31/32)^j y una consulta falla si acierta en las 8 palabras.
+     */
+    static double
+        estimateFalsePositiveRate(uint64_t entries, uint64_t blocks) {
+        if (blocks == 0) return 1.0;
+        double lambda = static_cast<double>(entries) / blocks;
+        if (lambda == 0.0) return 0.0;
+        double rate = 0.0;
+        size_t limit = static_cast<size_t>(lambda + 12.0 * std::sqrt(lambda) + 32.0);
+        for (size_t j = 0; j <= limit; ++j) {
+            double logPmf = j * std::log(lambda) - lambda - std::lgamma(static_cast<double>(j) + 1.0);
+            double word = 1.0 - std::pow(31.0 / 32.0, static_cast<double>(j));
+            rate += std::exp(logPmf) * std::pow(word, static_cast<double>(BLOCK_WORDS));
+        }
+        return rate;
+    }
+
+    /**
+     * @brief Bloque que corresponde a la parte alta del resumen (reducción por multiplicación).
+     */
+    static uint64_t
+        blockIndex(uint32_t high, uint64_t blocks) {
+        return (static_cast<uint64_t>(high) * blocks) >> 32;
+    }
+
+    static uint32_t
+        readHigh(const uint8_t* digest) {
+        return (static_cast<uint32_t>(digest[0]) << 24) | (static_cast<uint32_t>(digest[1]) << 16)
+            | (static_cast<uint32_t>(digest[2]) << 8) | digest[3];
+    }
+
+    static uint32_t
+        readLow(const uint8_t* digest) {
+        return (static_cast<uint32_t>(digest[4]) << 24) | (static_cast<uint32_t>(digest[5]) << 16)
+            | (static_cast<uint32_t>(digest[6]) << 8) | digest[7];
+    }
+
+    /**
+     * @brief Bit de cada palabra del bloque para la parte baja del resumen.
+     */
+    static uint32_t
+        wordMask(uint32_t low, size_t word) {
+        static const uint32_t salts[BLOCK_WORDS] = {
+            0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31 };
+        return 1u << ((low * salts[word]) >> 27);
+    }
+
+private:
+    MappedFile m_file;
+    const uint32_t* m_words = nullptr;
+    uint64_t m_blocks = 0;
+    uint64_t m_entries = 0;
+
+    static bool
+        probe(const uint32_t* block, uint32_t low) {
+#if TTC_X86
+        static const bool useAvx2 = CpuFeatures::get().avx2;
+        if (useAvx2) return probeAvx2(block, low);
+#endif
+        for (size_t w = 0; w < BLOCK_WORDS; ++w) {
+            uint32_t mask = wordMask(low, w);
+            if ((block[w] & mask) != mask) return false;
+        }
+        return true;
+    }
+
+    static void
+        prefetch(const uint32_t* block) {
+#if TTC_X86
+        _mm_prefetch(reinterpret_cast<const char*>(block), _MM_HINT_T0);
+#else
+        (void)block;
+#endif
+    }
+
+#if TTC_X86
+    TTC_TARGET("avx2")
+        static bool
+        probeAvx2(const uint32_t* block, uint32_t low) {
+        const __m256i salts = _mm256_setr_epi32(
+            0x47b6137b, 0x44974d91, static_cast<int>(0x8824ad5b), static_cast<int>(0xa2b7289d),
+            0x705495c7, 0x2df1424b, static_cast<int>(0x9efc4947), 0x5c6bfb31);
+        __m256i hashes = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(low)), salts);
+        __m256i masks = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(hashes, 27));
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        return _mm256_testc_si256(words, masks) != 0;
+    }
+#endif
+};
+
+/**
+ * @class BreachFilterBuilder
+ * @brief Compila un BreachFilter a partir de listas de contraseñas filtradas.
+ *
+ * Acepta contraseñas en claro o resúmenes SHA-1 en hexadecimal (uno por línea, con un
+ * ":recuento" opcional detrás, como en las listas públicas de filtraciones).
+ */
+class BreachFilterBuilder {
+public:
+    /**
+     * @brief Formato de las líneas de addFile.
+     */
+    enum class Format {
+        Auto,       ///< SHA-1 si la línea empieza por 40 dígitos hex, si no, texto en claro.
+        Plaintext,  ///< Una contraseña por línea.
+        Sha1Hex     ///< Un SHA-1 en hexadecimal por línea.
+    };
+
+    /**
+     * @param expectedEntries Entradas previstas (dimensiona el filtro).
+     * @param bitsPerEntry    Bits por entrada (16 ≈ 0.1 % de falsos positivos, 12 ≈ 0.5 %).
+     * @throws std::invalid_argument Si el tamaño resultante no es válido.
+     */
+    explicit BreachFilterBuilder(uint64_t expectedEntries, double bitsPerEntry = 16.0) {
+        if (expectedEntries == 0 || bitsPerEntry < 1.0) {
+            throw std::invalid_argument("El filtro necesita al menos una entrada y un bit por entrada.");
+        }
+        double bits = static_cast<double>(expectedEntries) * bitsPerEntry;
+        m_blocks = static_cast<uint64_t>(std::ceil(bits / (BreachFilter::BLOCK_SIZE * 8)));
+        if (m_blocks > (1ULL << 32)) {
+            throw std::invalid_argument("El filtro de contrasenas no puede superar 2^32 bloques.");
+        }
+        m_words.assign(m_blocks * BreachFilter::BLOCK_WORDS, 0);
+    }
+
+    /**
+     * @brief Añade una contraseña en claro.
+     */
+    void
+        addPassword(const std::string& password) {
+        uint8_t digest[SHA1::DIGEST_SIZE];
+        SHA1::hash(reinterpret_cast<const uint8_t*>(password.data()), password.size(), digest);
+        addSha1(digest);
+    }
+
+    /**
+     * @brief Añade un resumen SHA-1 de 20 bytes.
+     */
+    void
+        addSha1(const uint8_t* digest) {
+        uint32_t* block = m_words.data()
+            + BreachFilter::blockIndex(BreachFilter::readHigh(digest), m_blocks) * BreachFilter::BLOCK_WORDS;
+        uint32_t low = BreachFilter::readLow(digest);
+        for (size_t w = 0; w < BreachFilter::BLOCK_WORDS; ++w) {
+            block[w] |= BreachFilter::wordMask(low, w);
+        }
+        ++m_entries;
+    }
+
+    /**
+     * @brief Añade una línea de una lista.
+     *
+     * @return true si se añadió; false si la línea está vacía o no tiene el formato pedido.
+     */
+    bool
+        addLine(const std::string& line, Format format = Format::Auto) {
+        size_t length = line.size();
+        if (length > 0 && line[length - 1] == '\r') --length;
+        if (length == 0) return false;
+
+        uint8_t digest[SHA1::DIGEST_SIZE];
+        bool isHash = length >= 40 && (length == 40 || line[40] == ':') && parseSha1Hex(line.data(), digest);
+        if (format == Format::Sha1Hex || (format == Format::Auto && isHash)) {
+            if (!isHash) return false;
+            addSha1(digest);
+        }
+        else {
+            addPassword(line.substr(0, length));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Añade todas las líneas de un archivo.
+     *
+     * @return uint64_t Líneas añadidas.
+     * @throws std::runtime_error Si el archivo no se puede abrir.
+     */
+    uint64_t
+        addFile(const std::string& path, Format format = Format::Auto) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("No se pudo abrir la lista de contrasenas: " + path);
+        }
+        uint64_t added = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            added += addLine(line, format);
+        }
+        return added;
+    }
+
+    uint64_t
+        entryCount() const {
+        return m_entries;
+    }
+
+    /**
+     * @brief Tasa de falsos positivos esperada con las entradas añadidas hasta ahora.
+     */
+    double
+        falsePositiveRate() const {
+        return BreachFilter::estimateFalsePositiveRate(m_entries, m_blocks);
+    }
+
+    /**
+     * @brief Escribe el filtro compilado.
+     *
+     * @throws std::runtime_error Si el archivo no se puede crear.
+     */
+    void
+        write(const std::string& path) const {
+        uint8_t header[BreachFilter::HEADER_SIZE] = {};
+        std::memcpy(header, "TTCBLOOM", 8);
+        EncryptedContainer::put32(header + 8, BreachFilter::VERSION);
+        EncryptedContainer::put64(header + 16, m_blocks);
+        EncryptedContainer::put64(header + 24, m_entries);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        std::vector<uint8_t> chunk;
+        const size_t CHUNK_WORDS = 64 * 1024;
+        for (size_t start = 0; start < m_words.size(); start += CHUNK_WORDS) {
+            size_t n = std::min(CHUNK_WORDS, m_words.size() - start);
+            chunk.resize(n * 4);
+            for (size_t i = 0; i < n; ++i) EncryptedContainer::put32(chunk.data() + 4 * i, m_words[start + i]);
+            out.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+        }
+        if (!out) {
+            throw std::runtime_error("No se pudo escribir el filtro de contrasenas: " + path);
+        }
+    }
+
+private:
+    std::vector<uint32_t> m_words;
+    uint64_t m_blocks = 0;
+    uint64_t m_entries = 0;
+
+    static bool
+        parseSha1Hex(const char* text, uint8_t* digest) {
+        for (size_t i = 0; i < SHA1::DIGEST_SIZE; ++i) {
+            int high = hexValue(text[2 * i]);
+            int low = hexValue(text[2 * i + 1]);
+            if (high < 0 || low < 0) return false;
+            digest[i] = static_cast<uint8_t>((high << 4) | low);
+        }
+        return true;
+    }
+
+    static int
+        hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+};
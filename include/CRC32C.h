@@ -0,0 +1,114 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+
+/**
+ * @class CRC32C
+ * @brief Suma de verificación CRC-32C (Castagnoli).
+ *
+ * Usa la instrucción crc32 de SSE4.2 cuando está disponible y una tabla
+ * slicing-by-8 en caso contrario. No es una protección criptográfica: sirve para
+ * detectar corrupción accidental de datos.
+ */
+class CRC32C {
+public:
+    CRC32C() = default;
+    ~CRC32C() = default;
+
+    /**
+     * @brief Calcula el CRC-32C de un buffer.
+     *
+     * @param data   Datos.
+     * @param length Longitud en bytes.
+     * @param crc    CRC previo para continuar un cálculo (0 al empezar).
+     * @return uint32_t CRC resultante.
+     */
+    static uint32_t
+        compute(const uint8_t* data, size_t length, uint32_t crc = 0) {
+#if TTC_X86
+        static const bool useHardware = CpuFeatures::get().sse42;
+        if (useHardware) {
+            return computeHardware(data, length, crc);
+        }
+#endif
+        return computeTable(data, length, crc);
+    }
+
+private:
+    struct Table {
+        uint32_t values[8][256];
+    };
+
+    static const Table&
+        table() {
+        static const Table t = buildTable();
+        return t;
+    }
+
+    static Table
+        buildTable() {
+        Table t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            }
+            t.values[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int s = 1; s < 8; ++s) {
+                uint32_t prev = t.values[s - 1][i];
+                t.values[s][i] = (prev >> 8) ^ t.values[0][prev & 0xFF];
+            }
+        }
+        return t;
+    }
+
+    static uint32_t
+        computeTable(const uint8_t* data, size_t length, uint32_t crc) {
+        const auto& t = table().values;
+        crc = ~crc;
+        while (length >= 8) {
+            uint32_t lo = crc ^ (static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+                | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24));
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+            data += 8;
+            length -= 8;
+        }
+        while (length--) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+        }
+        return ~crc;
+    }
+
+#if TTC_X86
+    TTC_TARGET("sse4.2")
+        static uint32_t
+        computeHardware(const uint8_t* data, size_t length, uint32_t crc) {
+        crc = ~crc;
+#if defined(__x86_64__) || defined(_M_X64)
+        uint64_t c = crc;
+        while (length >= 8) {
+            uint64_t v;
+            std::memcpy(&v, data, 8);
+            c = _mm_crc32_u64(c, v);
+            data += 8;
+            length -= 8;
+        }
+        crc = static_cast<uint32_t>(c);
+#endif
+        while (length >= 4) {
+            uint32_t v;
+            std::memcpy(&v, data, 4);
+            crc = _mm_crc32_u32(crc, v);
+            data += 4;
+            length -= 4;
+        }
+        while (length--) {
+            crc = _mm_crc32_u8(crc, *data++);
+        }
+        return ~crc;
+    }
+#endif
+};
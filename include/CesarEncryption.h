@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "ResultSink.h"
 
 /**
  * @class CesarEncryption
@@ -75,10 +76,28 @@ public:
      */
     void bruteForceAttack(const std::string& texto) {
         std::cout << "\nIntentos de descifrado por fuerza bruta:\n";
+        std::string lineas;
+        for (int clave = 0; clave < 26; clave++) {
+            lineas += "Clave " + std::to_string(clave) + ": " + encode(texto, 26 - clave) + "\n";
+        }
+        std::cout << lineas;
+    }
+
+    /**
+     * @brief Fuerza bruta que entrega los 26 descifrados a @p sink.
+     *
+     * La puntuacin es la misma medida lxica que usa evaluatePossibleKey (palabras
+     * comunes del espaol encontradas), as que un TopKSink de 1 da la clave sugerida.
+     *
+     * @param texto Texto cifrado a analizar.
+     * @param sink  Destino de los candidatos.
+     */
+    void bruteForceAttack(const std::string& texto, ResultSink& sink) {
         for (int clave = 0; clave < 26; clave++) {
             std::string intento = encode(texto, 26 - clave);
-            std::cout << "Clave " << clave << ": " << intento << std::endl;
+            sink.push("cesar", std::to_string(clave), intento, lexicalScore(intento));
         }
+        sink.flush();
     }
 
     /**
@@ -117,18 +136,8 @@ public:
 
         for (char letraRef : letrasEsp) {
             int clave = (indiceMax - (letraRef - 'a') + 26) % 26;
-            int puntaje = 0;
-
             std::string descifrado = encode(texto, 26 - clave);
-
-            std::string comunes[] = { "el", "de", "la", "que", "en",
-                                      "y", "los", "se" };
-
-            for (std::string palabra : comunes) {
-                if (descifrado.find(palabra) != std::string::npos) {
-                    puntaje++;
-                }
-            }
+            int puntaje = lexicalScore(descifrado);
 
             if (puntaje > mejorPuntaje) {
                 mejorPuntaje = puntaje;
@@ -141,4 +150,19 @@ public:
 
 private:
     // No se han declarado atributos privados en esta clase.
+
+    /**
+     * @brief Cuenta cuntas palabras comunes del espaol aparecen en el texto.
+     */
+    static int lexicalScore(const std::string& descifrado) {
+        static const char* comunes[] = { "el", "de", "la", "que", "en",
+                                         "y", "los", "se" };
+        int puntaje = 0;
+        for (const char* palabra : comunes) {
+            if (descifrado.find(palabra) != std::string::npos) {
+                puntaje++;
+            }
+        }
+        return puntaje;
+    }
 };
@@ -0,0 +1,399 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Vigenere.h"
+
+/**
+ * @file CipherPipeline.h
+ * @brief Cadena de cifrados por byte (César → Vigenère → XOR...) fusionada en una sola pasada.
+ *
+ * Encadenar CesarEncryption::encode, Vigenere::encode y XOREncoder::encode recorre la
+ * memoria tres veces y crea tres std::string intermedios. CipherPipeline aplica todas las
+ * etapas sobre un bloque de BLOCK_SIZE bytes (que cabe en caché L1) antes de pasar al
+ * siguiente, así que N etapas cuestan aproximadamente una pasada de memoria.
+ *
+ * Ejemplo:
+ * @code
+ *   auto pipeline = makePipeline(CaesarStage(3), VigenereStage("clave"), XorStage("k"));
+ *   std::string cifrado = pipeline.encode(texto);
+ *   std::string original = pipeline.decode(cifrado);      // etapas en orden inverso
+ *   auto inversa = pipeline.inverse();                     // XOR⁻¹ → Vigenère⁻¹ → César⁻¹
+ * @endcode
+ */
+
+/**
+ * @class CipherStage
+ * @brief Base CRTP de una etapa: la clase derivada define encodeByte/decodeByte.
+ *
+ * Las implementaciones por bloque llaman directamente a la clase derivada, de modo que el
+ * compilador puede integrar (inline) la etapa completa en el bucle. Una etapa puede
+ * redefinir encodeBlock/decodeBlock si tiene una versión más rápida.
+ */
+template <class Derived>
+class CipherStage {
+public:
+    /**
+     * @brief Cifra un bloque en el lugar.
+     */
+    void
+        encodeBlock(uint8_t* data, size_t length) {
+        Derived& self = static_cast<Derived&>(*this);
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = self.encodeByte(data[i]);
+        }
+    }
+
+    /**
+     * @brief Descifra un bloque en el lugar.
+     */
+    void
+        decodeBlock(uint8_t* data, size_t length) {
+        Derived& self = static_cast<Derived&>(*this);
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = self.decodeByte(data[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia el estado de la etapa (posición en la clave). Sin estado por defecto.
+     */
+    void
+        reset() {
+    }
+};
+
+/**
+ * @class CaesarStage
+ * @brief Etapa César: mismas reglas que CesarEncryption::encode (letras mód 26, dígitos mód 10).
+ *
+ * La decodificación es la inversa exacta, también para dígitos.
+ */
+class CaesarStage : public CipherStage<CaesarStage> {
+public:
+    explicit CaesarStage(int desplazamiento) {
+        int letras = ((desplazamiento % 26) + 26) % 26;
+        int digitos = ((desplazamiento % 10) + 10) % 10;
+        for (int c = 0; c < 256; ++c) {
+            m_encode[c] = static_cast<uint8_t>(c);
+            m_decode[c] = static_cast<uint8_t>(c);
+        }
+        for (int i = 0; i < 26; ++i) {
+            m_encode['A' + i] = static_cast<uint8_t>('A' + (i + letras) % 26);
+            m_encode['a' + i] = static_cast<uint8_t>('a' + (i + letras) % 26);
+            m_decode['A' + i] = static_cast<uint8_t>('A' + (i + 26 - letras) % 26);
+            m_decode['a' + i] = static_cast<uint8_t>('a' + (i + 26 - letras) % 26);
+        }
+        for (int i = 0; i < 10; ++i) {
+            m_encode['0' + i] = static_cast<uint8_t>('0' + (i + digitos) % 10);
+            m_decode['0' + i] = static_cast<uint8_t>('0' + (i + 10 - digitos) % 10);
+        }
+    }
+
+    uint8_t
+        encodeByte(uint8_t c) const {
+        return m_encode[c];
+    }
+
+    uint8_t
+        decodeByte(uint8_t c) const {
+        return m_decode[c];
+    }
+
+private:
+    std::array<uint8_t, 256> m_encode{};
+    std::array<uint8_t, 256> m_decode{};
+};
+
+/**
+ * @class VigenereStage
+ * @brief Etapa Vigenère: equivalente a Vigenere::encode/decode (sólo avanza la clave en letras).
+ */
+class VigenereStage : public CipherStage<VigenereStage> {
+public:
+    explicit VigenereStage(const std::string& key) : m_key(Vigenere::normalizeKey(key)) {
+        if (m_key.empty()) {
+            throw std::invalid_argument("La clave no puede estar vacia o sin letras.");
+        }
+    }
+
+    uint8_t
+        encodeByte(uint8_t c) {
+        uint8_t base;
+        if (!letterBase(c, base)) {
+            return c;
+        }
+        int shift = m_key[m_index] - 'A';
+        if (++m_index == m_key.size()) m_index = 0;
+        return static_cast<uint8_t>((c - base + shift) % 26 + base);
+    }
+
+    uint8_t
+        decodeByte(uint8_t c) {
+        uint8_t base;
+        if (!letterBase(c, base)) {
+            return c;
+        }
+        int shift = m_key[m_index] - 'A';
+        if (++m_index == m_key.size()) m_index = 0;
+        return static_cast<uint8_t>((c - base - shift + 26) % 26 + base);
+    }
+
+    void
+        reset() {
+        m_index = 0;
+    }
+
+private:
+    std::string m_key;
+    size_t m_index = 0;
+
+    static bool
+        letterBase(uint8_t c, uint8_t& base) {
+        if (c >= 'A' && c <= 'Z') {
+            base = 'A';
+            return true;
+        }
+        if (c >= 'a' && c <= 'z') {
+            base = 'a';
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @class XorStage
+ * @brief Etapa XOR con clave repetida (equivalente a XOREncoder::encode).
+ *
+ * Guarda la clave repetida hasta cubrir un bloque completo, de forma que el bucle de
+ * bloque es un XOR entre dos arreglos contiguos que el compilador vectoriza.
+ */
+class XorStage : public CipherStage<XorStage> {
+public:
+    explicit XorStage(const std::string& key) : m_keyLength(key.size()) {
+        if (key.empty()) {
+            throw std::invalid_argument("La clave XOR no puede estar vacia.");
+        }
+        m_repeated.resize(m_keyLength + REPEAT_SPAN);
+        for (size_t i = 0; i < m_repeated.size(); ++i) {
+            m_repeated[i] = static_cast<uint8_t>(key[i % m_keyLength]);
+        }
+    }
+
+    uint8_t
+        encodeByte(uint8_t c) {
+        uint8_t r = static_cast<uint8_t>(c ^ m_repeated[m_index]);
+        if (++m_index == m_keyLength) m_index = 0;
+        return r;
+    }
+
+    uint8_t
+        decodeByte(uint8_t c) {
+        return encodeByte(c);
+    }
+
+    void
+        encodeBlock(uint8_t* data, size_t length) {
+        while (length > 0) {
+            size_t n = length < REPEAT_SPAN ? length : REPEAT_SPAN;
+            const uint8_t* key = m_repeated.data() + m_index;
+            for (size_t i = 0; i < n; ++i) {
+                data[i] ^= key[i];
+            }
+            m_index = (m_index + n) % m_keyLength;
+            data += n;
+            length -= n;
+        }
+    }
+
+    void
+        decodeBlock(uint8_t* data, size_t length) {
+        encodeBlock(data, length);
+    }
+
+    void
+        reset() {
+        m_index = 0;
+    }
+
+private:
+    static constexpr size_t REPEAT_SPAN = 4096;
+
+    std::vector<uint8_t> m_repeated;
+    size_t m_keyLength;
+    size_t m_index = 0;
+};
+
+/**
+ * @class InverseStage
+ * @brief Adaptador que intercambia cifrado y descifrado de una etapa.
+ */
+template <class Stage>
+class InverseStage : public CipherStage<InverseStage<Stage>> {
+public:
+    explicit InverseStage(Stage stage) : m_stage(std::move(stage)) {
+    }
+
+    uint8_t
+        encodeByte(uint8_t c) {
+        return m_stage.decodeByte(c);
+    }
+
+    uint8_t
+        decodeByte(uint8_t c) {
+        return m_stage.encodeByte(c);
+    }
+
+    void
+        encodeBlock(uint8_t* data, size_t length) {
+        m_stage.decodeBlock(data, length);
+    }
+
+    void
+        decodeBlock(uint8_t* data, size_t length) {
+        m_stage.encodeBlock(data, length);
+    }
+
+    void
+        reset() {
+        m_stage.reset();
+    }
+
+    /**
+     * @brief Etapa original (la inversa de la inversa).
+     */
+    const Stage&
+        stage() const {
+        return m_stage;
+    }
+
+private:
+    Stage m_stage;
+};
+
+/**
+ * @class CipherPipeline
+ * @brief Aplica una secuencia fija de etapas en una sola pasada por bloques.
+ *
+ * @tparam Stages Tipos de etapa (derivados de CipherStage). El orden de cifrado es el de
+ *                los parámetros; el descifrado los recorre al revés.
+ */
+template <class... Stages>
+class CipherPipeline {
+public:
+    /**
+     * @brief Bytes procesados por todas las etapas antes de avanzar (cabe en caché L1).
+     */
+    static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+    static constexpr size_t STAGE_COUNT = sizeof...(Stages);
+
+    explicit CipherPipeline(Stages... stages) : m_stages(std::move(stages)...) {
+    }
+
+    /**
+     * @brief Cifra un texto completo (reinicia el estado de las etapas).
+     */
+    std::string
+        encode(const std::string& input) {
+        reset();
+        std::string output(input.size(), '\0');
+        encode(reinterpret_cast<const uint8_t*>(input.data()), reinterpret_cast<uint8_t*>(&output[0]), input.size());
+        return output;
+    }
+
+    /**
+     * @brief Descifra un texto completo (reinicia el estado de las etapas).
+     */
+    std::string
+        decode(const std::string& input) {
+        reset();
+        std::string output(input.size(), '\0');
+        decode(reinterpret_cast<const uint8_t*>(input.data()), reinterpret_cast<uint8_t*>(&output[0]), input.size());
+        return output;
+    }
+
+    /**
+     * @brief Cifra un buffer continuando el estado actual (útil para flujos).
+     *
+     * @param input  Datos de entrada.
+     * @param output Destino; puede coincidir con input para cifrar en el lugar.
+     * @param length Longitud en bytes.
+     */
+    void
+        encode(const uint8_t* input, uint8_t* output, size_t length) {
+        run(input, output, length, [this](uint8_t* block, size_t n) {
+            encodeStages(block, n, std::index_sequence_for<Stages...>{});
+            });
+    }
+
+    /**
+     * @brief Descifra un buffer continuando el estado actual.
+     */
+    void
+        decode(const uint8_t* input, uint8_t* output, size_t length) {
+        run(input, output, length, [this](uint8_t* block, size_t n) {
+            decodeStages(block, n, std::index_sequence_for<Stages...>{});
+            });
+    }
+
+    /**
+     * @brief Reinicia todas las etapas (posiciones de clave a cero).
+     */
+    void
+        reset() {
+        std::apply([](auto&... stage) { (stage.reset(), ...); }, m_stages);
+    }
+
+    /**
+     * @brief Genera la canalización inversa: etapas invertidas y en orden contrario.
+     *
+     * inverse().encode(x) equivale a decode(x).
+     */
+    auto
+        inverse() const {
+        return inverseImpl(std::index_sequence_for<Stages...>{});
+    }
+
+private:
+    std::tuple<Stages...> m_stages;
+
+    template <class Kernel>
+    void
+        run(const uint8_t* input, uint8_t* output, size_t length, Kernel kernel) {
+        for (size_t offset = 0; offset < length; offset += BLOCK_SIZE) {
+            size_t n = length - offset < BLOCK_SIZE ? length - offset : BLOCK_SIZE;
+            if (output != input) {
+                std::memcpy(output + offset, input + offset, n);
+            }
+            kernel(output + offset, n);
+        }
+    }
+
+    template <size_t... I>
+    void
+        encodeStages(uint8_t* block, size_t n, std::index_sequence<I...>) {
+        (std::get<I>(m_stages).encodeBlock(block, n), ...);
+    }
+
+    template <size_t... I>
+    void
+        decodeStages(uint8_t* block, size_t n, std::index_sequence<I...>) {
+        (std::get<STAGE_COUNT - 1 - I>(m_stages).decodeBlock(block, n), ...);
+    }
+
+    template <size_t... I>
+    auto
+        inverseImpl(std::index_sequence<I...>) const {
+        return CipherPipeline<InverseStage<std::tuple_element_t<STAGE_COUNT - 1 - I, std::tuple<Stages...>>>...>(
+            InverseStage<std::tuple_element_t<STAGE_COUNT - 1 - I, std::tuple<Stages...>>>(std::get<STAGE_COUNT - 1 - I>(m_stages))...);
+    }
+};
+
+/**
+ * @brief Construye una canalización deduciendo los tipos de etapa.
+ */
+template <class... Stages>
+CipherPipeline<Stages...>
+makePipeline(Stages... stages) {
+    return CipherPipeline<Stages...>(std::move(stages)...);
+}
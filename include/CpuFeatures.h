@@ -0,0 +1,106 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TTC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define TTC_X86 0
+#endif
+
+/**
+ * @def TTC_TARGET
+ * @brief Habilita un conjunto de instrucciones sólo para la función marcada.
+ *
+ * MSVC permite usar intrínsecos sin banderas extra; GCC y Clang necesitan el atributo
+ * target para compilar la ruta rápida sin exigir esas instrucciones al resto del programa.
+ */
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TTC_TARGET(features)
+#else
+#define TTC_TARGET(features) __attribute__((target(features)))
+#endif
+
+/**
+ * @class CpuFeatures
+ * @brief Detecta en tiempo de ejecución las extensiones de CPU disponibles (CPUID).
+ *
+ * La detección se realiza una sola vez; las clases de cifrado consultan get()
+ * para elegir entre la ruta acelerada por hardware y la implementación portable.
+ */
+class CpuFeatures {
+public:
+    bool sse41 = false;   ///< SSE4.1
+    bool sse42 = false;   ///< SSE4.2 (CRC32C)
+    bool aesni = false;   ///< Instrucciones AES-NI
+    bool pclmul = false;  ///< Multiplicación sin acarreo (GHASH)
+    bool avx2 = false;    ///< AVX2
+    bool shani = false;   ///< Extensiones SHA
+
+    /**
+     * @brief Devuelve las capacidades de la CPU actual (detectadas una vez).
+     */
+    static const CpuFeatures&
+        get() {
+        static const CpuFeatures features = detect();
+        return features;
+    }
+
+private:
+    static CpuFeatures
+        detect() {
+        CpuFeatures f;
+#if TTC_X86
+        unsigned int regs0[4] = { 0, 0, 0, 0 };
+        unsigned int regs1[4] = { 0, 0, 0, 0 };
+        unsigned int regs7[4] = { 0, 0, 0, 0 };
+        cpuid(0, 0, regs0);
+        if (regs0[0] >= 1) cpuid(1, 0, regs1);
+        if (regs0[0] >= 7) cpuid(7, 0, regs7);
+
+        f.sse41 = (regs1[2] >> 19) & 1;
+        f.sse42 = (regs1[2] >> 20) & 1;
+        f.aesni = (regs1[2] >> 25) & 1;
+        f.pclmul = (regs1[2] >> 1) & 1;
+        f.shani = (regs7[1] >> 29) & 1;
+
+        // AVX2 requiere además que el sistema operativo guarde los registros YMM.
+        bool osxsave = (regs1[2] >> 27) & 1;
+        if (osxsave && ((xgetbv0() & 0x6) == 0x6)) {
+            f.avx2 = (regs7[1] >> 5) & 1;
+        }
+#endif
+        return f;
+    }
+
+#if TTC_X86
+    static void
+        cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; ++i) {
+            regs[i] = static_cast<unsigned int>(r[i]);
+        }
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    static unsigned long long
+        xgetbv0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int eax = 0, edx = 0;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+#endif
+};
@@ -0,0 +1,383 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "ShardedKeySearch.h"
+
+#include <condition_variable>
+#include <map>
+
+/**
+ * @brief Estado de un trabajo del planificador.
+ */
+enum class CrackJobState {
+    Queued,     ///< Aceptado, todavía sin ninguna porción ejecutada.
+    Running,
+    Completed,  ///< Recorrió todo su espacio de claves.
+    Cancelled,  ///< Cancelado; conserva los resultados parciales.
+    TimedOut,   ///< Superó su plazo; conserva los resultados parciales.
+    Failed      ///< Una porción lanzó una excepción; conserva el mensaje y los resultados parciales.
+};
+
+/**
+ * @brief Parámetros de un trabajo.
+ */
+struct CrackJobOptions {
+    std::string name;
+    unsigned priority = 1;                      ///< Peso (≥ 1): parte del tiempo de CPU proporcional.
+    std::chrono::milliseconds deadline{ 0 };    ///< Plazo desde el envío (0 = sin plazo).
+    size_t topK = 5;                            ///< Candidatos que se conservan.
+};
+
+/**
+ * @brief Progreso y resultados (parciales o finales) de un trabajo.
+ */
+struct CrackJobStatus {
+    uint64_t id = 0;
+    std::string name;
+    CrackJobState state = CrackJobState::Queued;
+    unsigned priority = 1;
+    uint64_t keysTried = 0;
+    uint64_t totalKeys = 0;
+    double elapsedSeconds = 0.0;
+    double keysPerSecond = 0.0;
+    double etaSeconds = 0.0;            ///< Estimación con la velocidad media (0 si terminó).
+    std::vector<KeyCandidate> best;     ///< De mejor a peor.
+    std::string error;                  ///< Mensaje de la excepción si el estado es Failed.
+};
+
+/**
+ * @class CrackScheduler
+ * @brief Planificador de trabajos de fuerza bruta sobre un grupo de hilos compartido.
+ *
+ * Cada trabajo es un espacio de claves indexado que se recorre por porciones de unos
+ * milisegundos (el tamaño se ajusta solo). Los hilos eligen siempre el trabajo con menor
+ * tiempo de CPU ponderado (planificación por pasos: tiempo / prioridad), así que un trabajo
+ * de prioridad 4 recibe cuatro veces más CPU que uno de prioridad 1, pero ninguno se queda
+ * sin turno. El plazo y la cancelación se comprueban entre porciones (cancelación
+ * cooperativa) y los candidatos encontrados hasta ese momento se conservan.
+ *
+ * Los trabajos pueden ser un KeySearchJob (XOR de N bytes como bruteForce_2Byte, Vigenère
+ * hasta N letras como breakEncode/breakBruteForce, subespacio DES) o cualquier función que
+ * busque en un rango de índices.
+ */
+class CrackScheduler {
+public:
+    /**
+     * @brief Busca en [first, first + count) y devuelve los topK mejores candidatos.
+     *        Si lanza una excepción, el trabajo termina en CrackJobState::Failed.
+     */
+    using RangeSearch = std::function<std::vector<KeyCandidate>(uint64_t first, uint64_t count, size_t topK)>;
+
+    /**
+     * @param threads Hilos del grupo (0 = hardware_concurrency).
+     * @param slice   Duración objetivo de cada porción.
+     */
+    explicit CrackScheduler(unsigned threads = 0, std::chrono::milliseconds slice = std::chrono::milliseconds(20))
+        : m_slice(std::chrono::duration<double>(slice).count()) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i) m_workers.emplace_back([this] { workerLoop(); });
+    }
+
+    /**
+     * @brief Cancela lo pendiente y espera a los hilos.
+     */
+    ~CrackScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& t : m_workers) t.join();
+    }
+
+    CrackScheduler(const CrackScheduler&) = delete;
+    CrackScheduler& operator=(const CrackScheduler&) = delete;
+
+    /**
+     * @brief Encola una búsqueda de KeySearchJob.
+     *
+     * @return uint64_t Identificador del trabajo.
+     */
+    uint64_t
+        submit(const KeySearchJob& job, const CrackJobOptions& options) {
+        auto shared = std::make_shared<KeySearchJob>(job);
+        return submit(job.size(), [shared](uint64_t first, uint64_t count, size_t topK) {
+            return shared->search(first, count, topK);
+            }, options);
+    }
+
+    /**
+     * @brief Encola una búsqueda genérica sobre [0, totalKeys).
+     *
+     * @throws std::invalid_argument Si el espacio está vacío o no hay función.
+     */
+    uint64_t
+        submit(uint64_t totalKeys, RangeSearch search, const CrackJobOptions& options) {
+        if (totalKeys == 0 || !search) {
+            throw std::invalid_argument("El trabajo necesita un espacio de claves y una funcion de busqueda.");
+        }
+        auto job = std::make_unique<Job>(options.topK);
+        job->options = options;
+        job->options.priority = std::max(1u, options.priority);
+        job->total = totalKeys;
+        job->search = std::move(search);
+        job->submitted = Clock::now();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->id = ++m_lastId;
+        // Un trabajo nuevo empieza en el paso mínimo actual: no adelanta a nadie por llegar tarde.
+        double minimum = -1.0;
+        for (const auto& entry : m_jobs) {
+            if (isActive(*entry.second) && (minimum < 0 || entry.second->pass < minimum)) minimum = entry.second->pass;
+        }
+        job->pass = std::max(0.0, minimum);
+        uint64_t id = job->id;
+        m_jobs.emplace(id, std::move(job));
+        m_wake.notify_all();
+        return id;
+    }
+
+    /**
+     * @brief Pide la cancelación; las porciones en curso terminan y sus resultados cuentan.
+     *
+     * @return bool false si el trabajo no existe o ya había terminado.
+     */
+    bool
+        cancel(uint64_t id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(id);
+        if (it == m_jobs.end() || !isActive(*it->second)) return false;
+        finish(*it->second, CrackJobState::Cancelled);
+        return true;
+    }
+
+    /**
+     * @throws std::out_of_range Si el trabajo no existe.
+     */
+    CrackJobStatus
+        status(uint64_t id) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return snapshot(job(id));
+    }
+
+    /**
+     * @brief Estado de todos los trabajos, por identificador.
+     */
+    std::vector<CrackJobStatus>
+        statuses() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<CrackJobStatus> result;
+        for (const auto& entry : m_jobs) result.push_back(snapshot(*entry.second));
+        return result;
+    }
+
+    /**
+     * @brief Espera a que el trabajo termine (por completarse, cancelarse o agotar su plazo).
+     */
+    CrackJobStatus
+        wait(uint64_t id) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const Job& j = job(id);
+        m_done.wait(lock, [&] { return !isActive(j) && j.inFlight == 0; });
+        return snapshot(j);
+    }
+
+    /**
+     * @brief Espera a que terminen todos los trabajos enviados.
+     */
+    void
+        waitAll() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&] {
+            for (const auto& entry : m_jobs) {
+                if (isActive(*entry.second) || entry.second->inFlight) return false;
+            }
+            return true;
+            });
+    }
+
+    static const char*
+        stateName(CrackJobState state) {
+        switch (state) {
+        case CrackJobState::Queued: return "en cola";
+        case CrackJobState::Running: return "en curso";
+        case CrackJobState::Completed: return "completado";
+        case CrackJobState::Cancelled: return "cancelado";
+        case CrackJobState::TimedOut: return "plazo agotado";
+        case CrackJobState::Failed: return "fallido";
+        }
+        return "?";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        explicit Job(size_t topK) : best(topK) {
+        }
+
+        uint64_t id = 0;
+        CrackJobOptions options;
+        RangeSearch search;
+        uint64_t total = 0;
+        uint64_t cursor = 0;        ///< Siguiente índice por repartir.
+        uint64_t tried = 0;         ///< Índices ya evaluados.
+        uint64_t chunk = 1024;      ///< Claves por porción (se ajusta a m_slice).
+        double pass = 0.0;          ///< Tiempo de CPU / prioridad.
+        double cpuSeconds = 0.0;
+        unsigned inFlight = 0;      ///< Porciones en ejecución.
+        CrackJobState state = CrackJobState::Queued;
+        std::string error;          ///< Mensaje de la porción que falló.
+        Clock::time_point submitted;
+        Clock::time_point finished;
+        KeyCandidateSet best;
+    };
+
+    double m_slice;
+    std::map<uint64_t, std::unique_ptr<Job>> m_jobs;
+    uint64_t m_lastId = 0;
+    bool m_stopping = false;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<std::thread> m_workers;
+
+    static bool
+        isActive(const Job& j) {
+        return j.state == CrackJobState::Queued || j.state == CrackJobState::Running;
+    }
+
+    const Job&
+        job(uint64_t id) const {
+        auto it = m_jobs.find(id);
+        if (it == m_jobs.end()) {
+            throw std::out_of_range("No existe el trabajo " + std::to_string(id));
+        }
+        return *it->second;
+    }
+
+    void
+        finish(Job& j, CrackJobState state) {
+        j.state = state;
+        j.finished = Clock::now();
+        m_done.notify_all();
+    }
+
+    bool
+        expired(const Job& j, Clock::time_point now) const {
+        return j.options.deadline.count() > 0 && now - j.submitted >= j.options.deadline;
+    }
+
+    CrackJobStatus
+        snapshot(const Job& j) const {
+        CrackJobStatus s;
+        s.id = j.id;
+        s.name = j.options.name;
+        s.state = j.state;
+        s.priority = j.options.priority;
+        s.keysTried = j.tried;
+        s.totalKeys = j.total;
+        Clock::time_point end = isActive(j) ? Clock::now() : j.finished;
+        s.elapsedSeconds = std::chrono::duration<double>(end - j.submitted).count();
+        s.keysPerSecond = s.elapsedSeconds > 0 ? j.tried / s.elapsedSeconds : 0.0;
+        s.etaSeconds = isActive(j) && s.keysPerSecond > 0 ? (j.total - j.tried) / s.keysPerSecond : 0.0;
+        s.best = j.best.sorted();
+        s.error = j.error;
+        return s;
+    }
+
+    /**
+     * @brief Trabajo activo con menor paso que aún tenga índices por repartir; marca los
+     *        que han agotado su plazo. Se llama con el mutex tomado.
+     */
+    Job*
+        pickJob() {
+        Clock::time_point now = Clock::now();
+        Job* chosen = nullptr;
+        for (auto& entry : m_jobs) {
+            Job& j = *entry.second;
+            if (!isActive(j)) continue;
+            if (expired(j, now)) {
+                finish(j, CrackJobState::TimedOut);
+                continue;
+            }
+            if (j.cursor < j.total && (!chosen || j.pass < chosen->pass)) chosen = &j;
+        }
+        return chosen;
+    }
+
+    void
+        workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            Job* j = nullptr;
+            // Despierta cada cierto tiempo aunque nadie avise, para vencer plazos de trabajos en cola.
+            m_wake.wait_for(lock, std::chrono::milliseconds(50), [&] { return m_stopping || (j = pickJob()) != nullptr; });
+            if (m_stopping) {
+                for (auto& entry : m_jobs) {
+                    if (isActive(*entry.second)) finish(*entry.second, CrackJobState::Cancelled);
+                }
+                return;
+            }
+            if (!j) continue;
+
+            uint64_t first = j->cursor;
+            uint64_t count = std::min(j->chunk, j->total - first);
+            j->cursor += count;
+            j->state = CrackJobState::Running;
+            ++j->inFlight;
+            // Adelanta el paso con la duración prevista para que otros hilos no elijan
+            // todos el mismo trabajo mientras esta porción se ejecuta.
+            j->pass += m_slice / j->options.priority;
+            RangeSearch search = j->search;
+            size_t topK = j->options.topK;
+
+            lock.unlock();
+            auto start = Clock::now();
+            std::vector<KeyCandidate> found;
+            // Una excepción no puede salir del hilo (std::terminate): el trabajo pasa a Failed
+            bool failed = false;
+            std::string error;
+            try {
+                found = search(first, count, topK);
+            }
+            catch (const std::exception& e) {
+                failed = true;
+                try { error = e.what(); } catch (...) {}
+            }
+            catch (...) {
+                failed = true;
+                try { error = "excepcion desconocida"; } catch (...) {}
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            lock.lock();
+
+            --j->inFlight;
+            if (failed) {
+                j->cpuSeconds += seconds;
+                if (isActive(*j)) {
+                    j->error = std::move(error);
+                    finish(*j, CrackJobState::Failed);
+                }
+                else if (j->inFlight == 0) {
+                    m_done.notify_all();
+                }
+                continue;
+            }
+            j->tried += count;
+            j->cpuSeconds += seconds;
+            j->pass += (seconds - m_slice) / j->options.priority;
+            for (const KeyCandidate& c : found) j->best.add(c);
+            // Nueva porción: la proporción que habría durado m_slice, sin saltos bruscos.
+            double scale = seconds > 0 ? std::clamp(m_slice / seconds, 0.5, 2.0) : 2.0;
+            j->chunk = std::max<uint64_t>(1, static_cast<uint64_t>(j->chunk * scale));
+
+            if (isActive(*j)) {
+                if (j->tried == j->total) finish(*j, CrackJobState::Completed);
+                else if (expired(*j, Clock::now())) finish(*j, CrackJobState::TimedOut);
+            }
+            else if (j->inFlight == 0) {
+                m_done.notify_all();
+            }
+        }
+    }
+};
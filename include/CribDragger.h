@@ -0,0 +1,364 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+
+/**
+ * @class CribDragger
+ * @brief Ataca muchos mensajes cifrados con XOR contra el mismo flujo de clave
+ *        (reutilización de clave / "two-time pad").
+ *
+ * Si c_i = p_i ^ k y c_j = p_j ^ k, entonces c_i ^ c_j = p_i ^ p_j: la clave desaparece.
+ * Suponer que el mensaje i contiene la palabra probable (crib) en la posición o fija
+ * k[o..o+L) = c_i ^ crib, y el par (i, j) confirma la hipótesis si c_j ^ k en esa misma
+ * ventana parece texto. drag() prueba cada mensaje y cada desplazamiento contra todos los
+ * demás mensajes que cubren la ventana; la prueba de "parece texto" compara 32 bytes a la
+ * vez con AVX2 (tabla de clases por nibbles con pshufb) y corta en cuanto los fallos
+ * superan el margen permitido, de modo que las hipótesis falsas cuestan pocas pruebas.
+ *
+ * Los bytes de clave aceptados (accept/setPlaintext) se aplican a todos los mensajes y
+ * los siguientes arrastres saltan las ventanas que ya no aportan nada o que contradicen
+ * lo confirmado.
+ */
+class CribDragger {
+public:
+    /**
+     * @brief Parámetros de un arrastre.
+     */
+    struct Options {
+        unsigned threads = 0;       ///< 0 = núcleos disponibles.
+        double minSupport = 0.9;    ///< Fracción mínima de mensajes que deben parecer texto.
+        size_t minCovering = 2;     ///< Mínimo de otros mensajes que cubren la ventana.
+        size_t maxHits = 20;        ///< Candidatos a devolver.
+    };
+
+    /**
+     * @brief Hipótesis que sobrevive a la comprobación contra los demás mensajes.
+     */
+    struct Hit {
+        size_t message = 0;        ///< Mensaje en el que se supone el crib.
+        size_t offset = 0;         ///< Posición del crib.
+        std::string crib;
+        size_t covering = 0;       ///< Otros mensajes que cubren la ventana.
+        double support = 0.0;      ///< Fracción de ellos que descifra a texto.
+        double textScore = 0.0;    ///< Parecido medio a texto (desempate).
+        size_t newKeyBytes = 0;    ///< Bytes de clave que aún no se conocían.
+    };
+
+    /**
+     * @brief Coste del último arrastre.
+     */
+    struct Stats {
+        uint64_t hypotheses = 0;   ///< Pares (mensaje, desplazamiento) evaluados.
+        uint64_t comparisons = 0;  ///< Ventanas de otros mensajes comprobadas.
+        double seconds = 0.0;
+    };
+
+    /**
+     * @param ciphertexts Mensajes cifrados con el mismo flujo de clave desde el byte 0.
+     * @throws std::invalid_argument Si hay menos de dos mensajes.
+     */
+    explicit CribDragger(const std::vector<std::vector<uint8_t>>& ciphertexts) {
+        if (ciphertexts.size() < 2) {
+            throw std::invalid_argument("Se necesitan al menos dos mensajes con la misma clave.");
+        }
+        for (const auto& c : ciphertexts) m_maxLength = std::max(m_maxLength, c.size());
+        // Relleno de 32 bytes para que las cargas AVX2 nunca salgan del búfer.
+        m_stride = m_maxLength + SIMD_WIDTH;
+        m_data.assign(ciphertexts.size() * m_stride + SIMD_WIDTH, 0);
+        for (size_t m = 0; m < ciphertexts.size(); ++m) {
+            std::copy(ciphertexts[m].begin(), ciphertexts[m].end(), m_data.begin() + m * m_stride);
+            m_lengths.push_back(ciphertexts[m].size());
+        }
+        m_covering.assign(m_maxLength + 2, 0);
+        for (size_t length : m_lengths) ++m_covering[length];
+        for (size_t end = m_maxLength; end-- > 0;) m_covering[end] += m_covering[end + 1];
+        m_key.assign(m_maxLength, 0);
+        m_known.assign(m_maxLength, false);
+        m_useAvx2 = CpuFeatures::get().avx2;
+    }
+
+    size_t
+        messageCount() const {
+        return m_lengths.size();
+    }
+
+    size_t
+        maxLength() const {
+        return m_maxLength;
+    }
+
+    /**
+     * @brief Arrastra un crib por todos los mensajes y desplazamientos.
+     *
+     * @return std::vector<Hit> Hipótesis con soporte suficiente, de mejor a peor.
+     * @throws std::invalid_argument Si el crib está vacío o es más largo que todos los mensajes.
+     */
+    std::vector<Hit>
+        drag(const std::string& crib, const Options& options) {
+        if (crib.empty() || crib.size() > m_maxLength) {
+            throw std::invalid_argument("El crib debe tener entre 1 y " + std::to_string(m_maxLength) + " bytes.");
+        }
+        const size_t length = crib.size();
+        unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<Hit> hits;
+        std::atomic<size_t> next{ 0 };
+        std::atomic<uint64_t> hypotheses{ 0 };
+        std::atomic<uint64_t> comparisons{ 0 };
+        std::mutex mutex;
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                std::vector<Hit> local;
+                std::vector<uint8_t> key(length + SIMD_WIDTH, 0);
+                uint64_t localHypotheses = 0;
+                uint64_t localComparisons = 0;
+                for (size_t i = next++; i < m_lengths.size(); i = next++) {
+                    const uint8_t* cipher = message(i);
+                    for (size_t offset = 0; offset + length <= m_lengths[i]; ++offset) {
+                        size_t fresh = 0;
+                        bool conflict = false;
+                        for (size_t b = 0; b < length; ++b) {
+                            key[b] = static_cast<uint8_t>(cipher[offset + b] ^ crib[b]);
+                            if (!m_known[offset + b]) ++fresh;
+                            else if (m_key[offset + b] != key[b]) conflict = true;
+                        }
+                        if (fresh == 0 || conflict) continue;
+                        size_t covering = m_covering[offset + length] - 1;
+                        if (covering < options.minCovering) continue;
+
+                        ++localHypotheses;
+                        size_t allowed = static_cast<size_t>((1.0 - options.minSupport) * covering);
+                        size_t failures = 0;
+                        for (size_t m = 0; m < m_lengths.size() && failures <= allowed; ++m) {
+                            if (m == i || m_lengths[m] < offset + length) continue;
+                            ++localComparisons;
+                            if (!looksLikeText(message(m) + offset, key.data(), length)) ++failures;
+                        }
+                        if (failures > allowed) continue;
+
+                        Hit hit;
+                        hit.message = i;
+                        hit.offset = offset;
+                        hit.crib = crib;
+                        hit.covering = covering;
+                        hit.support = static_cast<double>(covering - failures) / covering;
+                        hit.textScore = textScore(i, offset, key.data(), length);
+                        hit.newKeyBytes = fresh;
+                        local.push_back(std::move(hit));
+                    }
+                }
+                hypotheses += localHypotheses;
+                comparisons += localComparisons;
+                std::lock_guard<std::mutex> lock(mutex);
+                hits.insert(hits.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+                });
+        }
+        for (auto& worker : workers) worker.join();
+
+        std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+            if (a.support != b.support) return a.support > b.support;
+            if (a.textScore != b.textScore) return a.textScore > b.textScore;
+            return a.message < b.message || (a.message == b.message && a.offset < b.offset);
+            });
+        if (hits.size() > options.maxHits) hits.resize(options.maxHits);
+
+        m_stats.hypotheses = hypotheses;
+        m_stats.comparisons = comparisons;
+        m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return hits;
+    }
+
+    /**
+     * @brief Arrastre con las opciones por defecto.
+     */
+    std::vector<Hit>
+        drag(const std::string& crib) {
+        return drag(crib, Options());
+    }
+
+    /**
+     * @brief Confirma una hipótesis: fija sus bytes de clave para todos los mensajes.
+     *
+     * @return size_t Bytes de clave nuevos.
+     */
+    size_t
+        accept(const Hit& hit) {
+        return setPlaintext(hit.message, hit.offset, hit.crib);
+    }
+
+    /**
+     * @brief Declara que el mensaje contiene text en offset (p. ej. al completar una palabra
+     *        a la vista de otro mensaje). Sobrescribe bytes de clave anteriores.
+     *
+     * @return size_t Bytes de clave nuevos.
+     * @throws std::out_of_range Si el texto no cabe en el mensaje.
+     */
+    size_t
+        setPlaintext(size_t messageIndex, size_t offset, const std::string& text) {
+        if (messageIndex >= m_lengths.size() || offset + text.size() > m_lengths[messageIndex]) {
+            throw std::out_of_range("El texto no cabe en el mensaje indicado.");
+        }
+        size_t fresh = 0;
+        const uint8_t* cipher = message(messageIndex);
+        for (size_t b = 0; b < text.size(); ++b) {
+            if (!m_known[offset + b]) ++fresh;
+            m_key[offset + b] = static_cast<uint8_t>(cipher[offset + b] ^ text[b]);
+            m_known[offset + b] = true;
+        }
+        return fresh;
+    }
+
+    /**
+     * @brief Olvida un tramo de la clave (para deshacer una hipótesis equivocada).
+     */
+    void
+        forget(size_t offset, size_t length) {
+        for (size_t p = offset; p < offset + length && p < m_maxLength; ++p) {
+            m_known[p] = false;
+            m_key[p] = 0;
+        }
+    }
+
+    /**
+     * @brief Bytes de clave conocidos.
+     */
+    size_t
+        knownKeyBytes() const {
+        return static_cast<size_t>(std::count(m_known.begin(), m_known.end(), true));
+    }
+
+    /**
+     * @brief Byte de clave en la posición, o -1 si no se conoce.
+     */
+    int
+        keyByte(size_t position) const {
+        return position < m_maxLength && m_known[position] ? m_key[position] : -1;
+    }
+
+    /**
+     * @brief Texto del mensaje con lo que se sabe de la clave.
+     *
+     * @param unknown Carácter para las posiciones sin clave.
+     */
+    std::string
+        plaintext(size_t messageIndex, char unknown = '_') const {
+        std::string text(m_lengths.at(messageIndex), unknown);
+        const uint8_t* cipher = message(messageIndex);
+        for (size_t p = 0; p < text.size(); ++p) {
+            if (m_known[p]) text[p] = static_cast<char>(cipher[p] ^ m_key[p]);
+        }
+        return text;
+    }
+
+    /**
+     * @brief Estadísticas del último drag().
+     */
+    const Stats&
+        stats() const {
+        return m_stats;
+    }
+
+private:
+    static constexpr size_t SIMD_WIDTH = 32;
+
+    std::vector<uint8_t> m_data;      ///< Mensajes con paso fijo m_stride.
+    std::vector<size_t> m_lengths;
+    std::vector<size_t> m_covering;   ///< m_covering[n] = mensajes de longitud >= n.
+    std::vector<uint8_t> m_key;
+    std::vector<bool> m_known;
+    size_t m_maxLength = 0;
+    size_t m_stride = 0;
+    bool m_useAvx2 = false;
+    Stats m_stats;
+
+    const uint8_t*
+        message(size_t index) const {
+        return m_data.data() + index * m_stride;
+    }
+
+    /**
+     * @brief Caracteres admitidos en un mensaje en claro: letras, dígitos, espacio,
+     *        salto de línea y la puntuación habitual. Excluir el resto de símbolos ASCII
+     *        es lo que descarta las hipótesis falsas, que producen p_i ^ p_j ^ crib.
+     */
+    static const std::array<bool, 256>&
+        textClass() {
+        static const std::array<bool, 256> table = [] {
+            std::array<bool, 256> t{};
+            for (int c = 0; c < 128; ++c) t[c] = std::isalnum(c) != 0;
+            for (unsigned char c : std::string(" \n.,;:'\"!?-()")) t[c] = true;
+            return t;
+            }();
+        return table;
+    }
+
+    bool
+        looksLikeText(const uint8_t* cipher, const uint8_t* key, size_t length) const {
+#if TTC_X86
+        if (m_useAvx2) return looksLikeTextAvx2(cipher, key, length);
+#endif
+        const auto& allowed = textClass();
+        for (size_t b = 0; b < length; ++b) {
+            if (!allowed[cipher[b] ^ key[b]]) return false;
+        }
+        return true;
+    }
+
+    double
+        textScore(size_t skip, size_t offset, const uint8_t* key, size_t length) const {
+        uint64_t total = 0;
+        uint64_t count = 0;
+        for (size_t m = 0; m < m_lengths.size(); ++m) {
+            if (m == skip || m_lengths[m] < offset + length) continue;
+            const uint8_t* cipher = message(m) + offset;
+            for (size_t b = 0; b < length; ++b) {
+                uint8_t c = cipher[b] ^ key[b];
+                total += c == ' ' ? 3 : (c >= 'a' && c <= 'z') ? 2 : (c >= 'A' && c <= 'Z') ? 1 : 0;
+            }
+            count += length;
+        }
+        return count ? static_cast<double>(total) / count : 0.0;
+    }
+
+#if TTC_X86
+    /**
+     * @brief Clasifica 32 bytes por vuelta: pshufb sobre el nibble bajo da la máscara de
+     *        nibbles altos admitidos, y pshufb sobre el nibble alto da el bit a comprobar.
+     */
+    TTC_TARGET("avx2")
+        static bool
+        looksLikeTextAvx2(const uint8_t* cipher, const uint8_t* key, size_t length) {
+        static const std::array<uint8_t, 16> lowTable = [] {
+            std::array<uint8_t, 16> t{};
+            const auto& allowed = textClass();
+            for (int c = 0; c < 128; ++c) {
+                if (allowed[c]) t[c & 0x0F] |= static_cast<uint8_t>(1 << (c >> 4));
+            }
+            return t;
+            }();
+        const __m128i low128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lowTable.data()));
+        const __m256i lowLookup = _mm256_broadcastsi128_si256(low128);
+        const __m256i bitLookup = _mm256_setr_epi8(
+            1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,
+            1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (size_t b = 0; b < length; b += SIMD_WIDTH) {
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cipher + b));
+            __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + b));
+            __m256i x = _mm256_xor_si256(c, k);
+            __m256i rows = _mm256_shuffle_epi8(lowLookup, _mm256_and_si256(x, nibble));
+            __m256i bit = _mm256_shuffle_epi8(bitLookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+            __m256i rejected = _mm256_cmpeq_epi8(_mm256_and_si256(rows, bit), zero);
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(rejected));
+            size_t remaining = length - b;
+            if (remaining < SIMD_WIDTH) mask &= (1u << remaining) - 1;
+            if (mask) return false;
+        }
+        return true;
+    }
+#endif
+};
@@ -1,5 +1,7 @@
 #pragma once
 #include "Prerequisites.h"
+#include "BreachFilter.h"
+#include "SecureArena.h"
 
 /**
  * @class CryptoGenerator
@@ -150,6 +152,42 @@ public:
 		return generateBytes(length);
 	}
 
+	/**
+	 * @brief Genera una clave directamente en un bloque de la arena segura.
+	 *
+	 * La clave no pasa por el montn: queda en memoria bloqueada y se borra sola
+	 * cuando el SecureBuffer se destruye.
+	 *
+	 * @param bits  Tamao de la clave en bits (debe ser mltiplo de 8).
+	 * @param arena Arena de la que se toma el bloque.
+	 * @return SecureBuffer Clave generada (bits/8 bytes).
+	 * @throws std::runtime_error Si bits no es mltiplo de 8.
+	 * @throws std::invalid_argument Si la clave no cabe en un bloque de la arena.
+	 */
+	SecureBuffer
+		generateKey(unsigned int bits, SecureArena& arena) {
+		if (bits % 8 != 0) {
+			throw std::runtime_error("Bits debe ser mltiplo de 8.");
+		}
+		return generateSecureBytes(bits / 8, arena);
+	}
+
+	/**
+	 * @brief Genera un IV en un bloque de la arena segura.
+	 */
+	SecureBuffer
+		generateIV(unsigned int blockSize, SecureArena& arena) {
+		return generateSecureBytes(blockSize, arena);
+	}
+
+	/**
+	 * @brief Genera una salt en un bloque de la arena segura.
+	 */
+	SecureBuffer
+		generateSalt(unsigned int length, SecureArena& arena) {
+		return generateSecureBytes(length, arena);
+	}
+
 	/**
 		 * @brief Convierte un vector de bytes a una cadena Base64.
 		 *
@@ -236,19 +274,34 @@ public:
 	/**
 	 * @brief Limpia de forma segura los datos sensibles en un vector.
 	 *
-	 * Sobrescribe cada byte con cero para evitar filtraciones en memoria.
+	 * Sobrescribe cada byte con cero para evitar filtraciones en memoria. Usa
+	 * SecureArena::secureZero, que el optimizador no puede eliminar aunque el vector
+	 * no se vuelva a leer.
 	 *
 	 * @param data Vector cuyos elementos sern limpiados.
 	 */
 	void
 		secureWipe(std::vector<uint8_t>& data) {
-		std::fill(data.begin(), data.end(), 0);
+		if (!data.empty()) SecureArena::secureZero(data.data(), data.size());
+	}
+
+	/**
+	 * @brief Activa el rechazo de contraseas que aparecen en una lista de filtraciones.
+	 *
+	 * @param filter Filtro compilado con BreachFilterBuilder (debe vivir ms que el
+	 *               generador), o nullptr para desactivar la comprobacin.
+	 */
+	void
+		setBreachFilter(const BreachFilter* filter) {
+		m_breachFilter = filter;
 	}
 
 	/**
 	 * @brief Valida si una contrasea cumple con polticas mnimas.
 	 *
 	 * Requiere al menos una mayscula, una minscula, un dgito y longitud mnima de 8.
+	 * Si hay un filtro de filtraciones activo, adems rechaza las contraseas que contiene
+	 * (con la tasa de falsos positivos del filtro, BreachFilter::falsePositiveRate()).
 	 *
 	 * @param password Contrasea a validar.
 	 * @return true si cumple la poltica; false en caso contrario.
@@ -272,12 +325,24 @@ public:
 			}
 		}
 
-		return hasUpper && hasLower && hasDigit && hasSymbols;
+		if (!(hasUpper && hasLower && hasDigit && hasSymbols)) return false;
+		return !(m_breachFilter && m_breachFilter->contains(password));
 	}
 
 private:
+	SecureBuffer
+		generateSecureBytes(unsigned int numBytes, SecureArena& arena) {
+		SecureBuffer bytes = arena.acquire(numBytes);
+		std::uniform_int_distribution<int> dist(0, 255);
+		for (unsigned int i = 0; i < numBytes; ++i) {
+			bytes[i] = static_cast<uint8_t>(dist(m_engine));
+		}
+		return bytes;
+	}
+
 	std::mt19937 m_engine;  ///< Motor de generacin de nmeros aleatorios Mersenne Twister.
 	std::mutex _mtx;          ///< Mutex para uso thread-safe.
 	std::array<uint8_t, 256> _decTable;  ///< Tabla de decodificacin Base64.
+	const BreachFilter* m_breachFilter = nullptr;  ///< Lista de contraseas filtradas (opcional).
 
 };
\ No newline at end of file
@@ -0,0 +1,325 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "DES.h"
+#include "SecureArena.h"
+
+/**
+ * @class DESKernel
+ * @brief Núcleo rápido de la función de ronda de DES basado en tablas.
+ *
+ * Reproduce exactamente la ronda de la clase DES (expansión, S-Box y permutación P),
+ * pero precalcula las tablas a partir de los propios métodos públicos de DES, de modo
+ * que cualquier cambio en las tablas de DES se refleja aquí automáticamente.
+ * Cada ronda se reduce a 4 búsquedas de expansión y 8 búsquedas S-Box+P sobre enteros.
+ *
+ * El método cryptBlocks intercala varios bloques independientes a través de las rondas
+ * para ocultar la latencia de las búsquedas en tabla.
+ */
+class DESKernel {
+public:
+    /**
+     * @brief Subclaves de 48 bits de una operación DES (16 rondas).
+     */
+    using Schedule = std::array<uint64_t, 16>;
+
+    /**
+     * @brief Número de bloques que se procesan a la vez en la ruta intercalada.
+     */
+    static constexpr size_t LANES = 8;
+
+    DESKernel() = default;
+    ~DESKernel() = default;
+
+    /**
+     * @brief Genera las subclaves igual que DES::generateSubkeys.
+     *
+     * @param key Clave DES de 64 bits.
+     * @return Schedule Subclaves para cifrar.
+     */
+    static Schedule
+        makeSchedule(const std::bitset<64>& key) {
+        Schedule schedule{};
+        uint64_t k = key.to_ullong();
+        for (int i = 0; i < 16; ++i) {
+            schedule[i] = (k >> i) & 0xFFFFFFFFFFFFULL;
+        }
+        return schedule;
+    }
+
+    /**
+     * @brief Genera las subclaves en un bloque de la arena segura, para que el
+     *        material derivado de la clave tampoco quede en el montón.
+     *
+     * @param key     Clave DES de 64 bits.
+     * @param arena   Arena con bloques de al menos 128 bytes.
+     * @param decrypt true para el orden de descifrado.
+     * @return SecureBuffer 16 subclaves uint64_t (usar con subkeys()).
+     */
+    static SecureBuffer
+        makeSchedule(const std::bitset<64>& key, SecureArena& arena, bool decrypt = false) {
+        SecureBuffer buffer = arena.acquire(sizeof(Schedule));
+        uint64_t* out = subkeys(buffer);
+        uint64_t k = key.to_ullong();
+        for (int i = 0; i < 16; ++i) {
+            out[decrypt ? 15 - i : i] = (k >> i) & 0xFFFFFFFFFFFFULL;
+        }
+        return buffer;
+    }
+
+    /**
+     * @brief Vista de un bloque de la arena como subclaves para cryptBlock/cryptBlocks.
+     */
+    static uint64_t*
+        subkeys(SecureBuffer& buffer) {
+        return reinterpret_cast<uint64_t*>(buffer.data());
+    }
+
+    static const uint64_t*
+        subkeys(const SecureBuffer& buffer) {
+        return reinterpret_cast<const uint64_t*>(buffer.data());
+    }
+
+    /**
+     * @brief Invierte el orden de las subclaves (cifrado -> descifrado).
+     *
+     * @param schedule Subclaves de cifrado.
+     * @return Schedule Subclaves de descifrado.
+     */
+    static Schedule
+        reverse(const Schedule& schedule) {
+        Schedule out{};
+        for (int i = 0; i < 16; ++i) {
+            out[i] = schedule[15 - i];
+        }
+        return out;
+    }
+
+    /**
+     * @brief Procesa un bloque con una o varias operaciones DES encadenadas.
+     *
+     * Cada pasada consume 16 subclaves consecutivas de @p subkeys y termina con el
+     * intercambio de mitades, igual que DES::encode/decode.
+     *
+     * @param block  Bloque de 64 bits.
+     * @param subkeys Subclaves (16 * passes elementos).
+     * @param passes Número de operaciones DES encadenadas (1 para DES, 3 para 3DES).
+     * @return uint64_t Bloque resultante.
+     */
+    static uint64_t
+        cryptBlock(uint64_t block, const uint64_t* subkeys, int passes = 1) {
+        const Tables& t = tables();
+        uint32_t left = static_cast<uint32_t>(block >> 32);
+        uint32_t right = static_cast<uint32_t>(block);
+
+        for (int p = 0; p < passes; ++p) {
+            const uint64_t* k = subkeys + p * 16;
+            for (int round = 0; round < 16; ++round) {
+                uint32_t newRight = left ^ feistel(right, k[round], t);
+                left = right;
+                right = newRight;
+            }
+            std::swap(left, right);
+        }
+
+        return (static_cast<uint64_t>(left) << 32) | right;
+    }
+
+    /**
+     * @brief Procesa @p count bloques independientes intercalándolos de LANES en LANES.
+     *
+     * @param in      Bloques de entrada.
+     * @param out     Bloques de salida (puede coincidir con @p in).
+     * @param count   Número de bloques.
+     * @param subkeys Subclaves (16 * passes elementos).
+     * @param passes  Número de operaciones DES encadenadas.
+     */
+    static void
+        cryptBlocks(const uint64_t* in, uint64_t* out, size_t count,
+            const uint64_t* subkeys, int passes = 1) {
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES) {
+            cryptLanes<LANES>(in + i, out + i, subkeys, passes);
+        }
+        for (; i + 4 <= count; i += 4) {
+            cryptLanes<4>(in + i, out + i, subkeys, passes);
+        }
+        for (; i < count; ++i) {
+            out[i] = cryptBlock(in[i], subkeys, passes);
+        }
+    }
+
+    /**
+     * @brief Cifra el mismo bloque con @p count claves distintas (búsqueda de claves).
+     *
+     * Las subclaves se derivan al vuelo como en makeSchedule y las claves se procesan de
+     * LANES en LANES, intercaladas igual que en cryptBlocks.
+     *
+     * @param block Bloque en claro.
+     * @param keys  Claves de 64 bits (std::bitset<64>::to_ullong()).
+     * @param out   Bloques cifrados, uno por clave.
+     * @param count Número de claves.
+     */
+    static void
+        encryptUnderKeys(uint64_t block, const uint64_t* keys, uint64_t* out, size_t count) {
+        underKeys<false>(block, keys, out, count);
+    }
+
+    /**
+     * @brief Descifra el mismo bloque con @p count claves distintas (subclaves en orden inverso).
+     */
+    static void
+        decryptUnderKeys(uint64_t block, const uint64_t* keys, uint64_t* out, size_t count) {
+        underKeys<true>(block, keys, out, count);
+    }
+
+    /**
+     * @brief Lee 8 bytes en orden big-endian (mismo criterio que DES::stringToBitset64).
+     */
+    static uint64_t
+        load64(const unsigned char* p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v = (v << 8) | p[i];
+        }
+        return v;
+    }
+
+    /**
+     * @brief Escribe 8 bytes en orden big-endian (mismo criterio que DES::bitset64ToString).
+     */
+    static void
+        store64(unsigned char* p, uint64_t v) {
+        for (int i = 7; i >= 0; --i) {
+            p[i] = static_cast<unsigned char>(v);
+            v >>= 8;
+        }
+    }
+
+private:
+    /**
+     * @brief Tablas precalculadas de expansión y S-Box+P.
+     */
+    struct Tables {
+        uint64_t expansion[4][256];  ///< Expansión E por byte de la mitad derecha.
+        uint32_t sp[8][64];          ///< S-Box seguida de P por grupo de 6 bits.
+    };
+
+    static const Tables&
+        tables() {
+        static const Tables t = buildTables();
+        return t;
+    }
+
+    static Tables
+        buildTables() {
+        Tables t{};
+        DES ref;
+
+        // La expansión es una copia de bits: basta con expandir cada byte por separado.
+        for (int b = 0; b < 4; ++b) {
+            for (uint32_t v = 0; v < 256; ++v) {
+                std::bitset<32> half(static_cast<unsigned long long>(v) << (8 * b));
+                t.expansion[b][v] = ref.expand(half).to_ullong();
+            }
+        }
+
+        // Cada grupo de 6 bits produce 4 bits de salida; P es lineal, así que se aplica
+        // a la contribución aislada de cada grupo.
+        for (int g = 0; g < 8; ++g) {
+            for (uint32_t v = 0; v < 64; ++v) {
+                std::bitset<48> input(static_cast<unsigned long long>(v) << (6 * g));
+                std::bitset<32> substituted = ref.substitute(input);
+                std::bitset<32> isolated(substituted.to_ullong() & (0xFULL << (4 * g)));
+                t.sp[g][v] = static_cast<uint32_t>(ref.permuteP(isolated).to_ullong());
+            }
+        }
+
+        return t;
+    }
+
+    static inline uint32_t
+        feistel(uint32_t right, uint64_t subkey, const Tables& t) {
+        uint64_t e = t.expansion[0][right & 0xFF]
+            ^ t.expansion[1][(right >> 8) & 0xFF]
+            ^ t.expansion[2][(right >> 16) & 0xFF]
+            ^ t.expansion[3][right >> 24];
+        e ^= subkey;
+
+        return t.sp[0][e & 0x3F]
+            ^ t.sp[1][(e >> 6) & 0x3F]
+            ^ t.sp[2][(e >> 12) & 0x3F]
+            ^ t.sp[3][(e >> 18) & 0x3F]
+            ^ t.sp[4][(e >> 24) & 0x3F]
+            ^ t.sp[5][(e >> 30) & 0x3F]
+            ^ t.sp[6][(e >> 36) & 0x3F]
+            ^ t.sp[7][(e >> 42) & 0x3F];
+    }
+
+    template <size_t N>
+    static void
+        cryptLanes(const uint64_t* in, uint64_t* out, const uint64_t* subkeys, int passes) {
+        const Tables& t = tables();
+        uint32_t left[N];
+        uint32_t right[N];
+
+        for (size_t j = 0; j < N; ++j) {
+            left[j] = static_cast<uint32_t>(in[j] >> 32);
+            right[j] = static_cast<uint32_t>(in[j]);
+        }
+
+        for (int p = 0; p < passes; ++p) {
+            const uint64_t* k = subkeys + p * 16;
+            for (int round = 0; round < 16; ++round) {
+                uint64_t subkey = k[round];
+                // Las N rondas son independientes entre sí: la CPU solapa sus búsquedas.
+                for (size_t j = 0; j < N; ++j) {
+                    uint32_t newRight = left[j] ^ feistel(right[j], subkey, t);
+                    left[j] = right[j];
+                    right[j] = newRight;
+                }
+            }
+            for (size_t j = 0; j < N; ++j) {
+                std::swap(left[j], right[j]);
+            }
+        }
+
+        for (size_t j = 0; j < N; ++j) {
+            out[j] = (static_cast<uint64_t>(left[j]) << 32) | right[j];
+        }
+    }
+
+    template <bool Decrypt>
+    static void
+        underKeys(uint64_t block, const uint64_t* keys, uint64_t* out, size_t count) {
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES) {
+            keyLanes<LANES, Decrypt>(block, keys + i, out + i);
+        }
+        for (; i < count; ++i) {
+            keyLanes<1, Decrypt>(block, keys + i, out + i);
+        }
+    }
+
+    template <size_t N, bool Decrypt>
+    static void
+        keyLanes(uint64_t block, const uint64_t* keys, uint64_t* out) {
+        const Tables& t = tables();
+        uint32_t left[N];
+        uint32_t right[N];
+        for (size_t j = 0; j < N; ++j) {
+            left[j] = static_cast<uint32_t>(block >> 32);
+            right[j] = static_cast<uint32_t>(block);
+        }
+        for (int round = 0; round < 16; ++round) {
+            for (size_t j = 0; j < N; ++j) {
+                int shift = Decrypt ? 15 - round : round;
+                uint32_t newRight = left[j] ^ feistel(right[j], (keys[j] >> shift) & 0xFFFFFFFFFFFFULL, t);
+                left[j] = right[j];
+                right[j] = newRight;
+            }
+        }
+        for (size_t j = 0; j < N; ++j) {
+            out[j] = (static_cast<uint64_t>(right[j]) << 32) | left[j];
+        }
+    }
+};
@@ -0,0 +1,95 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class DESKeySpace
+ * @brief Espacio de claves DES reducido: una clave base con algunos bits desconocidos
+ *        (tablas arcoíris, encuentro a medio camino).
+ *
+ * Los bits de @p mask son los que se buscan (entre 1 y 40); el resto se toma de la clave
+ * base. El índice i ∈ [0, 2^bits) se reparte sobre las posiciones de la máscara con
+ * tablas por byte (equivalente a pdep, sin depender de BMI2).
+ */
+class DESKeySpace {
+public:
+    static constexpr unsigned MAX_BITS = 40;
+
+    DESKeySpace() = default;
+
+    /**
+     * @param base Clave con los bits conocidos (los de la máscara se ignoran).
+     * @param mask Bits desconocidos.
+     * @throws std::invalid_argument Si la máscara está vacía o tiene más de MAX_BITS bits.
+     */
+    DESKeySpace(uint64_t base, uint64_t mask) : m_base(base & ~mask), m_mask(mask) {
+        std::vector<int> positions;
+        for (int bit = 0; bit < 64; ++bit) {
+            if ((mask >> bit) & 1) positions.push_back(bit);
+        }
+        if (positions.empty() || positions.size() > MAX_BITS) {
+            throw std::invalid_argument("El espacio de claves debe tener entre 1 y "
+                + std::to_string(MAX_BITS) + " bits desconocidos.");
+        }
+        m_bits = static_cast<unsigned>(positions.size());
+        for (size_t chunk = 0; chunk < m_scatter.size(); ++chunk) {
+            for (unsigned value = 0; value < 256; ++value) {
+                uint64_t scattered = 0;
+                for (unsigned b = 0; b < 8; ++b) {
+                    size_t index = chunk * 8 + b;
+                    if (((value >> b) & 1) && index < positions.size()) scattered |= 1ULL << positions[index];
+                }
+                m_scatter[chunk][value] = scattered;
+            }
+        }
+    }
+
+    /**
+     * @brief Espacio con los @p unknownBits bits bajos de @p key desconocidos.
+     */
+    static DESKeySpace
+        lowBits(uint64_t key, unsigned unknownBits) {
+        uint64_t mask = unknownBits >= 64 ? ~0ULL : (1ULL << unknownBits) - 1;
+        return DESKeySpace(key, mask);
+    }
+
+    /**
+     * @brief Clave correspondiente al índice @p index.
+     */
+    uint64_t
+        keyAt(uint64_t index) const {
+        uint64_t key = m_base;
+        for (size_t chunk = 0; chunk < m_scatter.size(); ++chunk) {
+            key |= m_scatter[chunk][(index >> (8 * chunk)) & 0xFF];
+        }
+        return key;
+    }
+
+    /**
+     * @brief Índice de una clave del espacio (inversa de keyAt).
+     */
+    uint64_t
+        indexOf(uint64_t key) const {
+        uint64_t index = 0;
+        unsigned out = 0;
+        for (int bit = 0; bit < 64; ++bit) {
+            if ((m_mask >> bit) & 1) index |= ((key >> bit) & 1) << out++;
+        }
+        return index;
+    }
+
+    bool
+        contains(uint64_t key) const {
+        return (key & ~m_mask) == m_base;
+    }
+
+    uint64_t base() const { return m_base; }
+    uint64_t mask() const { return m_mask; }
+    unsigned bits() const { return m_bits; }
+    uint64_t size() const { return 1ULL << m_bits; }
+
+private:
+    uint64_t m_base = 0;
+    uint64_t m_mask = 0;
+    unsigned m_bits = 0;
+    std::array<std::array<uint64_t, 256>, 5> m_scatter{};
+};
@@ -0,0 +1,387 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CesarEncryption.h"
+#include "Vigenere.h"
+#include "DESKernel.h"
+#include <ranges>
+
+/**
+ * @file DecodeViews.h
+ * @brief Vistas de rangos (C++20) que decodifican texto cifrado de forma perezosa.
+ *
+ * A diferencia de CesarEncryption::decode, Vigenere::decode, XOREncoder::encode,
+ * AsciiBinary::binaryToString o DES::bitset64ToString, estas vistas no construyen el
+ * texto plano completo: decodifican bloques de BLOCK_SIZE caracteres a medida que se
+ * itera, de modo que combinadas con std::views::take o std::ranges::find permiten
+ * detenerse tras unos pocos KB.
+ *
+ * Ejemplo:
+ * @code
+ *   auto prefijo = cifrado | decode_views::caesar(4) | std::views::take(64);
+ *   auto vista = cifrado | decode_views::xor_key("clave");
+ *   auto it = std::ranges::find(vista, '\n');
+ * @endcode
+ *
+ * Son rangos de entrada (input_range): se recorren una sola vez. Sus iteradores guardan un
+ * puntero a la vista, así que la vista debe tener nombre y seguir viva mientras se usen;
+ * pasada como temporal, std::ranges::find devuelve std::ranges::dangling.
+ */
+
+/**
+ * @class buffered_decode_view
+ * @brief Vista genérica que rellena un buffer interno con un decodificador por bloques.
+ *
+ * @tparam V       Vista de origen (caracteres o bloques cifrados).
+ * @tparam Decoder Tipo con el método fill(it, end, out, capacidad) que consume elementos
+ *                 de origen y devuelve cuántos caracteres escribió.
+ */
+template <std::ranges::input_range V, class Decoder>
+    requires std::ranges::view<V>
+class buffered_decode_view : public std::ranges::view_interface<buffered_decode_view<V, Decoder>> {
+public:
+    /**
+     * @brief Caracteres decodificados por bloque.
+     */
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(buffered_decode_view* parent) : m_parent(parent) {}
+
+        char
+            operator*() const {
+            return m_parent->m_buffer[m_parent->m_position];
+        }
+
+        iterator&
+            operator++() {
+            m_parent->advance();
+            return *this;
+        }
+
+        void
+            operator++(int) {
+            ++*this;
+        }
+
+        friend bool
+            operator==(const iterator& it, std::default_sentinel_t) {
+            return it.done();
+        }
+
+    private:
+        bool
+            done() const {
+            return m_parent->m_position >= m_parent->m_length;
+        }
+
+        buffered_decode_view* m_parent = nullptr;
+    };
+
+    buffered_decode_view() = default;
+
+    buffered_decode_view(V base, Decoder decoder)
+        : m_base(std::move(base)), m_decoder(std::move(decoder)) {
+    }
+
+    iterator
+        begin() {
+        if (!m_started) {
+            m_started = true;
+            m_current = std::ranges::begin(m_base);
+            refill();
+        }
+        return iterator(this);
+    }
+
+    std::default_sentinel_t
+        end() const noexcept {
+        return std::default_sentinel;
+    }
+
+    /**
+     * @brief Vista de origen.
+     */
+    const V&
+        base() const& {
+        return m_base;
+    }
+
+private:
+    V m_base = V();
+    Decoder m_decoder;
+    std::ranges::iterator_t<V> m_current{};
+    std::array<char, BLOCK_SIZE> m_buffer{};
+    size_t m_position = 0;
+    size_t m_length = 0;
+    bool m_started = false;
+
+    void
+        advance() {
+        if (++m_position >= m_length) {
+            refill();
+        }
+    }
+
+    void
+        refill() {
+        m_position = 0;
+        m_length = 0;
+        auto last = std::ranges::end(m_base);
+        // Un decodificador puede consumir entrada sin producir salida (p. ej. espacios).
+        while (m_length == 0 && m_current != last) {
+            m_length = m_decoder.fill(m_current, last, m_buffer.data(), BLOCK_SIZE);
+        }
+    }
+};
+
+/**
+ * @brief Decodificador César: tabla de 256 entradas generada con CesarEncryption::decode.
+ */
+class CaesarDecoder {
+public:
+    CaesarDecoder() = default;
+
+    explicit CaesarDecoder(int desplazamiento) {
+        CesarEncryption cesar;
+        for (int c = 0; c < 256; ++c) {
+            m_table[c] = cesar.decode(std::string(1, static_cast<char>(c)), desplazamiento)[0];
+        }
+    }
+
+    template <class It, class End>
+    size_t
+        fill(It& it, End last, char* out, size_t capacity) {
+        size_t n = 0;
+        for (; n < capacity && it != last; ++it) {
+            out[n++] = m_table[static_cast<unsigned char>(*it)];
+        }
+        return n;
+    }
+
+private:
+    std::array<char, 256> m_table{};
+};
+
+/**
+ * @brief Decodificador XOR con clave repetida (equivalente a XOREncoder::encode).
+ */
+class XorDecoder {
+public:
+    XorDecoder() = default;
+
+    explicit XorDecoder(std::string key) : m_key(std::move(key)) {
+        if (m_key.empty()) {
+            throw std::invalid_argument("La clave XOR no puede estar vacia.");
+        }
+    }
+
+    template <class It, class End>
+    size_t
+        fill(It& it, End last, char* out, size_t capacity) {
+        size_t n = 0;
+        for (; n < capacity && it != last; ++it) {
+            out[n++] = static_cast<char>(*it ^ m_key[m_index]);
+            if (++m_index == m_key.size()) m_index = 0;
+        }
+        return n;
+    }
+
+private:
+    std::string m_key;
+    size_t m_index = 0;
+};
+
+/**
+ * @brief Decodificador Vigenère (equivalente a Vigenere::decode).
+ */
+class VigenereDecoder {
+public:
+    VigenereDecoder() = default;
+
+    explicit VigenereDecoder(const std::string& key) : m_key(Vigenere::normalizeKey(key)) {
+        if (m_key.empty()) {
+            throw std::invalid_argument("La clave no puede estar vacia o sin letras.");
+        }
+    }
+
+    template <class It, class End>
+    size_t
+        fill(It& it, End last, char* out, size_t capacity) {
+        size_t n = 0;
+        for (; n < capacity && it != last; ++it) {
+            char c = *it;
+            if (std::isalpha(static_cast<unsigned char>(c))) {
+                char base = std::islower(static_cast<unsigned char>(c)) ? 'a' : 'A';
+                int shift = m_key[m_index] - 'A';
+                c = static_cast<char>(((c - base) - shift + 26) % 26 + base);
+                if (++m_index == m_key.size()) m_index = 0;
+            }
+            out[n++] = c;
+        }
+        return n;
+    }
+
+private:
+    std::string m_key;
+    size_t m_index = 0;
+};
+
+/**
+ * @brief Decodificador de texto binario "01000001 01000010 ..." (como AsciiBinary::binaryToString).
+ */
+class BinaryTextDecoder {
+public:
+    template <class It, class End>
+    size_t
+        fill(It& it, End last, char* out, size_t capacity) {
+        size_t n = 0;
+        while (n < capacity && it != last) {
+            char c = *it;
+            ++it;
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                if (m_inToken) {
+                    out[n++] = static_cast<char>(m_value);
+                    m_inToken = false;
+                    m_value = 0;
+                }
+                continue;
+            }
+            m_inToken = true;
+            m_value = m_value * 2 + (c - '0');
+        }
+        if (it == last && m_inToken && n < capacity) {
+            out[n++] = static_cast<char>(m_value);
+            m_inToken = false;
+        }
+        return n;
+    }
+
+private:
+    int m_value = 0;
+    bool m_inToken = false;
+};
+
+/**
+ * @brief Descifra bloques DES (std::bitset<64> o uint64_t) y emite sus 8 bytes.
+ *
+ * Usa DESKernel, por lo que el resultado coincide con DES::decode seguido de
+ * DES::bitset64ToString, y descifra varios bloques intercalados por relleno.
+ */
+class DESDecoder {
+public:
+    DESDecoder() = default;
+
+    explicit DESDecoder(const std::bitset<64>& key)
+        : m_keys(DESKernel::reverse(DESKernel::makeSchedule(key))) {
+    }
+
+    template <class It, class End>
+    size_t
+        fill(It& it, End last, char* out, size_t capacity) {
+        uint64_t blocks[64];
+        size_t count = 0;
+        for (; count < 64 && count * 8 + 8 <= capacity && it != last; ++it) {
+            blocks[count++] = toWord(*it);
+        }
+        DESKernel::cryptBlocks(blocks, blocks, count, m_keys.data());
+        for (size_t i = 0; i < count; ++i) {
+            DESKernel::store64(reinterpret_cast<unsigned char*>(out + 8 * i), blocks[i]);
+        }
+        return count * 8;
+    }
+
+private:
+    DESKernel::Schedule m_keys{};
+
+    static uint64_t
+        toWord(const std::bitset<64>& bits) {
+        return bits.to_ullong();
+    }
+
+    static uint64_t
+        toWord(uint64_t bits) {
+        return bits;
+    }
+};
+
+template <class V>
+using caesar_decode_view = buffered_decode_view<V, CaesarDecoder>;
+
+template <class V>
+using xor_view = buffered_decode_view<V, XorDecoder>;
+
+template <class V>
+using vigenere_view = buffered_decode_view<V, VigenereDecoder>;
+
+template <class V>
+using binary_text_view = buffered_decode_view<V, BinaryTextDecoder>;
+
+template <class V>
+using des_decode_view = buffered_decode_view<V, DESDecoder>;
+
+/**
+ * @brief Adaptadores para componer las vistas con el operador |.
+ */
+namespace decode_views {
+
+    /**
+     * @brief Cierre de adaptador: guarda el decodificador hasta recibir el rango.
+     */
+    template <class Decoder>
+    struct adaptor {
+        Decoder decoder;
+
+        template <std::ranges::viewable_range R>
+        friend auto
+            operator|(R&& range, adaptor self) {
+            using View = std::views::all_t<R>;
+            return buffered_decode_view<View, Decoder>(std::views::all(std::forward<R>(range)), std::move(self.decoder));
+        }
+    };
+
+    /**
+     * @brief Vista César que descifra con el desplazamiento dado.
+     */
+    inline adaptor<CaesarDecoder>
+        caesar(int desplazamiento) {
+        return { CaesarDecoder(desplazamiento) };
+    }
+
+    /**
+     * @brief Vista XOR con clave repetida.
+     */
+    inline adaptor<XorDecoder>
+        xor_key(const std::string& key) {
+        return { XorDecoder(key) };
+    }
+
+    /**
+     * @brief Vista Vigenère que descifra con la clave dada.
+     */
+    inline adaptor<VigenereDecoder>
+        vigenere(const std::string& key) {
+        return { VigenereDecoder(key) };
+    }
+
+    /**
+     * @brief Vista que convierte texto binario separado por espacios en caracteres.
+     */
+    inline adaptor<BinaryTextDecoder>
+        binary_text() {
+        return { BinaryTextDecoder() };
+    }
+
+    /**
+     * @brief Vista que descifra bloques DES y emite texto.
+     */
+    inline adaptor<DESDecoder>
+        des(const std::bitset<64>& key) {
+        return { DESDecoder(key) };
+    }
+}
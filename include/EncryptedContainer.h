@@ -0,0 +1,442 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "AES.h"
+#include "SHA256.h"
+#include "CRC32C.h"
+#include "MappedFile.h"
+
+/**
+ * @class EncryptedContainer
+ * @brief Define el formato en disco de un contenedor cifrado por bloques (chunks).
+ *
+ * Estructura del archivo:
+ *
+ *     [Cabecera 64 B][chunk 0][chunk 1]...[chunk N-1][Índice N x 24 B][Pie 32 B]
+ *
+ * - Cabecera: magic "TTCCHNK1", versión, cifrador, tamaño de chunk, identificador
+ *   del programa de claves (8 bytes de HMAC(clave)) y nonce base de 16 bytes.
+ * - Cada chunk se cifra con AES-CTR empezando en el contador (nonce base + desplazamiento),
+ *   así que puede descifrarse sin tocar los demás.
+ * - Índice: por chunk, posición en el archivo, desplazamiento del contador CTR,
+ *   longitud y CRC-32C del texto cifrado.
+ * - Pie: posición del índice, número de chunks, tamaño del texto plano y CRC del índice.
+ *
+ * El lector (EncryptedContainerReader) proyecta el archivo con MappedFile y localiza
+ * cualquier byte con una división, por lo que leer el byte N no requiere descifrar
+ * los anteriores.
+ */
+class EncryptedContainer {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t CIPHER_AES_CTR = 1;
+    static constexpr uint32_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t ENTRY_SIZE = 24;
+    static constexpr size_t FOOTER_SIZE = 32;
+
+    /**
+     * @brief Entrada del índice de chunks.
+     */
+    struct ChunkEntry {
+        uint64_t offset = 0;   ///< Posición del chunk en el archivo.
+        uint64_t counter = 0;  ///< Desplazamiento del contador CTR (en bloques de 16 bytes).
+        uint32_t length = 0;   ///< Longitud del chunk en bytes.
+        uint32_t crc = 0;      ///< CRC-32C del texto cifrado.
+    };
+
+    /**
+     * @brief Identificador del programa de claves: permite detectar una clave incorrecta
+     *        sin revelar la clave.
+     */
+    static std::array<uint8_t, 8>
+        keyScheduleId(const std::vector<uint8_t>& key) {
+        static const std::string label = "TheTribalChief key schedule id";
+        std::vector<uint8_t> mac = HMACSHA256(key).compute(std::vector<uint8_t>(label.begin(), label.end()));
+        std::array<uint8_t, 8> id{};
+        std::copy(mac.begin(), mac.begin() + 8, id.begin());
+        return id;
+    }
+
+    /**
+     * @brief Bloque contador = nonce base + desplazamiento (aritmética big-endian de 128 bits).
+     */
+    static void
+        counterBlock(const uint8_t* baseNonce, uint64_t offset, uint8_t* out) {
+        uint64_t carry = offset;
+        for (int i = 15; i >= 0; --i) {
+            uint64_t sum = static_cast<uint64_t>(baseNonce[i]) + (carry & 0xFF);
+            out[i] = static_cast<uint8_t>(sum);
+            carry = (carry >> 8) + (sum >> 8);
+        }
+    }
+
+    static void
+        put32(uint8_t* p, uint32_t v) {
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    static void
+        put64(uint8_t* p, uint64_t v) {
+        for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    static uint32_t
+        get32(const uint8_t* p) {
+        uint32_t v = 0;
+        for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+
+    static uint64_t
+        get64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+};
+
+/**
+ * @class EncryptedContainerWriter
+ * @brief Escribe un contenedor cifrado de forma incremental, chunk a chunk.
+ *
+ * Los datos se acumulan hasta completar un chunk, que se cifra y se escribe
+ * inmediatamente; el índice y el pie se escriben en finish().
+ */
+class EncryptedContainerWriter {
+public:
+    /**
+     * @brief Crea el archivo y escribe la cabecera.
+     *
+     * @param path      Ruta del contenedor.
+     * @param key       Clave AES (16, 24 o 32 bytes).
+     * @param baseNonce Nonce base de 16 bytes (p. ej. CryptoGenerator::generateIV(16)).
+     * @param chunkSize Tamaño de chunk en bytes (múltiplo de 16).
+     * @throws std::invalid_argument Si los parámetros no son válidos.
+     * @throws std::runtime_error Si el archivo no se puede crear.
+     */
+    EncryptedContainerWriter(const std::string& path, const std::vector<uint8_t>& key,
+        const std::vector<uint8_t>& baseNonce,
+        uint32_t chunkSize = EncryptedContainer::DEFAULT_CHUNK_SIZE)
+        : m_aes(key), m_chunkSize(chunkSize) {
+        if (chunkSize == 0 || chunkSize % AES::BLOCK_SIZE != 0) {
+            throw std::invalid_argument("El tamano de chunk debe ser multiplo de 16.");
+        }
+        if (baseNonce.size() != AES::BLOCK_SIZE) {
+            throw std::invalid_argument("El nonce base debe tener 16 bytes.");
+        }
+        std::copy(baseNonce.begin(), baseNonce.end(), m_baseNonce.begin());
+
+        m_out.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_out) {
+            throw std::runtime_error("No se pudo crear el contenedor: " + path);
+        }
+
+        uint8_t header[EncryptedContainer::HEADER_SIZE] = {};
+        std::memcpy(header, "TTCCHNK1", 8);
+        EncryptedContainer::put32(header + 8, EncryptedContainer::VERSION);
+        EncryptedContainer::put32(header + 12, EncryptedContainer::CIPHER_AES_CTR);
+        EncryptedContainer::put32(header + 16, chunkSize);
+        auto id = EncryptedContainer::keyScheduleId(key);
+        std::memcpy(header + 24, id.data(), id.size());
+        std::memcpy(header + 32, m_baseNonce.data(), m_baseNonce.size());
+        m_out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        m_position = sizeof(header);
+        m_buffer.reserve(chunkSize);
+    }
+
+    /**
+     * @brief Cierra el contenedor si no se llamó a finish().
+     */
+    ~EncryptedContainerWriter() {
+        try {
+            finish();
+        }
+        catch (...) {
+        }
+    }
+
+    /**
+     * @brief Añade datos al contenedor.
+     */
+    void
+        write(const uint8_t* data, size_t length) {
+        while (length > 0) {
+            size_t take = m_chunkSize - m_buffer.size();
+            if (take > length) take = length;
+            m_buffer.insert(m_buffer.end(), data, data + take);
+            data += take;
+            length -= take;
+            if (m_buffer.size() == m_chunkSize) {
+                flushChunk();
+            }
+        }
+    }
+
+    /**
+     * @brief Añade una cadena al contenedor.
+     */
+    void
+        write(const std::string& data) {
+        write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    /**
+     * @brief Escribe el último chunk, el índice y el pie.
+     */
+    void
+        finish() {
+        if (m_finished) return;
+        m_finished = true;
+        if (!m_buffer.empty()) {
+            flushChunk();
+        }
+
+        std::vector<uint8_t> index(m_entries.size() * EncryptedContainer::ENTRY_SIZE);
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            uint8_t* p = index.data() + i * EncryptedContainer::ENTRY_SIZE;
+            EncryptedContainer::put64(p, m_entries[i].offset);
+            EncryptedContainer::put64(p + 8, m_entries[i].counter);
+            EncryptedContainer::put32(p + 16, m_entries[i].length);
+            EncryptedContainer::put32(p + 20, m_entries[i].crc);
+        }
+
+        uint8_t footer[EncryptedContainer::FOOTER_SIZE] = {};
+        EncryptedContainer::put64(footer, m_position);
+        EncryptedContainer::put64(footer + 8, m_entries.size());
+        EncryptedContainer::put64(footer + 16, m_plainSize);
+        EncryptedContainer::put32(footer + 24, CRC32C::compute(index.data(), index.size()));
+        std::memcpy(footer + 28, "TIDX", 4);
+
+        m_out.write(reinterpret_cast<const char*>(index.data()), index.size());
+        m_out.write(reinterpret_cast<const char*>(footer), sizeof(footer));
+        m_out.close();
+        if (m_out.fail()) {
+            throw std::runtime_error("Error al escribir el contenedor.");
+        }
+    }
+
+private:
+    AES m_aes;
+    uint32_t m_chunkSize;
+    std::array<uint8_t, 16> m_baseNonce{};
+    std::ofstream m_out;
+    std::vector<uint8_t> m_buffer;
+    std::vector<EncryptedContainer::ChunkEntry> m_entries;
+    uint64_t m_position = 0;
+    uint64_t m_plainSize = 0;
+    bool m_finished = false;
+
+    void
+        flushChunk() {
+        EncryptedContainer::ChunkEntry entry;
+        entry.offset = m_position;
+        entry.counter = static_cast<uint64_t>(m_entries.size()) * (m_chunkSize / AES::BLOCK_SIZE);
+        entry.length = static_cast<uint32_t>(m_buffer.size());
+
+        uint8_t iv[AES::BLOCK_SIZE];
+        EncryptedContainer::counterBlock(m_baseNonce.data(), entry.counter, iv);
+        m_aes.cryptCTR(m_buffer.data(), m_buffer.data(), m_buffer.size(), iv);
+        entry.crc = CRC32C::compute(m_buffer.data(), m_buffer.size());
+
+        m_out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        m_position += m_buffer.size();
+        m_plainSize += m_buffer.size();
+        m_entries.push_back(entry);
+        m_buffer.clear();
+    }
+};
+
+/**
+ * @class EncryptedContainerReader
+ * @brief Lee un contenedor cifrado con acceso aleatorio mediante mmap.
+ *
+ * Sólo se verifican y descifran los chunks que cubren el rango pedido; dentro de un
+ * chunk, CTR permite empezar a descifrar en el bloque de 16 bytes que contiene el
+ * primer byte solicitado.
+ */
+class EncryptedContainerReader {
+public:
+    /**
+     * @brief Abre el contenedor, valida cabecera, pie, índice y clave.
+     *
+     * @param path Ruta del contenedor.
+     * @param key  Clave AES usada al escribirlo.
+     * @throws std::runtime_error Si el formato es inválido o la clave no coincide.
+     */
+    EncryptedContainerReader(const std::string& path, const std::vector<uint8_t>& key)
+        : m_file(path), m_aes(key) {
+        const uint8_t* base = m_file.data();
+        size_t size = m_file.size();
+        if (size < EncryptedContainer::HEADER_SIZE + EncryptedContainer::FOOTER_SIZE
+            || std::memcmp(base, "TTCCHNK1", 8) != 0) {
+            throw std::runtime_error("El archivo no es un contenedor valido.");
+        }
+        if (EncryptedContainer::get32(base + 8) != EncryptedContainer::VERSION
+            || EncryptedContainer::get32(base + 12) != EncryptedContainer::CIPHER_AES_CTR) {
+            throw std::runtime_error("Version o cifrador de contenedor no soportado.");
+        }
+        auto id = EncryptedContainer::keyScheduleId(key);
+        if (std::memcmp(base + 24, id.data(), id.size()) != 0) {
+            throw std::runtime_error("La clave no corresponde a este contenedor.");
+        }
+        m_chunkSize = EncryptedContainer::get32(base + 16);
+        if (m_chunkSize == 0 || m_chunkSize % AES::BLOCK_SIZE != 0) {
+            throw std::runtime_error("Tamano de chunk de contenedor invalido.");
+        }
+        std::memcpy(m_baseNonce.data(), base + 32, m_baseNonce.size());
+
+        const uint8_t* footer = base + size - EncryptedContainer::FOOTER_SIZE;
+        if (std::memcmp(footer + 28, "TIDX", 4) != 0) {
+            throw std::runtime_error("Pie de contenedor invalido.");
+        }
+        uint64_t indexOffset = EncryptedContainer::get64(footer);
+        uint64_t count = EncryptedContainer::get64(footer + 8);
+        m_plainSize = EncryptedContainer::get64(footer + 16);
+        // Límites del índice sin desbordamientos: [indexOffset, size - FOOTER_SIZE)
+        uint64_t dataEnd = size - EncryptedContainer::FOOTER_SIZE;
+        if (indexOffset < EncryptedContainer::HEADER_SIZE || indexOffset > dataEnd
+            || count > (dataEnd - indexOffset) / EncryptedContainer::ENTRY_SIZE
+            || indexOffset + count * EncryptedContainer::ENTRY_SIZE != dataEnd) {
+            throw std::runtime_error("Indice de contenedor truncado.");
+        }
+        const uint8_t* index = base + indexOffset;
+        if (CRC32C::compute(index, count * EncryptedContainer::ENTRY_SIZE) != EncryptedContainer::get32(footer + 24)) {
+            throw std::runtime_error("El indice del contenedor esta corrupto.");
+        }
+
+        // El pie no entra en el CRC del índice: se contrasta con las entradas, que deben
+        // describir chunks completos y consecutivos (solo el último puede ser más corto).
+        uint64_t plainSize = 0;
+        m_entries.resize(static_cast<size_t>(count));
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* p = index + i * EncryptedContainer::ENTRY_SIZE;
+            EncryptedContainer::ChunkEntry& entry = m_entries[i];
+            entry.offset = EncryptedContainer::get64(p);
+            entry.counter = EncryptedContainer::get64(p + 8);
+            entry.length = EncryptedContainer::get32(p + 16);
+            entry.crc = EncryptedContainer::get32(p + 20);
+            if (entry.offset < EncryptedContainer::HEADER_SIZE || entry.offset > indexOffset
+                || entry.length > indexOffset - entry.offset) {
+                throw std::runtime_error("Entrada de indice fuera de rango.");
+            }
+            bool last = i + 1 == count;
+            if (entry.length == 0 || entry.length > m_chunkSize || (!last && entry.length != m_chunkSize)
+                || entry.counter != static_cast<uint64_t>(i) * (m_chunkSize / AES::BLOCK_SIZE)) {
+                throw std::runtime_error("Entrada de indice inconsistente.");
+            }
+            plainSize += entry.length;
+        }
+        if (plainSize != m_plainSize) {
+            throw std::runtime_error("El tamano del pie no coincide con el indice.");
+        }
+    }
+
+    ~EncryptedContainerReader() = default;
+
+    /**
+     * @brief Tamaño del texto plano completo.
+     */
+    uint64_t
+        size() const {
+        return m_plainSize;
+    }
+
+    /**
+     * @brief Número de chunks.
+     */
+    size_t
+        chunkCount() const {
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Tamaño nominal de chunk.
+     */
+    uint32_t
+        chunkSize() const {
+        return m_chunkSize;
+    }
+
+    /**
+     * @brief Lee y descifra un rango arbitrario del texto plano.
+     *
+     * @param offset Posición en el texto plano.
+     * @param out    Buffer de salida.
+     * @param length Bytes a leer.
+     * @param verify Verificar el CRC-32C de cada chunk tocado.
+     * @return size_t Bytes leídos (menos que @p length si se alcanza el final).
+     * @throws std::runtime_error Si un chunk no supera la verificación.
+     */
+    size_t
+        read(uint64_t offset, uint8_t* out, size_t length, bool verify = true) const {
+        if (offset >= m_plainSize) return 0;
+        if (length > m_plainSize - offset) length = static_cast<size_t>(m_plainSize - offset);
+
+        size_t done = 0;
+        while (done < length) {
+            uint64_t position = offset + done;
+            size_t chunk = static_cast<size_t>(position / m_chunkSize);
+            size_t inChunk = static_cast<size_t>(position % m_chunkSize);
+            const EncryptedContainer::ChunkEntry& entry = m_entries[chunk];
+            size_t n = entry.length - inChunk;
+            if (n > length - done) n = length - done;
+
+            const uint8_t* cipher = m_file.data() + entry.offset;
+            if (verify && CRC32C::compute(cipher, entry.length) != entry.crc) {
+                throw std::runtime_error("CRC invalido en el chunk " + std::to_string(chunk));
+            }
+            decryptRange(entry, cipher, inChunk, out + done, n);
+            done += n;
+        }
+        return done;
+    }
+
+    /**
+     * @brief Lee y descifra un chunk completo.
+     */
+    std::vector<uint8_t>
+        readChunk(size_t index, bool verify = true) const {
+        if (index >= m_entries.size()) {
+            throw std::out_of_range("Chunk fuera de rango.");
+        }
+        std::vector<uint8_t> out(m_entries[index].length);
+        read(static_cast<uint64_t>(index) * m_chunkSize, out.data(), out.size(), verify);
+        return out;
+    }
+
+private:
+    MappedFile m_file;
+    AES m_aes;
+    uint32_t m_chunkSize = 0;
+    uint64_t m_plainSize = 0;
+    std::array<uint8_t, 16> m_baseNonce{};
+    std::vector<EncryptedContainer::ChunkEntry> m_entries;
+
+    void
+        decryptRange(const EncryptedContainer::ChunkEntry& entry, const uint8_t* cipher,
+            size_t inChunk, uint8_t* out, size_t length) const {
+        size_t block = inChunk / AES::BLOCK_SIZE;
+        size_t skip = inChunk % AES::BLOCK_SIZE;
+        uint8_t iv[AES::BLOCK_SIZE];
+        EncryptedContainer::counterBlock(m_baseNonce.data(), entry.counter + block, iv);
+
+        const uint8_t* src = cipher + block * AES::BLOCK_SIZE;
+        if (skip != 0) {
+            // Primer bloque parcial: se descifra completo y se copia sólo la parte pedida.
+            uint8_t tmp[AES::BLOCK_SIZE] = {};
+            size_t avail = entry.length - block * AES::BLOCK_SIZE;
+            if (avail > AES::BLOCK_SIZE) avail = AES::BLOCK_SIZE;
+            m_aes.cryptCTR(src, tmp, avail, iv);
+            size_t n = avail - skip;
+            if (n > length) n = length;
+            std::memcpy(out, tmp + skip, n);
+            out += n;
+            length -= n;
+            src += AES::BLOCK_SIZE;
+            EncryptedContainer::counterBlock(m_baseNonce.data(), entry.counter + block + 1, iv);
+        }
+        if (length > 0) {
+            m_aes.cryptCTR(src, out, length, iv);
+        }
+    }
+};
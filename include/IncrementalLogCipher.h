@@ -0,0 +1,429 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "AES.h"
+#include "TripleDES.h"
+#include "CRC32C.h"
+#include "EncryptedContainer.h"
+
+#include <filesystem>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Cifrador de flujo usado por IncrementalLogCipher.
+ *
+ * Los tres son posicionales: el byte N del log se cifra con el byte N del flujo de clave,
+ * que se puede calcular sin procesar los anteriores.
+ */
+enum class LogCipherKind : uint32_t {
+    Xor = 1,            ///< Clave repetida, como XOREncoder::encode.
+    AesCtr = 2,         ///< AES-CTR con contador = nonce + desplazamiento / 16.
+    TripleDesCtr = 3    ///< 3DES-CTR con contador = nonce (64 bits) + desplazamiento / 8.
+};
+
+/**
+ * @class LogKeystream
+ * @brief Flujo de clave de un LogCipherKind aplicable a partir de cualquier desplazamiento.
+ */
+class LogKeystream {
+public:
+    /**
+     * @throws std::invalid_argument Si la clave no es válida para el cifrador.
+     */
+    LogKeystream(LogCipherKind kind, const std::vector<uint8_t>& key, const std::array<uint8_t, 16>& nonce)
+        : m_kind(kind), m_key(key), m_nonce(nonce) {
+        switch (kind) {
+        case LogCipherKind::Xor:
+            if (key.empty()) {
+                throw std::invalid_argument("La clave XOR no puede estar vacia.");
+            }
+            break;
+        case LogCipherKind::AesCtr:
+            m_aes = std::make_unique<AES>(key);
+            break;
+        case LogCipherKind::TripleDesCtr:
+            if (key.size() != 24) {
+                throw std::invalid_argument("La clave 3DES debe tener 24 bytes.");
+            }
+            m_tripleDes = std::make_unique<TripleDES>(std::bitset<64>(load64(key.data())),
+                std::bitset<64>(load64(key.data() + 8)), std::bitset<64>(load64(key.data() + 16)));
+            break;
+        default:
+            throw std::invalid_argument("Cifrador de log desconocido.");
+        }
+    }
+
+    /**
+     * @brief Cifra (o descifra) en el sitio @p length bytes que están en la posición
+     *        @p offset del log.
+     */
+    void
+        apply(uint8_t* data, size_t length, uint64_t offset) const {
+        switch (m_kind) {
+        case LogCipherKind::Xor: {
+            size_t k = static_cast<size_t>(offset % m_key.size());
+            for (size_t i = 0; i < length; ++i) {
+                data[i] ^= m_key[k];
+                if (++k == m_key.size()) k = 0;
+            }
+            break;
+        }
+        case LogCipherKind::AesCtr: {
+            uint64_t block = offset / AES::BLOCK_SIZE;
+            size_t skip = static_cast<size_t>(offset % AES::BLOCK_SIZE);
+            uint8_t iv[AES::BLOCK_SIZE];
+            if (skip != 0 && length > 0) {
+                // Bloque parcial: se descarta el principio del flujo de clave
+                uint8_t tmp[AES::BLOCK_SIZE] = {};
+                size_t n = std::min(length, AES::BLOCK_SIZE - skip);
+                std::memcpy(tmp + skip, data, n);
+                EncryptedContainer::counterBlock(m_nonce.data(), block, iv);
+                m_aes->cryptCTR(tmp, tmp, AES::BLOCK_SIZE, iv);
+                std::memcpy(data, tmp + skip, n);
+                data += n;
+                length -= n;
+                ++block;
+            }
+            if (length > 0) {
+                EncryptedContainer::counterBlock(m_nonce.data(), block, iv);
+                m_aes->cryptCTR(data, data, length, iv);
+            }
+            break;
+        }
+        case LogCipherKind::TripleDesCtr: {
+            size_t skip = static_cast<size_t>(offset % TripleDES::BLOCK_SIZE);
+            uint64_t counter = load64(m_nonce.data()) + offset / TripleDES::BLOCK_SIZE;
+            std::string input(skip + length, '\0');
+            std::memcpy(&input[skip], data, length);
+            std::string output = m_tripleDes->cryptCTR(input, counter);
+            std::memcpy(data, output.data() + skip, length);
+            break;
+        }
+        }
+    }
+
+private:
+    LogCipherKind m_kind;
+    std::vector<uint8_t> m_key;
+    std::array<uint8_t, 16> m_nonce;
+    std::unique_ptr<AES> m_aes;
+    std::unique_ptr<TripleDES> m_tripleDes;
+
+    static uint64_t
+        load64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+        return v;
+    }
+};
+
+/**
+ * @class IncrementalLogCipher
+ * @brief Cifra un log que solo crece, procesando únicamente los bytes añadidos desde la
+ *        última sincronización.
+ *
+ * El estado se guarda en un fichero lateral de 64 bytes (<salida>.state):
+ *
+ *     [magic "TTCLOGS1"][versión][cifrador][id del programa de claves 8 B][nonce 16 B]
+ *     [posición 8 B][sincronizaciones 8 B][CRC-32C de lo anterior][reservado]
+ *
+ * La posición es el número de bytes del log ya cifrados (y la longitud válida de la
+ * salida). El identificador del programa de claves (EncryptedContainer::keyScheduleId)
+ * permite rechazar una clave distinta sin guardarla. Cada sincronización añade el texto
+ * cifrado a la salida y después reescribe el estado (fichero temporal + rename); si el
+ * proceso muere entre ambos pasos, la siguiente sincronización recorta la salida a la
+ * posición guardada y vuelve a cifrar esa parte, así que nunca queda texto duplicado.
+ */
+class IncrementalLogCipher {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t STATE_SIZE = 64;
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief Resultado de una sincronización.
+     */
+    struct SyncStats {
+        uint64_t bytes = 0;         ///< Bytes nuevos cifrados.
+        uint64_t position = 0;      ///< Posición tras la sincronización.
+        bool recovered = false;     ///< Se recortó una salida que iba por delante del estado.
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Abre (o crea) el estado de cifrado incremental de @p sourcePath hacia @p outputPath.
+     *
+     * Si no existe el fichero de estado, se empieza desde la posición 0 con un nonce nuevo
+     * y la salida se vacía.
+     *
+     * @throws std::invalid_argument Si la clave o el cifrador no coinciden con el estado guardado.
+     * @throws std::runtime_error Si el estado está dañado o no se puede escribir.
+     */
+    IncrementalLogCipher(const std::string& sourcePath, const std::string& outputPath,
+        LogCipherKind kind, const std::vector<uint8_t>& key)
+        : m_source(sourcePath), m_output(outputPath), m_statePath(statePath(outputPath)) {
+        if (std::filesystem::exists(m_statePath)) {
+            m_state = loadState(m_statePath);
+            if (m_state.kind != kind) {
+                throw std::invalid_argument("El cifrador no coincide con el del estado guardado.");
+            }
+            if (m_state.keyId != EncryptedContainer::keyScheduleId(key)) {
+                throw std::invalid_argument("La clave no coincide con la del estado guardado.");
+            }
+        }
+        else {
+            m_state.kind = kind;
+            m_state.keyId = EncryptedContainer::keyScheduleId(key);
+            m_state.nonce = randomNonce();
+            std::ofstream(m_output, std::ios::binary | std::ios::trunc);
+            saveState();
+        }
+        m_keystream = std::make_unique<LogKeystream>(kind, key, m_state.nonce);
+        m_buffer.resize(CHUNK_SIZE);
+    }
+
+    /**
+     * @brief Ruta del fichero de estado asociado a una salida.
+     */
+    static std::string
+        statePath(const std::string& outputPath) {
+        return outputPath + ".state";
+    }
+
+    /**
+     * @brief Bytes del log ya cifrados.
+     */
+    uint64_t
+        position() const {
+        return m_state.position;
+    }
+
+    /**
+     * @brief Cifra los bytes añadidos al log desde la última sincronización.
+     *
+     * El coste es proporcional a los bytes nuevos: el log se abre en la posición guardada
+     * y la salida se abre en modo de añadir. Si no hay bytes nuevos no se escribe nada.
+     *
+     * @throws std::runtime_error Si el log es más corto que la posición (truncado o rotado)
+     *         o si falla la lectura o la escritura.
+     */
+    SyncStats
+        sync() {
+        auto start = std::chrono::steady_clock::now();
+        SyncStats stats;
+
+        std::error_code error;
+        uint64_t sourceSize = std::filesystem::file_size(m_source, error);
+        if (error) {
+            throw std::runtime_error("No se pudo leer el log: " + m_source);
+        }
+        if (sourceSize < m_state.position) {
+            throw std::runtime_error("El log es mas corto que la posicion guardada (truncado o rotado): " + m_source);
+        }
+
+        uint64_t outputSize = std::filesystem::file_size(m_output, error);
+        if (error || outputSize < m_state.position) {
+            throw std::runtime_error("La salida cifrada esta incompleta: " + m_output);
+        }
+        if (outputSize > m_state.position) {
+            std::filesystem::resize_file(m_output, m_state.position);
+            stats.recovered = true;
+        }
+
+        if (sourceSize > m_state.position) {
+            std::ifstream in(m_source, std::ios::binary);
+            std::ofstream out(m_output, std::ios::binary | std::ios::app);
+            if (!in || !out) {
+                throw std::runtime_error("No se pudo abrir el log o la salida.");
+            }
+            in.seekg(static_cast<std::streamoff>(m_state.position));
+
+            uint64_t offset = m_state.position;
+            while (offset < sourceSize) {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, sourceSize - offset));
+                in.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(n));
+                if (static_cast<size_t>(in.gcount()) != n) {
+                    throw std::runtime_error("Lectura incompleta del log: " + m_source);
+                }
+                m_keystream->apply(m_buffer.data(), n, offset);
+                out.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(n));
+                offset += n;
+            }
+            out.flush();
+            if (!out) {
+                throw std::runtime_error("No se pudo escribir la salida cifrada: " + m_output);
+            }
+
+            stats.bytes = offset - m_state.position;
+            m_state.position = offset;
+            ++m_state.syncs;
+            saveState();
+        }
+
+        stats.position = m_state.position;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    /**
+     * @brief Sigue el log y cifra lo que se le añada hasta que @p stop sea true o el log se
+     *        mueva o borre.
+     *
+     * En Linux espera eventos de inotify (IN_MODIFY/IN_CLOSE_WRITE); @p interval solo
+     * acota cuánto tarda en notar @p stop. En otros sistemas, o si inotify no está
+     * disponible, comprueba el tamaño cada @p interval.
+     *
+     * @param onSync Se llama tras cada sincronización que cifró algo.
+     * @return uint64_t Bytes cifrados en total.
+     */
+    uint64_t
+        follow(const std::atomic<bool>& stop,
+            const std::function<void(const SyncStats&)>& onSync = {},
+            std::chrono::milliseconds interval = std::chrono::milliseconds(200)) {
+        uint64_t total = 0;
+        auto step = [&]() {
+            SyncStats stats = sync();
+            total += stats.bytes;
+            if (stats.bytes > 0 && onSync) onSync(stats);
+        };
+        step();
+
+#if defined(__linux__)
+        // El descriptor se cierra aunque sync() lance una excepción
+        struct Inotify {
+            int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            ~Inotify() {
+                if (fd >= 0) ::close(fd);
+            }
+        } watch;
+        int fd = watch.fd;
+        if (fd >= 0 && inotify_add_watch(fd, m_source.c_str(),
+            IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF) >= 0) {
+            alignas(inotify_event) char events[4096];
+            bool gone = false;
+            while (!stop.load() && !gone) {
+                pollfd p{ fd, POLLIN, 0 };
+                if (poll(&p, 1, static_cast<int>(interval.count())) <= 0) {
+                    continue;
+                }
+                ssize_t n;
+                while ((n = read(fd, events, sizeof(events))) > 0) {
+                    for (char* e = events; e < events + n; e += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(e)->len) {
+                        if (reinterpret_cast<inotify_event*>(e)->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) gone = true;
+                    }
+                }
+                if (!gone) step();
+            }
+            return total;
+        }
+#endif
+        while (!stop.load()) {
+            std::this_thread::sleep_for(interval);
+            if (!std::filesystem::exists(m_source)) break;
+            step();
+        }
+        return total;
+    }
+
+    /**
+     * @brief Descifra la parte válida de una salida con su fichero de estado.
+     *
+     * @throws std::invalid_argument Si la clave no coincide.
+     * @throws std::runtime_error Si el estado o la salida no se pueden leer.
+     */
+    static std::vector<uint8_t>
+        readPlaintext(const std::string& outputPath, const std::vector<uint8_t>& key) {
+        State state = loadState(statePath(outputPath));
+        if (state.keyId != EncryptedContainer::keyScheduleId(key)) {
+            throw std::invalid_argument("La clave no coincide con la del estado guardado.");
+        }
+        std::ifstream in(outputPath, std::ios::binary);
+        std::vector<uint8_t> data(static_cast<size_t>(state.position));
+        in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (static_cast<size_t>(in.gcount()) != data.size()) {
+            throw std::runtime_error("La salida cifrada esta incompleta: " + outputPath);
+        }
+        LogKeystream(state.kind, key, state.nonce).apply(data.data(), data.size(), 0);
+        return data;
+    }
+
+private:
+    struct State {
+        LogCipherKind kind = LogCipherKind::Xor;
+        std::array<uint8_t, 8> keyId{};
+        std::array<uint8_t, 16> nonce{};
+        uint64_t position = 0;
+        uint64_t syncs = 0;
+    };
+
+    std::string m_source;
+    std::string m_output;
+    std::string m_statePath;
+    State m_state;
+    std::unique_ptr<LogKeystream> m_keystream;
+    std::vector<uint8_t> m_buffer;
+
+    /**
+     * @brief Nonce de 128 bits tomado entero del generador del sistema.
+     *
+     * No se usa CryptoGenerator: su mt19937 parte de una sola semilla de 32 bits, así que
+     * solo daría 2^32 nonces distintos y, con la misma clave, se repetiría el flujo de clave
+     * tras unos 2^16 logs.
+     */
+    static std::array<uint8_t, 16>
+        randomNonce() {
+        std::random_device device;
+        std::array<uint8_t, 16> nonce{};
+        for (size_t i = 0; i < nonce.size(); i += 4) {
+            uint32_t word = device();
+            std::memcpy(nonce.data() + i, &word, 4);
+        }
+        return nonce;
+    }
+
+    static State
+        loadState(const std::string& path) {
+        uint8_t raw[STATE_SIZE];
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(raw), STATE_SIZE);
+        if (in.gcount() != static_cast<std::streamsize>(STATE_SIZE) || std::memcmp(raw, "TTCLOGS1", 8) != 0
+            || EncryptedContainer::get32(raw + 8) != VERSION
+            || EncryptedContainer::get32(raw + 56) != CRC32C::compute(raw, 56)) {
+            throw std::runtime_error("Fichero de estado no valido: " + path);
+        }
+        State state;
+        state.kind = static_cast<LogCipherKind>(EncryptedContainer::get32(raw + 12));
+        std::memcpy(state.keyId.data(), raw + 16, 8);
+        std::memcpy(state.nonce.data(), raw + 24, 16);
+        state.position = EncryptedContainer::get64(raw + 40);
+        state.syncs = EncryptedContainer::get64(raw + 48);
+        return state;
+    }
+
+    void
+        saveState() const {
+        uint8_t raw[STATE_SIZE] = {};
+        std::memcpy(raw, "TTCLOGS1", 8);
+        EncryptedContainer::put32(raw + 8, VERSION);
+        EncryptedContainer::put32(raw + 12, static_cast<uint32_t>(m_state.kind));
+        std::memcpy(raw + 16, m_state.keyId.data(), 8);
+        std::memcpy(raw + 24, m_state.nonce.data(), 16);
+        EncryptedContainer::put64(raw + 40, m_state.position);
+        EncryptedContainer::put64(raw + 48, m_state.syncs);
+        EncryptedContainer::put32(raw + 56, CRC32C::compute(raw, 56));
+
+        std::string temporary = m_statePath + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(raw), STATE_SIZE);
+            if (!out) {
+                throw std::runtime_error("No se pudo escribir el estado: " + temporary);
+            }
+        }
+        std::filesystem::rename(temporary, m_statePath);
+    }
+};
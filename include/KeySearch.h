@@ -0,0 +1,315 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "ResultSink.h"
+#include "ScratchArena.h"
+
+/**
+ * @brief Parámetros de una búsqueda de claves.
+ */
+struct KeySearchOptions {
+    std::string attack = "busqueda";        ///< Nombre con el que se entregan los candidatos.
+    double minScore = -std::numeric_limits<double>::infinity();  ///< Se entregan los de puntuación mayor.
+    unsigned threads = 1;                   ///< 0 = uno por núcleo.
+    uint64_t chunk = 4096;                  ///< Candidatos que toma cada hilo de una vez.
+};
+
+/**
+ * @brief Resultado de una búsqueda de claves.
+ */
+struct KeySearchStats {
+    uint64_t candidates = 0;        ///< Claves probadas.
+    uint64_t decoded = 0;           ///< Claves que el descifrador no descartó.
+    uint64_t pushed = 0;            ///< Candidatos entregados al sumidero.
+    uint64_t arenaBlocks = 0;       ///< Bloques que pidieron al montón las arenas de los hilos.
+    double seconds = 0.0;
+    double candidatesPerSecond = 0.0;
+};
+
+/**
+ * @class KeySearch
+ * @brief Búsqueda de claves genérica: generador × descifrador × puntuador → sumidero.
+ *
+ * - Generador: size() claves indexadas; key(i, arena) escribe la clave i en la arena y
+ *   label(clave, arena) da su forma legible (solo se pide para los candidatos entregados).
+ * - Descifrador: decoder(clave, arena, texto) -> bool; escribe el texto en la arena y puede
+ *   devolver false para descartar la clave sin puntuarla (p. ej. un byte no imprimible).
+ * - Puntuador: scorer(texto) -> double; mayor es mejor.
+ * - Sumidero: cualquier ResultSink (TopKSink, JsonLinesSink, NullSink...).
+ *
+ * Cada hilo usa su ScratchArena y la vacía antes de cada candidato, así que, calentadas las
+ * arenas, el bucle interior no reserva memoria (salvo lo que haga el sumidero al guardar).
+ * Con un hilo la búsqueda se ejecuta en el hilo que llama y en orden de índice, de modo
+ * que los empates se resuelven a favor de la primera clave, como en los bucles originales.
+ */
+template <typename Generator, typename Decoder, typename Scorer>
+class KeySearch {
+public:
+    KeySearch(Generator generator, Decoder decoder, Scorer scorer)
+        : m_generator(std::move(generator)), m_decoder(std::move(decoder)), m_scorer(std::move(scorer)) {
+    }
+
+    /**
+     * @brief Prueba todas las claves del generador.
+     */
+    KeySearchStats
+        run(ResultSink& sink, const KeySearchOptions& options = KeySearchOptions()) const {
+        auto start = std::chrono::steady_clock::now();
+        const uint64_t total = m_generator.size();
+        const uint64_t chunk = std::max<uint64_t>(1, options.chunk);
+        unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<uint64_t>(threads, (total + chunk - 1) / chunk));
+
+        std::atomic<uint64_t> next{ 0 };
+        std::mutex statsMutex;
+        KeySearchStats stats;
+
+        auto worker = [&]() {
+            ScratchArena& arena = ScratchArena::local();
+            uint64_t blocksBefore = arena.blockAllocations();
+            KeySearchStats local;
+            for (;;) {
+                uint64_t first = next.fetch_add(chunk);
+                if (first >= total) break;
+                uint64_t last = std::min(total, first + chunk);
+                for (uint64_t index = first; index < last; ++index) {
+                    arena.reset();
+                    std::string_view key = m_generator.key(index, arena);
+                    std::string_view text;
+                    if (!m_decoder(key, arena, text)) {
+                        continue;
+                    }
+                    ++local.decoded;
+                    double score = m_scorer(text);
+                    if (score > options.minScore) {
+                        ++local.pushed;
+                        sink.push(options.attack, m_generator.label(key, arena), text, score);
+                    }
+                }
+                local.candidates += last - first;
+            }
+            arena.reset();
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.candidates += local.candidates;
+            stats.decoded += local.decoded;
+            stats.pushed += local.pushed;
+            stats.arenaBlocks += arena.blockAllocations() - blocksBefore;
+        };
+
+        if (threads <= 1) {
+            worker();
+        }
+        else {
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker);
+            for (std::thread& thread : pool) thread.join();
+        }
+        sink.flush();
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.candidatesPerSecond = stats.seconds > 0 ? stats.candidates / stats.seconds : 0.0;
+        return stats;
+    }
+
+private:
+    Generator m_generator;
+    Decoder m_decoder;
+    Scorer m_scorer;
+};
+
+// ================= Generadores =================
+
+/**
+ * @class ByteKeyGenerator
+ * @brief Todas las claves de N bytes (1 a 4); la clave i es i en big-endian, así que el
+ *        orden es el de los bucles anidados de bruteForce_2Byte.
+ */
+class ByteKeyGenerator {
+public:
+    /**
+     * @throws std::invalid_argument Si @p bytes no está entre 1 y 4.
+     */
+    explicit ByteKeyGenerator(unsigned bytes) : m_bytes(bytes) {
+        if (bytes < 1 || bytes > 4) {
+            throw std::invalid_argument("Las claves de bytes deben tener entre 1 y 4 bytes.");
+        }
+    }
+
+    uint64_t
+        size() const {
+        return uint64_t(1) << (8 * m_bytes);
+    }
+
+    std::string_view
+        key(uint64_t index, ScratchArena& arena) const {
+        char* key = arena.allocate<char>(m_bytes);
+        for (unsigned i = 0; i < m_bytes; ++i) {
+            key[i] = static_cast<char>(index >> (8 * (m_bytes - 1 - i)));
+        }
+        return std::string_view(key, m_bytes);
+    }
+
+    /**
+     * @brief "0x" seguido de los bytes en hexadecimal.
+     */
+    std::string_view
+        label(std::string_view key, ScratchArena& arena) const {
+        static const char HEX[] = "0123456789abcdef";
+        char* text = arena.allocate<char>(2 + 2 * key.size());
+        text[0] = '0';
+        text[1] = 'x';
+        for (size_t i = 0; i < key.size(); ++i) {
+            unsigned char byte = static_cast<unsigned char>(key[i]);
+            text[2 + 2 * i] = HEX[byte >> 4];
+            text[3 + 2 * i] = HEX[byte & 0x0F];
+        }
+        return std::string_view(text, 2 + 2 * key.size());
+    }
+
+private:
+    unsigned m_bytes;
+};
+
+/**
+ * @class WordListGenerator
+ * @brief Claves de una lista (ataque por diccionario).
+ */
+class WordListGenerator {
+public:
+    explicit WordListGenerator(std::vector<std::string> words) : m_words(std::move(words)) {
+    }
+
+    uint64_t
+        size() const {
+        return m_words.size();
+    }
+
+    std::string_view
+        key(uint64_t index, ScratchArena&) const {
+        return m_words[static_cast<size_t>(index)];
+    }
+
+    std::string_view
+        label(std::string_view key, ScratchArena&) const {
+        return key;
+    }
+
+private:
+    std::vector<std::string> m_words;
+};
+
+/**
+ * @class LetterKeyGenerator
+ * @brief Todas las claves de 1 a maxLength letras, por longitud y después en orden
+ *        alfabético (el recorrido de breakEncode: "A".."Z", "AA".."ZZ", ...).
+ */
+class LetterKeyGenerator {
+public:
+    /**
+     * @throws std::invalid_argument Si no hay letras o el espacio no cabe en 64 bits.
+     */
+    explicit LetterKeyGenerator(unsigned maxLength, std::string letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ")
+        : m_maxLength(maxLength), m_letters(std::move(letters)) {
+        if (m_letters.empty()) {
+            throw std::invalid_argument("Claves de letras: hace falta al menos una letra.");
+        }
+        uint64_t count = 1;
+        for (unsigned length = 1; length <= maxLength; ++length) {
+            if (count > std::numeric_limits<uint64_t>::max() / m_letters.size() / 2) {
+                throw std::invalid_argument("El espacio de claves de letras no cabe en 64 bits.");
+            }
+            count *= m_letters.size();
+            m_size += count;
+        }
+    }
+
+    uint64_t
+        size() const {
+        return m_size;
+    }
+
+    std::string_view
+        key(uint64_t index, ScratchArena& arena) const {
+        // Longitud: se descuentan los bloques de claves más cortas
+        unsigned length = 1;
+        uint64_t count = m_letters.size();
+        while (index >= count) {
+            index -= count;
+            count *= m_letters.size();
+            ++length;
+        }
+        char* key = arena.allocate<char>(length);
+        for (unsigned i = length; i-- > 0;) {
+            key[i] = m_letters[static_cast<size_t>(index % m_letters.size())];
+            index /= m_letters.size();
+        }
+        return std::string_view(key, length);
+    }
+
+    std::string_view
+        label(std::string_view key, ScratchArena&) const {
+        return key;
+    }
+
+private:
+    unsigned m_maxLength;
+    std::string m_letters;
+    uint64_t m_size = 0;
+};
+
+// ================= Descifradores y puntuadores =================
+
+/**
+ * @class RepeatingXorDecoder
+ * @brief XOR con clave repetida (XOREncoder::encode). Con printableOnly descarta la clave en
+ *        el primer byte que no sea imprimible ni espacio (criterio de XOREncoder::isValidText).
+ */
+class RepeatingXorDecoder {
+public:
+    explicit RepeatingXorDecoder(std::vector<unsigned char> ciphertext, bool printableOnly = true)
+        : m_ciphertext(std::move(ciphertext)), m_printableOnly(printableOnly) {
+    }
+
+    bool
+        operator()(std::string_view key, ScratchArena& arena, std::string_view& text) const {
+        static const std::array<bool, 256> printable = [] {
+            std::array<bool, 256> t{};
+            for (int c = 0; c < 256; ++c) t[c] = std::isprint(c) || std::isspace(c);
+            return t;
+            }();
+
+        if (key.empty()) {
+            return false;
+        }
+        char* out = arena.allocate<char>(m_ciphertext.size());
+        size_t k = 0;
+        for (size_t i = 0; i < m_ciphertext.size(); ++i) {
+            unsigned char p = static_cast<unsigned char>(m_ciphertext[i] ^ static_cast<unsigned char>(key[k]));
+            if (++k == key.size()) k = 0;
+            if (m_printableOnly && !printable[p]) {
+                return false;
+            }
+            out[i] = static_cast<char>(p);
+        }
+        text = std::string_view(out, m_ciphertext.size());
+        return true;
+    }
+
+private:
+    std::vector<unsigned char> m_ciphertext;
+    bool m_printableOnly;
+};
+
+/**
+ * @brief Fracción de letras y espacios del texto (0 si está vacío).
+ */
+struct LetterRatioScorer {
+    double
+        operator()(std::string_view text) const {
+        if (text.empty()) return 0.0;
+        size_t letters = 0;
+        for (char c : text) {
+            letters += (std::isalpha(static_cast<unsigned char>(c)) || c == ' ') ? 1 : 0;
+        }
+        return static_cast<double>(letters) / text.size();
+    }
+};
@@ -0,0 +1,290 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "AES.h"
+#include "TripleDES.h"
+#include <condition_variable>
+
+/**
+ * @class AesCtrKeystream
+ * @brief Genera el flujo de clave AES-CTR (mismo contador que AES::cryptCTR).
+ */
+class AesCtrKeystream {
+public:
+    static constexpr size_t BLOCK_SIZE = AES::BLOCK_SIZE;
+
+    /**
+     * @param aes Cifrador con la clave de la sesión.
+     * @param iv  Contador inicial de 16 bytes (big-endian).
+     */
+    AesCtrKeystream(const AES& aes, const uint8_t* iv) : m_aes(aes) {
+        std::memcpy(m_counter, iv, BLOCK_SIZE);
+    }
+
+    /**
+     * @brief Escribe los siguientes bytes de flujo (múltiplo de BLOCK_SIZE) y avanza el contador.
+     */
+    void
+        generate(uint8_t* out, size_t length) {
+        std::memset(out, 0, length);
+        m_aes.cryptCTR(out, out, length, m_counter);
+        uint64_t carry = length / BLOCK_SIZE;
+        for (int i = BLOCK_SIZE - 1; i >= 0 && carry; --i) {
+            uint64_t sum = m_counter[i] + (carry & 0xFF);
+            m_counter[i] = static_cast<uint8_t>(sum);
+            carry = (carry >> 8) + (sum >> 8);
+        }
+    }
+
+private:
+    AES m_aes;
+    uint8_t m_counter[BLOCK_SIZE];
+};
+
+/**
+ * @class DesCtrKeystream
+ * @brief Genera el flujo de clave 3DES-CTR (mismo contador que TripleDES::cryptCTR).
+ *
+ * Para DES simple basta con TripleDES(k, k, k).
+ */
+class DesCtrKeystream {
+public:
+    static constexpr size_t BLOCK_SIZE = TripleDES::BLOCK_SIZE;
+
+    DesCtrKeystream(const TripleDES& cipher, uint64_t iv) : m_cipher(cipher), m_counter(iv) {
+    }
+
+    /**
+     * @brief Escribe los siguientes bytes de flujo (múltiplo de BLOCK_SIZE) y avanza el contador.
+     */
+    void
+        generate(uint8_t* out, size_t length) {
+        uint64_t counters[BATCH];
+        uint64_t stream[BATCH];
+        for (size_t offset = 0; offset < length; offset += BATCH * BLOCK_SIZE) {
+            size_t count = (length - offset) / BLOCK_SIZE;
+            if (count > BATCH) count = BATCH;
+            for (size_t j = 0; j < count; ++j) {
+                counters[j] = m_counter++;
+            }
+            m_cipher.encodeBlocks(counters, stream, count);
+            for (size_t j = 0; j < count; ++j) {
+                DESKernel::store64(out + offset + j * BLOCK_SIZE, stream[j]);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t BATCH = 64;
+
+    TripleDES m_cipher;
+    uint64_t m_counter;
+};
+
+/**
+ * @class KeystreamPrefetcher
+ * @brief Anillo de flujo de clave CTR que un hilo de fondo mantiene lleno.
+ *
+ * El flujo CTR sólo depende de la clave y del contador, así que puede calcularse antes
+ * de que llegue el mensaje. Un hilo productor rellena el anillo por trozos de
+ * REFILL_CHUNK bytes con los núcleos por lotes (AES-NI de 8 bloques o DES intercalado);
+ * crypt() en el hilo llamador sólo hace XOR contra bytes ya calculados.
+ *
+ * Un único hilo consumidor por sesión. Si el anillo se vacía, crypt() espera al
+ * productor y cuenta una parada (stall): stats() permite dimensionar el anillo.
+ *
+ * @tparam Keystream AesCtrKeystream o DesCtrKeystream.
+ */
+template <class Keystream>
+class KeystreamPrefetcher {
+public:
+    /**
+     * @brief Bytes que genera el productor en cada iteración.
+     */
+    static constexpr size_t REFILL_CHUNK = 4096;
+
+    /**
+     * @brief Estado del anillo para dimensionarlo.
+     */
+    struct Stats {
+        size_t capacity = 0;         ///< Tamaño del anillo en bytes.
+        size_t fill = 0;             ///< Bytes de flujo disponibles ahora.
+        size_t lowWatermark = 0;     ///< Mínimo de bytes disponibles visto al consumir.
+        uint64_t produced = 0;       ///< Bytes generados en total.
+        uint64_t consumed = 0;       ///< Bytes consumidos en total.
+        uint64_t stalls = 0;         ///< Veces que crypt() encontró el anillo vacío.
+        uint64_t stallNanoseconds = 0;  ///< Tiempo total esperando al productor.
+    };
+
+    /**
+     * @param keystream Generador con la clave y el contador inicial.
+     * @param capacity  Tamaño del anillo (se redondea a múltiplo de REFILL_CHUNK, mínimo 2).
+     */
+    explicit KeystreamPrefetcher(Keystream keystream, size_t capacity = 256 * 1024)
+        : m_keystream(std::move(keystream)) {
+        size_t chunks = (capacity + REFILL_CHUNK - 1) / REFILL_CHUNK;
+        m_ring.assign((chunks < 2 ? 2 : chunks) * REFILL_CHUNK, 0);
+        m_lowWatermark = m_ring.size();
+        m_worker = std::thread([this] { produce(); });
+    }
+
+    ~KeystreamPrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_spaceAvailable.notify_all();
+        m_worker.join();
+        volatile uint8_t* p = m_ring.data();
+        for (size_t i = 0; i < m_ring.size(); ++i) p[i] = 0;
+    }
+
+    KeystreamPrefetcher(const KeystreamPrefetcher&) = delete;
+    KeystreamPrefetcher& operator=(const KeystreamPrefetcher&) = delete;
+
+    /**
+     * @brief Cifra o descifra (CTR es simétrico) consumiendo el flujo precalculado.
+     *
+     * @param in     Datos de entrada.
+     * @param out    Destino (puede coincidir con in).
+     * @param length Longitud en bytes.
+     */
+    void
+        crypt(const uint8_t* in, uint8_t* out, size_t length) {
+        const size_t capacity = m_ring.size();
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        while (length > 0) {
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            if (head == tail) {
+                head = waitForData(tail);
+            }
+            size_t available = static_cast<size_t>(head - tail);
+            if (available < m_lowWatermark) m_lowWatermark = available;
+
+            size_t position = static_cast<size_t>(tail % capacity);
+            size_t n = length;
+            if (n > available) n = available;
+            if (n > capacity - position) n = capacity - position;
+
+            const uint8_t* key = m_ring.data() + position;
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = in[i] ^ key[i];
+            }
+            in += n;
+            out += n;
+            length -= n;
+            tail += n;
+            // seq_cst en ambos lados: el productor publica m_producerWaiting y luego lee
+            // m_tail; sin orden total uno de los dos podría no ver al otro y dormir.
+            // Se despierta al productor sólo al bajar de la mitad, para que rellene en
+            // ráfagas y no cueste un cambio de contexto por mensaje.
+            m_tail.store(tail);
+            if (m_producerWaiting.load() && head - tail <= capacity / 2) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_spaceAvailable.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief Versión para std::string.
+     */
+    std::string
+        crypt(const std::string& input) {
+        std::string output(input.size(), '\0');
+        crypt(reinterpret_cast<const uint8_t*>(input.data()), reinterpret_cast<uint8_t*>(&output[0]), input.size());
+        return output;
+    }
+
+    /**
+     * @brief Bytes de flujo disponibles en este momento.
+     */
+    size_t
+        fillLevel() const {
+        return static_cast<size_t>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Veces que el consumidor tuvo que esperar al productor.
+     */
+    uint64_t
+        stallCount() const {
+        return m_stalls.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Instantánea de las estadísticas (llamar desde el hilo consumidor).
+     */
+    Stats
+        stats() const {
+        Stats s;
+        s.capacity = m_ring.size();
+        s.produced = m_head.load(std::memory_order_acquire);
+        s.consumed = m_tail.load(std::memory_order_acquire);
+        s.fill = static_cast<size_t>(s.produced - s.consumed);
+        s.lowWatermark = m_lowWatermark;
+        s.stalls = m_stalls.load(std::memory_order_relaxed);
+        s.stallNanoseconds = m_stallNanoseconds.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /**
+     * @brief Espera a que el anillo esté lleno (útil antes de medir o al abrir la sesión).
+     */
+    void
+        waitUntilFull() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_dataAvailable.wait(lock, [this] {
+            return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire) == m_ring.size();
+            });
+    }
+
+private:
+    Keystream m_keystream;
+    std::vector<uint8_t> m_ring;
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_dataAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::atomic<uint64_t> m_head{ 0 };  ///< Bytes producidos (sólo escribe el productor).
+    std::atomic<uint64_t> m_tail{ 0 };  ///< Bytes consumidos (sólo escribe el consumidor).
+    std::atomic<bool> m_producerWaiting{ false };
+    std::atomic<uint64_t> m_stalls{ 0 };
+    std::atomic<uint64_t> m_stallNanoseconds{ 0 };
+    size_t m_lowWatermark = 0;
+    bool m_running = true;
+
+    void
+        produce() {
+        const size_t capacity = m_ring.size();
+        uint64_t head = 0;
+        while (true) {
+            if (head - m_tail.load(std::memory_order_acquire) + REFILL_CHUNK > capacity) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_producerWaiting.store(true);
+                m_spaceAvailable.wait(lock, [&] {
+                    return !m_running || head - m_tail.load() <= capacity / 2;
+                    });
+                m_producerWaiting.store(false, std::memory_order_relaxed);
+                if (!m_running) return;
+            }
+            m_keystream.generate(m_ring.data() + head % capacity, REFILL_CHUNK);
+            head += REFILL_CHUNK;
+            m_head.store(head, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_dataAvailable.notify_all();
+            }
+        }
+    }
+
+    uint64_t
+        waitForData(uint64_t tail) {
+        auto start = std::chrono::steady_clock::now();
+        m_stalls.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_dataAvailable.wait(lock, [&] { return m_head.load(std::memory_order_acquire) != tail; });
+        m_stallNanoseconds.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+        return m_head.load(std::memory_order_acquire);
+    }
+};
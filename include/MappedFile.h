@@ -0,0 +1,165 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class MappedFile
+ * @brief Proyecta un archivo en memoria de sólo lectura (mmap / MapViewOfFile).
+ *
+ * Permite acceder a cualquier posición del archivo sin leerlo completo: el sistema
+ * operativo sólo carga las páginas que realmente se tocan.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Abre y proyecta el archivo indicado.
+     *
+     * @param path Ruta del archivo.
+     * @throws std::runtime_error Si el archivo no se puede abrir o proyectar.
+     */
+    explicit MappedFile(const std::string& path) {
+        open(path);
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile&
+        operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            m_data = other.m_data;
+            m_size = other.m_size;
+#if defined(_WIN32)
+            m_file = other.m_file;
+            m_mapping = other.m_mapping;
+            other.m_file = INVALID_HANDLE_VALUE;
+            other.m_mapping = nullptr;
+#endif
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Proyecta un archivo (cierra el anterior si lo había).
+     */
+    void
+        open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("No se pudo abrir el archivo: " + path);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_file, &size);
+        m_size = static_cast<size_t>(size.QuadPart);
+        if (m_size > 0) {
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            m_data = m_mapping ? static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+            if (!m_data) {
+                close();
+                throw std::runtime_error("No se pudo proyectar el archivo: " + path);
+            }
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("No se pudo abrir el archivo: " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("No se pudo leer el tamano del archivo: " + path);
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size > 0) {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                m_size = 0;
+                throw std::runtime_error("No se pudo proyectar el archivo: " + path);
+            }
+            m_data = static_cast<const uint8_t*>(p);
+        }
+        ::close(fd);  // La proyección sigue siendo válida tras cerrar el descriptor.
+#endif
+    }
+
+    /**
+     * @brief Libera la proyección.
+     */
+    void
+        close() {
+#if defined(_WIN32)
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    /**
+     * @brief Puntero al inicio del archivo proyectado (nullptr si está vacío).
+     */
+    const uint8_t*
+        data() const {
+        return m_data;
+    }
+
+    /**
+     * @brief Tamaño del archivo en bytes.
+     */
+    size_t
+        size() const {
+        return m_size;
+    }
+
+    /**
+     * @brief Indica si hay un archivo abierto.
+     */
+    bool
+        isOpen() const {
+        return m_data != nullptr;
+    }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+};
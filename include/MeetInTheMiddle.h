@@ -0,0 +1,436 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include "DESKernel.h"
+#include "DESKeySpace.h"
+
+/**
+ * @class MeetInTheMiddle
+ * @brief Ataque de encuentro a medio camino contra doble DES: C = E_k2(E_k1(P)).
+ *
+ * 1. Cifra P con todas las claves k1 del primer subespacio y guarda los valores intermedios
+ *    en una tabla hash particionada por los bits altos del valor: cada partición es una
+ *    tabla de direccionamiento abierto de unos miles de entradas, que cabe en caché.
+ * 2. Descifra C con todas las claves k2 del segundo subespacio en paralelo y busca cada
+ *    resultado en su partición (con prefetch por lotes).
+ * 3. Cada coincidencia se comprueba con los demás pares conocidos. Con un solo par pueden
+ *    salir falsos positivos si el espacio conjunto supera los 2^64 bloques posibles.
+ *
+ * Si la tabla no cabe en el presupuesto de memoria, el paso 1 se vuelca a disco en series
+ * ordenadas por valor intermedio y el ataque se hace en varias pasadas, cada una con un
+ * rango de valores intermedios: cada pasada lee de forma secuencial su tramo de cada serie
+ * y vuelve a descifrar con todas las k2 (cuesta N2 descifrados más por pasada).
+ */
+class MeetInTheMiddle {
+public:
+    /**
+     * @brief Memoria estimada por clave k1 en una pasada: entrada (16 bytes) más tabla con
+     *        carga entre 1/3 y 2/3 (hasta 48 bytes).
+     */
+    static constexpr size_t BYTES_PER_KEY = 64;
+
+    /**
+     * @brief Par texto claro / cifrado conocido.
+     */
+    struct KnownPair {
+        uint64_t plaintext = 0;
+        uint64_t ciphertext = 0;
+    };
+
+    /**
+     * @brief Parámetros del ataque.
+     */
+    struct Options {
+        size_t memoryBudget = size_t(1) << 30;  ///< Bytes para la tabla de una pasada.
+        unsigned threads = 0;                   ///< 0 = hardware_concurrency.
+        std::string spillDirectory;             ///< Directorio de las series (vacío = std::tmpfile).
+        size_t maxSolutions = 64;
+    };
+
+    /**
+     * @brief Pareja de claves que cumple todos los pares conocidos.
+     */
+    struct Solution {
+        uint64_t key1 = 0;
+        uint64_t key2 = 0;
+    };
+
+    /**
+     * @brief Resumen del último ataque.
+     */
+    struct Stats {
+        uint64_t forwardEncryptions = 0;   ///< Cifrados con k1.
+        uint64_t backwardDecryptions = 0;  ///< Descifrados con k2 (todas las pasadas).
+        uint64_t collisions = 0;           ///< Coincidencias con el primer par.
+        uint64_t solutions = 0;            ///< Coincidencias que cumplen todos los pares.
+        unsigned passes = 0;
+        unsigned spillRuns = 0;            ///< Series volcadas a disco (0 si todo cupo en memoria).
+        uint64_t spilledBytes = 0;
+        double seconds = 0.0;
+        double candidatePairsPerSecond = 0.0;  ///< Parejas (k1, k2) cubiertas por segundo.
+    };
+
+    /**
+     * @param space1 Subespacio de la primera clave (la que cifra primero).
+     * @param space2 Subespacio de la segunda clave.
+     */
+    MeetInTheMiddle(const DESKeySpace& space1, const DESKeySpace& space2) : m_space1(space1), m_space2(space2) {
+    }
+
+    ~MeetInTheMiddle() = default;
+
+    /**
+     * @brief Ataque con las opciones por defecto.
+     */
+    std::vector<Solution>
+        attack(const std::vector<KnownPair>& pairs) {
+        return attack(pairs, Options());
+    }
+
+    /**
+     * @brief Busca todas las parejas (k1, k2) de los subespacios que cumplen los pares.
+     *
+     * @throws std::invalid_argument Si no hay pares o el presupuesto de memoria es nulo.
+     * @throws std::runtime_error Si no se pueden crear o leer las series en disco.
+     */
+    std::vector<Solution>
+        attack(const std::vector<KnownPair>& pairs, const Options& options) {
+        if (pairs.empty()) {
+            throw std::invalid_argument("El ataque necesita al menos un par texto claro / cifrado.");
+        }
+        if (options.memoryBudget < BYTES_PER_KEY) {
+            throw std::invalid_argument("El presupuesto de memoria es demasiado pequeno.");
+        }
+        auto start = std::chrono::steady_clock::now();
+        m_stats = Stats();
+        m_pairs = pairs;
+        m_threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        m_maxSolutions = options.maxSolutions;
+        m_solutions.clear();
+
+        const uint64_t keys1 = m_space1.size();
+        const uint64_t budgetKeys = std::max<uint64_t>(options.memoryBudget / BYTES_PER_KEY, 1);
+        const unsigned passes = static_cast<unsigned>((keys1 + budgetKeys - 1) / budgetKeys);
+        m_stats.passes = passes;
+
+        if (passes == 1) {
+            std::vector<Entry> entries(keys1);
+            forward(0, keys1, entries.data());
+            buildTable(entries);
+            entries = std::vector<Entry>();
+            backward(0, ~0ULL, true);
+        }
+        else {
+            attackWithSpill(passes, options);
+        }
+
+        m_stats.solutions = m_solutions.size();
+        m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        m_stats.candidatePairsPerSecond = static_cast<double>(keys1) * static_cast<double>(m_space2.size()) / m_stats.seconds;
+        std::sort(m_solutions.begin(), m_solutions.end(), [](const Solution& a, const Solution& b) {
+            return a.key1 != b.key1 ? a.key1 < b.key1 : a.key2 < b.key2;
+            });
+        if (m_solutions.size() > m_maxSolutions) m_solutions.resize(m_maxSolutions);
+        m_table = Table();
+        return m_solutions;
+    }
+
+    const Stats&
+        stats() const {
+        return m_stats;
+    }
+
+    /**
+     * @brief Doble DES de un bloque: E_k2(E_k1(block)).
+     */
+    static uint64_t
+        encrypt(uint64_t block, uint64_t key1, uint64_t key2) {
+        DESKernel::encryptUnderKeys(block, &key1, &block, 1);
+        DESKernel::encryptUnderKeys(block, &key2, &block, 1);
+        return block;
+    }
+
+private:
+    static constexpr uint64_t EMPTY = ~0ULL;
+    static constexpr size_t BATCH = 4096;
+    static constexpr uint64_t PARTITION_ENTRIES = 4096;
+
+    /**
+     * @brief Valor intermedio E_k1(P) y el índice de k1 en su subespacio.
+     */
+    struct Entry {
+        uint64_t middle;
+        uint64_t index;
+    };
+
+    /**
+     * @brief Tabla hash particionada: 2^bits particiones de capacidad potencia de dos.
+     */
+    struct Table {
+        unsigned bits = 0;
+        std::vector<uint64_t> offset;   ///< Primer hueco de cada partición.
+        std::vector<uint64_t> mask;     ///< Capacidad - 1 de cada partición.
+        std::vector<Entry> slots;
+    };
+
+    DESKeySpace m_space1;
+    DESKeySpace m_space2;
+    std::vector<KnownPair> m_pairs;
+    unsigned m_threads = 1;
+    size_t m_maxSolutions = 0;
+    Table m_table;
+    std::vector<Solution> m_solutions;
+    std::mutex m_mutex;
+    Stats m_stats;
+
+    /**
+     * @brief Ejecuta fn(first, count) sobre lotes de [begin, end) repartidos entre los hilos.
+     */
+    template <typename Fn>
+    void
+        parallelBatches(uint64_t begin, uint64_t end, Fn&& fn) {
+        std::atomic<uint64_t> next{ begin };
+        auto worker = [&]() {
+            for (;;) {
+                uint64_t first = next.fetch_add(BATCH);
+                if (first >= end) break;
+                fn(first, static_cast<size_t>(std::min<uint64_t>(BATCH, end - first)));
+            }
+        };
+        if (m_threads == 1) {
+            worker();
+            return;
+        }
+        std::vector<std::thread> pool;
+        for (unsigned id = 0; id < m_threads; ++id) pool.emplace_back(worker);
+        for (std::thread& t : pool) t.join();
+    }
+
+    /**
+     * @brief Cifra el primer texto claro con las k1 de [begin, end) y deja las entradas en @p out.
+     */
+    void
+        forward(uint64_t begin, uint64_t end, Entry* out) {
+        const uint64_t plaintext = m_pairs[0].plaintext;
+        parallelBatches(begin, end, [&](uint64_t first, size_t count) {
+            std::vector<uint64_t> keys(count), middle(count);
+            for (size_t i = 0; i < count; ++i) keys[i] = m_space1.keyAt(first + i);
+            DESKernel::encryptUnderKeys(plaintext, keys.data(), middle.data(), count);
+            Entry* dst = out + (first - begin);
+            for (size_t i = 0; i < count; ++i) dst[i] = { middle[i], first + i };
+            });
+        m_stats.forwardEncryptions += end - begin;
+    }
+
+    uint64_t
+        partitionOf(uint64_t middle) const {
+        return m_table.bits ? middle >> (64 - m_table.bits) : 0;
+    }
+
+    static void
+        prefetch(const Entry* slot) {
+#if TTC_X86
+        _mm_prefetch(reinterpret_cast<const char*>(slot), _MM_HINT_T0);
+#else
+        (void)slot;
+#endif
+    }
+
+    static uint64_t
+        slotHash(uint64_t middle) {
+        return middle * 0x9E3779B97F4A7C15ULL >> 20;
+    }
+
+    /**
+     * @brief Reparte las entradas en particiones y las inserta (sondeo lineal).
+     *
+     * Cada hilo se queda con un rango de particiones: recorre todas las entradas, pero sólo
+     * escribe en su zona de la tabla.
+     */
+    void
+        buildTable(const std::vector<Entry>& entries) {
+        Table& t = m_table;
+        t = Table();
+        while (t.bits < 24 && (entries.size() >> t.bits) > PARTITION_ENTRIES) ++t.bits;
+        const uint64_t partitions = 1ULL << t.bits;
+        std::vector<uint64_t> counts(partitions, 0);
+        for (const Entry& e : entries) ++counts[partitionOf(e.middle)];
+        t.offset.resize(partitions + 1);
+        t.mask.resize(partitions);
+        uint64_t total = 0;
+        for (uint64_t p = 0; p < partitions; ++p) {
+            uint64_t capacity = 4;
+            while (capacity < counts[p] + counts[p] / 2) capacity <<= 1;
+            t.offset[p] = total;
+            t.mask[p] = capacity - 1;
+            total += capacity;
+        }
+        t.offset[partitions] = total;
+        t.slots.assign(total, Entry{ 0, EMPTY });
+
+        const unsigned threads = static_cast<unsigned>(std::min<uint64_t>(m_threads, partitions));
+        auto worker = [&](unsigned id) {
+            uint64_t low = partitions * id / threads;
+            uint64_t high = partitions * (id + 1) / threads;
+            for (const Entry& e : entries) {
+                uint64_t p = partitionOf(e.middle);
+                if (p < low || p >= high) continue;
+                Entry* slots = t.slots.data() + t.offset[p];
+                uint64_t slot = slotHash(e.middle) & t.mask[p];
+                while (slots[slot].index != EMPTY) slot = (slot + 1) & t.mask[p];
+                slots[slot] = e;
+            }
+        };
+        if (threads == 1) {
+            worker(0);
+        }
+        else {
+            std::vector<std::thread> pool;
+            for (unsigned id = 0; id < threads; ++id) pool.emplace_back(worker, id);
+            for (std::thread& th : pool) th.join();
+        }
+    }
+
+    /**
+     * @brief Descifra el primer cifrado con todas las k2 y busca los valores de [low, high]
+     *        en la tabla; verifica las coincidencias con el resto de pares.
+     */
+    void
+        backward(uint64_t low, uint64_t high, bool inclusiveHigh) {
+        const uint64_t ciphertext = m_pairs[0].ciphertext;
+        std::atomic<uint64_t> collisions{ 0 };
+        parallelBatches(0, m_space2.size(), [&](uint64_t first, size_t count) {
+            std::vector<uint64_t> keys(count), middle(count);
+            std::vector<const Entry*> bucket(count);
+            for (size_t i = 0; i < count; ++i) keys[i] = m_space2.keyAt(first + i);
+            DESKernel::decryptUnderKeys(ciphertext, keys.data(), middle.data(), count);
+
+            // Primero se calculan (y se piden a memoria) todos los huecos del lote.
+            size_t n = 0;
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t m = middle[i];
+                if (m < low || (inclusiveHigh ? m > high : m >= high)) continue;
+                uint64_t p = partitionOf(m);
+                const Entry* slot = m_table.slots.data() + m_table.offset[p] + (slotHash(m) & m_table.mask[p]);
+                prefetch(slot);
+                middle[n] = m;
+                keys[n] = keys[i];
+                bucket[n] = slot;
+                ++n;
+            }
+
+            uint64_t found = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t m = middle[i];
+                uint64_t p = partitionOf(m);
+                const Entry* slots = m_table.slots.data() + m_table.offset[p];
+                uint64_t slot = static_cast<uint64_t>(bucket[i] - slots);
+                while (slots[slot].index != EMPTY) {
+                    if (slots[slot].middle == m) {
+                        ++found;
+                        verify(m_space1.keyAt(slots[slot].index), keys[i]);
+                    }
+                    slot = (slot + 1) & m_table.mask[p];
+                }
+            }
+            if (found) collisions.fetch_add(found, std::memory_order_relaxed);
+            });
+        m_stats.backwardDecryptions += m_space2.size();
+        m_stats.collisions += collisions.load();
+    }
+
+    void
+        verify(uint64_t key1, uint64_t key2) {
+        for (size_t j = 1; j < m_pairs.size(); ++j) {
+            if (encrypt(m_pairs[j].plaintext, key1, key2) != m_pairs[j].ciphertext) return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_solutions.push_back({ key1, key2 });
+    }
+
+    /**
+     * @brief Serie ordenada en disco y cuántas entradas tiene en cada pasada.
+     */
+    struct SpillRun {
+        FILE* file = nullptr;
+        std::string path;
+        std::vector<uint64_t> countPerPass;
+    };
+
+    void
+        attackWithSpill(unsigned passes, const Options& options) {
+        // Límites de los valores intermedios de cada pasada.
+        std::vector<uint64_t> bounds(passes + 1);
+        for (unsigned p = 0; p < passes; ++p) bounds[p] = (~0ULL / passes) * p;
+        bounds[passes] = ~0ULL;
+
+        const uint64_t keys1 = m_space1.size();
+        const uint64_t runKeys = std::max<uint64_t>(options.memoryBudget / sizeof(Entry), BATCH);
+        std::vector<SpillRun> runs;
+        auto closeRuns = [&]() {
+            for (SpillRun& run : runs) {
+                if (run.file) std::fclose(run.file);
+                if (!run.path.empty()) std::remove(run.path.c_str());
+            }
+        };
+
+        try {
+            // Paso 1: series de hasta runKeys entradas ordenadas por valor intermedio.
+            std::vector<Entry> chunk;
+            for (uint64_t first = 0; first < keys1; first += runKeys) {
+                uint64_t count = std::min(runKeys, keys1 - first);
+                chunk.resize(count);
+                forward(first, first + count, chunk.data());
+                std::sort(chunk.begin(), chunk.end(), [](const Entry& a, const Entry& b) { return a.middle < b.middle; });
+
+                SpillRun run;
+                if (options.spillDirectory.empty()) {
+                    run.file = std::tmpfile();
+                }
+                else {
+                    run.path = options.spillDirectory + "/mitm_run_" + std::to_string(runs.size()) + ".tmp";
+                    run.file = std::fopen(run.path.c_str(), "w+b");
+                }
+                if (!run.file) {
+                    throw std::runtime_error("No se pudo crear una serie temporal del ataque a medio camino.");
+                }
+                runs.push_back(run);
+                if (std::fwrite(chunk.data(), sizeof(Entry), count, run.file) != count) {
+                    throw std::runtime_error("No se pudo escribir una serie temporal del ataque a medio camino.");
+                }
+                std::rewind(run.file);
+                auto it = chunk.begin();
+                for (unsigned p = 0; p < passes; ++p) {
+                    auto end = p + 1 == passes ? chunk.end()
+                        : std::lower_bound(it, chunk.end(), bounds[p + 1], [](const Entry& e, uint64_t v) { return e.middle < v; });
+                    runs.back().countPerPass.push_back(static_cast<uint64_t>(end - it));
+                    it = end;
+                }
+                m_stats.spilledBytes += count * sizeof(Entry);
+            }
+            chunk = std::vector<Entry>();
+            m_stats.spillRuns = static_cast<unsigned>(runs.size());
+
+            // Paso 2: cada pasada lee su tramo de cada serie (secuencialmente) y descifra.
+            std::vector<Entry> entries;
+            for (unsigned p = 0; p < passes; ++p) {
+                entries.clear();
+                for (SpillRun& run : runs) {
+                    size_t count = static_cast<size_t>(run.countPerPass[p]);
+                    size_t at = entries.size();
+                    entries.resize(at + count);
+                    if (std::fread(entries.data() + at, sizeof(Entry), count, run.file) != count) {
+                        throw std::runtime_error("No se pudo leer una serie temporal del ataque a medio camino.");
+                    }
+                }
+                buildTable(entries);
+                backward(bounds[p], bounds[p + 1], p + 1 == passes);
+            }
+        }
+        catch (...) {
+            closeRuns();
+            throw;
+        }
+        closeRuns();
+    }
+};
@@ -0,0 +1,148 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "NGramModel.h"
+#include <filesystem>
+
+/**
+ * @class NGramCorpus
+ * @brief Corpus de ejemplo en español e inglés para compilar modelos de n-gramas sin
+ *        archivos externos.
+ *
+ * Son textos cortos (unas 2.200 letras): bastan para ordenar candidatos en los ataques del
+ * laboratorio, pero los cuadrigramas que no aparecen en ellos reciben todos la misma
+ * puntuación mínima. Para textos cifrados cortos hay que compilar el modelo con un corpus
+ * grande: loadOrBuild con corpusFiles, o el archivo de TTC_CORPUS_<IDIOMA>.
+ */
+class NGramCorpus {
+public:
+    NGramCorpus() = default;
+    ~NGramCorpus() = default;
+
+    /**
+     * @brief Texto de ejemplo del idioma ("es" o "en").
+     *
+     * @throws std::invalid_argument Si el idioma no está incluido.
+     */
+    static const char*
+        sample(const std::string& language) {
+        if (language == "es") {
+            return
+                "En un lugar de la ciudad vivia un programador que pasaba las noches frente a la pantalla. "
+                "Cada manana revisaba los mensajes del servidor y buscaba los errores que habian aparecido "
+                "durante la madrugada. Le gustaba pensar que su trabajo consistia en proteger a los jugadores, "
+                "que confiaban en que nadie podria robar sus cuentas ni cambiar las reglas del juego. "
+                "La seguridad de un videojuego no depende solo del cifrado de los datos, sino tambien de la "
+                "forma en que se guardan las claves y de la manera en que el cliente habla con el servidor. "
+                "Por eso el equipo decidio estudiar los metodos clasicos antes de usar los modernos. "
+                "Empezaron por el cifrado de Cesar, que desplaza cada letra del alfabeto un numero fijo de "
+                "posiciones, y siguieron con el de Vigenere, que usa una palabra como clave para cambiar el "
+                "desplazamiento en cada letra. Despues llegaron al cifrado por sustitucion, donde cada letra "
+                "se cambia por otra siguiendo una tabla secreta, y comprobaron que el analisis de frecuencias "
+                "permite recuperar el mensaje cuando el texto es suficientemente largo. "
+                "El profesor explico que en espanol las letras mas comunes son la e, la a, la o y la s, y que "
+                "palabras como de, la, que, el, en, los y se aparecen en casi cualquier parrafo. "
+                "Tambien conto que los antiguos secretarios de los reyes escribian cartas cifradas y que los "
+                "espias del enemigo pasaban semanas intentando leerlas. Hoy las computadoras prueban millones "
+                "de claves por segundo, asi que un sistema solo es seguro si el numero de claves posibles es "
+                "enorme y si no existe un atajo para encontrar la correcta. "
+                "Los estudiantes escribieron programas para romper los mensajes de sus companeros. Algunos "
+                "usaban la fuerza bruta, probando todas las combinaciones; otros preferian medir cuanto se "
+                "parecia el resultado al idioma, contando pares, trios y grupos de cuatro letras. "
+                "Descubrieron que la segunda forma era mucho mas rapida y que casi nunca se equivocaba. "
+                "Al final del curso cada grupo presento su herramienta. Una de ellas podia detectar el tipo de "
+                "cifrado de un archivo, otra generaba contrasenas seguras y comprobaba que no estuvieran en las "
+                "listas de claves filtradas, y la ultima protegia los paquetes de red del juego para que nadie "
+                "pudiera leerlos ni modificarlos durante la partida. "
+                "El programador sonrio al ver el trabajo de todos. Sabia que la seguridad nunca esta terminada, "
+                "pero tambien sabia que cada persona que entiende como funciona un ataque es una persona mas "
+                "capaz de construir defensas mejores para los jugadores y para el resto del mundo. "
+                "Esa noche volvio a casa caminando por las calles tranquilas, pensando en la proxima leccion y "
+                "en los nuevos problemas que traeria la siguiente version del juego.";
+        }
+        if (language == "en") {
+            return
+                "Once upon a time there was a small team of developers who built games for people all over the "
+                "world. Every morning they read the reports from their servers and looked for the strange "
+                "errors that had appeared during the night. They liked to think that their work was about "
+                "protecting the players, who trusted that nobody would steal their accounts or change the rules "
+                "of the game while they were playing. "
+                "The security of a game does not depend only on the encryption of the data, but also on the way "
+                "the keys are stored and on the way the client talks to the server. That is why the team decided "
+                "to study the classical methods before moving on to the modern ones. "
+                "They started with the Caesar cipher, which shifts every letter of the alphabet by a fixed number "
+                "of positions, and then moved on to the Vigenere cipher, which uses a word as the key and changes "
+                "the shift for each letter. After that they studied the substitution cipher, where every letter "
+                "is replaced by another one according to a secret table, and they found that frequency analysis "
+                "recovers the message whenever the text is long enough. "
+                "Their teacher explained that in English the most common letters are e, t, a and o, and that "
+                "words such as the, of, and, to, in, that and is appear in almost every paragraph. She also told "
+                "them that the secretaries of ancient kings wrote letters in cipher and that the spies of the "
+                "enemy spent weeks trying to read them. Today computers try millions of keys every second, so a "
+                "system is only secure if the number of possible keys is huge and there is no shortcut that "
+                "leads to the right one. "
+                "The students wrote programs to break the messages of their classmates. Some of them used brute "
+                "force and tried every combination; others preferred to measure how much the result looked like "
+                "the language, counting pairs, triples and groups of four letters. They discovered that the "
+                "second approach was much faster and that it was almost never wrong. "
+                "At the end of the course each group presented its tool. One of them could detect the kind of "
+                "cipher used in a file, another generated strong passwords and checked that they were not part "
+                "of the leaked password lists, and the last one protected the network packets of the game so "
+                "that nobody could read or change them during a match. "
+                "The developers smiled when they saw what everyone had built. They knew that security is never "
+                "finished, but they also knew that every person who understands how an attack works is one more "
+                "person able to build better defenses for the players and for everybody else. "
+                "That night they walked home through the quiet streets, thinking about the next lesson and about "
+                "the new problems that the next version of the game would bring.";
+        }
+        throw std::invalid_argument("No hay corpus de ejemplo para el idioma: " + language);
+    }
+
+    /**
+     * @brief Devuelve el modelo en path; si no existe, lo compila antes.
+     *
+     * Con @p corpusFiles vacío se compila con el texto de ejemplo (unas 2.200 letras); si se
+     * dan archivos (p. ej. libros en texto plano, idealmente más de un millón de letras), se
+     * compila solo con ellos. Un modelo ya existente en path no se recompila: usar otra ruta
+     * para cada corpus.
+     *
+     * @throws std::runtime_error Si algún archivo del corpus no se puede abrir.
+     */
+    static NGramModel
+        loadOrBuild(const std::string& language, const std::string& path,
+            const std::vector<std::string>& corpusFiles = {}) {
+        if (!std::filesystem::exists(path)) {
+            NGramModelBuilder builder(language);
+            if (corpusFiles.empty()) {
+                builder.addText(sample(language));
+            }
+            for (const std::string& file : corpusFiles) {
+                builder.addFile(file);
+            }
+            builder.write(path);
+        }
+        return NGramModel(path);
+    }
+
+    /**
+     * @brief Archivo de corpus indicado en la variable de entorno TTC_CORPUS_<IDIOMA>
+     *        (p. ej. TTC_CORPUS_ES), o cadena vacía si no está definida.
+     */
+    static std::string
+        corpusFromEnvironment(const std::string& language) {
+        std::string name = "TTC_CORPUS_";
+        for (char c : language) name += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+#ifdef _WIN32
+        char* value = nullptr;
+        size_t length = 0;
+        if (_dupenv_s(&value, &length, name.c_str()) != 0 || value == nullptr) {
+            return "";
+        }
+        std::string path(value);
+        std::free(value);
+        return path;
+#else
+        const char* value = std::getenv(name.c_str());
+        return value ? value : "";
+#endif
+    }
+};
@@ -0,0 +1,396 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+#include "EncryptedContainer.h"
+
+/**
+ * @class NGramModel
+ * @brief Modelo de n-gramas de letras (1 a 4) en log10 de probabilidad, proyectado en memoria.
+ *
+ * Formato del archivo (little-endian):
+ *
+ *     [Cabecera 32 B][unigramas 26 float][bigramas 26^2][trigramas 26^3][cuadrigramas 26^4]
+ *
+ * - Cabecera: magic "TTCNGRM1", versión, idioma (2 letras), letras del corpus (8 B).
+ * - Cada tabla es densa: el índice del n-grama "ABCD" es ((A*26 + B)*26 + C)*26 + D.
+ *   Los n-gramas que no aparecen en el corpus reciben log10(0.01 / total).
+ *
+ * El archivo ocupa unos 1.9 MB y se abre con MappedFile, así que cargarlo al iniciar es
+ * inmediato y las páginas se leen sólo cuando el evaluador las toca.
+ */
+class NGramModel {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 32;
+    static constexpr size_t ALPHABET = 26;
+
+    /**
+     * @brief Número de entradas de la tabla de orden n (26^n).
+     */
+    static constexpr size_t
+        tableSize(int order) {
+        return order == 1 ? ALPHABET : ALPHABET * tableSize(order - 1);
+    }
+
+    /**
+     * @brief Posición (en floats) de la tabla de orden n dentro del archivo.
+     */
+    static constexpr size_t
+        tableOffset(int order) {
+        return order == 1 ? 0 : tableOffset(order - 1) + tableSize(order - 1);
+    }
+
+    /**
+     * @brief Entradas de las cuatro tablas juntas (26 + 26^2 + 26^3 + 26^4).
+     */
+    static constexpr size_t TOTAL_ENTRIES = 26 + 26 * 26 + 26 * 26 * 26 + 26 * 26 * 26 * 26;
+
+    /**
+     * @brief Letra (0-25) de un byte, o -1 si no es letra.
+     *
+     * Acepta ASCII y las vocales acentuadas, ü y ñ de Latin-1/cp1252 (ñ cuenta como N).
+     * Para UTF-8, el byte 0xC3 es prefijo: la letra es letterIndex(siguiente + 0x40).
+     */
+    static int
+        letterIndex(unsigned char c) {
+        return letterTable().values[c];
+    }
+
+    NGramModel() = default;
+
+    /**
+     * @brief Abre un modelo ya compilado.
+     *
+     * @throws std::runtime_error Si el archivo no existe o no es un modelo válido.
+     */
+    explicit NGramModel(const std::string& path) {
+        load(path);
+    }
+
+    /**
+     * @brief Proyecta un modelo compilado con NGramModelBuilder.
+     */
+    void
+        load(const std::string& path) {
+        m_file.open(path);
+        const uint8_t* base = m_file.data();
+        if (m_file.size() != HEADER_SIZE + TOTAL_ENTRIES * sizeof(float)
+            || std::memcmp(base, "TTCNGRM1", 8) != 0
+            || EncryptedContainer::get32(base + 8) != VERSION) {
+            m_file.close();
+            throw std::runtime_error("El archivo no es un modelo de n-gramas valido: " + path);
+        }
+        m_language.assign(reinterpret_cast<const char*>(base + 12), 2);
+        m_letters = EncryptedContainer::get64(base + 16);
+        m_tables = reinterpret_cast<const float*>(base + HEADER_SIZE);
+    }
+
+    /**
+     * @brief Indica si hay un modelo cargado.
+     */
+    bool
+        isLoaded() const {
+        return m_tables != nullptr;
+    }
+
+    /**
+     * @brief Código de idioma ("es", "en", ...).
+     */
+    const std::string&
+        language() const {
+        return m_language;
+    }
+
+    /**
+     * @brief Letras del corpus con el que se compiló el modelo.
+     */
+    uint64_t
+        corpusLetters() const {
+        return m_letters;
+    }
+
+    /**
+     * @brief Tabla densa de orden n (1 a 4).
+     */
+    const float*
+        table(int order) const {
+        return m_tables + tableOffset(order);
+    }
+
+private:
+    struct LetterTable {
+        int8_t values[256];
+    };
+
+    MappedFile m_file;
+    const float* m_tables = nullptr;
+    std::string m_language;
+    uint64_t m_letters = 0;
+
+    static const LetterTable&
+        letterTable() {
+        static const LetterTable t = [] {
+            LetterTable table{};
+            for (int c = 0; c < 256; ++c) table.values[c] = -1;
+            for (int i = 0; i < 26; ++i) {
+                table.values['A' + i] = static_cast<int8_t>(i);
+                table.values['a' + i] = static_cast<int8_t>(i);
+            }
+            // Latin-1: ÀÁÂÄ àáâä ÈÉÊË èéêë ÌÍÎÏ ìíîï ÒÓÔÖ òóôö ÙÚÛÜ ùúûü Ññ Çç
+            const struct { unsigned char first; unsigned char last; char letter; } ranges[] = {
+                { 0xC0, 0xC4, 'A' }, { 0xE0, 0xE4, 'A' }, { 0xC8, 0xCB, 'E' }, { 0xE8, 0xEB, 'E' },
+                { 0xCC, 0xCF, 'I' }, { 0xEC, 0xEF, 'I' }, { 0xD2, 0xD6, 'O' }, { 0xF2, 0xF6, 'O' },
+                { 0xD9, 0xDC, 'U' }, { 0xF9, 0xFC, 'U' }, { 0xD1, 0xD1, 'N' }, { 0xF1, 0xF1, 'N' },
+                { 0xC7, 0xC7, 'C' }, { 0xE7, 0xE7, 'C' },
+            };
+            for (const auto& r : ranges) {
+                for (int c = r.first; c <= r.last; ++c) table.values[c] = static_cast<int8_t>(r.letter - 'A');
+            }
+            return table;
+            }();
+        return t;
+    }
+};
+
+/**
+ * @class NGramModelBuilder
+ * @brief Cuenta n-gramas de un corpus y compila el modelo binario.
+ *
+ * Los n-gramas se cuentan sobre la secuencia de letras, ignorando espacios y signos,
+ * igual que los recorre NGramScorer.
+ */
+class NGramModelBuilder {
+public:
+    /**
+     * @param language Código de idioma de dos letras ("es", "en").
+     */
+    explicit NGramModelBuilder(const std::string& language)
+        : m_language(language), m_counts(NGramModel::TOTAL_ENTRIES, 0) {
+        if (language.size() != 2) {
+            throw std::invalid_argument("El codigo de idioma debe tener dos letras.");
+        }
+    }
+
+    /**
+     * @brief Añade texto al corpus (ASCII, Latin-1 o UTF-8).
+     */
+    void
+        addText(const std::string& text) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == 0xC3 && i + 1 < text.size()) {
+                c = static_cast<unsigned char>(static_cast<unsigned char>(text[++i]) + 0x40);
+            }
+            int letter = NGramModel::letterIndex(c);
+            if (letter < 0) continue;
+            m_window = (m_window * NGramModel::ALPHABET + letter) % NGramModel::tableSize(4);
+            ++m_letters;
+            for (int order = 1; order <= 4; ++order) {
+                if (m_letters >= static_cast<uint64_t>(order)) {
+                    ++m_counts[NGramModel::tableOffset(order) + m_window % NGramModel::tableSize(order)];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Añade el contenido de un archivo de texto al corpus.
+     *
+     * @throws std::runtime_error Si el archivo no se puede abrir.
+     */
+    void
+        addFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("No se pudo abrir el corpus: " + path);
+        }
+        std::string buffer(1 << 20, '\0');
+        while (in.read(&buffer[0], buffer.size()) || in.gcount() > 0) {
+            addText(buffer.substr(0, static_cast<size_t>(in.gcount())));
+        }
+    }
+
+    /**
+     * @brief Letras contadas hasta ahora.
+     */
+    uint64_t
+        letterCount() const {
+        return m_letters;
+    }
+
+    /**
+     * @brief Escribe el modelo compilado.
+     *
+     * @throws std::runtime_error Si el corpus es demasiado corto o el archivo no se puede crear.
+     */
+    void
+        write(const std::string& path) const {
+        if (m_letters < 4) {
+            throw std::runtime_error("El corpus necesita al menos cuatro letras.");
+        }
+        std::vector<float> tables(NGramModel::TOTAL_ENTRIES);
+        for (int order = 1; order <= 4; ++order) {
+            size_t offset = NGramModel::tableOffset(order);
+            size_t size = NGramModel::tableSize(order);
+            double total = static_cast<double>(m_letters - (order - 1));
+            float floor = static_cast<float>(std::log10(0.01 / total));
+            for (size_t i = 0; i < size; ++i) {
+                uint64_t count = m_counts[offset + i];
+                tables[offset + i] = count ? static_cast<float>(std::log10(count / total)) : floor;
+            }
+        }
+
+        uint8_t header[NGramModel::HEADER_SIZE] = {};
+        std::memcpy(header, "TTCNGRM1", 8);
+        EncryptedContainer::put32(header + 8, NGramModel::VERSION);
+        std::memcpy(header + 12, m_language.data(), 2);
+        EncryptedContainer::put64(header + 16, m_letters);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (float value : tables) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, 4);
+            uint8_t le[4];
+            EncryptedContainer::put32(le, bits);
+            out.write(reinterpret_cast<const char*>(le), 4);
+        }
+        if (!out) {
+            throw std::runtime_error("No se pudo escribir el modelo: " + path);
+        }
+    }
+
+private:
+    std::string m_language;
+    std::vector<uint64_t> m_counts;
+    uint64_t m_letters = 0;
+    size_t m_window = 0;
+};
+
+/**
+ * @class NGramScorer
+ * @brief Evalúa texto con un modelo de n-gramas sin reservar memoria.
+ *
+ * Recorre el texto una vez manteniendo el índice del n-grama con una ventana deslizante
+ * (índice = índice * 26 + letra, módulo 26^n) y suma las log-probabilidades. Cuanto
+ * mayor (menos negativa) la puntuación, más se parece el texto al idioma del modelo.
+ */
+class NGramScorer {
+public:
+    /**
+     * @param model Modelo cargado (debe vivir más que el evaluador).
+     * @param order Orden de n-grama a usar (1 a 4; 4 por defecto).
+     * @throws std::invalid_argument Si el modelo no está cargado o el orden no es válido.
+     */
+    explicit NGramScorer(const NGramModel& model, int order = 4)
+        : m_table(checkedTable(model, order)), m_order(order), m_modulo(NGramModel::tableSize(order)) {
+    }
+
+    /**
+     * @brief Suma de log10 P de todos los n-gramas del texto.
+     */
+    double
+        score(const char* text, size_t length) const {
+        double total = 0.0;
+        size_t window = 0;
+        int letters = 0;
+        forEachLetter(text, length, [&](int letter) {
+            window = (window * NGramModel::ALPHABET + letter) % m_modulo;
+            if (++letters >= m_order) {
+                total += m_table[window];
+            }
+            });
+        return total;
+    }
+
+    double
+        score(const std::string& text) const {
+        return score(text.data(), text.size());
+    }
+
+    /**
+     * @brief Puntuación media por n-grama: permite comparar textos de distinta longitud.
+     *
+     * @return double Media de log10 P, o -100 si el texto tiene menos letras que el orden.
+     */
+    double
+        scorePerNgram(const char* text, size_t length) const {
+        size_t letters = 0;
+        forEachLetter(text, length, [&](int) { ++letters; });
+        if (letters < static_cast<size_t>(m_order)) {
+            return -100.0;
+        }
+        return score(text, length) / static_cast<double>(letters - m_order + 1);
+    }
+
+    double
+        scorePerNgram(const std::string& text) const {
+        return scorePerNgram(text.data(), text.size());
+    }
+
+    /**
+     * @brief Puntuación de un texto ya convertido a índices de letra (0-25), como el que
+     *        mantienen los resolvedores de sustitución.
+     */
+    double
+        scoreIndices(const uint8_t* letters, size_t length) const {
+        double total = 0.0;
+        size_t window = 0;
+        for (size_t i = 0; i < length; ++i) {
+            window = (window * NGramModel::ALPHABET + letters[i]) % m_modulo;
+            if (i + 1 >= static_cast<size_t>(m_order)) {
+                total += m_table[window];
+            }
+        }
+        return total;
+    }
+
+    /**
+     * @brief Tabla usada (para actualizaciones incrementales).
+     */
+    const float*
+        table() const {
+        return m_table;
+    }
+
+    int
+        order() const {
+        return m_order;
+    }
+
+private:
+    const float* m_table;
+    int m_order;
+    size_t m_modulo;
+
+    /**
+     * @brief Tabla del orden pedido; valida antes de calcular desplazamientos y tamaños.
+     *
+     * @throws std::invalid_argument Si el modelo no está cargado o el orden no está entre 1 y 4.
+     */
+    static const float*
+        checkedTable(const NGramModel& model, int order) {
+        if (!model.isLoaded()) {
+            throw std::invalid_argument("El modelo de n-gramas no esta cargado.");
+        }
+        if (order < 1 || order > 4) {
+            throw std::invalid_argument("El orden de n-grama debe estar entre 1 y 4.");
+        }
+        return model.table(order);
+    }
+
+    template <class Visit>
+    static void
+        forEachLetter(const char* text, size_t length, Visit visit) {
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == 0xC3 && i + 1 < length) {
+                c = static_cast<unsigned char>(static_cast<unsigned char>(text[++i]) + 0x40);
+            }
+            int letter = NGramModel::letterIndex(c);
+            if (letter >= 0) {
+                visit(letter);
+            }
+        }
+    }
+};
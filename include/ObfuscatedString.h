@@ -0,0 +1,229 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <string_view>
+
+/**
+ * @file ObfuscatedString.h
+ * @brief Cifrado de literales en tiempo de compilación para ocultarlos de `strings`.
+ *
+ * Incluye versiones constexpr de CesarEncryption::encode, Vigenere::encode y
+ * XOREncoder::encode, y el literal "texto"_obf: el binario sólo contiene el texto
+ * cifrado y éste se descifra al usarlo, en la pila (decrypt) o una única vez por hilo
+ * en un buffer thread_local (c_str). No hay inicialización dinámica al arrancar.
+ *
+ * Ejemplo:
+ * @code
+ *   using namespace obfuscation::literals;
+ *   std::cout << "Servidor: game.example.com"_obf.c_str();
+ * @endcode
+ */
+namespace obfuscation {
+
+    /**
+     * @brief Versión constexpr de CesarEncryption::encode para un carácter.
+     */
+    constexpr char
+        caesarEncode(char c, int desplazamiento) {
+        int letras = ((desplazamiento % 26) + 26) % 26;
+        int digitos = ((desplazamiento % 10) + 10) % 10;
+        if (c >= 'A' && c <= 'Z') return static_cast<char>((c - 'A' + letras) % 26 + 'A');
+        if (c >= 'a' && c <= 'z') return static_cast<char>((c - 'a' + letras) % 26 + 'a');
+        if (c >= '0' && c <= '9') return static_cast<char>((c - '0' + digitos) % 10 + '0');
+        return c;
+    }
+
+    /**
+     * @brief Inversa exacta de caesarEncode (también para dígitos).
+     */
+    constexpr char
+        caesarDecode(char c, int desplazamiento) {
+        if (c >= '0' && c <= '9') return caesarEncode(c, -(desplazamiento % 10));
+        return caesarEncode(c, -(desplazamiento % 26));
+    }
+
+    /**
+     * @brief Versión constexpr de CesarEncryption::encode.
+     */
+    template <size_t N>
+    constexpr std::array<char, N>
+        caesarEncode(std::array<char, N> texto, int desplazamiento) {
+        for (char& c : texto) {
+            c = caesarEncode(c, desplazamiento);
+        }
+        return texto;
+    }
+
+    /**
+     * @brief Versión constexpr de Vigenere::encode (la clave se normaliza como en Vigenere).
+     *
+     * @throws std::invalid_argument Si la clave no contiene letras (error de compilación
+     *         cuando se evalúa en contexto constante).
+     */
+    template <size_t N>
+    constexpr std::array<char, N>
+        vigenereEncode(std::array<char, N> texto, std::string_view key) {
+        size_t letrasClave = 0;
+        for (char k : key) {
+            if ((k >= 'A' && k <= 'Z') || (k >= 'a' && k <= 'z')) ++letrasClave;
+        }
+        if (letrasClave == 0) {
+            throw std::invalid_argument("La clave no puede estar vacia o sin letras.");
+        }
+        size_t posicion = 0;
+        for (char& c : texto) {
+            bool mayuscula = c >= 'A' && c <= 'Z';
+            if (!mayuscula && !(c >= 'a' && c <= 'z')) continue;
+            while (!((key[posicion] >= 'A' && key[posicion] <= 'Z') || (key[posicion] >= 'a' && key[posicion] <= 'z'))) {
+                posicion = (posicion + 1) % key.size();
+            }
+            char k = key[posicion];
+            int shift = (k >= 'a' ? k - 'a' : k - 'A');
+            char base = mayuscula ? 'A' : 'a';
+            c = static_cast<char>((c - base + shift) % 26 + base);
+            posicion = (posicion + 1) % key.size();
+        }
+        return texto;
+    }
+
+    /**
+     * @brief Versión constexpr de XOREncoder::encode (clave repetida).
+     */
+    template <size_t N>
+    constexpr std::array<char, N>
+        xorEncode(std::array<char, N> texto, std::string_view key) {
+        if (key.empty()) {
+            throw std::invalid_argument("La clave XOR no puede estar vacia.");
+        }
+        for (size_t i = 0; i < N; ++i) {
+            texto[i] = static_cast<char>(texto[i] ^ key[i % key.size()]);
+        }
+        return texto;
+    }
+
+    /**
+     * @brief Flujo de clave xorshift32 (idéntico en tiempo de compilación y de ejecución).
+     */
+    constexpr uint32_t
+        nextKey(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    /**
+     * @brief Literal de cadena utilizable como parámetro de plantilla, ya cifrado.
+     *
+     * El constructor consteval cifra el texto con XOR sobre nextKey, partiendo de una
+     * semilla que calcula él mismo (FNV-1a del literal). Así el valor del parámetro de
+     * plantilla, que los compiladores codifican en los nombres de símbolo (y en la
+     * información de depuración), ya es texto cifrado: el texto plano nunca sale del
+     * compilador.
+     */
+    template <size_t N>
+    struct FixedString {
+        char data[N]{};     ///< Texto cifrado; data[N - 1] es el terminador, sin cifrar.
+        uint32_t seed = 0;  ///< Semilla del flujo de clave.
+
+        consteval FixedString(const char(&texto)[N]) {
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < N; ++i) {
+                h = (h ^ static_cast<uint8_t>(texto[i])) * 16777619u;
+            }
+            seed = h ^ 0x9E3779B9u;
+            uint32_t state = seed;
+            for (size_t i = 0; i + 1 < N; ++i) {
+                data[i] = static_cast<char>(texto[i] ^ static_cast<char>(nextKey(state)));
+            }
+        }
+    };
+
+    /**
+     * @class ObfuscatedLiteral
+     * @brief Literal cifrado con XOR en tiempo de compilación.
+     *
+     * S ya llega cifrado (FixedString), así que ni el arreglo cipher ni el nombre de la
+     * instancia contienen el texto plano. Se lee a través de un puntero volatile para que el
+     * optimizador no pueda plegar el descifrado y volver a emitir el texto plano.
+     */
+    template <FixedString S>
+    class ObfuscatedLiteral {
+    public:
+        /**
+         * @brief Longitud del texto (sin el terminador).
+         */
+        static constexpr size_t SIZE = sizeof(S.data) - 1;
+
+        /**
+         * @brief Descifra en un buffer de pila terminado en '\0'.
+         */
+        static std::array<char, SIZE + 1>
+            decrypt() {
+            std::array<char, SIZE + 1> plano{};
+            decryptInto(plano.data());
+            return plano;
+        }
+
+        /**
+         * @brief Texto descifrado en un buffer thread_local; se descifra la primera vez
+         *        que cada hilo lo usa y después sólo cuesta comprobar un indicador.
+         */
+        static const char*
+            c_str() {
+            thread_local char plano[SIZE + 1];
+            thread_local bool listo = false;
+            if (!listo) {
+                decryptInto(plano);
+                listo = true;
+            }
+            return plano;
+        }
+
+        /**
+         * @brief Vista del texto descifrado (buffer thread_local).
+         */
+        static std::string_view
+            view() {
+            return std::string_view(c_str(), SIZE);
+        }
+
+        /**
+         * @brief Copia del texto descifrado.
+         */
+        static std::string
+            str() {
+            return std::string(c_str(), SIZE);
+        }
+
+    private:
+        static constexpr uint32_t SEED = S.seed;
+
+        static constexpr std::array<char, SIZE + 1> cipher = [] {
+            std::array<char, SIZE + 1> datos{};
+            for (size_t i = 0; i < SIZE; ++i) datos[i] = S.data[i];
+            return datos;
+        }();
+
+        static void
+            decryptInto(char* out) {
+            const volatile char* origen = cipher.data();
+            uint32_t state = SEED;
+            for (size_t i = 0; i < SIZE; ++i) {
+                out[i] = static_cast<char>(origen[i] ^ static_cast<char>(nextKey(state)));
+            }
+            out[SIZE] = '\0';
+        }
+    };
+
+    namespace literals {
+
+        /**
+         * @brief "texto"_obf: cifra el literal al compilar.
+         */
+        template <FixedString S>
+        constexpr ObfuscatedLiteral<S>
+            operator""_obf() {
+            return {};
+        }
+    }
+}
@@ -0,0 +1,279 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "SHA256.h"
+
+/**
+ * @class PBKDF2
+ * @brief Derivación de claves PBKDF2-HMAC-SHA256 (RFC 8018).
+ *
+ * Pensada para combinarse con las salts de CryptoGenerator::generateSalt.
+ * Cada iteración cuesta dos compresiones de un bloque gracias a los estados
+ * ipad/opad precalculados. deriveKeys procesa varias contraseñas a la vez: con AVX2
+ * cada una ocupa un carril de 32 bits y se derivan 8 contraseñas por compresión.
+ */
+class PBKDF2 {
+public:
+    /**
+     * @brief Contraseñas derivadas en paralelo por la ruta AVX2.
+     */
+    static constexpr size_t LANES = 8;
+
+    PBKDF2() = default;
+    ~PBKDF2() = default;
+
+    /**
+     * @brief Deriva una clave a partir de una contraseña.
+     *
+     * @param password   Contraseña.
+     * @param salt       Salt (p. ej. CryptoGenerator::generateSalt(16)).
+     * @param iterations Número de iteraciones (>= 1).
+     * @param keyLength  Longitud de la clave derivada en bytes.
+     * @return std::vector<uint8_t> Clave derivada.
+     * @throws std::invalid_argument Si iterations es 0.
+     */
+    static std::vector<uint8_t>
+        deriveKey(const std::string& password, const std::vector<uint8_t>& salt,
+            uint32_t iterations, size_t keyLength) {
+        checkIterations(iterations);
+        HMACSHA256 mac(reinterpret_cast<const uint8_t*>(password.data()), password.size());
+        std::vector<uint8_t> key(keyLength);
+
+        for (uint32_t blockIndex = 1; (blockIndex - 1) * SHA256::DIGEST_SIZE < keyLength; ++blockIndex) {
+            uint32_t u[8], t[8];
+            firstIteration(mac, salt, blockIndex, u);
+            std::memcpy(t, u, sizeof(t));
+            iterateScalar(mac, u, t, iterations - 1);
+            storeBlock(t, key, blockIndex);
+        }
+        return key;
+    }
+
+    /**
+     * @brief Deriva claves para muchas contraseñas (ruta multi-buffer si hay AVX2).
+     *
+     * @param passwords  Contraseñas.
+     * @param salts      Una salt por contraseña, o una sola salt compartida.
+     * @param iterations Número de iteraciones (>= 1).
+     * @param keyLength  Longitud de cada clave derivada en bytes.
+     * @return std::vector<std::vector<uint8_t>> Claves en el mismo orden que @p passwords.
+     * @throws std::invalid_argument Si el número de salts no coincide.
+     */
+    static std::vector<std::vector<uint8_t>>
+        deriveKeys(const std::vector<std::string>& passwords,
+            const std::vector<std::vector<uint8_t>>& salts,
+            uint32_t iterations, size_t keyLength) {
+        checkIterations(iterations);
+        if (salts.size() != 1 && salts.size() != passwords.size()) {
+            throw std::invalid_argument("Se requiere una salt por contrasena o una sola compartida.");
+        }
+
+        std::vector<std::vector<uint8_t>> keys(passwords.size());
+        if (!multiBufferAvailable()) {
+            for (size_t i = 0; i < passwords.size(); ++i) {
+                keys[i] = deriveKey(passwords[i], salts.size() == 1 ? salts[0] : salts[i], iterations, keyLength);
+            }
+            return keys;
+        }
+
+#if TTC_X86
+        for (size_t first = 0; first < passwords.size(); first += LANES) {
+            size_t active = passwords.size() - first;
+            if (active > LANES) active = LANES;
+
+            std::vector<HMACSHA256> macs;
+            macs.reserve(LANES);
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                // Los carriles sobrantes repiten la primera contraseña y se descartan.
+                const std::string& p = passwords[first + (lane < active ? lane : 0)];
+                macs.emplace_back(reinterpret_cast<const uint8_t*>(p.data()), p.size());
+            }
+            for (size_t lane = 0; lane < active; ++lane) {
+                keys[first + lane].assign(keyLength, 0);
+            }
+
+            for (uint32_t blockIndex = 1; (blockIndex - 1) * SHA256::DIGEST_SIZE < keyLength; ++blockIndex) {
+                uint32_t inner[LANES][8], outer[LANES][8], u[LANES][8], t[LANES][8];
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    size_t index = first + (lane < active ? lane : 0);
+                    const std::vector<uint8_t>& salt = salts.size() == 1 ? salts[0] : salts[index];
+                    firstIteration(macs[lane], salt, blockIndex, u[lane]);
+                    std::memcpy(t[lane], u[lane], sizeof(t[lane]));
+                    std::memcpy(inner[lane], macs[lane].innerState(), sizeof(inner[lane]));
+                    std::memcpy(outer[lane], macs[lane].outerState(), sizeof(outer[lane]));
+                }
+                iterateLanes(inner, outer, u, t, iterations - 1);
+                for (size_t lane = 0; lane < active; ++lane) {
+                    storeBlock(t[lane], keys[first + lane], blockIndex);
+                }
+            }
+        }
+#endif
+        return keys;
+    }
+
+    /**
+     * @brief Indica si la ruta multi-buffer AVX2 está disponible.
+     */
+    static bool
+        multiBufferAvailable() {
+        return CpuFeatures::get().avx2;
+    }
+
+private:
+    static void
+        checkIterations(uint32_t iterations) {
+        if (iterations == 0) {
+            throw std::invalid_argument("PBKDF2 requiere al menos una iteracion.");
+        }
+    }
+
+    /**
+     * @brief U1 = HMAC(P, salt || INT(i)), devuelto como palabras big-endian.
+     */
+    static void
+        firstIteration(const HMACSHA256& mac, const std::vector<uint8_t>& salt, uint32_t blockIndex, uint32_t* u) {
+        std::vector<uint8_t> message(salt);
+        message.push_back(static_cast<uint8_t>(blockIndex >> 24));
+        message.push_back(static_cast<uint8_t>(blockIndex >> 16));
+        message.push_back(static_cast<uint8_t>(blockIndex >> 8));
+        message.push_back(static_cast<uint8_t>(blockIndex));
+
+        uint8_t digest[SHA256::DIGEST_SIZE];
+        mac.compute(message.data(), message.size(), digest);
+        for (int i = 0; i < 8; ++i) {
+            u[i] = (static_cast<uint32_t>(digest[4 * i]) << 24) | (static_cast<uint32_t>(digest[4 * i + 1]) << 16)
+                | (static_cast<uint32_t>(digest[4 * i + 2]) << 8) | digest[4 * i + 3];
+        }
+    }
+
+    static void
+        storeBlock(const uint32_t* t, std::vector<uint8_t>& key, uint32_t blockIndex) {
+        uint8_t digest[SHA256::DIGEST_SIZE];
+        SHA256::storeState(t, digest);
+        size_t offset = (blockIndex - 1) * SHA256::DIGEST_SIZE;
+        size_t n = key.size() - offset;
+        if (n > SHA256::DIGEST_SIZE) n = SHA256::DIGEST_SIZE;
+        std::memcpy(key.data() + offset, digest, n);
+    }
+
+    /**
+     * @brief Iteraciones 2..c de un bloque: dos compresiones de un bloque cada una.
+     *
+     * El mensaje (32 bytes + relleno) ocupa siempre un único bloque, por lo que el
+     * relleno se escribe una sola vez y sólo se reemplazan los primeros 32 bytes.
+     */
+    static void
+        iterateScalar(const HMACSHA256& mac, uint32_t* u, uint32_t* t, uint32_t rounds) {
+        uint8_t block[SHA256::BLOCK_SIZE] = {};
+        block[32] = 0x80;
+        block[62] = 0x03;  // (64 + 32) * 8 = 768 bits
+        uint32_t state[8];
+
+        for (uint32_t r = 0; r < rounds; ++r) {
+            SHA256::storeState(u, block);
+            std::memcpy(state, mac.innerState(), sizeof(state));
+            SHA256::compress(state, block, 1);
+
+            SHA256::storeState(state, block);
+            std::memcpy(state, mac.outerState(), sizeof(state));
+            SHA256::compress(state, block, 1);
+
+            for (int i = 0; i < 8; ++i) {
+                u[i] = state[i];
+                t[i] ^= state[i];
+            }
+        }
+    }
+
+#if TTC_X86
+    TTC_TARGET("avx2")
+        static __m256i
+        rotr8x(__m256i x, int n) {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    }
+
+    /**
+     * @brief Compresión SHA-256 de 8 mensajes independientes (un carril por mensaje).
+     */
+    TTC_TARGET("avx2")
+        static void
+        compressLanes(__m256i* state, const __m256i* block) {
+        const uint32_t* k = SHA256::roundConstants();
+        __m256i w[64];
+        for (int j = 0; j < 16; ++j) w[j] = block[j];
+        for (int j = 16; j < 64; ++j) {
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(w[j - 15], 7), rotr8x(w[j - 15], 18)), _mm256_srli_epi32(w[j - 15], 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(w[j - 2], 17), rotr8x(w[j - 2], 19)), _mm256_srli_epi32(w[j - 2], 10));
+            w[j] = _mm256_add_epi32(_mm256_add_epi32(w[j - 16], s0), _mm256_add_epi32(w[j - 7], s1));
+        }
+
+        __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+        __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int j = 0; j < 64; ++j) {
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(e, 6), rotr8x(e, 11)), rotr8x(e, 25));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(k[j])), w[j])));
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(a, 2), rotr8x(a, 13)), rotr8x(a, 22));
+            __m256i maj = _mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_xor_si256(a, b)));
+            __m256i t2 = _mm256_add_epi32(s0, maj);
+            h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+            d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+        }
+        state[0] = _mm256_add_epi32(state[0], a); state[1] = _mm256_add_epi32(state[1], b);
+        state[2] = _mm256_add_epi32(state[2], c); state[3] = _mm256_add_epi32(state[3], d);
+        state[4] = _mm256_add_epi32(state[4], e); state[5] = _mm256_add_epi32(state[5], f);
+        state[6] = _mm256_add_epi32(state[6], g); state[7] = _mm256_add_epi32(state[7], h);
+    }
+
+    /**
+     * @brief Iteraciones 2..c para 8 contraseñas a la vez.
+     *
+     * Tras transponer los estados (palabra i de los 8 carriles en un registro), la
+     * salida de cada compresión ya tiene la forma del siguiente bloque, así que no
+     * hay más transposiciones hasta el final.
+     */
+    TTC_TARGET("avx2")
+        static void
+        iterateLanes(const uint32_t inner[LANES][8], const uint32_t outer[LANES][8],
+            uint32_t u[LANES][8], uint32_t t[LANES][8], uint32_t rounds) {
+        __m256i vInner[8], vOuter[8], vU[8], vT[8];
+        for (int w = 0; w < 8; ++w) {
+            vInner[w] = _mm256_setr_epi32(inner[0][w], inner[1][w], inner[2][w], inner[3][w], inner[4][w], inner[5][w], inner[6][w], inner[7][w]);
+            vOuter[w] = _mm256_setr_epi32(outer[0][w], outer[1][w], outer[2][w], outer[3][w], outer[4][w], outer[5][w], outer[6][w], outer[7][w]);
+            vU[w] = _mm256_setr_epi32(u[0][w], u[1][w], u[2][w], u[3][w], u[4][w], u[5][w], u[6][w], u[7][w]);
+            vT[w] = _mm256_setr_epi32(t[0][w], t[1][w], t[2][w], t[3][w], t[4][w], t[5][w], t[6][w], t[7][w]);
+        }
+
+        __m256i block[16];
+        block[8] = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+        for (int w = 9; w < 15; ++w) block[w] = _mm256_setzero_si256();
+        block[15] = _mm256_set1_epi32(768);
+
+        __m256i state[8];
+        for (uint32_t r = 0; r < rounds; ++r) {
+            for (int w = 0; w < 8; ++w) {
+                block[w] = vU[w];
+                state[w] = vInner[w];
+            }
+            compressLanes(state, block);
+
+            for (int w = 0; w < 8; ++w) {
+                block[w] = state[w];
+                state[w] = vOuter[w];
+            }
+            compressLanes(state, block);
+
+            for (int w = 0; w < 8; ++w) {
+                vU[w] = state[w];
+                vT[w] = _mm256_xor_si256(vT[w], state[w]);
+            }
+        }
+
+        alignas(32) uint32_t lanes[8];
+        for (int w = 0; w < 8; ++w) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), vT[w]);
+            for (size_t lane = 0; lane < LANES; ++lane) t[lane][w] = lanes[lane];
+        }
+    }
+#endif
+};
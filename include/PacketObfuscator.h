@@ -0,0 +1,255 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "AES.h"
+#include "SecureArena.h"
+
+/**
+ * @brief Paquete en un buffer propiedad del llamador (no se copia ni se reserva memoria).
+ */
+struct PacketView {
+    uint8_t* data = nullptr;  ///< Inicio de la zona a ofuscar.
+    size_t length = 0;        ///< Bytes válidos.
+    size_t capacity = 0;      ///< Capacidad del buffer (para recibir).
+    uint64_t sequence = 0;    ///< Número de secuencia con el que se ofuscó el paquete.
+};
+
+/**
+ * @brief Estado por conexión: 16 bytes, caben cuatro por línea de caché.
+ */
+struct PacketConnection {
+    uint32_t salt = 0;              ///< Diferencia los flujos de clave de cada conexión.
+    uint8_t sendDirection = 0;      ///< Sentido de los paquetes que se envían (0 o 1).
+    uint8_t receiveDirection = 1;   ///< Sentido de los paquetes que se reciben.
+    uint16_t reserved = 0;
+    uint64_t nextSequence = 0;      ///< Secuencia del próximo paquete enviado.
+};
+
+/**
+ * @class PacketObfuscator
+ * @brief Ofusca paquetes UDP en el lugar, sin reservar memoria por paquete.
+ *
+ * Cada paquete se cifra con un flujo de clave que depende sólo de (conexión, secuencia),
+ * por lo que los paquetes pueden llegar desordenados o perderse:
+ *
+ * - Mode::AES_CTR: bloque contador = salt (4 B) || sentido:secuencia (1 bit + 63 bits)
+ *   || bloque (4 B). El bit de sentido separa los flujos cliente→servidor y
+ *   servidor→cliente: sin él, el paquete N de cada extremo usaría el mismo flujo de clave
+ *   (two-time pad). En lotes, los contadores de todos los paquetes se cifran con una sola llamada a
+ *   AES::encodeBlocks, que aprovecha el núcleo AES-NI de 8 bloques en paralelo.
+ * - Mode::XOR: clave repetida como XOREncoder::encode, empezando en la posición
+ *   (salt + secuencia) mód longitud de clave. Reutiliza el flujo de clave por diseño
+ *   (entre paquetes y entre sentidos): es ofuscación compatible con XOREncoder, no cifrado.
+ *
+ * El número de secuencia debe viajar en claro junto al paquete. La instancia guarda
+ * buffers de trabajo: usar una por hilo.
+ */
+class PacketObfuscator {
+public:
+    enum class Mode {
+        XOR,
+        AES_CTR
+    };
+
+    /**
+     * @brief Extremo de la conexión; fija qué sentido usa cada uno para enviar.
+     */
+    enum class Role {
+        Client,
+        Server
+    };
+
+    /**
+     * @brief Bloques de flujo de clave generados por llamada a AES (4 KB).
+     */
+    static constexpr size_t SCRATCH_BLOCKS = 256;
+
+    /**
+     * @param key  Clave: 16, 24 o 32 bytes para AES_CTR; cualquier longitud no vacía para XOR.
+     * @param mode Algoritmo de ofuscación.
+     * @throws std::invalid_argument Si la clave no es válida para el modo.
+     */
+    PacketObfuscator(const std::vector<uint8_t>& key, Mode mode = Mode::AES_CTR)
+        : m_mode(mode) {
+        if (key.empty()) {
+            throw std::invalid_argument("La clave no puede estar vacia.");
+        }
+        if (mode == Mode::AES_CTR) {
+            m_aes = AES(key);
+        }
+        else {
+            m_keyLength = key.size();
+            m_repeated.resize(m_keyLength + SCRATCH_BLOCKS * AES::BLOCK_SIZE);
+            for (size_t i = 0; i < m_repeated.size(); ++i) {
+                m_repeated[i] = key[i % m_keyLength];
+            }
+        }
+    }
+
+    ~PacketObfuscator() {
+        if (!m_repeated.empty()) SecureArena::secureZero(m_repeated.data(), m_repeated.size());
+        SecureArena::secureZero(m_keystream.data(), m_keystream.size());
+    }
+
+    /**
+     * @brief Crea el estado de una conexión.
+     *
+     * @param connectionId Identificador acordado por ambos extremos (p. ej. id de sesión).
+     * @param role         Extremo local: el cliente envía en el sentido 0 y recibe en el 1;
+     *                     el servidor, al revés.
+     */
+    static PacketConnection
+        openConnection(uint32_t connectionId, Role role) {
+        PacketConnection connection;
+        connection.salt = connectionId;
+        connection.sendDirection = role == Role::Client ? 0 : 1;
+        connection.receiveDirection = role == Role::Client ? 1 : 0;
+        return connection;
+    }
+
+    /**
+     * @brief Ofusca un paquete en el lugar y le asigna la siguiente secuencia.
+     */
+    void
+        protect(PacketConnection& connection, PacketView& packet) {
+        protectBatch(connection, &packet, 1);
+    }
+
+    /**
+     * @brief Recupera un paquete en el lugar usando packet.sequence.
+     */
+    void
+        unprotect(const PacketConnection& connection, PacketView& packet) {
+        unprotectBatch(connection, &packet, 1);
+    }
+
+    /**
+     * @brief Ofusca un lote de paquetes (p. ej. el arreglo que se pasará a sendmmsg).
+     */
+    void
+        protectBatch(PacketConnection& connection, PacketView* packets, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            packets[i].sequence = connection.nextSequence++;
+        }
+        cryptBatch(connection.salt, connection.sendDirection, packets, count);
+    }
+
+    /**
+     * @brief Recupera un lote de paquetes (p. ej. el arreglo devuelto por recvmmsg).
+     */
+    void
+        unprotectBatch(const PacketConnection& connection, PacketView* packets, size_t count) {
+        cryptBatch(connection.salt, connection.receiveDirection, packets, count);
+    }
+
+    /**
+     * @brief Modo configurado.
+     */
+    Mode
+        mode() const {
+        return m_mode;
+    }
+
+private:
+    /**
+     * @brief Tramo de un paquete pendiente de combinar con el flujo de clave.
+     */
+    struct Segment {
+        uint8_t* data;
+        size_t length;
+        size_t keystreamOffset;
+    };
+
+    Mode m_mode;
+    AES m_aes;
+    std::vector<uint8_t> m_repeated;
+    size_t m_keyLength = 0;
+    std::array<uint8_t, SCRATCH_BLOCKS * AES::BLOCK_SIZE> m_counters{};
+    std::array<uint8_t, SCRATCH_BLOCKS * AES::BLOCK_SIZE> m_keystream{};
+    std::array<Segment, SCRATCH_BLOCKS> m_segments{};
+
+    void
+        cryptBatch(uint32_t salt, uint8_t direction, PacketView* packets, size_t count) {
+        if (m_mode == Mode::XOR) {
+            for (size_t i = 0; i < count; ++i) {
+                xorPacket(salt, packets[i]);
+            }
+            return;
+        }
+
+        size_t used = 0;
+        size_t segments = 0;
+        uint8_t counter[AES::BLOCK_SIZE];
+        for (size_t i = 0; i < count; ++i) {
+            PacketView& packet = packets[i];
+            writeCounterPrefix(counter, salt, direction, packet.sequence);
+            for (size_t offset = 0; offset < packet.length;) {
+                if (used == SCRATCH_BLOCKS) {
+                    flush(used, segments);
+                    used = 0;
+                    segments = 0;
+                }
+                size_t remaining = packet.length - offset;
+                size_t blocks = (remaining + AES::BLOCK_SIZE - 1) / AES::BLOCK_SIZE;
+                if (blocks > SCRATCH_BLOCKS - used) blocks = SCRATCH_BLOCKS - used;
+                uint32_t first = static_cast<uint32_t>(offset / AES::BLOCK_SIZE);
+                for (size_t b = 0; b < blocks; ++b) {
+                    uint32_t block = first + static_cast<uint32_t>(b);
+                    counter[12] = static_cast<uint8_t>(block >> 24);
+                    counter[13] = static_cast<uint8_t>(block >> 16);
+                    counter[14] = static_cast<uint8_t>(block >> 8);
+                    counter[15] = static_cast<uint8_t>(block);
+                    std::memcpy(m_counters.data() + (used + b) * AES::BLOCK_SIZE, counter, AES::BLOCK_SIZE);
+                }
+                size_t length = blocks * AES::BLOCK_SIZE < remaining ? blocks * AES::BLOCK_SIZE : remaining;
+                m_segments[segments++] = { packet.data + offset, length, used * AES::BLOCK_SIZE };
+                used += blocks;
+                offset += length;
+            }
+        }
+        flush(used, segments);
+    }
+
+    void
+        flush(size_t blocks, size_t segments) {
+        if (blocks == 0) return;
+        m_aes.encodeBlocks(m_counters.data(), m_keystream.data(), blocks);
+        for (size_t s = 0; s < segments; ++s) {
+            const Segment& segment = m_segments[s];
+            const uint8_t* key = m_keystream.data() + segment.keystreamOffset;
+            size_t i = 0;
+            for (; i + 8 <= segment.length; i += 8) {
+                uint64_t a;
+                uint64_t b;
+                std::memcpy(&a, segment.data + i, 8);
+                std::memcpy(&b, key + i, 8);
+                a ^= b;
+                std::memcpy(segment.data + i, &a, 8);
+            }
+            for (; i < segment.length; ++i) {
+                segment.data[i] ^= key[i];
+            }
+        }
+    }
+
+    void
+        xorPacket(uint32_t salt, PacketView& packet) const {
+        size_t start = static_cast<size_t>((salt + packet.sequence) % m_keyLength);
+        const size_t span = m_repeated.size() - m_keyLength;
+        for (size_t offset = 0; offset < packet.length;) {
+            size_t n = packet.length - offset < span ? packet.length - offset : span;
+            const uint8_t* key = m_repeated.data() + start;
+            for (size_t i = 0; i < n; ++i) {
+                packet.data[offset + i] ^= key[i];
+            }
+            start = (start + n) % m_keyLength;
+            offset += n;
+        }
+    }
+
+    static void
+        writeCounterPrefix(uint8_t* out, uint32_t salt, uint8_t direction, uint64_t sequence) {
+        sequence = (sequence & ~(uint64_t(1) << 63)) | (uint64_t(direction & 1) << 63);
+        for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(salt >> (24 - 8 * i));
+        for (int i = 0; i < 8; ++i) out[4 + i] = static_cast<uint8_t>(sequence >> (56 - 8 * i));
+    }
+};
@@ -12,4 +12,16 @@
 #include <stdexcept>
 #include <random>
 #include <mutex>
-#include <array>
\ No newline at end of file
+#include <array>
+#include <cstdint>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <cstdio>
+#include <tuple>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
\ No newline at end of file
@@ -0,0 +1,417 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "DESKernel.h"
+#include "DESKeySpace.h"
+#include "EncryptedContainer.h"
+#include "MappedFile.h"
+
+/**
+ * @class RainbowTable
+ * @brief Tabla arcoíris para recuperar una clave DES de un espacio reducido a partir de
+ *        un par texto claro / cifrado conocido.
+ *
+ * Una cadena parte del índice de su número (0, 1, 2...) y alterna t veces cifrar el texto
+ * claro con la clave del índice y reducir el cifrado a un índice nuevo con una función
+ * distinta en cada columna (y en cada tabla). Sólo se guardan el inicio y el final de cada
+ * cadena: en el archivo van ordenados por final, sin finales repetidos, en registros de
+ * ceil((bits + bits del inicio) / 8) bytes big-endian; la búsqueda proyecta el archivo y
+ * hace búsqueda binaria sin cargarlo.
+ *
+ * Coste: construir son m·t cifrados; buscar, t²/2 cifrados más las falsas alarmas. Como no
+ * hay finales repetidos, las cadenas guardadas no se fusionan y cada columna tiene m claves
+ * distintas: la probabilidad de éxito de una tabla es 1 − (1 − m/N)^t.
+ */
+class RainbowTable {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+
+    /**
+     * @brief Resultado de una búsqueda.
+     */
+    struct LookupResult {
+        bool found = false;
+        uint64_t key = 0;
+        uint64_t falseAlarms = 0;   ///< Finales coincidentes que no llevaban a la clave.
+        uint64_t encryptions = 0;   ///< Cifrados DES realizados.
+        double seconds = 0.0;
+    };
+
+    RainbowTable() = default;
+
+    /**
+     * @brief Abre una tabla creada con RainbowTableBuilder.
+     *
+     * @throws std::runtime_error Si el archivo no existe o no es una tabla válida.
+     */
+    explicit RainbowTable(const std::string& path) {
+        load(path);
+    }
+
+    ~RainbowTable() = default;
+
+    RainbowTable(RainbowTable&&) = default;
+    RainbowTable& operator=(RainbowTable&&) = default;
+
+    /**
+     * @brief Proyecta el archivo de la tabla.
+     */
+    void
+        load(const std::string& path) {
+        m_file.open(path);
+        const uint8_t* base = m_file.data();
+        if (m_file.size() < HEADER_SIZE
+            || std::memcmp(base, "TTCRAINB", 8) != 0
+            || EncryptedContainer::get32(base + 8) != VERSION) {
+            m_file.close();
+            throw std::runtime_error("El archivo no es una tabla arcoiris valida: " + path);
+        }
+        m_plaintext = EncryptedContainer::get64(base + 16);
+        m_space = DESKeySpace(EncryptedContainer::get64(base + 24), EncryptedContainer::get64(base + 32));
+        m_chainLength = EncryptedContainer::get32(base + 40);
+        m_tableIndex = EncryptedContainer::get32(base + 44);
+        m_chainsBuilt = EncryptedContainer::get64(base + 48);
+        m_startBits = base[56];
+        m_recordSize = recordSize(m_space.bits(), m_startBits);
+        m_entries = (m_file.size() - HEADER_SIZE) / m_recordSize;
+        if (m_chainLength == 0 || m_entries == 0 || m_file.size() != HEADER_SIZE + m_entries * m_recordSize) {
+            m_file.close();
+            throw std::runtime_error("La tabla arcoiris esta truncada: " + path);
+        }
+        m_records = base + HEADER_SIZE;
+    }
+
+    bool
+        isLoaded() const {
+        return m_records != nullptr;
+    }
+
+    /**
+     * @brief Busca la clave que cifra plaintext() en @p ciphertext.
+     *
+     * Cada hilo recorre un subconjunto de columnas; todas sus colas avanzan a la vez, de
+     * modo que los cifrados se hacen en lotes con DESKernel::encryptUnderKeys.
+     *
+     * @param threads Hilos (0 = hardware_concurrency).
+     */
+    LookupResult
+        lookup(uint64_t ciphertext, unsigned threads = 0) const {
+        if (!isLoaded()) {
+            throw std::runtime_error("No hay ninguna tabla arcoiris cargada.");
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<uint64_t>(threads, m_chainLength));
+
+        std::vector<LookupResult> partial(threads);
+        std::atomic<bool> done{ false };
+        auto worker = [&](unsigned id) {
+            LookupResult& result = partial[id];
+            // Columnas id, id + threads, ...: repartidas por igual entre las caras y las baratas.
+            std::vector<uint32_t> columns;
+            for (uint32_t column = id; column < m_chainLength; column += threads) columns.push_back(column);
+            std::vector<uint64_t> current(columns.size());
+            std::vector<uint64_t> keys(columns.size());
+            std::vector<uint64_t> cipher(columns.size());
+            for (size_t i = 0; i < columns.size(); ++i) current[i] = reduce(ciphertext, columns[i]);
+
+            // En el paso p avanzan las colas cuya columna es menor que p (un prefijo de columns).
+            size_t active = 0;
+            for (uint32_t p = 1; p < m_chainLength && !done.load(std::memory_order_relaxed); ++p) {
+                while (active < columns.size() && columns[active] < p) ++active;
+                for (size_t i = 0; i < active; ++i) keys[i] = m_space.keyAt(current[i]);
+                DESKernel::encryptUnderKeys(m_plaintext, keys.data(), cipher.data(), active);
+                for (size_t i = 0; i < active; ++i) current[i] = reduce(cipher[i], p);
+                result.encryptions += active;
+            }
+
+            // De la última columna hacia atrás: las coincidencias tardías cuestan menos de verificar.
+            for (size_t i = columns.size(); i-- > 0 && !done.load(std::memory_order_relaxed);) {
+                uint64_t chainStart;
+                if (!findEndpoint(current[i], chainStart)) continue;
+                uint64_t index = chainStart;
+                for (uint32_t p = 0; p < columns[i]; ++p) {
+                    index = reduce(encrypt(m_space.keyAt(index)), p);
+                }
+                uint64_t key = m_space.keyAt(index);
+                result.encryptions += columns[i] + 1;
+                if (encrypt(key) == ciphertext) {
+                    result.found = true;
+                    result.key = key;
+                    done.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                ++result.falseAlarms;
+            }
+        };
+
+        if (threads == 1) {
+            worker(0);
+        }
+        else {
+            std::vector<std::thread> pool;
+            for (unsigned id = 0; id < threads; ++id) pool.emplace_back(worker, id);
+            for (std::thread& t : pool) t.join();
+        }
+
+        LookupResult total;
+        for (const LookupResult& r : partial) {
+            if (r.found) {
+                total.found = true;
+                total.key = r.key;
+            }
+            total.falseAlarms += r.falseAlarms;
+            total.encryptions += r.encryptions;
+        }
+        total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return total;
+    }
+
+    /**
+     * @brief Probabilidad estimada de que la tabla contenga una clave al azar del espacio.
+     */
+    double
+        successProbability() const {
+        return successProbability(static_cast<double>(m_space.size()), static_cast<double>(m_entries), m_chainLength);
+    }
+
+    /**
+     * @brief Probabilidad de éxito de una tabla sin finales repetidos de @p chains cadenas
+     *        de @p chainLength columnas en un espacio de @p keys claves.
+     */
+    static double
+        successProbability(double keys, double chains, uint32_t chainLength) {
+        return -std::expm1(chainLength * std::log1p(-chains / keys));
+    }
+
+    uint64_t plaintext() const { return m_plaintext; }
+    const DESKeySpace& keySpace() const { return m_space; }
+    uint32_t chainLength() const { return m_chainLength; }
+    uint32_t tableIndex() const { return m_tableIndex; }
+    uint64_t chainsBuilt() const { return m_chainsBuilt; }
+    uint64_t entryCount() const { return m_entries; }
+    size_t fileSize() const { return m_file.size(); }
+
+    /**
+     * @brief Función de reducción de la columna @p column: cifrado → índice del espacio.
+     */
+    static uint64_t
+        reduce(uint64_t ciphertext, uint32_t column, uint32_t tableIndex, unsigned bits) {
+        uint64_t x = ciphertext + (static_cast<uint64_t>(tableIndex) << 32 | column) * 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x & ((1ULL << bits) - 1);
+    }
+
+    /**
+     * @brief Bytes por registro en el archivo.
+     */
+    static size_t
+        recordSize(unsigned bits, unsigned startBits) {
+        return (bits + startBits + 7) / 8;
+    }
+
+private:
+    MappedFile m_file;
+    const uint8_t* m_records = nullptr;
+    uint64_t m_plaintext = 0;
+    DESKeySpace m_space;
+    uint32_t m_chainLength = 0;
+    uint32_t m_tableIndex = 0;
+    uint64_t m_chainsBuilt = 0;
+    uint64_t m_entries = 0;
+    unsigned m_startBits = 0;
+    size_t m_recordSize = 0;
+
+    uint64_t
+        reduce(uint64_t ciphertext, uint32_t column) const {
+        return reduce(ciphertext, column, m_tableIndex, m_space.bits());
+    }
+
+    uint64_t
+        encrypt(uint64_t key) const {
+        uint64_t out;
+        DESKernel::encryptUnderKeys(m_plaintext, &key, &out, 1);
+        return out;
+    }
+
+    uint64_t
+        record(uint64_t i) const {
+        const uint8_t* p = m_records + i * m_recordSize;
+        uint64_t value = 0;
+        for (size_t b = 0; b < m_recordSize; ++b) value = (value << 8) | p[b];
+        return value;
+    }
+
+    /**
+     * @brief Búsqueda binaria del final @p endpoint; devuelve el inicio de su cadena.
+     */
+    bool
+        findEndpoint(uint64_t endpoint, uint64_t& chainStart) const {
+        uint64_t low = 0;
+        uint64_t high = m_entries;
+        while (low < high) {
+            uint64_t mid = low + (high - low) / 2;
+            if ((record(mid) >> m_startBits) < endpoint) low = mid + 1;
+            else high = mid;
+        }
+        if (low == m_entries) return false;
+        uint64_t value = record(low);
+        if ((value >> m_startBits) != endpoint) return false;
+        chainStart = value & ((1ULL << m_startBits) - 1);
+        return true;
+    }
+};
+
+/**
+ * @class RainbowTableBuilder
+ * @brief Genera las cadenas de una tabla arcoíris en paralelo y escribe el archivo.
+ */
+class RainbowTableBuilder {
+public:
+    /**
+     * @brief Resumen de la construcción.
+     */
+    struct Stats {
+        uint64_t chains = 0;          ///< Cadenas generadas.
+        uint64_t entries = 0;         ///< Cadenas guardadas (finales distintos).
+        uint64_t encryptions = 0;
+        uint64_t fileBytes = 0;
+        double seconds = 0.0;
+        double successProbability = 0.0;
+    };
+
+    /**
+     * @param plaintext   Bloque en claro conocido (el de la práctica de testRandomDesKey).
+     * @param space       Espacio de claves a cubrir.
+     * @param chainLength Columnas por cadena (t).
+     * @param tableIndex  Número de tabla: cambia las funciones de reducción.
+     * @throws std::invalid_argument Si chainLength es 0.
+     */
+    RainbowTableBuilder(uint64_t plaintext, const DESKeySpace& space, uint32_t chainLength, uint32_t tableIndex = 0)
+        : m_plaintext(plaintext), m_space(space), m_chainLength(chainLength), m_tableIndex(tableIndex) {
+        if (chainLength == 0) {
+            throw std::invalid_argument("La longitud de cadena debe ser mayor que cero.");
+        }
+    }
+
+    /**
+     * @brief Genera @p chains cadenas con @p threads hilos (0 = hardware_concurrency).
+     *
+     * @throws std::invalid_argument Si hay más cadenas que claves o el registro no cabe en 64 bits.
+     */
+    Stats
+        build(uint64_t chains, unsigned threads = 0) {
+        unsigned startBits = 1;
+        while (startBits < 64 && (1ULL << startBits) < chains) ++startBits;
+        if (chains == 0 || chains > m_space.size() || m_space.bits() + startBits > 64) {
+            throw std::invalid_argument("Numero de cadenas no valido para un espacio de "
+                + std::to_string(m_space.bits()) + " bits.");
+        }
+        m_startBits = startBits;
+        auto start = std::chrono::steady_clock::now();
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // Cada hilo toma lotes de cadenas y las avanza columna a columna en bloque.
+        const uint64_t BATCH = 4096;
+        m_records.assign(chains, 0);
+        std::atomic<uint64_t> next{ 0 };
+        auto worker = [&]() {
+            std::vector<uint64_t> index(BATCH), keys(BATCH), cipher(BATCH);
+            for (;;) {
+                uint64_t first = next.fetch_add(BATCH);
+                if (first >= chains) break;
+                size_t count = static_cast<size_t>(std::min(BATCH, chains - first));
+                for (size_t i = 0; i < count; ++i) index[i] = first + i;
+                for (uint32_t column = 0; column < m_chainLength; ++column) {
+                    for (size_t i = 0; i < count; ++i) keys[i] = m_space.keyAt(index[i]);
+                    DESKernel::encryptUnderKeys(m_plaintext, keys.data(), cipher.data(), count);
+                    for (size_t i = 0; i < count; ++i) {
+                        index[i] = RainbowTable::reduce(cipher[i], column, m_tableIndex, m_space.bits());
+                    }
+                }
+                for (size_t i = 0; i < count; ++i) m_records[first + i] = (index[i] << m_startBits) | (first + i);
+            }
+        };
+        if (threads == 1) {
+            worker();
+        }
+        else {
+            std::vector<std::thread> pool;
+            for (unsigned id = 0; id < threads; ++id) pool.emplace_back(worker);
+            for (std::thread& t : pool) t.join();
+        }
+
+        // Orden por final; de las cadenas que acaban igual (se fusionaron) basta con una.
+        std::sort(m_records.begin(), m_records.end());
+        size_t kept = 0;
+        for (size_t i = 0; i < m_records.size(); ++i) {
+            if (kept == 0 || (m_records[i] >> m_startBits) != (m_records[kept - 1] >> m_startBits)) {
+                m_records[kept++] = m_records[i];
+            }
+        }
+        m_records.resize(kept);
+        m_chains = chains;
+
+        Stats stats;
+        stats.chains = chains;
+        stats.entries = kept;
+        stats.encryptions = chains * m_chainLength;
+        stats.fileBytes = RainbowTable::HEADER_SIZE + kept * RainbowTable::recordSize(m_space.bits(), m_startBits);
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.successProbability = RainbowTable::successProbability(static_cast<double>(m_space.size()),
+            static_cast<double>(kept), m_chainLength);
+        return stats;
+    }
+
+    /**
+     * @brief Escribe la tabla generada con build().
+     *
+     * @throws std::runtime_error Si no se ha generado o el archivo no se puede crear.
+     */
+    void
+        write(const std::string& path) const {
+        if (m_records.empty()) {
+            throw std::runtime_error("No hay cadenas generadas para escribir.");
+        }
+        uint8_t header[RainbowTable::HEADER_SIZE] = {};
+        std::memcpy(header, "TTCRAINB", 8);
+        EncryptedContainer::put32(header + 8, RainbowTable::VERSION);
+        EncryptedContainer::put64(header + 16, m_plaintext);
+        EncryptedContainer::put64(header + 24, m_space.base());
+        EncryptedContainer::put64(header + 32, m_space.mask());
+        EncryptedContainer::put32(header + 40, m_chainLength);
+        EncryptedContainer::put32(header + 44, m_tableIndex);
+        EncryptedContainer::put64(header + 48, m_chains);
+        header[56] = static_cast<uint8_t>(m_startBits);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        const size_t size = RainbowTable::recordSize(m_space.bits(), m_startBits);
+        std::vector<uint8_t> chunk;
+        const size_t CHUNK_RECORDS = 64 * 1024;
+        for (size_t first = 0; first < m_records.size(); first += CHUNK_RECORDS) {
+            size_t n = std::min(CHUNK_RECORDS, m_records.size() - first);
+            chunk.resize(n * size);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t b = 0; b < size; ++b) {
+                    chunk[i * size + b] = static_cast<uint8_t>(m_records[first + i] >> (8 * (size - 1 - b)));
+                }
+            }
+            out.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+        }
+        if (!out) {
+            throw std::runtime_error("No se pudo escribir la tabla arcoiris: " + path);
+        }
+    }
+
+private:
+    uint64_t m_plaintext;
+    DESKeySpace m_space;
+    uint32_t m_chainLength;
+    uint32_t m_tableIndex;
+    uint64_t m_chains = 0;
+    unsigned m_startBits = 0;
+    std::vector<uint64_t> m_records;
+};
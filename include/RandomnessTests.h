@@ -0,0 +1,541 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include <condition_variable>
+#include <map>
+
+/**
+ * @class RandomnessTests
+ * @brief Batería de pruebas estadísticas de aleatoriedad (NIST SP 800-22) sobre un flujo.
+ *
+ * Pruebas: monobit, rachas (runs), frecuencia por bloques (M = 8192 bits), serial (m = 8),
+ * chi-cuadrado de la distribución de bytes y entropía aproximada (m = 8). Los bits se
+ * leen de cada byte empezando por el más significativo.
+ *
+ * El flujo se procesa por segmentos sin guardarlo: cada segmento se resume en contadores
+ * (unos, transiciones, histograma de bytes, ventanas solapadas de 9 bits, desviación de los
+ * bloques) y dos segmentos consecutivos se unen sumando contadores y añadiendo lo que cruza
+ * la frontera. Así update() admite gigabytes y run() reparte segmentos entre núcleos. Los
+ * recuentos serial y de entropía aproximada son cíclicos (como en NIST): al final se
+ * cierran con las ventanas que unen el último byte con el primero.
+ */
+class RandomnessTests {
+public:
+    /**
+     * @brief Bytes por bloque de la prueba de frecuencia por bloques.
+     */
+    static constexpr size_t BLOCK_BYTES = 1024;
+
+    /**
+     * @brief Longitud de patrón de las pruebas serial y de entropía aproximada.
+     */
+    static constexpr int PATTERN_BITS = 8;
+
+    /**
+     * @brief Nivel de significación: una prueba falla si su p-valor es menor.
+     */
+    static constexpr double ALPHA = 0.01;
+
+    /**
+     * @brief Resultado de una prueba.
+     */
+    struct Result {
+        std::string name;
+        double statistic = 0.0;
+        double pValue = 0.0;
+        bool passed = false;
+    };
+
+    RandomnessTests() = default;
+    ~RandomnessTests() = default;
+
+    /**
+     * @brief Añade los siguientes bytes del flujo.
+     */
+    void
+        update(const uint8_t* data, size_t length) {
+        m_bytes += length;
+        // Los segmentos se cortan en múltiplos de BLOCK_BYTES; el resto espera al siguiente.
+        if (m_pendingLength > 0) {
+            size_t take = std::min(length, BLOCK_BYTES - m_pendingLength);
+            std::memcpy(m_pending + m_pendingLength, data, take);
+            m_pendingLength += take;
+            data += take;
+            length -= take;
+            if (m_pendingLength < BLOCK_BYTES) return;
+            appendSegment(m_pending, BLOCK_BYTES);
+            m_pendingLength = 0;
+        }
+        size_t whole = length / BLOCK_BYTES * BLOCK_BYTES;
+        if (whole > 0) appendSegment(data, whole);
+        std::memcpy(m_pending, data + whole, length - whole);
+        m_pendingLength = length - whole;
+    }
+
+    /**
+     * @brief Bytes recibidos hasta ahora.
+     */
+    uint64_t
+        bytesProcessed() const {
+        return m_bytes;
+    }
+
+    /**
+     * @brief Calcula los p-valores con todo lo recibido (se puede seguir llamando a update()).
+     *
+     * @throws std::runtime_error Si hay menos de BLOCK_BYTES bytes.
+     */
+    std::vector<Result>
+        results() const {
+        Segment total = m_total;
+        bool empty = !m_hasData;
+        if (m_pendingLength > 0) {
+            Segment tail;
+            tail.analyze(m_pending, m_pendingLength);
+            if (empty) total = tail;
+            else total.append(tail);
+            empty = false;
+        }
+        if (empty || total.bytes < BLOCK_BYTES) {
+            throw std::runtime_error("Las pruebas de aleatoriedad necesitan al menos "
+                + std::to_string(BLOCK_BYTES) + " bytes.");
+        }
+        return evaluate(total);
+    }
+
+    /**
+     * @brief Analiza totalBytes de una fuente secuencial repartiendo el análisis entre hilos.
+     *
+     * El hilo llamador genera trozos con source (nunca hay más de dos por hilo en memoria)
+     * y los hilos de trabajo los resumen; los segmentos se unen en orden.
+     *
+     * @param source     Escribe hasta n bytes del generador en el buffer y devuelve cuántos
+     *                   escribió; menos de n indica el final del flujo.
+     * @param totalBytes Máximo de bytes a analizar.
+     * @param threads    Hilos de análisis (0 = núcleos disponibles).
+     * @param chunkBytes Tamaño de cada trozo (se redondea a múltiplo de BLOCK_BYTES).
+     * @throws std::runtime_error Si la fuente da menos de BLOCK_BYTES bytes.
+     */
+    static std::vector<Result>
+        run(const std::function<size_t(uint8_t*, size_t)>& source, uint64_t totalBytes,
+            unsigned threads = 0, size_t chunkBytes = 4 * 1024 * 1024) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        chunkBytes = std::max(BLOCK_BYTES, chunkBytes / BLOCK_BYTES * BLOCK_BYTES);
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::vector<uint8_t>> buffers(2 * threads, std::vector<uint8_t>(chunkBytes));
+        std::vector<size_t> freeBuffers;
+        for (size_t b = 0; b < buffers.size(); ++b) freeBuffers.push_back(b);
+        std::vector<std::tuple<size_t, size_t, size_t>> ready;  // (trozo, buffer, longitud)
+        std::map<size_t, Segment> finished;
+        size_t nextToMerge = 0;
+        bool producing = true;
+        Segment total;
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                while (true) {
+                    std::tuple<size_t, size_t, size_t> job;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        changed.wait(lock, [&] { return !ready.empty() || !producing; });
+                        if (ready.empty()) return;
+                        job = ready.back();
+                        ready.pop_back();
+                    }
+                    Segment segment;
+                    segment.analyze(buffers[std::get<1>(job)].data(), std::get<2>(job));
+                    std::lock_guard<std::mutex> lock(mutex);
+                    freeBuffers.push_back(std::get<1>(job));
+                    finished.emplace(std::get<0>(job), std::move(segment));
+                    for (auto it = finished.find(nextToMerge); it != finished.end(); it = finished.find(nextToMerge)) {
+                        if (nextToMerge == 0) total = it->second;
+                        else total.append(it->second);
+                        finished.erase(it);
+                        ++nextToMerge;
+                    }
+                    changed.notify_all();
+                }
+                });
+        }
+
+        uint64_t produced = 0;
+        for (size_t c = 0; produced < totalBytes; ++c) {
+            size_t buffer;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return !freeBuffers.empty(); });
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+            size_t wanted = static_cast<size_t>(std::min<uint64_t>(chunkBytes, totalBytes - produced));
+            size_t length = source(buffers[buffer].data(), wanted);
+            produced += length;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (length == 0) {
+                freeBuffers.push_back(buffer);
+                break;
+            }
+            ready.emplace_back(c, buffer, length);
+            changed.notify_all();
+            if (length < wanted) break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            producing = false;
+        }
+        changed.notify_all();
+        for (auto& worker : workers) worker.join();
+
+        if (total.bytes < BLOCK_BYTES) {
+            throw std::runtime_error("Las pruebas de aleatoriedad necesitan al menos "
+                + std::to_string(BLOCK_BYTES) + " bytes.");
+        }
+        return evaluate(total);
+    }
+
+    /**
+     * @brief Indica si todas las pruebas pasan.
+     */
+    static bool
+        allPassed(const std::vector<Result>& results) {
+        return std::all_of(results.begin(), results.end(), [](const Result& r) { return r.passed; });
+    }
+
+    /**
+     * @brief Escribe los resultados como tabla.
+     */
+    static void
+        printResults(const std::vector<Result>& results, std::ostream& out) {
+        for (const Result& r : results) {
+            out << std::left << std::setw(28) << r.name << std::right
+                << " estadistico " << std::setw(12) << std::fixed << std::setprecision(4) << r.statistic
+                << "  p = " << std::setprecision(6) << r.pValue
+                << (r.passed ? "  OK" : "  FALLA") << "\n";
+        }
+        out << std::defaultfloat;
+    }
+
+    /**
+     * @brief Función gamma incompleta regularizada superior Q(a, x).
+     */
+    static double
+        igamc(double a, double x) {
+        if (x <= 0.0) return 1.0;
+        double logPrefix = -x + a * std::log(x) - std::lgamma(a);
+        if (x < a + 1.0) {
+            double term = 1.0 / a;
+            double sum = term;
+            for (int n = 1; n < 10000; ++n) {
+                term *= x / (a + n);
+                sum += term;
+                if (std::fabs(term) < std::fabs(sum) * 1e-15) break;
+            }
+            return std::max(0.0, 1.0 - sum * std::exp(logPrefix));
+        }
+        // Fracción continua de Lentz.
+        const double tiny = 1e-300;
+        double b = x + 1.0 - a;
+        double c = 1.0 / tiny;
+        double d = 1.0 / b;
+        double h = d;
+        for (int i = 1; i < 10000; ++i) {
+            double an = -i * (i - a);
+            b += 2.0;
+            d = an * d + b;
+            if (std::fabs(d) < tiny) d = tiny;
+            c = b + an / c;
+            if (std::fabs(c) < tiny) c = tiny;
+            d = 1.0 / d;
+            double delta = d * c;
+            h *= delta;
+            if (std::fabs(delta - 1.0) < 1e-15) break;
+        }
+        return std::exp(logPrefix) * h;
+    }
+
+private:
+    static constexpr int WINDOW_BITS = PATTERN_BITS + 1;
+    static constexpr size_t WINDOWS = size_t(1) << WINDOW_BITS;
+
+    /**
+     * @brief Resumen de un tramo contiguo del flujo.
+     */
+    struct Segment {
+        uint64_t bytes = 0;
+        uint64_t ones = 0;
+        uint64_t transitions = 0;                ///< Pares de bits vecinos distintos dentro del tramo.
+        uint64_t blocks = 0;
+        double blockDeviation = 0.0;             ///< Suma de (pi - 1/2)^2 de los bloques completos.
+        std::array<uint64_t, 256> histogram{};
+        std::array<uint64_t, WINDOWS> windows{};  ///< Ventanas de 9 bits contenidas en el tramo.
+        uint8_t first = 0;
+        uint8_t last = 0;
+
+        /**
+         * @brief Resume un tramo (los bloques completos empiezan en data).
+         */
+        void
+            analyze(const uint8_t* data, size_t length) {
+            if (length == 0) return;
+            bytes = length;
+            first = data[0];
+            last = data[length - 1];
+            size_t offset = 0;
+            for (; offset + BLOCK_BYTES <= length; offset += BLOCK_BYTES) {
+                uint64_t blockOnes = popcount(data + offset, BLOCK_BYTES);
+                double pi = static_cast<double>(blockOnes) / (BLOCK_BYTES * 8);
+                blockDeviation += (pi - 0.5) * (pi - 0.5);
+                ones += blockOnes;
+                ++blocks;
+            }
+            ones += popcount(data + offset, length - offset);
+            transitions = countTransitions(data, length);
+            countPatterns(data, length);
+        }
+
+        /**
+         * @brief Añade a continuación el tramo @p next.
+         */
+        void
+            append(const Segment& next) {
+            if (next.bytes == 0) return;
+            if (bytes == 0) {
+                *this = next;
+                return;
+            }
+            transitions += next.transitions + ((last & 1) != (next.first >> 7));
+            addCrossingWindows(last, next.first, windows);
+            ones += next.ones;
+            blocks += next.blocks;
+            blockDeviation += next.blockDeviation;
+            for (size_t i = 0; i < 256; ++i) histogram[i] += next.histogram[i];
+            for (size_t i = 0; i < WINDOWS; ++i) windows[i] += next.windows[i];
+            bytes += next.bytes;
+            last = next.last;
+        }
+
+        /**
+         * @brief Ventanas que empiezan en el byte @p before y terminan en @p after.
+         */
+        static void
+            addCrossingWindows(uint8_t before, uint8_t after, std::array<uint64_t, WINDOWS>& windows) {
+            uint32_t word = (static_cast<uint32_t>(before) << 8) | after;
+            for (int p = 0; p < 8; ++p) {
+                ++windows[(word >> (16 - WINDOW_BITS - p)) & (WINDOWS - 1)];
+            }
+        }
+
+        /**
+         * @brief Histograma de bytes y ventanas solapadas de 9 bits. Cada desplazamiento
+         *        de bit tiene su propia tabla para que los incrementos no se esperen.
+         */
+        void
+            countPatterns(const uint8_t* data, size_t length) {
+            constexpr size_t SLICE = 1 << 20;  // Contadores de 32 bits sin desbordar.
+            std::vector<uint32_t> partial(8 * WINDOWS + 256);
+            for (size_t start = 0; start < length; start += SLICE) {
+                std::fill(partial.begin(), partial.end(), 0);
+                uint32_t* w = partial.data();
+                uint32_t* h = partial.data() + 8 * WINDOWS;
+                size_t end = std::min(length, start + SLICE);
+                for (size_t i = start; i < end; ++i) {
+                    ++h[data[i]];
+                    if (i + 1 == length) break;
+                    uint32_t word = (static_cast<uint32_t>(data[i]) << 8) | data[i + 1];
+                    ++w[0 * WINDOWS + ((word >> 7) & (WINDOWS - 1))];
+                    ++w[1 * WINDOWS + ((word >> 6) & (WINDOWS - 1))];
+                    ++w[2 * WINDOWS + ((word >> 5) & (WINDOWS - 1))];
+                    ++w[3 * WINDOWS + ((word >> 4) & (WINDOWS - 1))];
+                    ++w[4 * WINDOWS + ((word >> 3) & (WINDOWS - 1))];
+                    ++w[5 * WINDOWS + ((word >> 2) & (WINDOWS - 1))];
+                    ++w[6 * WINDOWS + ((word >> 1) & (WINDOWS - 1))];
+                    ++w[7 * WINDOWS + (word & (WINDOWS - 1))];
+                }
+                for (size_t v = 0; v < WINDOWS; ++v) {
+                    for (int p = 0; p < 8; ++p) windows[v] += w[p * WINDOWS + v];
+                }
+                for (size_t b = 0; b < 256; ++b) histogram[b] += h[b];
+            }
+        }
+    };
+
+    Segment m_total;
+    bool m_hasData = false;
+    uint8_t m_pending[BLOCK_BYTES];
+    size_t m_pendingLength = 0;
+    uint64_t m_bytes = 0;
+
+    void
+        appendSegment(const uint8_t* data, size_t length) {
+        Segment segment;
+        segment.analyze(data, length);
+        if (!m_hasData) m_total = segment;
+        else m_total.append(segment);
+        m_hasData = true;
+    }
+
+    /**
+     * @brief Calcula las seis pruebas a partir del resumen de todo el flujo.
+     */
+    static std::vector<Result>
+        evaluate(const Segment& total) {
+        const double n = static_cast<double>(total.bytes) * 8.0;
+        std::vector<Result> results;
+        auto add = [&](const char* name, double statistic, double p) {
+            results.push_back({ name, statistic, p, p >= ALPHA });
+        };
+
+        // Monobit.
+        double s = std::fabs(2.0 * static_cast<double>(total.ones) - n) / std::sqrt(n);
+        add("Monobit", s, std::erfc(s / std::sqrt(2.0)));
+
+        // Frecuencia por bloques.
+        double blockChi = 4.0 * (BLOCK_BYTES * 8) * total.blockDeviation;
+        add("Frecuencia por bloques", blockChi, igamc(total.blocks / 2.0, blockChi / 2.0));
+
+        // Rachas: requiere que la proporción de unos pase antes la prueba previa de NIST.
+        double pi = total.ones / n;
+        double runs = static_cast<double>(total.transitions) + 1.0;
+        if (std::fabs(pi - 0.5) >= 2.0 / std::sqrt(n)) {
+            add("Rachas", runs, 0.0);
+        }
+        else {
+            double expected = 2.0 * n * pi * (1.0 - pi);
+            double deviation = std::fabs(runs - expected) / (2.0 * std::sqrt(2.0 * n) * pi * (1.0 - pi));
+            add("Rachas", runs, std::erfc(deviation));
+        }
+
+        // Chi-cuadrado de bytes (255 grados de libertad).
+        double expectedByte = static_cast<double>(total.bytes) / 256.0;
+        double byteChi = 0.0;
+        for (uint64_t count : total.histogram) {
+            double d = static_cast<double>(count) - expectedByte;
+            byteChi += d * d / expectedByte;
+        }
+        add("Chi-cuadrado de bytes", byteChi, igamc(255.0 / 2.0, byteChi / 2.0));
+
+        // Cierre cíclico: ventanas que empiezan en el último byte y siguen por el primero.
+        std::array<uint64_t, WINDOWS> cyclic = total.windows;
+        Segment::addCrossingWindows(total.last, total.first, cyclic);
+        std::vector<std::vector<double>> counts(WINDOW_BITS + 1);
+        counts[WINDOW_BITS].assign(cyclic.begin(), cyclic.end());
+        for (int m = WINDOW_BITS - 1; m >= PATTERN_BITS - 2; --m) {
+            counts[m].assign(size_t(1) << m, 0.0);
+            for (size_t v = 0; v < counts[m + 1].size(); ++v) counts[m][v >> 1] += counts[m + 1][v];
+        }
+
+        // Serial (m = 8): psi^2 con desviaciones para no perder precisión con n grande.
+        auto psi = [&](int m) {
+            double expected = n / static_cast<double>(size_t(1) << m);
+            double sum = 0.0;
+            for (double c : counts[m]) sum += (c - expected) * (c - expected);
+            return sum / expected;
+        };
+        double psi8 = psi(PATTERN_BITS), psi7 = psi(PATTERN_BITS - 1), psi6 = psi(PATTERN_BITS - 2);
+        double delta1 = psi8 - psi7;
+        double delta2 = psi8 - 2.0 * psi7 + psi6;
+        add("Serial (1)", delta1, igamc(std::ldexp(1.0, PATTERN_BITS - 2), delta1 / 2.0));
+        add("Serial (2)", delta2, igamc(std::ldexp(1.0, PATTERN_BITS - 3), delta2 / 2.0));
+
+        // Entropía aproximada (m = 8): 2n(ln 2 - ApEn) escrito como estadístico G para
+        // evitar restar dos números casi iguales.
+        double apenChi = 0.0;
+        for (size_t v = 0; v < counts[WINDOW_BITS].size(); ++v) {
+            double c = counts[WINDOW_BITS][v];
+            double parent = counts[PATTERN_BITS][v >> 1];
+            if (c > 0) apenChi += 2.0 * c * std::log(2.0 * c / parent);
+        }
+        add("Entropia aproximada", apenChi, igamc(std::ldexp(1.0, PATTERN_BITS - 1), apenChi / 2.0));
+        return results;
+    }
+
+    /**
+     * @brief Unos en un buffer (AVX2: tabla de nibbles con pshufb y suma con psadbw).
+     */
+    static uint64_t
+        popcount(const uint8_t* data, size_t length) {
+        size_t done = 0;
+        uint64_t total = 0;
+#if TTC_X86
+        static const bool useAvx2 = CpuFeatures::get().avx2;
+        if (useAvx2) {
+            done = length / 32 * 32;
+            total = popcountAvx2(data, done, nullptr);
+        }
+#endif
+        for (size_t i = done; i < length; ++i) total += bitsSet(data[i]);
+        return total;
+    }
+
+    /**
+     * @brief Pares de bits vecinos distintos: dentro de cada byte (b ^ b >> 1, 7 pares) y
+     *        entre el bit bajo de un byte y el alto del siguiente.
+     */
+    static uint64_t
+        countTransitions(const uint8_t* data, size_t length) {
+        size_t done = 0;
+        uint64_t total = 0;
+#if TTC_X86
+        static const bool useAvx2 = CpuFeatures::get().avx2;
+        if (useAvx2 && length > 32) {
+            // La última carga lee data[i + 1 .. i + 32]: hace falta un byte más.
+            done = (length - 1) / 32 * 32;
+            total = popcountAvx2(data, done, data + 1);
+        }
+#endif
+        for (size_t i = done; i < length; ++i) {
+            uint8_t b = data[i];
+            total += bitsSet(static_cast<uint8_t>((b ^ (b >> 1)) & 0x7F));
+            if (i + 1 < length) total += (b & 1) != (data[i + 1] >> 7);
+        }
+        return total;
+    }
+
+    static int
+        bitsSet(uint8_t b) {
+        static const std::array<uint8_t, 256> table = [] {
+            std::array<uint8_t, 256> t{};
+            for (int i = 0; i < 256; ++i) t[i] = static_cast<uint8_t>((i & 1) + t[i / 2]);
+            return t;
+            }();
+        return table[b];
+    }
+
+#if TTC_X86
+    /**
+     * @brief Cuenta unos de data, o transiciones si se pasa next (= data + 1).
+     *
+     * @param length Múltiplo de 32.
+     */
+    TTC_TARGET("avx2")
+        static uint64_t
+        popcountAvx2(const uint8_t* data, size_t length, const uint8_t* next) {
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i low7 = _mm256_set1_epi8(0x7F);
+        const __m256i one = _mm256_set1_epi8(1);
+        __m256i sum = _mm256_setzero_si256();
+        for (size_t i = 0; i < length; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            if (next) {
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(next + i));
+                __m256i inner = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi16(x, 1)), low7);
+                __m256i cross = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi16(y, 7)), one);
+                x = _mm256_or_si256(inner, _mm256_slli_epi16(cross, 7));
+            }
+            __m256i counts = _mm256_add_epi8(
+                _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, nibble)),
+                _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+            sum = _mm256_add_epi64(sum, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+};
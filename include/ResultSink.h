@@ -0,0 +1,390 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Candidato producido por un ataque (clave probada y texto que da).
+ */
+struct AttackResult {
+    std::string attack;     ///< Nombre del ataque ("xor-1byte", "cesar", "vigenere"...).
+    std::string key;        ///< Clave en forma legible (hex para XOR, letras para Vigenère).
+    std::string plaintext;
+    double score = 0.0;     ///< Mayor es mejor; la escala depende del ataque.
+};
+
+/**
+ * @class ResultSink
+ * @brief Destino de los candidatos de un ataque.
+ *
+ * Los bucles de búsqueda no escriben en consola: entregan cada candidato a un sumidero,
+ * que decide si lo descarta, lo guarda (top-K) o lo serializa. push() puede llamarse desde
+ * varios hilos a la vez; los datos de @p key y @p plaintext solo tienen que vivir durante
+ * la llamada, así que el ataque puede reutilizar sus buffers sin copiar por candidato.
+ */
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    /**
+     * @brief Entrega un candidato.
+     */
+    virtual void
+        push(std::string_view attack, std::string_view key, std::string_view plaintext, double score) = 0;
+
+    void
+        push(const AttackResult& result) {
+        push(result.attack, result.key, result.plaintext, result.score);
+    }
+
+    /**
+     * @brief Vacía lo que esté pendiente (buffers) hacia el destino final.
+     */
+    virtual void
+        flush() {}
+};
+
+/**
+ * @class NullSink
+ * @brief Descarta los candidatos; solo los cuenta. Útil para medir el coste del ataque puro.
+ */
+class NullSink : public ResultSink {
+public:
+    void
+        push(std::string_view, std::string_view, std::string_view, double) override {
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t
+        count() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_count{ 0 };
+};
+
+/**
+ * @class TopKSink
+ * @brief Conserva los K candidatos de mayor puntuación (montículo de mínimos).
+ *
+ * El umbral (peor puntuación del montículo lleno) se publica en un atómico para que los
+ * candidatos que no entran se rechacen sin tomar el mutex, que es el caso habitual cuando
+ * se prueban millones de claves.
+ */
+class TopKSink : public ResultSink {
+public:
+    /**
+     * @throws std::invalid_argument Si @p capacity es 0.
+     */
+    explicit TopKSink(size_t capacity) : m_capacity(capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("El top-K necesita al menos un elemento.");
+        }
+    }
+
+    void
+        push(std::string_view attack, std::string_view key, std::string_view plaintext, double score) override {
+        m_seen.fetch_add(1, std::memory_order_relaxed);
+        if (score <= m_threshold.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_heap.size() == m_capacity) {
+            if (score <= m_heap.front().score) {
+                return;
+            }
+            std::pop_heap(m_heap.begin(), m_heap.end(), worse);
+            AttackResult& slot = m_heap.back();
+            slot.attack.assign(attack);
+            slot.key.assign(key);
+            slot.plaintext.assign(plaintext);
+            slot.score = score;
+        }
+        else {
+            m_heap.push_back(AttackResult{ std::string(attack), std::string(key), std::string(plaintext), score });
+        }
+        std::push_heap(m_heap.begin(), m_heap.end(), worse);
+        if (m_heap.size() == m_capacity) {
+            m_threshold.store(m_heap.front().score, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Candidatos conservados, de mejor a peor.
+     */
+    std::vector<AttackResult>
+        results() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<AttackResult> sorted = m_heap;
+        std::sort(sorted.begin(), sorted.end(), [](const AttackResult& a, const AttackResult& b) {
+            return a.score > b.score;
+            });
+        return sorted;
+    }
+
+    /**
+     * @brief Candidatos recibidos en total (incluidos los descartados).
+     */
+    uint64_t
+        seen() const {
+        return m_seen.load(std::memory_order_relaxed);
+    }
+
+private:
+    size_t m_capacity;
+    std::vector<AttackResult> m_heap;
+    mutable std::mutex m_mutex;
+    std::atomic<double> m_threshold{ -std::numeric_limits<double>::infinity() };
+    std::atomic<uint64_t> m_seen{ 0 };
+
+    static bool
+        worse(const AttackResult& a, const AttackResult& b) {
+        return a.score > b.score;
+    }
+};
+
+/**
+ * @class BufferedSink
+ * @brief Base de los sumideros que serializan a un std::ostream.
+ *
+ * Cada hilo formatea en su propio buffer (su mutex nunca está disputado salvo durante
+ * flush()) y solo toma el mutex del flujo cuando el buffer supera FLUSH_BYTES, así que el
+ * flujo recibe escrituras grandes y pocas. Los registros nunca se parten, pero los de hilos
+ * distintos pueden quedar intercalados por bloques. No se usa std::endl ni se tocan los
+ * indicadores de formato del flujo.
+ */
+class BufferedSink : public ResultSink {
+public:
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+    explicit BufferedSink(std::ostream& out) : m_out(out), m_id(nextId()) {}
+
+    ~BufferedSink() override {
+        flush();
+    }
+
+    BufferedSink(const BufferedSink&) = delete;
+    BufferedSink& operator=(const BufferedSink&) = delete;
+
+    void
+        push(std::string_view attack, std::string_view key, std::string_view plaintext, double score) override {
+        ThreadBuffer& buffer = localBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        format(buffer.data, attack, key, plaintext, score);
+        if (buffer.data.size() >= FLUSH_BYTES) {
+            drain(buffer);
+        }
+    }
+
+    void
+        flush() override {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (auto& entry : m_buffers) {
+            std::lock_guard<std::mutex> bufferLock(entry.second->mutex);
+            drain(*entry.second);
+        }
+        std::lock_guard<std::mutex> outLock(m_outMutex);
+        m_out.flush();
+    }
+
+protected:
+    /**
+     * @brief Añade al final de @p out la representación de un candidato.
+     */
+    virtual void
+        format(std::string& out, std::string_view attack, std::string_view key,
+            std::string_view plaintext, double score) = 0;
+
+    /**
+     * @brief Escribe una cabecera directamente en el flujo (antes de cualquier registro).
+     */
+    void
+        writeHeader(std::string_view header) {
+        std::lock_guard<std::mutex> lock(m_outMutex);
+        m_out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+
+    /**
+     * @brief Puntuación con hasta 6 cifras significativas, sin pasar por el flujo.
+     */
+    static void
+        appendScore(std::string& out, double score) {
+        char text[32];
+        int length = std::snprintf(text, sizeof(text), "%.6g", score);
+        out.append(text, static_cast<size_t>(std::max(length, 0)));
+    }
+
+private:
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::string data;
+    };
+
+    std::ostream& m_out;
+    std::mutex m_outMutex;
+    uint64_t m_id;
+    std::mutex m_buffersMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadBuffer>> m_buffers;
+
+    static uint64_t
+        nextId() {
+        static std::atomic<uint64_t> counter{ 0 };
+        return ++counter;
+    }
+
+    /**
+     * @brief Buffer del hilo actual; el último sumidero usado se recuerda en una caché
+     *        thread_local para no buscar en el mapa en cada push().
+     */
+    ThreadBuffer&
+        localBuffer() {
+        struct Cache {
+            uint64_t id = 0;
+            ThreadBuffer* buffer = nullptr;
+        };
+        thread_local Cache cache;
+        if (cache.id == m_id) {
+            return *cache.buffer;
+        }
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        std::unique_ptr<ThreadBuffer>& slot = m_buffers[std::this_thread::get_id()];
+        if (!slot) {
+            slot = std::make_unique<ThreadBuffer>();
+            slot->data.reserve(FLUSH_BYTES + 1024);
+        }
+        cache.id = m_id;
+        cache.buffer = slot.get();
+        return *slot;
+    }
+
+    void
+        drain(ThreadBuffer& buffer) {
+        if (buffer.data.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_outMutex);
+        m_out.write(buffer.data.data(), static_cast<std::streamsize>(buffer.data.size()));
+        buffer.data.clear();
+    }
+};
+
+/**
+ * @class JsonLinesSink
+ * @brief Un objeto JSON por línea: {"attack":..,"key":..,"score":..,"plaintext":..}.
+ *
+ * Los bytes de control y los no ASCII se escapan como \u00XX (los textos candidatos son
+ * bytes arbitrarios, no necesariamente UTF-8 válido).
+ */
+class JsonLinesSink : public BufferedSink {
+public:
+    explicit JsonLinesSink(std::ostream& out) : BufferedSink(out) {}
+
+protected:
+    void
+        format(std::string& out, std::string_view attack, std::string_view key,
+            std::string_view plaintext, double score) override {
+        out += "{\"attack\":";
+        appendString(out, attack);
+        out += ",\"key\":";
+        appendString(out, key);
+        out += ",\"score\":";
+        appendScore(out, score);
+        out += ",\"plaintext\":";
+        appendString(out, plaintext);
+        out += "}\n";
+    }
+
+private:
+    static void
+        appendString(std::string& out, std::string_view text) {
+        static const char HEX[] = "0123456789abcdef";
+        out += '"';
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            }
+            else if (byte < 0x20 || byte >= 0x7F) {
+                out += "\\u00";
+                out += HEX[byte >> 4];
+                out += HEX[byte & 0x0F];
+            }
+            else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+};
+
+/**
+ * @class CsvSink
+ * @brief CSV (RFC 4180) con cabecera attack,key,score,plaintext.
+ *
+ * Los campos con comas, comillas o saltos de línea van entre comillas y las comillas
+ * internas se duplican.
+ */
+class CsvSink : public BufferedSink {
+public:
+    explicit CsvSink(std::ostream& out, bool header = true) : BufferedSink(out) {
+        if (header) {
+            writeHeader("attack,key,score,plaintext\n");
+        }
+    }
+
+protected:
+    void
+        format(std::string& out, std::string_view attack, std::string_view key,
+            std::string_view plaintext, double score) override {
+        appendField(out, attack);
+        out += ',';
+        appendField(out, key);
+        out += ',';
+        appendScore(out, score);
+        out += ',';
+        appendField(out, plaintext);
+        out += '\n';
+    }
+
+private:
+    static void
+        appendField(std::string& out, std::string_view text) {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out.append(text);
+            return;
+        }
+        out += '"';
+        for (char c : text) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+};
+
+/**
+ * @class TextSink
+ * @brief Formato legible para consola, el que usaban los ataques al imprimir directamente.
+ */
+class TextSink : public BufferedSink {
+public:
+    explicit TextSink(std::ostream& out) : BufferedSink(out) {}
+
+protected:
+    void
+        format(std::string& out, std::string_view attack, std::string_view key,
+            std::string_view plaintext, double score) override {
+        out += "=============================\n[";
+        out.append(attack);
+        out += "] Clave: ";
+        out.append(key);
+        out += "  (puntuacion ";
+        appendScore(out, score);
+        out += ")\nTexto posible : ";
+        out.append(plaintext);
+        out += '\n';
+    }
+};
@@ -0,0 +1,232 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+
+/**
+ * @class SHA1
+ * @brief Implementa el hash SHA-1 (FIPS 180-4).
+ *
+ * SHA-1 ya no es seguro frente a colisiones; aquí sólo se usa para leer listas de
+ * contraseñas filtradas que se publican como resúmenes SHA-1 en hexadecimal. Usa las
+ * extensiones SHA-NI cuando la CPU las tiene.
+ */
+class SHA1 {
+public:
+    /**
+     * @brief Tamaño del resumen en bytes.
+     */
+    static constexpr size_t DIGEST_SIZE = 20;
+
+    /**
+     * @brief Tamaño de bloque interno en bytes.
+     */
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    SHA1() {
+        reset();
+    }
+
+    ~SHA1() = default;
+
+    /**
+     * @brief Reinicia el estado para calcular un nuevo resumen.
+     */
+    void
+        reset() {
+        static const uint32_t h0[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+        std::memcpy(m_state, h0, sizeof(m_state));
+        m_bufferLength = 0;
+        m_totalLength = 0;
+    }
+
+    /**
+     * @brief Añade datos al resumen.
+     */
+    void
+        update(const uint8_t* data, size_t length) {
+        m_totalLength += length;
+        if (m_bufferLength > 0) {
+            size_t take = BLOCK_SIZE - m_bufferLength;
+            if (take > length) take = length;
+            std::memcpy(m_buffer + m_bufferLength, data, take);
+            m_bufferLength += take;
+            data += take;
+            length -= take;
+            if (m_bufferLength == BLOCK_SIZE) {
+                compress(m_state, m_buffer);
+                m_bufferLength = 0;
+            }
+        }
+        while (length >= BLOCK_SIZE) {
+            compress(m_state, data);
+            data += BLOCK_SIZE;
+            length -= BLOCK_SIZE;
+        }
+        if (length > 0) {
+            std::memcpy(m_buffer, data, length);
+            m_bufferLength = length;
+        }
+    }
+
+    /**
+     * @brief Añade una cadena al resumen.
+     */
+    void
+        update(const std::string& data) {
+        update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    /**
+     * @brief Aplica el relleno y escribe el resumen de 20 bytes.
+     */
+    void
+        finalize(uint8_t* digest) {
+        uint64_t bits = m_totalLength * 8;
+        uint8_t pad[BLOCK_SIZE * 2] = {};
+        size_t padLength = (m_bufferLength < 56) ? 56 - m_bufferLength : 120 - m_bufferLength;
+        pad[0] = 0x80;
+        for (int i = 0; i < 8; ++i) {
+            pad[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(pad, padLength + 8);
+        for (int i = 0; i < 5; ++i) {
+            digest[4 * i] = static_cast<uint8_t>(m_state[i] >> 24);
+            digest[4 * i + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+            digest[4 * i + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+            digest[4 * i + 3] = static_cast<uint8_t>(m_state[i]);
+        }
+    }
+
+    /**
+     * @brief Calcula el SHA-1 de un buffer en el destino indicado (sin reservar memoria).
+     */
+    static void
+        hash(const uint8_t* data, size_t length, uint8_t* digest) {
+        SHA1 sha;
+        sha.update(data, length);
+        sha.finalize(digest);
+    }
+
+    /**
+     * @brief Calcula el SHA-1 de una cadena.
+     */
+    static std::vector<uint8_t>
+        hash(const std::string& data) {
+        std::vector<uint8_t> digest(DIGEST_SIZE);
+        hash(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest.data());
+        return digest;
+    }
+
+private:
+    uint32_t m_state[5];
+    uint8_t m_buffer[BLOCK_SIZE];
+    size_t m_bufferLength = 0;
+    uint64_t m_totalLength = 0;
+
+    static uint32_t
+        rotl(uint32_t x, int n) {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    static void
+        compress(uint32_t* state, const uint8_t* block) {
+#if TTC_X86
+        static const bool useShaNi = CpuFeatures::get().shani && CpuFeatures::get().sse41;
+        if (useShaNi) {
+            compressShaNi(state, block);
+            return;
+        }
+#endif
+        uint32_t w[80];
+        for (int j = 0; j < 16; ++j) {
+            const uint8_t* p = block + 4 * j;
+            w[j] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+                | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+        for (int j = 16; j < 80; ++j) {
+            w[j] = rotl(w[j - 3] ^ w[j - 8] ^ w[j - 14] ^ w[j - 16], 1);
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int j = 0; j < 80; ++j) {
+            uint32_t f, k;
+            if (j < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (j < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (j < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = rotl(a, 5) + f + e + k + w[j];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+
+#if TTC_X86
+    /**
+     * @brief Cuatro rondas (grupo I de 20) con SHA-NI. La expansión del mensaje va
+     *        adelantada: msg1, xor y msg2 preparan las palabras de los grupos siguientes.
+     */
+    template <int I>
+    TTC_TARGET("sha,sse4.1")
+        static void
+        roundGroupShaNi(__m128i& abcd, __m128i* e, __m128i* msg) {
+        __m128i& current = e[I & 1];
+        current = _mm_sha1nexte_epu32(current, msg[I % 4]);
+        e[(I + 1) & 1] = abcd;
+        if constexpr (I >= 3 && I <= 18) msg[(I - 3) % 4] = _mm_sha1msg2_epu32(msg[(I - 3) % 4], msg[I % 4]);
+        abcd = _mm_sha1rnds4_epu32(abcd, current, I / 5);
+        if constexpr (I >= 1 && I <= 16) msg[(I - 1) % 4] = _mm_sha1msg1_epu32(msg[(I - 1) % 4], msg[I % 4]);
+        if constexpr (I >= 2 && I <= 17) msg[(I - 2) % 4] = _mm_xor_si128(msg[(I - 2) % 4], msg[I % 4]);
+    }
+
+    template <int... I>
+    TTC_TARGET("sha,sse4.1")
+        static void
+        roundGroupsShaNi(__m128i& abcd, __m128i* e, __m128i* msg, std::integer_sequence<int, I...>) {
+        (roundGroupShaNi<I + 1>(abcd, e, msg), ...);
+    }
+
+    TTC_TARGET("sha,sse4.1")
+        static void
+        compressShaNi(uint32_t* state, const uint8_t* block) {
+        const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+        __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+        const __m128i abcdSave = abcd;
+        __m128i e[2] = { _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0), _mm_setzero_si128() };
+        const __m128i eSave = e[0];
+        __m128i msg[4];
+        for (int i = 0; i < 4; ++i) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i)), mask);
+        }
+
+        e[0] = _mm_add_epi32(e[0], msg[0]);
+        e[1] = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e[0], 0);
+        roundGroupsShaNi(abcd, e, msg, std::make_integer_sequence<int, 19>());
+
+        e[0] = _mm_sha1nexte_epu32(e[0], eSave);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+        state[4] = static_cast<uint32_t>(_mm_extract_epi32(e[0], 3));
+    }
+#endif
+};
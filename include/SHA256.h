@@ -0,0 +1,398 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+
+/**
+ * @class SHA256
+ * @brief Implementa el hash SHA-256 (FIPS 180-4) con ruta SHA-NI opcional.
+ *
+ * Se puede usar de forma incremental (update/finalize) o con el método estático hash.
+ * La función de compresión se expone para que HMAC y PBKDF2 puedan reutilizar
+ * estados precalculados sin volver a procesar el relleno de la clave.
+ */
+class SHA256 {
+public:
+    /**
+     * @brief Tamaño del resumen en bytes.
+     */
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    /**
+     * @brief Tamaño de bloque interno en bytes.
+     */
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    SHA256() {
+        reset();
+    }
+
+    ~SHA256() = default;
+
+    /**
+     * @brief Reinicia el estado para calcular un nuevo resumen.
+     */
+    void
+        reset() {
+        std::memcpy(m_state, initialState(), sizeof(m_state));
+        m_bufferLength = 0;
+        m_totalLength = 0;
+    }
+
+    /**
+     * @brief Continúa desde un estado que ya procesó exactamente un bloque.
+     *
+     * HMAC lo usa para partir de los estados ipad/opad precalculados.
+     */
+    void
+        resumeFrom(const uint32_t* state) {
+        std::memcpy(m_state, state, sizeof(m_state));
+        m_bufferLength = 0;
+        m_totalLength = BLOCK_SIZE;
+    }
+
+    /**
+     * @brief Añade datos al resumen.
+     */
+    void
+        update(const uint8_t* data, size_t length) {
+        m_totalLength += length;
+        if (m_bufferLength > 0) {
+            size_t take = BLOCK_SIZE - m_bufferLength;
+            if (take > length) take = length;
+            std::memcpy(m_buffer + m_bufferLength, data, take);
+            m_bufferLength += take;
+            data += take;
+            length -= take;
+            if (m_bufferLength == BLOCK_SIZE) {
+                compress(m_state, m_buffer, 1);
+                m_bufferLength = 0;
+            }
+        }
+        size_t blocks = length / BLOCK_SIZE;
+        if (blocks > 0) {
+            compress(m_state, data, blocks);
+            data += blocks * BLOCK_SIZE;
+            length -= blocks * BLOCK_SIZE;
+        }
+        if (length > 0) {
+            std::memcpy(m_buffer, data, length);
+            m_bufferLength = length;
+        }
+    }
+
+    /**
+     * @brief Añade una cadena al resumen.
+     */
+    void
+        update(const std::string& data) {
+        update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    /**
+     * @brief Aplica el relleno y escribe el resumen de 32 bytes.
+     */
+    void
+        finalize(uint8_t* digest) {
+        uint64_t bits = m_totalLength * 8;
+        uint8_t pad[BLOCK_SIZE * 2] = {};
+        size_t padLength = (m_bufferLength < 56) ? 56 - m_bufferLength : 120 - m_bufferLength;
+        pad[0] = 0x80;
+        for (int i = 0; i < 8; ++i) {
+            pad[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(pad, padLength + 8);
+        storeState(m_state, digest);
+    }
+
+    /**
+     * @brief Calcula el SHA-256 de un buffer.
+     */
+    static std::vector<uint8_t>
+        hash(const uint8_t* data, size_t length) {
+        SHA256 sha;
+        sha.update(data, length);
+        std::vector<uint8_t> digest(DIGEST_SIZE);
+        sha.finalize(digest.data());
+        return digest;
+    }
+
+    /**
+     * @brief Calcula el SHA-256 de un vector de bytes.
+     */
+    static std::vector<uint8_t>
+        hash(const std::vector<uint8_t>& data) {
+        return hash(data.data(), data.size());
+    }
+
+    /**
+     * @brief Calcula el SHA-256 de una cadena.
+     */
+    static std::vector<uint8_t>
+        hash(const std::string& data) {
+        return hash(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    /**
+     * @brief Estado inicial H0..H7.
+     */
+    static const uint32_t*
+        initialState() {
+        static const uint32_t h0[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        return h0;
+    }
+
+    /**
+     * @brief Constantes de ronda K0..K63.
+     */
+    static const uint32_t*
+        roundConstants() {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+        return k;
+    }
+
+    /**
+     * @brief Procesa @p count bloques de 64 bytes sobre @p state (SHA-NI si está disponible).
+     */
+    static void
+        compress(uint32_t* state, const uint8_t* blocks, size_t count) {
+#if TTC_X86
+        static const bool useShaNi = CpuFeatures::get().shani && CpuFeatures::get().sse41;
+        if (useShaNi) {
+            compressShaNi(state, blocks, count);
+            return;
+        }
+#endif
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t w[16];
+            for (int j = 0; j < 16; ++j) {
+                const uint8_t* p = blocks + i * BLOCK_SIZE + 4 * j;
+                w[j] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+                    | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+            }
+            compressWords(state, w);
+        }
+    }
+
+    /**
+     * @brief Procesa un bloque ya expresado como 16 palabras big-endian.
+     *
+     * PBKDF2 lo usa para encadenar resúmenes sin convertirlos a bytes.
+     */
+    static void
+        compressWords(uint32_t* state, const uint32_t* block) {
+        const uint32_t* k = roundConstants();
+        uint32_t w[64];
+        for (int j = 0; j < 16; ++j) w[j] = block[j];
+        for (int j = 16; j < 64; ++j) {
+            uint32_t s0 = rotr(w[j - 15], 7) ^ rotr(w[j - 15], 18) ^ (w[j - 15] >> 3);
+            uint32_t s1 = rotr(w[j - 2], 17) ^ rotr(w[j - 2], 19) ^ (w[j - 2] >> 10);
+            w[j] = w[j - 16] + s0 + w[j - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int j = 0; j < 64; ++j) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[j] + w[j];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    /**
+     * @brief Escribe un estado como resumen big-endian de 32 bytes.
+     */
+    static void
+        storeState(const uint32_t* state, uint8_t* digest) {
+        for (int i = 0; i < 8; ++i) {
+            digest[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+            digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+            digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+            digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+        }
+    }
+
+private:
+    uint32_t m_state[8];
+    uint8_t m_buffer[BLOCK_SIZE];
+    size_t m_bufferLength = 0;
+    uint64_t m_totalLength = 0;
+
+    static uint32_t
+        rotr(uint32_t x, int n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+#if TTC_X86
+    TTC_TARGET("sha,sse4.1")
+        static void
+        compressShaNi(uint32_t* state, const uint8_t* data, size_t count) {
+        const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+        const uint32_t* k = roundConstants();
+
+        __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+        __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+        tmp = _mm_shuffle_epi32(tmp, 0xB1);                // CDAB
+        state1 = _mm_shuffle_epi32(state1, 0x1B);          // EFGH
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+        for (size_t block = 0; block < count; ++block, data += BLOCK_SIZE) {
+            __m128i abefSave = state0;
+            __m128i cdghSave = state1;
+            __m128i msg[4];
+
+            // 16 grupos de 4 rondas; el programa de mensajes se calcula sobre la marcha.
+            for (int g = 0; g < 16; ++g) {
+                if (g < 4) {
+                    msg[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * g)), mask);
+                }
+                __m128i m = _mm_add_epi32(msg[g & 3], _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 4 * g)));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, m);
+                if (g >= 3 && g <= 14) {
+                    __m128i t = _mm_alignr_epi8(msg[g & 3], msg[(g - 1) & 3], 4);
+                    msg[(g + 1) & 3] = _mm_add_epi32(msg[(g + 1) & 3], t);
+                    msg[(g + 1) & 3] = _mm_sha256msg2_epu32(msg[(g + 1) & 3], msg[g & 3]);
+                }
+                m = _mm_shuffle_epi32(m, 0x0E);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, m);
+                if (g >= 1 && g <= 12) {
+                    msg[(g - 1) & 3] = _mm_sha256msg1_epu32(msg[(g - 1) & 3], msg[g & 3]);
+                }
+            }
+
+            state0 = _mm_add_epi32(state0, abefSave);
+            state1 = _mm_add_epi32(state1, cdghSave);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+        state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+        state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+        state1 = _mm_alignr_epi8(state1, tmp, 8);     // ABEF
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+    }
+#endif
+};
+
+/**
+ * @class HMACSHA256
+ * @brief Implementa HMAC-SHA256 (RFC 2104).
+ *
+ * Los estados interno (ipad) y externo (opad) se calculan una sola vez en el
+ * constructor, de modo que cada mensaje sólo procesa sus propios bloques.
+ */
+class HMACSHA256 {
+public:
+    /**
+     * @brief Tamaño de la etiqueta en bytes.
+     */
+    static constexpr size_t MAC_SIZE = SHA256::DIGEST_SIZE;
+
+    /**
+     * @brief Prepara los estados ipad/opad para la clave dada.
+     */
+    HMACSHA256(const uint8_t* key, size_t keyLength) {
+        uint8_t block[SHA256::BLOCK_SIZE] = {};
+        if (keyLength > SHA256::BLOCK_SIZE) {
+            std::vector<uint8_t> hashed = SHA256::hash(key, keyLength);
+            std::memcpy(block, hashed.data(), hashed.size());
+        }
+        else if (keyLength > 0) {
+            std::memcpy(block, key, keyLength);
+        }
+
+        uint8_t pad[SHA256::BLOCK_SIZE];
+        for (size_t i = 0; i < SHA256::BLOCK_SIZE; ++i) pad[i] = block[i] ^ 0x36;
+        std::memcpy(m_innerState, SHA256::initialState(), sizeof(m_innerState));
+        SHA256::compress(m_innerState, pad, 1);
+
+        for (size_t i = 0; i < SHA256::BLOCK_SIZE; ++i) pad[i] = block[i] ^ 0x5c;
+        std::memcpy(m_outerState, SHA256::initialState(), sizeof(m_outerState));
+        SHA256::compress(m_outerState, pad, 1);
+
+        volatile uint8_t* wipe = block;
+        for (size_t i = 0; i < sizeof(block); ++i) wipe[i] = 0;
+    }
+
+    /**
+     * @brief Prepara los estados ipad/opad para una clave en vector.
+     */
+    explicit HMACSHA256(const std::vector<uint8_t>& key)
+        : HMACSHA256(key.data(), key.size()) {
+    }
+
+    ~HMACSHA256() = default;
+
+    /**
+     * @brief Calcula la etiqueta HMAC de un mensaje.
+     *
+     * @param data   Mensaje.
+     * @param length Longitud del mensaje.
+     * @param mac    Salida de 32 bytes.
+     */
+    void
+        compute(const uint8_t* data, size_t length, uint8_t* mac) const {
+        uint8_t inner[SHA256::DIGEST_SIZE];
+        SHA256 sha;
+        sha.resumeFrom(m_innerState);
+        sha.update(data, length);
+        sha.finalize(inner);
+
+        sha.resumeFrom(m_outerState);
+        sha.update(inner, sizeof(inner));
+        sha.finalize(mac);
+    }
+
+    /**
+     * @brief Calcula la etiqueta HMAC de un vector.
+     */
+    std::vector<uint8_t>
+        compute(const std::vector<uint8_t>& data) const {
+        std::vector<uint8_t> mac(MAC_SIZE);
+        compute(data.data(), data.size(), mac.data());
+        return mac;
+    }
+
+    /**
+     * @brief Atajo: HMAC-SHA256(key, data).
+     */
+    static std::vector<uint8_t>
+        mac(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data) {
+        return HMACSHA256(key).compute(data);
+    }
+
+    /**
+     * @brief Estado tras procesar (clave ^ ipad).
+     */
+    const uint32_t*
+        innerState() const {
+        return m_innerState;
+    }
+
+    /**
+     * @brief Estado tras procesar (clave ^ opad).
+     */
+    const uint32_t*
+        outerState() const {
+        return m_outerState;
+    }
+
+private:
+    uint32_t m_innerState[8];
+    uint32_t m_outerState[8];
+};
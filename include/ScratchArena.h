@@ -0,0 +1,121 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @class ScratchArena
+ * @brief Memoria temporal por avance de puntero (bump allocator) que se vacía de golpe.
+ *
+ * Pensada para los bucles de búsqueda de claves: cada candidato toma de aquí su clave y su
+ * texto descifrado y al pasar al siguiente se llama a reset(), que solo rebobina el puntero.
+ * Los bloques se piden al montón la primera vez que hacen falta y se conservan, así que tras
+ * el primer candidato el bucle no reserva memoria. No llama a destructores: solo sirve para
+ * tipos triviales (bytes, enteros, punteros).
+ *
+ * No es segura entre hilos; cada hilo usa la suya (local()).
+ */
+class ScratchArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit ScratchArena(size_t blockSize = DEFAULT_BLOCK_SIZE) : m_blockSize(blockSize) {
+    }
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * @brief Arena del hilo actual.
+     */
+    static ScratchArena&
+        local() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    /**
+     * @brief Reserva @p bytes con la alineación pedida.
+     */
+    char*
+        allocateBytes(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        while (m_current < m_blocks.size()) {
+            Block& block = m_blocks[m_current];
+            size_t start = (m_offset + alignment - 1) & ~(alignment - 1);
+            if (start + bytes <= block.size) {
+                m_offset = start + bytes;
+                return block.data.get() + start;
+            }
+            ++m_current;
+            m_offset = 0;
+        }
+        // Ningún bloque conservado tiene hueco: uno nuevo (más grande si la petición lo exige)
+        size_t size = std::max(m_blockSize, bytes + alignment);
+        m_blocks.push_back(Block{ std::unique_ptr<char[]>(new char[size]), size });
+        ++m_blockAllocations;
+        m_current = m_blocks.size() - 1;
+        m_offset = 0;
+        return allocateBytes(bytes, alignment);
+    }
+
+    /**
+     * @brief Reserva un array de @p count elementos de un tipo trivial.
+     */
+    template <typename T>
+    T*
+        allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "ScratchArena solo admite tipos triviales.");
+        return reinterpret_cast<T*>(allocateBytes(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * @brief Copia @p text en la arena.
+     */
+    std::string_view
+        copy(std::string_view text) {
+        char* data = allocateBytes(text.size(), 1);
+        std::memcpy(data, text.data(), text.size());
+        return std::string_view(data, text.size());
+    }
+
+    /**
+     * @brief Libera todo lo reservado (los bloques se conservan para reutilizarlos).
+     */
+    void
+        reset() {
+        m_current = 0;
+        m_offset = 0;
+    }
+
+    /**
+     * @brief Veces que la arena ha pedido un bloque al montón.
+     */
+    uint64_t
+        blockAllocations() const {
+        return m_blockAllocations;
+    }
+
+    /**
+     * @brief Bytes reservados en bloques.
+     */
+    size_t
+        capacity() const {
+        size_t total = 0;
+        for (const Block& block : m_blocks) total += block.size;
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    size_t m_blockSize;
+    std::vector<Block> m_blocks;
+    size_t m_current = 0;
+    size_t m_offset = 0;
+    uint64_t m_blockAllocations = 0;
+};
@@ -0,0 +1,283 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class SecureArena
+ * @brief Reserva de memoria para claves: bloques fijos dentro de losas bloqueadas en RAM
+ *        y rodeadas de páginas de guarda.
+ *
+ * Cada losa se reserva una sola vez con mmap/VirtualAlloc, se bloquea con mlock/VirtualLock
+ * (no va a swap) y lleva una página sin acceso delante y otra detrás, de modo que un
+ * desbordamiento fuera de la losa falla en lugar de leer o escribir memoria vecina. Pedir y
+ * devolver un bloque sólo mueve un puntero en una lista libre: no hay llamadas al sistema
+ * ni uso del montón por clave. Al devolverse, el bloque se borra con secureZero.
+ *
+ * Si el sistema no permite bloquear más memoria (límite RLIMIT_MEMLOCK), la losa se usa
+ * igualmente y isLocked() lo indica.
+ */
+class SecureArena {
+public:
+    static constexpr size_t DEFAULT_SLOT_SIZE = 128;
+    static constexpr size_t DEFAULT_SLOTS_PER_SLAB = 1024;
+
+    /**
+     * @class Buffer
+     * @brief Bloque de la arena con propiedad exclusiva; al destruirse se borra y se devuelve.
+     */
+    class Buffer {
+    public:
+        Buffer() = default;
+
+        Buffer(SecureArena* arena, uint8_t* data, size_t size) : m_arena(arena), m_data(data), m_size(size) {
+        }
+
+        ~Buffer() {
+            reset();
+        }
+
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        Buffer(Buffer&& other) noexcept {
+            *this = std::move(other);
+        }
+
+        Buffer&
+            operator=(Buffer&& other) noexcept {
+            if (this != &other) {
+                reset();
+                std::swap(m_arena, other.m_arena);
+                std::swap(m_data, other.m_data);
+                std::swap(m_size, other.m_size);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Borra el contenido y devuelve el bloque a la arena.
+         */
+        void
+            reset() {
+            if (m_data) {
+                m_arena->release(m_data);
+                m_data = nullptr;
+                m_size = 0;
+            }
+        }
+
+        uint8_t* data() { return m_data; }
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        uint8_t* begin() { return m_data; }
+        uint8_t* end() { return m_data + m_size; }
+        const uint8_t* begin() const { return m_data; }
+        const uint8_t* end() const { return m_data + m_size; }
+        uint8_t& operator[](size_t i) { return m_data[i]; }
+        const uint8_t& operator[](size_t i) const { return m_data[i]; }
+
+    private:
+        SecureArena* m_arena = nullptr;
+        uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    /**
+     * @param slotSize     Tamaño de cada bloque (se redondea a múltiplo de 16).
+     * @param slotsPerSlab Bloques por losa; la arena crece de losa en losa.
+     * @throws std::runtime_error Si no se puede reservar la primera losa.
+     */
+    explicit SecureArena(size_t slotSize = DEFAULT_SLOT_SIZE, size_t slotsPerSlab = DEFAULT_SLOTS_PER_SLAB)
+        : m_slotSize((std::max<size_t>(slotSize, 16) + 15) & ~size_t(15)),
+        m_slotsPerSlab(std::max<size_t>(slotsPerSlab, 1)) {
+        addSlab();
+    }
+
+    /**
+     * @brief Borra y libera todas las losas (también los bloques que sigan en uso).
+     */
+    ~SecureArena() {
+        for (const Slab& slab : m_slabs) {
+            secureZero(slab.data, slab.dataBytes);
+#if defined(_WIN32)
+            if (slab.locked) VirtualUnlock(slab.data, slab.dataBytes);
+            VirtualFree(slab.base, 0, MEM_RELEASE);
+#else
+            if (slab.locked) munlock(slab.data, slab.dataBytes);
+            munmap(slab.base, slab.totalBytes);
+#endif
+        }
+    }
+
+    SecureArena(const SecureArena&) = delete;
+    SecureArena& operator=(const SecureArena&) = delete;
+
+    /**
+     * @brief Entrega un bloque a cero de slotSize() bytes.
+     */
+    uint8_t*
+        allocate() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty()) addSlab();
+        uint8_t* slot = m_free.back();
+        m_free.pop_back();
+        return slot;
+    }
+
+    /**
+     * @brief Borra el bloque y lo devuelve a la lista libre.
+     */
+    void
+        release(uint8_t* slot) {
+        secureZero(slot, m_slotSize);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(slot);
+    }
+
+    /**
+     * @brief Bloque con gestión automática para @p length bytes.
+     *
+     * @throws std::invalid_argument Si length supera slotSize().
+     */
+    Buffer
+        acquire(size_t length) {
+        if (length > m_slotSize) {
+            throw std::invalid_argument("El dato no cabe en un bloque de la arena segura ("
+                + std::to_string(m_slotSize) + " bytes).");
+        }
+        return Buffer(this, allocate(), length);
+    }
+
+    size_t
+        slotSize() const {
+        return m_slotSize;
+    }
+
+    size_t
+        slabCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_slabs.size();
+    }
+
+    /**
+     * @brief Bloques entregados y aún no devueltos.
+     */
+    size_t
+        slotsInUse() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_slabs.size() * m_slotsPerSlab - m_free.size();
+    }
+
+    /**
+     * @brief Indica si todas las losas están bloqueadas en memoria física.
+     */
+    bool
+        isLocked() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const Slab& slab : m_slabs) {
+            if (!slab.locked) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Pone a cero la memoria de forma que el compilador no pueda eliminarlo
+     *        aunque el buffer no se vuelva a leer.
+     */
+    static void
+        secureZero(void* data, size_t length) {
+#if defined(_WIN32)
+        SecureZeroMemory(data, length);
+#else
+        std::memset(data, 0, length);
+        // Barrera: el compilador debe suponer que la memoria se lee después.
+        __asm__ __volatile__("" : : "r"(data) : "memory");
+#endif
+    }
+
+private:
+    struct Slab {
+        uint8_t* base = nullptr;   ///< Inicio de la reserva (página de guarda).
+        uint8_t* data = nullptr;   ///< Primer bloque.
+        size_t totalBytes = 0;
+        size_t dataBytes = 0;
+        bool locked = false;
+    };
+
+    size_t m_slotSize;
+    size_t m_slotsPerSlab;
+    std::vector<Slab> m_slabs;
+    std::vector<uint8_t*> m_free;
+    mutable std::mutex m_mutex;
+
+    static size_t
+        pageSize() {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    /**
+     * @brief Reserva una losa: [guarda][bloques][guarda]. Se llama con el mutex tomado.
+     */
+    void
+        addSlab() {
+        const size_t page = pageSize();
+        Slab slab;
+        slab.dataBytes = (m_slotSize * m_slotsPerSlab + page - 1) / page * page;
+        slab.totalBytes = slab.dataBytes + 2 * page;
+#if defined(_WIN32)
+        void* base = VirtualAlloc(nullptr, slab.totalBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!base) {
+            throw std::runtime_error("No se pudo reservar memoria para la arena segura.");
+        }
+        slab.base = static_cast<uint8_t*>(base);
+        slab.data = slab.base + page;
+        DWORD old;
+        VirtualProtect(slab.base, page, PAGE_NOACCESS, &old);
+        VirtualProtect(slab.data + slab.dataBytes, page, PAGE_NOACCESS, &old);
+        slab.locked = VirtualLock(slab.data, slab.dataBytes) != 0;
+#else
+        void* base = mmap(nullptr, slab.totalBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("No se pudo reservar memoria para la arena segura.");
+        }
+        slab.base = static_cast<uint8_t*>(base);
+        slab.data = slab.base + page;
+        mprotect(slab.base, page, PROT_NONE);
+        mprotect(slab.data + slab.dataBytes, page, PROT_NONE);
+        slab.locked = mlock(slab.data, slab.dataBytes) == 0;
+#if defined(MADV_DONTDUMP)
+        madvise(slab.data, slab.dataBytes, MADV_DONTDUMP);
+#endif
+#endif
+        m_slabs.push_back(slab);
+        m_free.reserve(m_slabs.size() * m_slotsPerSlab);
+        // En orden inverso para que los primeros bloques entregados sean los del principio.
+        for (size_t i = m_slotsPerSlab; i-- > 0;) {
+            m_free.push_back(slab.data + i * m_slotSize);
+        }
+    }
+};
+
+/**
+ * @brief Bloque de la arena segura (clave, IV, salt o subclaves).
+ */
+using SecureBuffer = SecureArena::Buffer;
@@ -0,0 +1,845 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "DESKernel.h"
+#include "DESKeySpace.h"
+#include "EncryptedContainer.h"
+#include "TcpSocket.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+/**
+ * @brief Candidato de una búsqueda de claves: índice en el espacio y puntuación.
+ */
+struct KeyCandidate {
+    uint64_t index = 0;
+    double score = 0.0;
+};
+
+/**
+ * @class KeyCandidateSet
+ * @brief Los K candidatos de mayor puntuación (montículo de mínimos).
+ */
+class KeyCandidateSet {
+public:
+    explicit KeyCandidateSet(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {
+    }
+
+    /**
+     * @brief Puntuación que hay que superar para entrar (−∞ mientras no esté lleno).
+     */
+    double
+        threshold() const {
+        return m_heap.size() < m_capacity ? -std::numeric_limits<double>::infinity() : m_heap.front().score;
+    }
+
+    void
+        add(const KeyCandidate& candidate) {
+        if (m_heap.size() < m_capacity) {
+            m_heap.push_back(candidate);
+            std::push_heap(m_heap.begin(), m_heap.end(), greater);
+        }
+        else if (candidate.score > m_heap.front().score) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), greater);
+            m_heap.back() = candidate;
+            std::push_heap(m_heap.begin(), m_heap.end(), greater);
+        }
+    }
+
+    /**
+     * @brief Candidatos de mejor a peor (a igual puntuación, menor índice primero).
+     */
+    std::vector<KeyCandidate>
+        sorted() const {
+        std::vector<KeyCandidate> result = m_heap;
+        std::sort(result.begin(), result.end(), [](const KeyCandidate& a, const KeyCandidate& b) {
+            return a.score != b.score ? a.score > b.score : a.index < b.index;
+            });
+        return result;
+    }
+
+private:
+    size_t m_capacity;
+    std::vector<KeyCandidate> m_heap;
+
+    static bool
+        greater(const KeyCandidate& a, const KeyCandidate& b) {
+        return a.score > b.score;
+    }
+};
+
+/**
+ * @class KeySearchJob
+ * @brief Búsqueda exhaustiva sobre un espacio de claves indexado [0, size()): XOR de N
+ *        bytes, Vigenère hasta una longitud o un subespacio DES con un par conocido.
+ *
+ * El trabajo se serializa para enviarlo a los procesos trabajadores; cada uno recorre los
+ * rangos de índices que le toquen con search().
+ */
+class KeySearchJob {
+public:
+    enum class Kind : uint8_t {
+        Xor = 1,        ///< Clave XOR repetida de N bytes (índice = bytes en little-endian).
+        Vigenere = 2,   ///< Claves A-Z de longitud 1 a N, en orden de longitud.
+        DesSubspace = 3 ///< Claves de un DESKeySpace; puntúa 1 si cifra el claro en el cifrado.
+    };
+
+    KeySearchJob() = default;
+
+    /**
+     * @throws std::invalid_argument Si keyBytes no está entre 1 y 4 o no hay datos.
+     */
+    static KeySearchJob
+        xorBytes(const std::vector<uint8_t>& ciphertext, unsigned keyBytes) {
+        if (keyBytes < 1 || keyBytes > 4 || ciphertext.empty()) {
+            throw std::invalid_argument("La busqueda XOR necesita datos y una clave de 1 a 4 bytes.");
+        }
+        KeySearchJob job;
+        job.m_kind = Kind::Xor;
+        job.m_param = keyBytes;
+        job.m_data = ciphertext;
+        job.prepare();
+        return job;
+    }
+
+    /**
+     * @throws std::invalid_argument Si maxKeyLength no está entre 1 y 6 o el texto no tiene letras.
+     */
+    static KeySearchJob
+        vigenere(const std::string& ciphertext, unsigned maxKeyLength) {
+        if (maxKeyLength < 1 || maxKeyLength > 6) {
+            throw std::invalid_argument("La busqueda Vigenere admite claves de 1 a 6 letras.");
+        }
+        KeySearchJob job;
+        job.m_kind = Kind::Vigenere;
+        job.m_param = maxKeyLength;
+        job.m_data.assign(ciphertext.begin(), ciphertext.end());
+        job.prepare();
+        if (job.m_letters.empty()) {
+            throw std::invalid_argument("El texto cifrado no tiene letras.");
+        }
+        return job;
+    }
+
+    static KeySearchJob
+        desSubspace(const DESKeySpace& space, uint64_t plaintext, uint64_t ciphertext) {
+        KeySearchJob job;
+        job.m_kind = Kind::DesSubspace;
+        job.m_words = { plaintext, ciphertext, space.base(), space.mask() };
+        job.prepare();
+        return job;
+    }
+
+    Kind kind() const { return m_kind; }
+
+    /**
+     * @brief Número de claves del espacio.
+     */
+    uint64_t
+        size() const {
+        switch (m_kind) {
+        case Kind::Xor:
+            return 1ULL << (8 * m_param);
+        case Kind::Vigenere:
+            return m_lengthOffset.back();
+        case Kind::DesSubspace:
+            return m_space.size();
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Clave del índice en forma legible (hex para XOR y DES, letras para Vigenère).
+     */
+    std::string
+        keyText(uint64_t index) const {
+        std::ostringstream out;
+        switch (m_kind) {
+        case Kind::Xor:
+            for (unsigned i = 0; i < m_param; ++i) {
+                out << std::hex << std::setw(2) << std::setfill('0') << ((index >> (8 * i)) & 0xFF);
+            }
+            break;
+        case Kind::Vigenere: {
+            uint8_t key[8];
+            unsigned length = vigenereKey(index, key);
+            for (unsigned i = 0; i < length; ++i) out << static_cast<char>('A' + key[i]);
+            break;
+        }
+        case Kind::DesSubspace:
+            out << std::hex << std::setw(16) << std::setfill('0') << m_space.keyAt(index);
+            break;
+        }
+        return out.str();
+    }
+
+    /**
+     * @brief Texto descifrado con la clave del índice (el bloque claro en DES).
+     */
+    std::string
+        decode(uint64_t index) const {
+        std::string text(m_data.begin(), m_data.end());
+        if (m_kind == Kind::Xor) {
+            for (size_t i = 0; i < text.size(); ++i) text[i] = static_cast<char>(m_data[i] ^ ((index >> (8 * (i % m_param))) & 0xFF));
+        }
+        else if (m_kind == Kind::Vigenere) {
+            uint8_t key[8];
+            unsigned length = vigenereKey(index, key);
+            for (size_t j = 0; j < m_letters.size(); ++j) {
+                const Letter& l = m_letters[j];
+                text[l.position] = static_cast<char>((l.upper ? 'A' : 'a') + (l.value + 26 - key[j % length]) % 26);
+            }
+        }
+        else {
+            text.assign(8, '\0');
+            DESKernel::store64(reinterpret_cast<uint8_t*>(&text[0]), m_words[0]);
+        }
+        return text;
+    }
+
+    /**
+     * @brief Recorre [first, first + count) y devuelve los @p topK mejores, de mejor a peor.
+     *
+     * Para XOR y Vigenère la puntuación es la log-verosimilitud media por carácter según
+     * las frecuencias del español; se abandona un candidato en cuanto ya no puede superar
+     * al peor de los guardados.
+     */
+    std::vector<KeyCandidate>
+        search(uint64_t first, uint64_t count, size_t topK) const {
+        KeyCandidateSet best(topK);
+        if (m_kind == Kind::DesSubspace) {
+            const size_t BATCH = 4096;
+            std::vector<uint64_t> keys(BATCH), cipher(BATCH);
+            for (uint64_t done = 0; done < count; done += BATCH) {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(BATCH, count - done));
+                for (size_t i = 0; i < n; ++i) keys[i] = m_space.keyAt(first + done + i);
+                DESKernel::encryptUnderKeys(m_words[0], keys.data(), cipher.data(), n);
+                for (size_t i = 0; i < n; ++i) {
+                    if (cipher[i] == m_words[1]) best.add({ first + done + i, 1.0 });
+                }
+            }
+            return best.sorted();
+        }
+
+        const double total = static_cast<double>(m_data.size());
+        const double maxByte = byteScores()[' '];
+        for (uint64_t index = first; index < first + count; ++index) {
+            // Se trabaja con la suma: umbral medio → umbral de suma.
+            double need = best.threshold() * total;
+            double score = m_kind == Kind::Xor ? scoreXor(index, need, maxByte) : scoreVigenere(index, need, maxByte);
+            if (score > need) best.add({ index, score / total });
+        }
+        return best.sorted();
+    }
+
+    /**
+     * @brief Serializa el trabajo para enviarlo a un trabajador.
+     */
+    std::vector<uint8_t>
+        serialize() const {
+        std::vector<uint8_t> out(1 + 4 + 32 + 4 + m_data.size());
+        out[0] = static_cast<uint8_t>(m_kind);
+        EncryptedContainer::put32(out.data() + 1, m_param);
+        for (int i = 0; i < 4; ++i) EncryptedContainer::put64(out.data() + 5 + 8 * i, m_words[i]);
+        EncryptedContainer::put32(out.data() + 37, static_cast<uint32_t>(m_data.size()));
+        if (!m_data.empty()) std::memcpy(out.data() + 41, m_data.data(), m_data.size());
+        return out;
+    }
+
+    /**
+     * @throws std::runtime_error Si el mensaje no es un trabajo válido.
+     */
+    static KeySearchJob
+        deserialize(const uint8_t* data, size_t length) {
+        if (length < 41 || data[0] < 1 || data[0] > 3 || 41 + EncryptedContainer::get32(data + 37) != length) {
+            throw std::runtime_error("Trabajo de busqueda de claves no valido.");
+        }
+        KeySearchJob job;
+        job.m_kind = static_cast<Kind>(data[0]);
+        job.m_param = EncryptedContainer::get32(data + 1);
+        for (int i = 0; i < 4; ++i) job.m_words[i] = EncryptedContainer::get64(data + 5 + 8 * i);
+        job.m_data.assign(data + 41, data + length);
+        job.prepare();
+        return job;
+    }
+
+private:
+    struct Letter {
+        uint32_t position;
+        uint8_t value;
+        bool upper;
+    };
+
+    Kind m_kind = Kind::Xor;
+    uint32_t m_param = 0;
+    std::array<uint64_t, 4> m_words{};
+    std::vector<uint8_t> m_data;
+
+    // Derivados (no se serializan).
+    DESKeySpace m_space;
+    std::vector<Letter> m_letters;
+    std::vector<uint64_t> m_lengthOffset;
+    double m_fixedScore = 0.0;
+
+    void
+        prepare() {
+        if (m_kind == Kind::DesSubspace) {
+            m_space = DESKeySpace(m_words[2], m_words[3]);
+        }
+        else if (m_kind == Kind::Vigenere) {
+            m_letters.clear();
+            m_fixedScore = 0.0;
+            for (size_t i = 0; i < m_data.size(); ++i) {
+                uint8_t c = m_data[i];
+                if (std::isalpha(c)) m_letters.push_back({ static_cast<uint32_t>(i), static_cast<uint8_t>(std::toupper(c) - 'A'), std::isupper(c) != 0 });
+                else m_fixedScore += byteScores()[c];
+            }
+            m_lengthOffset.assign(1, 0);
+            uint64_t keys = 1;
+            for (unsigned length = 1; length <= m_param; ++length) {
+                keys *= 26;
+                m_lengthOffset.push_back(m_lengthOffset.back() + keys);
+            }
+        }
+    }
+
+    unsigned
+        vigenereKey(uint64_t index, uint8_t* key) const {
+        unsigned length = 1;
+        while (index >= m_lengthOffset[length]) ++length;
+        uint64_t value = index - m_lengthOffset[length - 1];
+        for (unsigned i = length; i-- > 0;) {
+            key[i] = static_cast<uint8_t>(value % 26);
+            value /= 26;
+        }
+        return length;
+    }
+
+    /**
+     * @brief log10 de la frecuencia de cada byte en texto español (letras, espacio,
+     *        puntuación); los bytes no imprimibles penalizan mucho.
+     */
+    static const double*
+        byteScores() {
+        static const std::array<double, 256> table = [] {
+            static const double letters[26] = {
+                12.53, 1.42, 4.68, 5.86, 13.68, 0.69, 1.01, 0.70, 6.25, 0.44, 0.02, 4.97, 3.15,
+                7.02, 8.68, 2.51, 0.88, 6.87, 7.98, 4.63, 3.93, 0.90, 0.01, 0.22, 0.90, 0.52 };
+            std::array<double, 256> t;
+            for (int b = 0; b < 256; ++b) {
+                if (b >= 'a' && b <= 'z') t[b] = std::log10(0.83 * letters[b - 'a'] / 100.0);
+                else if (b >= 'A' && b <= 'Z') t[b] = std::log10(0.83 * letters[b - 'A'] / 100.0) - 1.0;
+                else if (b == ' ') t[b] = std::log10(0.16);
+                else if (b == '\n' || (b >= 0x21 && b <= 0x7E)) t[b] = -3.0;
+                else t[b] = -6.0;
+            }
+            // El espacio debe ser la mejor puntuación (cota de la poda).
+            t[' '] = std::max(t[' '], *std::max_element(t.begin(), t.end()));
+            return t;
+            }();
+        return table.data();
+    }
+
+    double
+        scoreXor(uint64_t index, double need, double maxByte) const {
+        const double* scores = byteScores();
+        uint8_t key[4];
+        for (unsigned i = 0; i < m_param; ++i) key[i] = static_cast<uint8_t>(index >> (8 * i));
+        const size_t length = m_data.size();
+        double score = 0.0;
+        for (size_t i = 0, k = 0; i < length; ++i) {
+            score += scores[m_data[i] ^ key[k]];
+            if (++k == m_param) k = 0;
+            if (score + (length - i - 1) * maxByte <= need) return -std::numeric_limits<double>::infinity();
+        }
+        return score;
+    }
+
+    double
+        scoreVigenere(uint64_t index, double need, double maxByte) const {
+        const double* scores = byteScores();
+        uint8_t key[8];
+        unsigned length = vigenereKey(index, key);
+        const size_t letters = m_letters.size();
+        double score = m_fixedScore;
+        for (size_t j = 0, k = 0; j < letters; ++j) {
+            const Letter& l = m_letters[j];
+            uint8_t plain = static_cast<uint8_t>((l.value + 26 - key[k]) % 26);
+            score += scores[(l.upper ? 'A' : 'a') + plain];
+            if (++k == length) k = 0;
+            if (score + (letters - j - 1) * maxByte <= need) return -std::numeric_limits<double>::infinity();
+        }
+        return score;
+    }
+};
+
+/**
+ * @class WorkerProcess
+ * @brief Proceso hijo lanzado con posix_spawn / CreateProcess.
+ */
+class WorkerProcess {
+public:
+    WorkerProcess() = default;
+
+    /**
+     * @brief Lanza @p args[0] con los argumentos dados.
+     *
+     * @throws std::runtime_error Si no se puede crear el proceso.
+     */
+    static WorkerProcess
+        spawn(const std::vector<std::string>& args) {
+        WorkerProcess process;
+#if defined(_WIN32)
+        std::string commandLine;
+        for (const std::string& arg : args) commandLine += "\"" + arg + "\" ";
+        STARTUPINFOA startup{};
+        startup.cb = sizeof(startup);
+        PROCESS_INFORMATION info{};
+        if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &info)) {
+            throw std::runtime_error("No se pudo lanzar el proceso " + args[0]);
+        }
+        CloseHandle(info.hThread);
+        process.m_handle = info.hProcess;
+#else
+        std::vector<char*> argv;
+        for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+        if (posix_spawn(&process.m_pid, args[0].c_str(), nullptr, nullptr, argv.data(), environ) != 0) {
+            throw std::runtime_error("No se pudo lanzar el proceso " + args[0]);
+        }
+#endif
+        return process;
+    }
+
+    /**
+     * @brief Espera a que termine y devuelve su código de salida (-1 si no se pudo saber).
+     */
+    int
+        wait() {
+#if defined(_WIN32)
+        if (!m_handle) return -1;
+        WaitForSingleObject(m_handle, INFINITE);
+        DWORD code = 0;
+        GetExitCodeProcess(m_handle, &code);
+        CloseHandle(m_handle);
+        m_handle = nullptr;
+        return static_cast<int>(code);
+#else
+        if (m_pid <= 0) return -1;
+        int status = 0;
+        waitpid(m_pid, &status, 0);
+        m_pid = 0;
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+    }
+
+    /**
+     * @brief Ruta del ejecutable en curso (para lanzar trabajadores del mismo programa).
+     *
+     * @throws std::runtime_error Si la plataforma no permite saberlo.
+     */
+    static std::string
+        currentExecutable() {
+#if defined(_WIN32)
+        char path[MAX_PATH];
+        DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+        if (length > 0 && length < MAX_PATH) return std::string(path, length);
+#else
+        char path[4096];
+        ssize_t length = readlink("/proc/self/exe", path, sizeof(path));
+        if (length > 0 && static_cast<size_t>(length) < sizeof(path)) return std::string(path, static_cast<size_t>(length));
+#endif
+        throw std::runtime_error("No se pudo determinar la ruta del ejecutable.");
+    }
+
+private:
+#if defined(_WIN32)
+    HANDLE m_handle = nullptr;
+#else
+    pid_t m_pid = 0;
+#endif
+};
+
+/**
+ * @brief Tipos de mensaje del protocolo coordinador/trabajador.
+ *
+ * Cada mensaje va precedido de su longitud (u32 big-endian, tipo incluido) y del tipo (u8).
+ */
+enum class KeySearchMessage : uint8_t {
+    Hello = 1,    ///< Trabajador → coordinador, al conectar.
+    Job = 2,      ///< Coordinador → trabajador: KeySearchJob::serialize().
+    Request = 3,  ///< Trabajador → coordinador: pide un rango.
+    Lease = 4,    ///< Coordinador → trabajador: id, primer índice, cantidad, K (u64, u64, u64, u32).
+    Result = 5,   ///< Trabajador → coordinador: id, n (u32) y n × (índice u64, puntuación f64).
+    Finish = 6    ///< Coordinador → trabajador: no queda trabajo.
+};
+
+/**
+ * @class KeySearchProtocol
+ * @brief Envío y recepción de mensajes KeySearchMessage sobre un TcpSocket.
+ */
+class KeySearchProtocol {
+public:
+    static bool
+        send(TcpSocket& socket, KeySearchMessage type, const uint8_t* payload, size_t length) {
+        std::vector<uint8_t> frame(5 + length);
+        EncryptedContainer::put32(frame.data(), static_cast<uint32_t>(length + 1));
+        frame[4] = static_cast<uint8_t>(type);
+        if (length) std::memcpy(frame.data() + 5, payload, length);
+        return socket.sendAll(frame.data(), frame.size());
+    }
+
+    /**
+     * @brief Recibe un mensaje completo (bloqueante).
+     */
+    static bool
+        receive(TcpSocket& socket, KeySearchMessage& type, std::vector<uint8_t>& payload) {
+        uint8_t header[5];
+        if (!socket.receiveAll(header, sizeof(header))) return false;
+        uint32_t length = EncryptedContainer::get32(header);
+        if (length == 0 || length > MAX_MESSAGE) return false;
+        type = static_cast<KeySearchMessage>(header[4]);
+        payload.resize(length - 1);
+        return payload.empty() || socket.receiveAll(payload.data(), payload.size());
+    }
+
+    static constexpr uint32_t MAX_MESSAGE = 1u << 24;
+};
+
+/**
+ * @class KeySearchCoordinator
+ * @brief Reparte el espacio de claves de un KeySearchJob en arrendamientos (rangos de
+ *        índices) entre procesos trabajadores conectados por TCP y junta los mejores
+ *        candidatos.
+ *
+ * Un arrendamiento se vuelve a entregar si su trabajador se desconecta (proceso muerto) o
+ * si no devuelve el resultado antes de Options::leaseTimeout; cuenta el primer resultado
+ * que llegue de cada arrendamiento. El bucle es de un solo hilo con select().
+ */
+class KeySearchCoordinator {
+public:
+    /**
+     * @brief Parámetros del reparto.
+     */
+    struct Options {
+        uint64_t leaseSize = 1 << 20;      ///< Claves por arrendamiento.
+        size_t topK = 10;                  ///< Candidatos que se conservan.
+        double leaseTimeout = 60.0;        ///< Segundos antes de volver a entregar un rango.
+        double workerWaitTimeout = 30.0;   ///< Segundos sin ningún trabajador antes de rendirse.
+        uint16_t port = 0;                 ///< 0 = puerto elegido por el sistema.
+    };
+
+    /**
+     * @brief Resumen de la ejecución.
+     */
+    struct Stats {
+        uint64_t leases = 0;           ///< Arrendamientos en que se dividió el espacio.
+        uint64_t leasesIssued = 0;     ///< Entregas (incluidas las repetidas).
+        uint64_t leasesReissued = 0;   ///< Entregas repetidas por muerte o retraso del trabajador.
+        uint64_t duplicateResults = 0; ///< Resultados de rangos ya completados (se ignoran).
+        uint64_t workersConnected = 0;
+        uint64_t workersLost = 0;      ///< Desconexiones con trabajo pendiente.
+        double seconds = 0.0;
+        double keysPerSecond = 0.0;
+    };
+
+    explicit KeySearchCoordinator(const KeySearchJob& job) : KeySearchCoordinator(job, Options()) {
+    }
+
+    /**
+     * @brief Prepara los arrendamientos y empieza a escuchar (port() ya es válido).
+     *
+     * @throws std::runtime_error Si no se puede escuchar en el puerto.
+     */
+    KeySearchCoordinator(const KeySearchJob& job, const Options& options)
+        : m_job(job), m_options(options), m_best(options.topK) {
+        m_jobMessage = m_job.serialize();
+        const uint64_t size = m_job.size();
+        const uint64_t leaseSize = std::max<uint64_t>(m_options.leaseSize, 1);
+        for (uint64_t first = 0; first < size; first += leaseSize) {
+            m_leases.push_back({ first, std::min(leaseSize, size - first) });
+        }
+        for (size_t i = m_leases.size(); i-- > 0;) m_pending.push_back(i);
+        m_stats.leases = m_leases.size();
+        m_listener.listenLoopback(m_options.port);
+    }
+
+    ~KeySearchCoordinator() = default;
+
+    uint16_t
+        port() const {
+        return m_listener.port();
+    }
+
+    /**
+     * @brief Atiende a los trabajadores hasta completar todo el espacio.
+     *
+     * @return Los mejores candidatos, de mejor a peor.
+     * @throws std::runtime_error Si pasa workerWaitTimeout sin ningún trabajador conectado.
+     */
+    std::vector<KeyCandidate>
+        run() {
+        auto start = Clock::now();
+        auto lastWorker = start;
+        while (m_completed < m_leases.size()) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(m_listener.handle(), &readable);
+            TcpSocket::Handle highest = m_listener.handle();
+            for (const auto& c : m_connections) {
+                FD_SET(c->socket.handle(), &readable);
+                highest = std::max(highest, c->socket.handle());
+            }
+            timeval wait{ 0, 100000 };
+            int ready = select(static_cast<int>(highest + 1), &readable, nullptr, nullptr, &wait);
+            if (ready < 0) continue;
+
+            if (FD_ISSET(m_listener.handle(), &readable)) {
+                auto connection = std::make_unique<Connection>();
+                connection->socket = m_listener.accept();
+                if (connection->socket.isOpen()) {
+                    ++m_stats.workersConnected;
+                    m_connections.push_back(std::move(connection));
+                }
+            }
+            for (size_t i = 0; i < m_connections.size();) {
+                Connection& c = *m_connections[i];
+                if (FD_ISSET(c.socket.handle(), &readable) && !readFrom(c)) {
+                    drop(i);
+                    continue;
+                }
+                ++i;
+            }
+
+            // Rangos vencidos: vuelven a la cola (el trabajador sigue conectado, por si acaba).
+            auto now = Clock::now();
+            for (size_t id = 0; id < m_leases.size(); ++id) {
+                Lease& lease = m_leases[id];
+                if (lease.state == LeaseState::Assigned && now > lease.deadline) {
+                    lease.state = LeaseState::Pending;
+                    m_pending.push_back(id);
+                    ++m_stats.leasesReissued;
+                }
+            }
+            serveWaiting();
+
+            if (!m_connections.empty()) {
+                lastWorker = now;
+            }
+            else if (std::chrono::duration<double>(now - lastWorker).count() > m_options.workerWaitTimeout) {
+                throw std::runtime_error("Ningun trabajador se ha conectado al coordinador.");
+            }
+        }
+
+        for (const auto& c : m_connections) KeySearchProtocol::send(c->socket, KeySearchMessage::Finish, nullptr, 0);
+        m_connections.clear();
+        m_stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        m_stats.keysPerSecond = static_cast<double>(m_job.size()) / m_stats.seconds;
+        return m_best.sorted();
+    }
+
+    const Stats&
+        stats() const {
+        return m_stats;
+    }
+
+    const KeySearchJob&
+        job() const {
+        return m_job;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class LeaseState : uint8_t { Pending, Assigned, Done };
+
+    struct Lease {
+        uint64_t first;
+        uint64_t count;
+        LeaseState state = LeaseState::Pending;
+        Clock::time_point deadline{};
+    };
+
+    struct Connection {
+        TcpSocket socket;
+        std::vector<uint8_t> inbox;
+        bool waiting = false;             ///< Pidió trabajo y no se le ha dado.
+        std::vector<uint64_t> leases;     ///< Rangos entregados a este trabajador.
+    };
+
+    KeySearchJob m_job;
+    Options m_options;
+    std::vector<uint8_t> m_jobMessage;
+    std::vector<Lease> m_leases;
+    std::vector<uint64_t> m_pending;      ///< Pila: el siguiente rango está al final.
+    uint64_t m_completed = 0;
+    KeyCandidateSet m_best;
+    TcpSocket m_listener;
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    Stats m_stats;
+
+    /**
+     * @brief Lee lo disponible y procesa los mensajes completos; false si la conexión murió.
+     */
+    bool
+        readFrom(Connection& c) {
+        uint8_t buffer[64 * 1024];
+        int n = c.socket.receive(buffer, sizeof(buffer));
+        if (n <= 0) return false;
+        c.inbox.insert(c.inbox.end(), buffer, buffer + n);
+        size_t offset = 0;
+        while (c.inbox.size() - offset >= 5) {
+            uint32_t length = EncryptedContainer::get32(c.inbox.data() + offset);
+            if (length == 0 || length > KeySearchProtocol::MAX_MESSAGE) return false;
+            if (c.inbox.size() - offset < 4 + length) break;
+            if (!handle(c, static_cast<KeySearchMessage>(c.inbox[offset + 4]), c.inbox.data() + offset + 5, length - 1)) {
+                return false;
+            }
+            offset += 4 + length;
+        }
+        c.inbox.erase(c.inbox.begin(), c.inbox.begin() + offset);
+        return true;
+    }
+
+    bool
+        handle(Connection& c, KeySearchMessage type, const uint8_t* payload, size_t length) {
+        switch (type) {
+        case KeySearchMessage::Hello:
+            return KeySearchProtocol::send(c.socket, KeySearchMessage::Job, m_jobMessage.data(), m_jobMessage.size());
+        case KeySearchMessage::Request:
+            c.waiting = true;
+            return true;
+        case KeySearchMessage::Result: {
+            if (length < 12) return false;
+            uint64_t id = EncryptedContainer::get64(payload);
+            uint32_t count = EncryptedContainer::get32(payload + 8);
+            if (id >= m_leases.size() || length != 12 + 16 * static_cast<size_t>(count)) return false;
+            c.leases.erase(std::remove(c.leases.begin(), c.leases.end(), id), c.leases.end());
+            Lease& lease = m_leases[id];
+            if (lease.state == LeaseState::Done) {
+                ++m_stats.duplicateResults;
+                return true;
+            }
+            if (lease.state == LeaseState::Pending) {
+                // Se había vuelto a poner en cola por retraso: ya no hace falta.
+                m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), id), m_pending.end());
+            }
+            lease.state = LeaseState::Done;
+            ++m_completed;
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint8_t* p = payload + 12 + 16 * i;
+                uint64_t bits = EncryptedContainer::get64(p + 8);
+                double score;
+                std::memcpy(&score, &bits, sizeof(score));
+                m_best.add({ EncryptedContainer::get64(p), score });
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    void
+        serveWaiting() {
+        for (const auto& connection : m_connections) {
+            Connection& c = *connection;
+            if (!c.waiting || m_pending.empty()) continue;
+            uint64_t id = m_pending.back();
+            m_pending.pop_back();
+            Lease& lease = m_leases[id];
+            uint8_t payload[28];
+            EncryptedContainer::put64(payload, id);
+            EncryptedContainer::put64(payload + 8, lease.first);
+            EncryptedContainer::put64(payload + 16, lease.count);
+            EncryptedContainer::put32(payload + 24, static_cast<uint32_t>(m_options.topK));
+            lease.state = LeaseState::Assigned;
+            lease.deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(m_options.leaseTimeout));
+            c.leases.push_back(id);
+            c.waiting = false;
+            ++m_stats.leasesIssued;
+            KeySearchProtocol::send(c.socket, KeySearchMessage::Lease, payload, sizeof(payload));
+        }
+    }
+
+    /**
+     * @brief Cierra una conexión y devuelve a la cola los rangos que tenía sin terminar.
+     */
+    void
+        drop(size_t i) {
+        Connection& c = *m_connections[i];
+        bool lost = false;
+        for (uint64_t id : c.leases) {
+            Lease& lease = m_leases[id];
+            if (lease.state == LeaseState::Assigned) {
+                lease.state = LeaseState::Pending;
+                m_pending.push_back(id);
+                ++m_stats.leasesReissued;
+                lost = true;
+            }
+        }
+        if (lost) ++m_stats.workersLost;
+        m_connections.erase(m_connections.begin() + i);
+    }
+};
+
+/**
+ * @class KeySearchWorker
+ * @brief Proceso trabajador: se conecta al coordinador, recibe el trabajo y procesa
+ *        rangos hasta que no quede ninguno.
+ */
+class KeySearchWorker {
+public:
+    /**
+     * @param port            Puerto del coordinador en 127.0.0.1.
+     * @param failAfterLeases Si no es 0, el proceso termina de golpe al recibir el rango
+     *                        número failAfterLeases + 1 (para probar la re-entrega).
+     * @return int Código de salida del proceso (0 si terminó normalmente).
+     */
+    static int
+        run(uint16_t port, unsigned failAfterLeases = 0) {
+        TcpSocket socket;
+        socket.connectLoopback(port);
+        if (!KeySearchProtocol::send(socket, KeySearchMessage::Hello, nullptr, 0)) return 1;
+
+        KeySearchMessage type;
+        std::vector<uint8_t> payload;
+        if (!KeySearchProtocol::receive(socket, type, payload) || type != KeySearchMessage::Job) return 1;
+        KeySearchJob job = KeySearchJob::deserialize(payload.data(), payload.size());
+
+        unsigned leases = 0;
+        for (;;) {
+            if (!KeySearchProtocol::send(socket, KeySearchMessage::Request, nullptr, 0)) return 1;
+            if (!KeySearchProtocol::receive(socket, type, payload)) return 1;
+            if (type == KeySearchMessage::Finish) return 0;
+            if (type != KeySearchMessage::Lease || payload.size() != 28) return 1;
+            if (failAfterLeases && ++leases > failAfterLeases) {
+                std::_Exit(3);
+            }
+
+            uint64_t id = EncryptedContainer::get64(payload.data());
+            uint64_t first = EncryptedContainer::get64(payload.data() + 8);
+            uint64_t count = EncryptedContainer::get64(payload.data() + 16);
+            uint32_t topK = EncryptedContainer::get32(payload.data() + 24);
+            std::vector<KeyCandidate> best = job.search(first, count, topK);
+
+            std::vector<uint8_t> result(12 + 16 * best.size());
+            EncryptedContainer::put64(result.data(), id);
+            EncryptedContainer::put32(result.data() + 8, static_cast<uint32_t>(best.size()));
+            for (size_t i = 0; i < best.size(); ++i) {
+                uint64_t bits;
+                std::memcpy(&bits, &best[i].score, sizeof(bits));
+                EncryptedContainer::put64(result.data() + 12 + 16 * i, best[i].index);
+                EncryptedContainer::put64(result.data() + 20 + 16 * i, bits);
+            }
+            if (!KeySearchProtocol::send(socket, KeySearchMessage::Result, result.data(), result.size())) return 1;
+        }
+    }
+
+};
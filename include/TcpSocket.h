@@ -0,0 +1,233 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class TcpSocket
+ * @brief Socket TCP sobre loopback: escucha, conexión y envío/recepción completos.
+ *
+ * Pensado para el protocolo de mensajes entre procesos del reparto de búsquedas; los
+ * mensajes son pequeños, así que se desactiva Nagle para no retrasarlos.
+ */
+class TcpSocket {
+public:
+#if defined(_WIN32)
+    using Handle = SOCKET;
+    static constexpr Handle INVALID = INVALID_SOCKET;
+#else
+    using Handle = int;
+    static constexpr Handle INVALID = -1;
+#endif
+
+    TcpSocket() = default;
+
+    ~TcpSocket() {
+        close();
+    }
+
+    TcpSocket(const TcpSocket&) = delete;
+    TcpSocket& operator=(const TcpSocket&) = delete;
+
+    TcpSocket(TcpSocket&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    TcpSocket&
+        operator=(TcpSocket&& other) noexcept {
+        if (this != &other) {
+            close();
+            m_socket = other.m_socket;
+            other.m_socket = INVALID;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Escucha en 127.0.0.1:port (0 = puerto elegido por el sistema).
+     *
+     * @throws std::runtime_error Si no se puede crear o asociar el socket.
+     */
+    void
+        listenLoopback(uint16_t port = 0, int backlog = 64) {
+        create();
+        int reuse = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        sockaddr_in address = loopback(port);
+        if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(m_socket, backlog) != 0) {
+            close();
+            throw std::runtime_error("No se pudo escuchar en el puerto TCP " + std::to_string(port));
+        }
+    }
+
+    /**
+     * @brief Acepta una conexión pendiente.
+     *
+     * @return TcpSocket Conexión aceptada (inválida si falló).
+     */
+    TcpSocket
+        accept() {
+        TcpSocket client;
+        client.m_socket = ::accept(m_socket, nullptr, nullptr);
+        if (client.isOpen()) client.setNoDelay();
+        return client;
+    }
+
+    /**
+     * @brief Conecta con 127.0.0.1:port.
+     *
+     * @throws std::runtime_error Si la conexión falla.
+     */
+    void
+        connectLoopback(uint16_t port) {
+        create();
+        sockaddr_in address = loopback(port);
+        if (::connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close();
+            throw std::runtime_error("No se pudo conectar con el puerto TCP " + std::to_string(port));
+        }
+        setNoDelay();
+    }
+
+    /**
+     * @brief Puerto local asociado.
+     */
+    uint16_t
+        port() const {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length);
+        return ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief Envía todo el buffer.
+     *
+     * @return bool false si la conexión se cerró o falló.
+     */
+    bool
+        sendAll(const uint8_t* data, size_t length) {
+        while (length > 0) {
+            int chunk = static_cast<int>(std::min<size_t>(length, 1 << 30));
+#if defined(MSG_NOSIGNAL)
+            int sent = static_cast<int>(::send(m_socket, reinterpret_cast<const char*>(data), chunk, MSG_NOSIGNAL));
+#else
+            int sent = static_cast<int>(::send(m_socket, reinterpret_cast<const char*>(data), chunk, 0));
+#endif
+            if (sent <= 0) return false;
+            data += sent;
+            length -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Recibe lo que haya disponible (bloquea hasta que llegue algo).
+     *
+     * @return int Bytes recibidos; 0 si el otro extremo cerró; negativo si hubo error.
+     */
+    int
+        receive(uint8_t* data, size_t capacity) {
+        return static_cast<int>(::recv(m_socket, reinterpret_cast<char*>(data), static_cast<int>(capacity), 0));
+    }
+
+    /**
+     * @brief Recibe exactamente @p length bytes.
+     *
+     * @return bool false si la conexión se cerró antes.
+     */
+    bool
+        receiveAll(uint8_t* data, size_t length) {
+        while (length > 0) {
+            int n = receive(data, length);
+            if (n <= 0) return false;
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool
+        isOpen() const {
+        return m_socket != INVALID;
+    }
+
+    Handle
+        handle() const {
+        return m_socket;
+    }
+
+    /**
+     * @brief Cierra el socket.
+     */
+    void
+        close() {
+        if (m_socket != INVALID) {
+#if defined(_WIN32)
+            closesocket(m_socket);
+#else
+            ::close(m_socket);
+#endif
+            m_socket = INVALID;
+        }
+    }
+
+private:
+    Handle m_socket = INVALID;
+
+    void
+        create() {
+        startup();
+        close();
+        m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (m_socket == INVALID) {
+            throw std::runtime_error("No se pudo crear el socket TCP.");
+        }
+    }
+
+    void
+        setNoDelay() {
+        int value = 1;
+        setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void
+        startup() {
+#if defined(_WIN32)
+        static const bool started = [] {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+        if (!started) {
+            throw std::runtime_error("No se pudo inicializar Winsock.");
+        }
+#endif
+    }
+
+    static sockaddr_in
+        loopback(uint16_t port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+    }
+};
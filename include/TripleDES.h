@@ -0,0 +1,252 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "DESKernel.h"
+
+/**
+ * @class TripleDES
+ * @brief Implementa Triple DES (EDE) sobre la ronda de la clase DES.
+ *
+ * Cifra con E(k3, D(k2, E(k1, x))). Con dos claves (EDE2) se usa k3 = k1.
+ * Las 48 subclaves de cada sentido se precalculan en el constructor y los bloques
+ * se procesan con DESKernel, que intercala varios bloques independientes por ronda.
+ * Incluye los modos ECB, CBC y CTR sobre buffers completos.
+ */
+class TripleDES {
+public:
+    /**
+     * @brief Tamaño de bloque en bytes.
+     */
+    static constexpr size_t BLOCK_SIZE = 8;
+
+    TripleDES() = default;
+
+    /**
+     * @brief Constructor EDE2 (dos claves, k3 = k1).
+     *
+     * @param k1 Primera clave (y tercera).
+     * @param k2 Segunda clave.
+     */
+    TripleDES(const std::bitset<64>& k1, const std::bitset<64>& k2)
+        : TripleDES(k1, k2, k1) {
+    }
+
+    /**
+     * @brief Constructor EDE3 (tres claves independientes).
+     *
+     * @param k1 Primera clave.
+     * @param k2 Segunda clave.
+     * @param k3 Tercera clave.
+     */
+    TripleDES(const std::bitset<64>& k1, const std::bitset<64>& k2, const std::bitset<64>& k3) {
+        DESKernel::Schedule s1 = DESKernel::makeSchedule(k1);
+        DESKernel::Schedule s2 = DESKernel::makeSchedule(k2);
+        DESKernel::Schedule s3 = DESKernel::makeSchedule(k3);
+
+        // Cifrado: E(k1) -> D(k2) -> E(k3)
+        setPass(m_encKeys, 0, s1);
+        setPass(m_encKeys, 1, DESKernel::reverse(s2));
+        setPass(m_encKeys, 2, s3);
+
+        // Descifrado: D(k3) -> E(k2) -> D(k1)
+        setPass(m_decKeys, 0, DESKernel::reverse(s3));
+        setPass(m_decKeys, 1, s2);
+        setPass(m_decKeys, 2, DESKernel::reverse(s1));
+    }
+
+    ~TripleDES() = default;
+
+    /**
+     * @brief Cifra un bloque de 64 bits.
+     */
+    std::bitset<64>
+        encode(const std::bitset<64>& plaintext) const {
+        return std::bitset<64>(DESKernel::cryptBlock(plaintext.to_ullong(), m_encKeys.data(), 3));
+    }
+
+    /**
+     * @brief Descifra un bloque de 64 bits.
+     */
+    std::bitset<64>
+        decode(const std::bitset<64>& ciphertext) const {
+        return std::bitset<64>(DESKernel::cryptBlock(ciphertext.to_ullong(), m_decKeys.data(), 3));
+    }
+
+    /**
+     * @brief Cifra varios bloques independientes (ruta intercalada).
+     */
+    void
+        encodeBlocks(const uint64_t* in, uint64_t* out, size_t count) const {
+        DESKernel::cryptBlocks(in, out, count, m_encKeys.data(), 3);
+    }
+
+    /**
+     * @brief Descifra varios bloques independientes (ruta intercalada).
+     */
+    void
+        decodeBlocks(const uint64_t* in, uint64_t* out, size_t count) const {
+        DESKernel::cryptBlocks(in, out, count, m_decKeys.data(), 3);
+    }
+
+    /**
+     * @brief Cifra un buffer en modo ECB.
+     *
+     * @param input Texto plano (longitud múltiplo de 8).
+     * @return std::string Texto cifrado.
+     * @throws std::invalid_argument Si la longitud no es múltiplo de 8.
+     */
+    std::string
+        encodeECB(const std::string& input) const {
+        return processECB(input, m_encKeys);
+    }
+
+    /**
+     * @brief Descifra un buffer en modo ECB.
+     */
+    std::string
+        decodeECB(const std::string& input) const {
+        return processECB(input, m_decKeys);
+    }
+
+    /**
+     * @brief Cifra un buffer en modo CBC.
+     *
+     * El cifrado CBC es secuencial por naturaleza, así que cada bloque se procesa
+     * en cuanto se conoce el anterior.
+     *
+     * @param input Texto plano (longitud múltiplo de 8).
+     * @param iv    Vector de inicialización de 64 bits.
+     * @return std::string Texto cifrado.
+     * @throws std::invalid_argument Si la longitud no es múltiplo de 8.
+     */
+    std::string
+        encodeCBC(const std::string& input, uint64_t iv) const {
+        checkLength(input);
+        std::string output(input.size(), '\0');
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+        unsigned char* out = reinterpret_cast<unsigned char*>(&output[0]);
+
+        uint64_t previous = iv;
+        for (size_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+            previous = DESKernel::cryptBlock(DESKernel::load64(in + i) ^ previous, m_encKeys.data(), 3);
+            DESKernel::store64(out + i, previous);
+        }
+        return output;
+    }
+
+    /**
+     * @brief Descifra un buffer en modo CBC.
+     *
+     * A diferencia del cifrado, los bloques se descifran de forma independiente y
+     * se aprovecha la ruta intercalada.
+     *
+     * @param input Texto cifrado (longitud múltiplo de 8).
+     * @param iv    Vector de inicialización usado al cifrar.
+     * @return std::string Texto plano.
+     */
+    std::string
+        decodeCBC(const std::string& input, uint64_t iv) const {
+        checkLength(input);
+        std::string output(input.size(), '\0');
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+        unsigned char* out = reinterpret_cast<unsigned char*>(&output[0]);
+
+        uint64_t blocks[BATCH];
+        uint64_t plain[BATCH];
+        uint64_t previous = iv;
+
+        for (size_t offset = 0; offset < input.size(); offset += BATCH * BLOCK_SIZE) {
+            size_t count = blocksIn(input.size() - offset);
+            for (size_t j = 0; j < count; ++j) {
+                blocks[j] = DESKernel::load64(in + offset + j * BLOCK_SIZE);
+            }
+            decodeBlocks(blocks, plain, count);
+            for (size_t j = 0; j < count; ++j) {
+                DESKernel::store64(out + offset + j * BLOCK_SIZE, plain[j] ^ previous);
+                previous = blocks[j];
+            }
+        }
+        return output;
+    }
+
+    /**
+     * @brief Cifra o descifra un buffer en modo CTR.
+     *
+     * El flujo de clave es E(iv + i) para el bloque i; como es simétrico, la misma
+     * función sirve para cifrar y descifrar. Admite cualquier longitud.
+     *
+     * @param input Datos de entrada.
+     * @param iv    Contador inicial de 64 bits.
+     * @return std::string Datos procesados.
+     */
+    std::string
+        cryptCTR(const std::string& input, uint64_t iv) const {
+        std::string output(input.size(), '\0');
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+        unsigned char* out = reinterpret_cast<unsigned char*>(&output[0]);
+
+        uint64_t counters[BATCH];
+        uint64_t stream[BATCH];
+        uint64_t counter = iv;
+
+        for (size_t offset = 0; offset < input.size(); offset += BATCH * BLOCK_SIZE) {
+            size_t remaining = input.size() - offset;
+            size_t count = blocksIn(remaining + BLOCK_SIZE - 1);
+            for (size_t j = 0; j < count; ++j) {
+                counters[j] = counter++;
+            }
+            encodeBlocks(counters, stream, count);
+
+            size_t bytes = remaining < count * BLOCK_SIZE ? remaining : count * BLOCK_SIZE;
+            for (size_t j = 0; j < bytes; ++j) {
+                unsigned char k = static_cast<unsigned char>(stream[j / 8] >> (56 - 8 * (j % 8)));
+                out[offset + j] = in[offset + j] ^ k;
+            }
+        }
+        return output;
+    }
+
+private:
+    static constexpr size_t BATCH = 64;  ///< Bloques por lote en CBC/CTR.
+
+    std::array<uint64_t, 48> m_encKeys{};  ///< Subclaves de cifrado (3 pasadas).
+    std::array<uint64_t, 48> m_decKeys{};  ///< Subclaves de descifrado (3 pasadas).
+
+    static void
+        setPass(std::array<uint64_t, 48>& keys, int pass, const DESKernel::Schedule& schedule) {
+        std::copy(schedule.begin(), schedule.end(), keys.begin() + pass * 16);
+    }
+
+    static size_t
+        blocksIn(size_t bytes) {
+        size_t blocks = bytes / BLOCK_SIZE;
+        return blocks < BATCH ? blocks : BATCH;
+    }
+
+    static void
+        checkLength(const std::string& input) {
+        if (input.size() % BLOCK_SIZE != 0) {
+            throw std::invalid_argument("La longitud debe ser multiplo de 8 bytes.");
+        }
+    }
+
+    std::string
+        processECB(const std::string& input, const std::array<uint64_t, 48>& keys) const {
+        checkLength(input);
+        std::string output(input.size(), '\0');
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+        unsigned char* out = reinterpret_cast<unsigned char*>(&output[0]);
+
+        uint64_t blocks[BATCH];
+        for (size_t offset = 0; offset < input.size(); offset += BATCH * BLOCK_SIZE) {
+            size_t count = blocksIn(input.size() - offset);
+            for (size_t j = 0; j < count; ++j) {
+                blocks[j] = DESKernel::load64(in + offset + j * BLOCK_SIZE);
+            }
+            DESKernel::cryptBlocks(blocks, blocks, count, keys.data(), 3);
+            for (size_t j = 0; j < count; ++j) {
+                DESKernel::store64(out + offset + j * BLOCK_SIZE, blocks[j]);
+            }
+        }
+        return output;
+    }
+};
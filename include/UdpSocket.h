@@ -0,0 +1,248 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "PacketObfuscator.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class UdpSocket
+ * @brief Socket UDP sobre loopback con envío y recepción por lotes.
+ *
+ * En Linux usa sendmmsg/recvmmsg (una llamada al sistema por lote); en otras plataformas
+ * recorre el lote con send/recv. Los lotes son arreglos de PacketView, los mismos que
+ * consume PacketObfuscator::protectBatch/unprotectBatch.
+ */
+class UdpSocket {
+public:
+    /**
+     * @brief Tamaño máximo de lote por llamada.
+     */
+    static constexpr size_t MAX_BATCH = 64;
+
+    /**
+     * @throws std::runtime_error Si no se puede crear el socket.
+     */
+    UdpSocket() {
+        startup();
+        m_socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (m_socket == INVALID) {
+            throw std::runtime_error("No se pudo crear el socket UDP.");
+        }
+    }
+
+    ~UdpSocket() {
+        close();
+    }
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    /**
+     * @brief Asocia el socket a 127.0.0.1 (puerto 0 = elegido por el sistema).
+     *
+     * @throws std::runtime_error Si el puerto no está disponible.
+     */
+    void
+        bindLoopback(uint16_t port = 0) {
+        sockaddr_in address = loopback(port);
+        if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw std::runtime_error("No se pudo asociar el socket UDP al puerto " + std::to_string(port));
+        }
+    }
+
+    /**
+     * @brief Fija el destino de los envíos en 127.0.0.1:port.
+     */
+    void
+        connectLoopback(uint16_t port) {
+        sockaddr_in address = loopback(port);
+        if (::connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw std::runtime_error("No se pudo conectar el socket UDP.");
+        }
+    }
+
+    /**
+     * @brief Puerto local asociado.
+     */
+    uint16_t
+        port() const {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length);
+        return ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief Tiempo máximo de espera de receiveBatch en milisegundos.
+     */
+    void
+        setReceiveTimeout(int milliseconds) {
+#if defined(_WIN32)
+        DWORD value = static_cast<DWORD>(milliseconds);
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+#else
+        timeval value{ milliseconds / 1000, (milliseconds % 1000) * 1000 };
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+#endif
+    }
+
+    /**
+     * @brief Tamaño del buffer de recepción del sistema (evita pérdidas en ráfagas).
+     */
+    void
+        setReceiveBuffer(int bytes) {
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+    }
+
+    /**
+     * @brief Envía un lote de paquetes al destino conectado.
+     *
+     * @return size_t Paquetes enviados.
+     */
+    size_t
+        sendBatch(const PacketView* packets, size_t count) {
+        if (count > MAX_BATCH) count = MAX_BATCH;
+#if defined(__linux__)
+        mmsghdr messages[MAX_BATCH];
+        iovec vectors[MAX_BATCH];
+        for (size_t i = 0; i < count; ++i) {
+            vectors[i] = { packets[i].data, packets[i].length };
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = sendmmsg(m_socket, messages, static_cast<unsigned int>(count), 0);
+        return sent < 0 ? 0 : static_cast<size_t>(sent);
+#else
+        size_t sent = 0;
+        for (; sent < count; ++sent) {
+            if (::send(m_socket, reinterpret_cast<const char*>(packets[sent].data),
+                static_cast<int>(packets[sent].length), 0) < 0) {
+                break;
+            }
+        }
+        return sent;
+#endif
+    }
+
+    /**
+     * @brief Recibe hasta count paquetes; cada PacketView debe traer data y capacity.
+     *
+     * Bloquea hasta recibir al menos uno o hasta que expire el tiempo de espera.
+     *
+     * @return size_t Paquetes recibidos (length actualizado en cada uno).
+     */
+    size_t
+        receiveBatch(PacketView* packets, size_t count) {
+        if (count > MAX_BATCH) count = MAX_BATCH;
+#if defined(__linux__)
+        mmsghdr messages[MAX_BATCH];
+        iovec vectors[MAX_BATCH];
+        for (size_t i = 0; i < count; ++i) {
+            vectors[i] = { packets[i].data, packets[i].capacity };
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        // La primera espera respeta el tiempo límite; el resto del lote sólo lo ya disponible.
+        int received = recvmmsg(m_socket, messages, static_cast<unsigned int>(count), MSG_WAITFORONE, nullptr);
+        if (received <= 0) return 0;
+        for (int i = 0; i < received; ++i) {
+            packets[i].length = messages[i].msg_len;
+        }
+        return static_cast<size_t>(received);
+#else
+        size_t received = 0;
+        for (; received < count; ++received) {
+            int n = ::recv(m_socket, reinterpret_cast<char*>(packets[received].data),
+                static_cast<int>(packets[received].capacity), 0);
+            if (n < 0) break;
+            packets[received].length = static_cast<size_t>(n);
+            if (!pending()) {
+                ++received;
+                break;
+            }
+        }
+        return received;
+#endif
+    }
+
+    /**
+     * @brief Cierra el socket.
+     */
+    void
+        close() {
+        if (m_socket != INVALID) {
+#if defined(_WIN32)
+            closesocket(m_socket);
+#else
+            ::close(m_socket);
+#endif
+            m_socket = INVALID;
+        }
+    }
+
+private:
+#if defined(_WIN32)
+    using Handle = SOCKET;
+    static constexpr Handle INVALID = INVALID_SOCKET;
+#else
+    using Handle = int;
+    static constexpr Handle INVALID = -1;
+#endif
+
+    Handle m_socket = INVALID;
+
+    static void
+        startup() {
+#if defined(_WIN32)
+        static const bool started = [] {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+        if (!started) {
+            throw std::runtime_error("No se pudo inicializar Winsock.");
+        }
+#endif
+    }
+
+    static sockaddr_in
+        loopback(uint16_t port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+    }
+
+#if !defined(__linux__)
+    bool
+        pending() const {
+#if defined(_WIN32)
+        u_long available = 0;
+        ioctlsocket(m_socket, FIONREAD, &available);
+#else
+        int available = 0;
+        ioctl(m_socket, FIONREAD, &available);
+#endif
+        return available > 0;
+    }
+#endif
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "KeySearch.h"
 
 class
 	Vigenere {
@@ -49,11 +50,21 @@ public:
 	}
 
 	std::string decode(const std::string& text) {
-		std::string result;
-		result.reserve(text.size()); // Reserve space for efficiency
+		std::string result(text.size(), '\0');
+		decodeTo(text, key, result.data());
+		return result; // Return the decoded string
+	}
+
+	/**
+	 * @brief Descifra @p text con @p key (ya normalizada) sobre @p result, que debe tener
+	 *        sitio para text.size() bytes. No reserva memoria.
+	 */
+	static void
+		decodeTo(std::string_view text, std::string_view key, char* result) {
 		unsigned int i = 0; // Index for the key
 
-		for (char c : text) {
+		for (size_t n = 0; n < text.size(); ++n) {
+			char c = text[n];
 			if (std::isalpha(static_cast<unsigned char>(c))) {
 				bool isLower = std::islower(static_cast<unsigned char>(c));
 				char base = isLower ? 'a' : 'A'; // Determine base based on case
@@ -61,19 +72,16 @@ public:
 				// Desplazamiento de la key
 				int shift = key[i % key.size()] - 'A'; // Calculate shift based on key character mod26
 				// decode
-				char encodedChar = static_cast<char>(((c - base) - shift + 26) % 26 + base);
-				result += encodedChar; // Append encoded character to result
+				result[n] = static_cast<char>(((c - base) - shift + 26) % 26 + base);
 				i++; // Increment key index
 			}
 			else {
-				result += c; // Non-alphabetic characters are added unchanged
+				result[n] = c; // Non-alphabetic characters are added unchanged
 			}
 		}
-
-		return result; // Return the encoded string
 	}
 
-	static double fitness(const std::string& text) {
+	static double fitness(std::string_view text) {
 		static const std::vector<std::string> comunes = {
 		" DE ", " LA ", " EL ", " QUE ", " Y ",
 		" A ", " EN ", " UN ", " PARA ", " CON ",
@@ -91,7 +99,7 @@ public:
 		double score = 0;
 		for (auto& w : comunes) {
 			size_t pos = 0;
-			while ((pos = text.find(w, pos)) != std::string::npos) {
+			while ((pos = text.find(w, pos)) != std::string_view::npos) {
 				score += w.length();
 				pos += w.length();
 			}
@@ -101,34 +109,20 @@ public:
 	}
 
 	static std::string breakEncode(const std::string& text, int maxKeyLenght) {
+		TopKSink best(1);
+		breakEncode(text, maxKeyLenght, best);
+
 		std::string bestKey;
 		std::string bestText;
-		std::string trailKey;
-
-		double bestScore = -std::numeric_limits<double>::infinity(); // Initialize best score
-
-		// Funcion revursiva para generar todas las posibles claves de longitud
-		std::function<void(int, int)> dfs = [&](int pos, int maxLen) {
-			if (pos == maxLen) {
-				Vigenere v(trailKey);
-				std::string decodedText = v.decode(text);
-				double score = fitness(decodedText); // Score the decoded text
-				if (score > bestScore) {
-					bestScore = score;
-					bestKey = trailKey;
-					bestText = decodedText;
-				}
-				return;
-			}
-			for (char c = 'A'; c <= 'Z'; ++c) {
-				trailKey[pos] = c;
-				dfs(pos + 1, maxLen);
-			}
-			};
-
-		for (int L = 1; L <= maxKeyLenght; ++L) {
-			trailKey.assign(L, 'A');
-			dfs(0, L);
+		std::vector<AttackResult> results = best.results();
+		if (!results.empty()) {
+			bestKey = results.front().key;
+			bestText = results.front().plaintext;
+		}
+		else if (maxKeyLenght >= 1) {
+			// Ningn candidato con palabras comunes: se queda la primera clave probada
+			bestKey = "A";
+			bestText = text;
 		}
 
 		std::cout << "*** Fuerza Bruta Vigenre ***\n";
@@ -137,6 +131,31 @@ public:
 		return bestKey;
 	}
 
+	/**
+	 * @brief Prueba todas las claves de 1 a @p maxKeyLenght letras y entrega a @p sink los
+	 *        descifrados con puntuacin (fitness) positiva.
+	 *
+	 * Recorre las claves con KeySearch (LetterKeyGenerator) y descifra en la arena del hilo,
+	 * sin reservar memoria por clave.
+	 */
+	static KeySearchStats
+		breakEncode(const std::string& text, int maxKeyLenght, ResultSink& sink, unsigned threads = 1) {
+		KeySearchOptions options;
+		options.attack = "vigenere";
+		options.minScore = 0;
+		options.threads = threads;
+
+		KeySearch search(LetterKeyGenerator(static_cast<unsigned>(std::max(0, maxKeyLenght))),
+			[&text](std::string_view key, ScratchArena& arena, std::string_view& decoded) {
+				char* out = arena.allocate<char>(text.size());
+				decodeTo(text, key, out);
+				decoded = std::string_view(out, text.size());
+				return true;
+			},
+			[](std::string_view decoded) { return fitness(decoded); });
+		return search.run(sink, options);
+	}
+
 private:
 	std::string key; // The key for the Vigenere cipher
 };
@@ -172,24 +191,30 @@ int main() {
 std::string bestKey;
 std::string bestText;
 double bestScore = 0;
-std::string trailKey;
 
-// Evala qu tan bueno es el texto decodificado comparando palabras comunes
-double fitness(const std::string& decodedText) {
-	std::vector<std::string> palabrasClave = { "EL", "LA", "DE", "QUE", "Y", "EN", "UN", "SER", "ES", "CON" };
+// Evala qu tan bueno es el texto decodificado comparando palabras comunes.
+// La palabra en curso se guarda en un buffer fijo: ninguna palabra clave pasa de 3 letras.
+double fitness(std::string_view decodedText) {
+	static const char* const palabrasClave[] = { "EL", "LA", "DE", "QUE", "Y", "EN", "UN", "SER", "ES", "CON" };
 	int score = 0;
 
-	std::string palabraActual;
+	char palabraActual[4];
+	size_t longitud = 0;
 	for (char c : decodedText) {
-		if (std::isalpha(c)) {
-			palabraActual += std::toupper(c);
+		if (std::isalpha(static_cast<unsigned char>(c))) {
+			if (longitud < sizeof(palabraActual)) {
+				palabraActual[longitud] = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+			}
+			++longitud;
 		}
 		else {
-			if (!palabraActual.empty()) {
-				for (const auto& palabra : palabrasClave) {
-					if (palabraActual == palabra) score++;
+			if (longitud != 0) {
+				if (longitud < sizeof(palabraActual)) {
+					for (const char* palabra : palabrasClave) {
+						if (std::strlen(palabra) == longitud && std::memcmp(palabraActual, palabra, longitud) == 0) score++;
+					}
 				}
-				palabraActual.clear();
+				longitud = 0;
 			}
 		}
 	}
@@ -197,35 +222,32 @@ double fitness(const std::string& decodedText) {
 	return static_cast<double>(score);
 }
 
-// DFS recursivo para generar claves y probarlas
-void dfs(int pos, int maxLen, const std::string& text) {
-	if (pos == maxLen) {
-		Vigenere v(trailKey);
-		std::string decodedText = v.decode(text);
-		double score = fitness(decodedText);
-		if (score > bestScore) {
-			bestScore = score;
-			bestKey = trailKey;
-			bestText = decodedText;
-		}
-		return;
-	}
-
-	for (char c = 'A'; c <= 'Z'; ++c) {
-		trailKey[pos] = c;
-		dfs(pos + 1, maxLen, text);
-	}
-}
-
-// Funcin principal para romper Vigenere
+// Funcin principal para romper Vigenere: claves de 1 a maxKeyLength letras con KeySearch
 std::string breakBruteForce(const std::string& text, int maxKeyLength = 3) {
 	bestKey.clear();
 	bestText.clear();
 	bestScore = 0;
 
-	for (int L = 1; L <= maxKeyLength; ++L) {
-		trailKey.assign(L, 'A');
-		dfs(0, L, text);
+	KeySearchOptions options;
+	options.attack = "vigenere";
+	options.minScore = 0;
+
+	TopKSink best(1);
+	KeySearch search(LetterKeyGenerator(static_cast<unsigned>(std::max(0, maxKeyLength))),
+		[&text](std::string_view key, ScratchArena& arena, std::string_view& decoded) {
+			char* out = arena.allocate<char>(text.size());
+			Vigenere::decodeTo(text, key, out);
+			decoded = std::string_view(out, text.size());
+			return true;
+		},
+		[](std::string_view decoded) { return fitness(decoded); });
+	search.run(best, options);
+
+	std::vector<AttackResult> results = best.results();
+	if (!results.empty()) {
+		bestKey = results.front().key;
+		bestText = results.front().plaintext;
+		bestScore = results.front().score;
 	}
 
 	std::cout << "\n*** Fuerza Bruta Vigenre ***\n";
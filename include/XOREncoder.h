@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "Prerequisites.h"
+#include "ResultSink.h"
+#include "KeySearch.h"
 
 /**
  * @class XOREncoder
@@ -105,21 +107,19 @@ public:
      * @param cifrado Vector de bytes del mensaje cifrado.
      */
     void bruteForce_1Byte(const std::vector<unsigned char>& cifrado) {
-        for (int clave = 0; clave < 256; ++clave) {
-            std::string result;
-
-            for (unsigned char c : cifrado) {
-                result += static_cast<unsigned char>(c ^ clave);
-            }
+        TextSink sink(std::cout);
+        bruteForce_1Byte(cifrado, sink);
+    }
 
-            if (isValidText(result)) {
-                std::cout << "=============================\n";
-                std::cout << "Clave 1 byte  : '" << static_cast<char>(clave)
-                    << "' (0x" << std::hex << std::setw(2)
-                    << std::setfill('0') << clave << ")\n";
-                std::cout << "Texto posible : " << result << "\n";
-            }
-        }
+    /**
+     * @brief Fuerza bruta de 1 byte que entrega los textos válidos a @p sink.
+     *
+     * La clave se entrega en hexadecimal ("0x6b") y la puntuación es la fracción de letras
+     * y espacios del texto.
+     */
+    void bruteForce_1Byte(const std::vector<unsigned char>& cifrado, ResultSink& sink) {
+        KeySearch search(ByteKeyGenerator(1), RepeatingXorDecoder(cifrado), LetterRatioScorer());
+        search.run(sink, xorOptions("xor-1byte"));
     }
 
     /**
@@ -131,29 +131,19 @@ public:
      * @param cifrado Vector de bytes del mensaje cifrado.
      */
     void bruteForce_2Byte(const std::vector<unsigned char>& cifrado) {
-        for (int b1 = 0; b1 < 256; ++b1) {
-            for (int b2 = 0; b2 < 256; ++b2) {
-                std::string result;
-                unsigned char key[2] = {
-                  static_cast<unsigned char>(b1),
-                  static_cast<unsigned char>(b2)
-                };
-
-                for (int i = 0; i < cifrado.size(); i++) {
-                    result += cifrado[i] ^ key[i % 2];
-                }
+        TextSink sink(std::cout);
+        bruteForce_2Byte(cifrado, sink);
+    }
 
-                if (isValidText(result)) {
-                    std::cout << "=============================\n";
-                    std::cout << "Clave 2 bytes : '" << static_cast<char>(b1)
-                        << static_cast<char>(b2) << "' (0x"
-                        << std::hex << std::setw(2) << std::setfill('0') << b1
-                        << " 0x" << std::setw(2) << std::setfill('0') << b2
-                        << ")\n";
-                    std::cout << "Texto posible : " << result << "\n";
-                }
-            }
-        }
+    /**
+     * @brief Fuerza bruta de 2 bytes que entrega los textos válidos a @p sink.
+     *
+     * Cada clave se descarta en cuanto aparece el primer byte no imprimible, así que la
+     * mayoría de las 65536 claves cuestan unos pocos bytes.
+     */
+    void bruteForce_2Byte(const std::vector<unsigned char>& cifrado, ResultSink& sink) {
+        KeySearch search(ByteKeyGenerator(2), RepeatingXorDecoder(cifrado), LetterRatioScorer());
+        search.run(sink, xorOptions("xor-2byte"));
     }
 
     /**
@@ -165,24 +155,27 @@ public:
      * @param cifrado Vector de bytes del mensaje cifrado.
      */
     void bruteForceByDictionary(const std::vector<unsigned char>& cifrado) {
-        std::vector<std::string> clavesComunes = {
+        TextSink sink(std::cout);
+        bruteForceByDictionary(cifrado, sink);
+    }
+
+    /**
+     * @brief Ataque por diccionario que entrega los textos válidos a @p sink.
+     */
+    void bruteForceByDictionary(const std::vector<unsigned char>& cifrado, ResultSink& sink) {
+        static const std::vector<std::string> clavesComunes = {
           "clave", "admin", "1234", "root", "test", "abc", "hola", "user",
           "pass", "12345", "0000", "password", "default"
         };
 
-        for (const auto& clave : clavesComunes) {
-            std::string result;
-            for (int i = 0; i < cifrado.size(); i++) {
-                result += static_cast<unsigned char>(
-                    cifrado[i] ^ clave[i % clave.size()]);
-            }
-            if (isValidText(result)) {
-                std::cout << "=============================\n";
-                std::cout << "Clave de diccionario: '" << clave << "'\n";
-                std::cout << "Texto posible : " << result << "\n";
-            }
-        }
+        KeySearch search{ WordListGenerator(clavesComunes), RepeatingXorDecoder(cifrado), LetterRatioScorer() };
+        search.run(sink, xorOptions("xor-diccionario"));
     }
 
 private:
+    static KeySearchOptions xorOptions(const char* attack) {
+        KeySearchOptions options;
+        options.attack = attack;
+        return options;
+    }
 };
@@ -10,6 +10,65 @@
 #include "../include/KeyGenerator.h"
 #include "../include/Vigenere.h"
 #include "../include/CryptoGenerator.h"
+#include "../include/TripleDES.h"
+#include "../include/AES.h"
+#include "../include/PBKDF2.h"
+#include "../include/EncryptedContainer.h"
+#include "../include/DecodeViews.h"
+#include "../include/CipherPipeline.h"
+#include "../include/ObfuscatedString.h"
+#include "../include/AssetPack.h"
+#include "../include/UdpSocket.h"
+#include "../include/KeystreamPrefetcher.h"
+#include "../include/NGramCorpus.h"
+#include "../include/SubstitutionSolver.h"
+#include "../include/BlobClassifier.h"
+#include "../include/CribDragger.h"
+#include "../include/BreachFilter.h"
+#include "../include/SecureArena.h"
+#include "../include/RandomnessTests.h"
+#include "../include/RainbowTable.h"
+#include "../include/MeetInTheMiddle.h"
+#include "../include/ShardedKeySearch.h"
+#include "../include/CrackScheduler.h"
+#include "../include/ResultSink.h"
+#include "../include/IncrementalLogCipher.h"
+#include "../include/AlphabetCipher.h"
+#include "../include/KeySearch.h"
+
+// ================= CONTADOR DE RESERVAS =================
+
+// Reservas del montón de todo el programa; las pruebas de rendimiento las restan antes y
+// después de un bucle para publicar reservas por candidato.
+static std::atomic<uint64_t> g_heapAllocations{ 0 };
+
+uint64_t heapAllocations() {
+    return g_heapAllocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC, al integrar estos operadores en quien los llama, ve un free() sobre memoria de new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
  // ================= FUNCIONES =================
 
@@ -174,10 +233,1940 @@ void testCryptoGenerator() {
     std::cout << "Salt e IV borrados de forma segura.\n";
 }
 
+void testTripleDes() {
+    std::cout << "\n--- Prueba de Triple DES (EDE) ---\n";
+
+    std::bitset<64> k1("0001001100110100010101110111100110011011101111001101111111110001");
+    std::bitset<64> k2("1010101111001101111011110000000100100011010001010110011110001001");
+    std::bitset<64> k3("0111011001010100001100100001000011111110110111001011101010011000");
+
+    TripleDES tdes(k1, k2, k3);
+    uint64_t iv = 0x0123456789ABCDEFULL;
+
+    std::string phrase = "$Hola 3DES! Mensaje de prueba.";
+    while (phrase.size() % 8 != 0) {
+        phrase += '\0';
+    }
+
+    std::string cbc = tdes.encodeCBC(phrase, iv);
+    std::string ctr = tdes.cryptCTR(phrase, iv);
+    XOREncoder hex;
+
+    std::cout << "Texto original : " << phrase.c_str() << std::endl;
+    std::cout << "CBC (hex)      : ";
+    hex.printHex(cbc);
+    std::cout << std::dec << std::endl;
+    std::cout << "CBC descifrado : " << tdes.decodeCBC(cbc, iv).c_str() << std::endl;
+    std::cout << "CTR descifrado : " << tdes.cryptCTR(ctr, iv).c_str() << std::endl;
+
+    // Comparacion contra tres llamadas a DES::encode/decode por bloque
+    DES d1(k1), d2(k2), d3(k3);
+    const size_t numBlocks = 20000;
+    std::vector<uint64_t> blocks(numBlocks), fast(numBlocks), naive(numBlocks);
+    for (size_t i = 0; i < numBlocks; ++i) {
+        blocks[i] = iv * (i + 1);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numBlocks; ++i) {
+        naive[i] = d3.encode(d2.decode(d1.encode(std::bitset<64>(blocks[i])))).to_ullong();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    tdes.encodeBlocks(blocks.data(), fast.data(), numBlocks);
+    auto t2 = std::chrono::steady_clock::now();
+
+    double naiveMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    double fastMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+    std::cout << "Resultados identicos a DES x3: " << (naive == fast ? "si" : "no") << std::endl;
+    std::cout << "DES::encode x3 : " << naiveMs << " ms (" << numBlocks << " bloques)" << std::endl;
+    std::cout << "TripleDES      : " << fastMs << " ms" << std::endl;
+    std::cout << "Aceleracion    : " << (fastMs > 0 ? naiveMs / fastMs : 0) << "x" << std::endl;
+}
+
+void testAes() {
+    std::cout << "\n--- Prueba de AES (CBC/CTR/GCM) ---\n";
+
+    CryptoGenerator cryptoGen;
+    auto key = cryptoGen.generateKey(128);
+    auto iv = cryptoGen.generateIV(16);
+    auto nonce = cryptoGen.generateIV(12);
+
+    AES aes(key);
+    std::cout << "Clave AES 128-bit (hex): " << cryptoGen.toHex(key) << std::endl;
+    std::cout << "Ruta AES-NI            : " << (aes.usesHardware() ? "si" : "no") << std::endl;
+
+    std::string mensaje = "Mensaje secreto para AES en el laboratorio!!";
+    std::vector<uint8_t> data(mensaje.begin(), mensaje.end());
+    std::vector<uint8_t> padded = data;
+    padded.resize((data.size() + 15) / 16 * 16, 0);
+
+    auto cbc = aes.encodeCBC(padded, iv);
+    auto ctr = aes.cryptCTR(data, iv);
+    auto gcm = aes.encodeGCM(data, nonce);
+    std::vector<uint8_t> plain;
+
+    std::cout << "CBC (hex): " << cryptoGen.toHex(cbc) << std::endl;
+    std::cout << "CTR (hex): " << cryptoGen.toHex(ctr) << std::endl;
+    std::cout << "GCM (hex): " << cryptoGen.toHex(gcm) << std::endl;
+
+    auto cbcPlain = aes.decodeCBC(cbc, iv);
+    auto ctrPlain = aes.cryptCTR(ctr, iv);
+    bool gcmOk = aes.decodeGCM(gcm, nonce, plain);
+    std::cout << "CBC descifrado: " << std::string(cbcPlain.begin(), cbcPlain.begin() + data.size()) << std::endl;
+    std::cout << "CTR descifrado: " << std::string(ctrPlain.begin(), ctrPlain.end()) << std::endl;
+    std::cout << "GCM descifrado: " << std::string(plain.begin(), plain.end())
+        << (gcmOk ? " (etiqueta valida)" : " (etiqueta invalida)") << std::endl;
+
+    // Rendimiento de CTR con ambas rutas
+    std::vector<uint8_t> buffer(16 * 1024 * 1024, 0x5A);
+    for (int hw = 1; hw >= 0; --hw) {
+        aes.setHardwareAcceleration(hw == 1);
+        if (hw == 1 && !aes.usesHardware()) {
+            continue;
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        aes.cryptCTR(buffer.data(), buffer.data(), buffer.size(), iv.data());
+        auto t1 = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(t1 - t0).count();
+        std::cout << (hw ? "CTR AES-NI  : " : "CTR tablas T: ")
+            << (buffer.size() / (1024.0 * 1024.0)) / seconds << " MB/s" << std::endl;
+    }
+
+    cryptoGen.secureWipe(key);
+}
+
+void testKeyDerivation() {
+    std::cout << "\n--- Prueba de SHA-256, HMAC y PBKDF2 ---\n";
+
+    CryptoGenerator cryptoGen;
+    std::string mensaje = "TheTribalChief";
+    std::cout << "SHA-256(\"" << mensaje << "\"): " << cryptoGen.toHex(SHA256::hash(mensaje)) << std::endl;
+
+    auto macKey = cryptoGen.generateKey(256);
+    std::vector<uint8_t> data(mensaje.begin(), mensaje.end());
+    std::cout << "HMAC-SHA256       : " << cryptoGen.toHex(HMACSHA256::mac(macKey, data)) << std::endl;
+
+    auto salt = cryptoGen.generateSalt(16);
+    std::string password = cryptoGen.generatePassword(16);
+    auto derived = PBKDF2::deriveKey(password, salt, 10000, 32);
+    std::cout << "Salt (Base64)     : " << cryptoGen.toBase64(salt) << std::endl;
+    std::cout << "Clave PBKDF2      : " << cryptoGen.toHex(derived) << std::endl;
+
+    // Derivacion masiva: una salt por contrasena, como en una migracion de credenciales
+    const size_t total = 64;
+    const uint32_t iterations = 10000;
+    std::vector<std::string> passwords;
+    std::vector<std::vector<uint8_t>> salts;
+    for (size_t i = 0; i < total; ++i) {
+        passwords.push_back(cryptoGen.generatePassword(12));
+        salts.push_back(cryptoGen.generateSalt(16));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint8_t>> scalar;
+    for (size_t i = 0; i < total; ++i) {
+        scalar.push_back(PBKDF2::deriveKey(passwords[i], salts[i], iterations, 32));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    auto lanes = PBKDF2::deriveKeys(passwords, salts, iterations, 32);
+    auto t2 = std::chrono::steady_clock::now();
+
+    double scalarSec = std::chrono::duration<double>(t1 - t0).count();
+    double lanesSec = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "Multi-buffer AVX2 : " << (PBKDF2::multiBufferAvailable() ? "si" : "no") << std::endl;
+    std::cout << "Resultados iguales: " << (scalar == lanes ? "si" : "no") << std::endl;
+    std::cout << "Una a una         : " << total / scalarSec << " contrasenas/s" << std::endl;
+    std::cout << "8 carriles        : " << total / lanesSec << " contrasenas/s" << std::endl;
+
+    cryptoGen.secureWipe(derived);
+    cryptoGen.secureWipe(macKey);
+}
+
+void testEncryptedContainer() {
+    std::cout << "\n--- Prueba del contenedor cifrado por chunks ---\n";
+
+    CryptoGenerator cryptoGen;
+    auto key = cryptoGen.generateKey(256);
+    auto nonce = cryptoGen.generateIV(16);
+    const std::string path = "contenedor_prueba.ttc";
+
+    // 32 MB de datos de prueba escritos en trozos de distinto tamano
+    std::vector<uint8_t> data(32 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>((i * 31) ^ (i >> 11));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        EncryptedContainerWriter writer(path, key, nonce);
+        for (size_t offset = 0; offset < data.size(); offset += 100000) {
+            writer.write(data.data() + offset, std::min<size_t>(100000, data.size() - offset));
+        }
+        writer.finish();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    EncryptedContainerReader reader(path, key);
+    std::cout << "Tamano plano   : " << reader.size() << " bytes en " << reader.chunkCount() << " chunks" << std::endl;
+    std::cout << "Escritura      : " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+
+    // Lecturas aleatorias de 4 KB
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> buffer(4096);
+    const int reads = 10000;
+    bool ok = true;
+    auto t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reads; ++i) {
+        uint64_t offset = rng() % (data.size() - buffer.size());
+        reader.read(offset, buffer.data(), buffer.size());
+        ok = ok && std::memcmp(buffer.data(), data.data() + offset, buffer.size()) == 0;
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    std::cout << "Lecturas correctas: " << (ok ? "si" : "no") << std::endl;
+    std::cout << "Lectura aleatoria 4 KB: "
+        << std::chrono::duration<double, std::micro>(t3 - t2).count() / reads << " us promedio" << std::endl;
+
+    // Contenedores alterados: tamano del pie (fuera del CRC del indice) y tamano de chunk
+    auto alterado = [&](size_t posicion, uint8_t valor) {
+        const std::string copia = path + ".alterado";
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::ofstream out(copia, std::ios::binary);
+            out << in.rdbuf();
+        }
+        {
+            std::fstream f(copia, std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(static_cast<std::streamoff>(posicion));
+            f.put(static_cast<char>(valor));
+        }
+        bool rechazado = false;
+        try {
+            EncryptedContainerReader corrupto(copia, key);
+        }
+        catch (const std::runtime_error& e) {
+            rechazado = true;
+            std::cout << "  rechazado: " << e.what() << std::endl;
+        }
+        std::remove(copia.c_str());
+        return rechazado;
+    };
+    size_t tamanoArchivo = static_cast<size_t>(std::filesystem::file_size(path));
+    std::cout << "Contenedores alterados:" << std::endl;
+    bool pie = alterado(tamanoArchivo - EncryptedContainer::FOOTER_SIZE + 16 + 7, 0x40);
+    bool chunk = alterado(16 + 2, 0);          // chunkSize = 0
+    chunk = alterado(16, 8) && chunk;          // chunkSize no multiplo de 16
+    std::cout << "Pie y chunk alterados rechazados: " << (pie && chunk ? "si" : "no") << std::endl;
+
+    cryptoGen.secureWipe(key);
+    std::remove(path.c_str());
+}
+
+void testDecodeViews() {
+    std::cout << "\n--- Prueba de vistas de decodificacion perezosa ---\n";
+
+    CesarEncryption cesar;
+    XOREncoder xorEncoder;
+    AsciiBinary ab;
+
+    // Texto grande con un marcador cerca del principio
+    std::string texto = "Cabecera del archivo. FIN_CABECERA ";
+    while (texto.size() < 8 * 1024 * 1024) {
+        texto += "Bienvenidos a la clase de seguridad para videojuegos. ";
+    }
+
+    std::string cifradoCesar = cesar.encode(texto, 4);
+    std::string cifradoXor = xorEncoder.encode(texto, "clave");
+
+    auto prefijo = cifradoCesar | decode_views::caesar(4) | std::views::take(21);
+    std::string inicio;
+    std::ranges::copy(prefijo, std::back_inserter(inicio));
+    std::cout << "Primeros 21 caracteres (Cesar): " << inicio << std::endl;
+
+    std::string binario = ab.stringToBinary("Hola!");
+    std::string desdeBinario;
+    std::ranges::copy(binario | decode_views::binary_text(), std::back_inserter(desdeBinario));
+    std::cout << "Binario a texto (vista)       : " << desdeBinario << std::endl;
+
+    // Buscar el marcador: decodificacion completa frente a vista perezosa
+    const std::string marcador = "FIN_CABECERA";
+    auto t0 = std::chrono::steady_clock::now();
+    std::string completo = xorEncoder.encode(cifradoXor, "clave");
+    size_t posCompleto = completo.find(marcador);
+    auto t1 = std::chrono::steady_clock::now();
+
+    auto vista = cifradoXor | decode_views::xor_key("clave");
+    size_t posVista = 0;
+    size_t coincidencia = 0;
+    for (char c : vista) {
+        coincidencia = (c == marcador[coincidencia]) ? coincidencia + 1 : (c == marcador[0] ? 1 : 0);
+        ++posVista;
+        if (coincidencia == marcador.size()) {
+            break;
+        }
+    }
+    posVista -= marcador.size();
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << "Marcador en posicion          : " << posCompleto << " / " << posVista << std::endl;
+    std::cout << "Decodificacion completa       : " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+    std::cout << "Vista perezosa                : " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+}
+
+
+void testCipherPipeline() {
+    std::cout << "\n--- Prueba de canalizacion de cifrado fusionada ---\n";
+
+    CesarEncryption cesar;
+    XOREncoder xorEncoder;
+    Vigenere vigenere("clave");
+    auto pipeline = makePipeline(CaesarStage(3), VigenereStage("clave"), XorStage("k3y"));
+
+    std::string mensaje = "Ataque al amanecer 0600";
+    std::string cifrado = pipeline.encode(mensaje);
+    std::cout << "Original  : " << mensaje << std::endl;
+    std::cout << "Descifrado: " << pipeline.decode(cifrado) << std::endl;
+    std::cout << "Inversa   : " << pipeline.inverse().encode(cifrado) << std::endl;
+
+    std::string texto;
+    while (texto.size() < 32 * 1024 * 1024) {
+        texto += "Bienvenidos a la clase de seguridad para videojuegos 2025. ";
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::string porEtapas = xorEncoder.encode(vigenere.encode(cesar.encode(texto, 3)), "k3y");
+    auto t1 = std::chrono::steady_clock::now();
+    std::string fusionado = pipeline.encode(texto);
+    auto t2 = std::chrono::steady_clock::now();
+    std::string recuperado = pipeline.decode(fusionado);
+    auto t3 = std::chrono::steady_clock::now();
+
+    auto mbps = [&](std::chrono::steady_clock::duration d) {
+        return texto.size() / (1024.0 * 1024.0) / std::chrono::duration<double>(d).count();
+        };
+    std::cout << "Mismo resultado que las tres clases: " << (porEtapas == fusionado ? "si" : "no") << std::endl;
+    std::cout << "Ida y vuelta correcta              : " << (recuperado == texto ? "si" : "no") << std::endl;
+    std::cout << "Tres pasadas (Cesar, Vigenere, XOR): " << mbps(t1 - t0) << " MB/s" << std::endl;
+    std::cout << "Canalizacion fusionada (cifrar)    : " << mbps(t2 - t1) << " MB/s" << std::endl;
+    std::cout << "Canalizacion fusionada (descifrar) : " << mbps(t3 - t2) << " MB/s" << std::endl;
+}
+
+void testObfuscatedStrings() {
+    using namespace obfuscation::literals;
+    std::cout << "\n--- Prueba de cadenas ofuscadas en compilacion ---\n";
+
+    // Versiones constexpr: se comprueban contra las clases originales
+    constexpr auto cesarCt = obfuscation::caesarEncode(std::to_array("Hola Mundo 2025"), 3);
+    constexpr auto vigenereCt = obfuscation::vigenereEncode(std::to_array("Ataque al amanecer"), "clave");
+    constexpr auto xorCt = obfuscation::xorEncode(std::to_array("Hola"), "k");
+    static_assert(obfuscation::caesarDecode(obfuscation::caesarEncode('7', 5), 5) == '7');
+
+    CesarEncryption cesar;
+    Vigenere vigenere("clave");
+    XOREncoder xorEncoder;
+    std::cout << "Cesar constexpr    : " << cesarCt.data()
+        << (cesar.encode("Hola Mundo 2025", 3) == cesarCt.data() ? " (coincide)" : " (NO coincide)") << std::endl;
+    std::cout << "Vigenere constexpr : " << vigenereCt.data()
+        << (vigenere.encode("Ataque al amanecer") == vigenereCt.data() ? " (coincide)" : " (NO coincide)") << std::endl;
+    std::cout << "XOR constexpr      : "
+        << (xorEncoder.encode("Hola", "k") == std::string(xorCt.data(), 4) ? "coincide" : "NO coincide") << std::endl;
+
+    auto servidor = "servidor-partidas.ttc.local:7777"_obf;
+    std::cout << "Literal ofuscado   : " << servidor.c_str() << std::endl;
+    std::cout << "Copia en la pila   : " << servidor.decrypt().data() << std::endl;
+
+    // Coste por acceso frente a un literal sin ofuscar
+    const int accesos = 10000000;
+    size_t total = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < accesos; ++i) {
+        const char* volatile p = "servidor-partidas.ttc.local:7777";
+        total += p[i & 15];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < accesos; ++i) {
+        total += "servidor-partidas.ttc.local:7777"_obf.c_str()[i & 15];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "Literal normal     : " << std::chrono::duration<double, std::nano>(t1 - t0).count() / accesos << " ns/acceso" << std::endl;
+    std::cout << "Literal ofuscado   : " << std::chrono::duration<double, std::nano>(t2 - t1).count() / accesos << " ns/acceso"
+        << " (suma " << total << ")" << std::endl;
+}
+
+void testAssetPack() {
+    std::cout << "\n--- Prueba de paquete de assets cifrado ---\n";
+
+    CryptoGenerator cryptoGen;
+    auto masterKey = cryptoGen.generateKey(256);
+    const std::string directorio = "assets_prueba";
+    const std::string path = "assets_prueba.ttcpak";
+
+    // Directorio de ejemplo con algunos archivos
+    std::filesystem::create_directories(directorio + "/texturas");
+    {
+        std::ofstream(directorio + "/config.ini") << "[video]\nresolucion=1920x1080\n";
+        std::ofstream(directorio + "/texturas/jugador.txt") << "Sprite del jugador";
+    }
+
+    // 256 MB de assets en memoria (64 x 4 MB); el tiempo escala linealmente con el tamano
+    const size_t assetSize = 4 * 1024 * 1024;
+    const int assetCount = 64;
+    std::vector<uint8_t> contenido(assetSize);
+    for (size_t i = 0; i < contenido.size(); ++i) {
+        contenido[i] = static_cast<uint8_t>((i * 131) ^ (i >> 9));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        AssetPackBuilder builder(masterKey);
+        builder.addDirectory(directorio);
+        for (int i = 0; i < assetCount; ++i) {
+            builder.addMemory("niveles/nivel" + std::to_string(i) + ".bin", contenido);
+        }
+        builder.write(path);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    AssetPack pack(path, masterKey);
+    std::cout << "Assets en el paquete: " << pack.assetCount() << std::endl;
+    auto config = pack.load("config.ini");
+    std::cout << "config.ini          : " << std::string(config.begin(), config.end());
+
+    std::vector<uint8_t> buffer(assetSize);
+    double totalMb = assetCount * (assetSize / (1024.0 * 1024.0));
+
+    // El paquete se acaba de escribir: todas las medidas son con la cache de paginas caliente,
+    // es decir, memoria -> memoria, sin lectura real del disco.
+    // Linea base: copiar los bytes cifrados desde la proyeccion (solo acceso a memoria)
+    auto t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < assetCount; ++i) {
+        const AssetPack::AssetInfo* info = pack.find("niveles/nivel" + std::to_string(i) + ".bin");
+        std::memcpy(buffer.data(), pack.rawData(*info), static_cast<size_t>(info->size));
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < assetCount; ++i) {
+        pack.load("niveles/nivel" + std::to_string(i) + ".bin", buffer.data(), buffer.size());
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    for (int i = 0; i < assetCount; ++i) {
+        pack.load("niveles/nivel" + std::to_string(i) + ".bin", buffer.data(), buffer.size(), false);
+    }
+    auto t5 = std::chrono::steady_clock::now();
+
+    // Comprobacion fuera de las medidas
+    bool ok = true;
+    for (int i = 0; i < assetCount; ++i) {
+        pack.load("niveles/nivel" + std::to_string(i) + ".bin", buffer.data(), buffer.size());
+        ok = ok && buffer == contenido;
+    }
+
+    auto segundos = [](std::chrono::steady_clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    std::cout << "Assets correctos    : " << (ok ? "si" : "no") << std::endl;
+    std::cout << "Construccion        : " << totalMb / segundos(t1 - t0) << " MB/s" << std::endl;
+    std::cout << "Cache de paginas caliente (archivo recien escrito):" << std::endl;
+    std::cout << "Copia de cifrados   : " << totalMb / segundos(t3 - t2) << " MB/s" << std::endl;
+    std::cout << "Descifrado + CRC    : " << totalMb / segundos(t4 - t3) << " MB/s" << std::endl;
+    std::cout << "Descifrado sin CRC  : " << totalMb / segundos(t5 - t4) << " MB/s" << std::endl;
+
+    cryptoGen.secureWipe(masterKey);
+    std::filesystem::remove_all(directorio);
+    std::remove(path.c_str());
+}
+
+void testPacketObfuscation() {
+    std::cout << "\n--- Prueba de ofuscacion de paquetes UDP ---\n";
+
+    CryptoGenerator cryptoGen;
+    auto key = cryptoGen.generateKey(128);
+    PacketObfuscator emisor(key);
+    PacketObfuscator receptor(key);
+    PacketConnection conexionEmisor = PacketObfuscator::openConnection(42, PacketObfuscator::Role::Client);
+    PacketConnection conexionReceptor = PacketObfuscator::openConnection(42, PacketObfuscator::Role::Server);
+
+    // Cada sentido usa su flujo de clave: el paquete 0 del cliente y el del servidor difieren
+    {
+        std::vector<uint8_t> deCliente(32, 0), deServidor(32, 0);
+        PacketConnection cliente = PacketObfuscator::openConnection(7, PacketObfuscator::Role::Client);
+        PacketConnection servidor = PacketObfuscator::openConnection(7, PacketObfuscator::Role::Server);
+        PacketView vistaCliente{ deCliente.data(), deCliente.size(), deCliente.size() };
+        PacketView vistaServidor{ deServidor.data(), deServidor.size(), deServidor.size() };
+        emisor.protect(cliente, vistaCliente);
+        receptor.protect(servidor, vistaServidor);
+        std::cout << "Flujos de clave distintos por sentido: " << (deCliente != deServidor ? "si" : "no") << std::endl;
+        emisor.unprotect(cliente, vistaServidor);
+        std::cout << "El cliente recupera el paquete del servidor: "
+            << (deServidor == std::vector<uint8_t>(32, 0) ? "si" : "no") << std::endl;
+    }
+
+    // Compatibilidad del modo XOR con XOREncoder
+    XOREncoder xorEncoder;
+    PacketObfuscator xorPaquetes(std::vector<uint8_t>{ 'c', 'l', 'a', 'v', 'e' }, PacketObfuscator::Mode::XOR);
+    PacketConnection conexionXor = PacketObfuscator::openConnection(0, PacketObfuscator::Role::Client);
+    std::string mensaje = "Jugador 7 se movio a (10, 4)";
+    std::string copia = mensaje;
+    PacketView vistaXor{ reinterpret_cast<uint8_t*>(&copia[0]), copia.size(), copia.size() };
+    xorPaquetes.protect(conexionXor, vistaXor);
+    std::cout << "Modo XOR igual a XOREncoder: " << (copia == xorEncoder.encode(mensaje, "clave") ? "si" : "no") << std::endl;
+
+    const size_t cabecera = 16;      // secuencia (8 B) + marca de tiempo (8 B) en claro
+    const size_t carga = 240;
+    const size_t lote = 32;
+    const size_t totalPaquetes = 1000000;
+
+    auto percentiles = [](std::vector<uint32_t>& ns, const char* titulo) {
+        std::sort(ns.begin(), ns.end());
+        auto at = [&](double q) { return ns[static_cast<size_t>(q * (ns.size() - 1))]; };
+        std::cout << titulo << " p50 " << at(0.5) << " ns, p99 " << at(0.99) << " ns, p999 " << at(0.999) << " ns" << std::endl;
+        };
+
+    // Coste de la ofuscacion sola, paquete a paquete
+    std::vector<uint8_t> paquete(carga, 0x5A);
+    std::vector<uint32_t> latencias;
+    latencias.reserve(totalPaquetes);
+    PacketView vista{ paquete.data(), paquete.size(), paquete.size() };
+    for (size_t i = 0; i < totalPaquetes; ++i) {
+        auto a = std::chrono::steady_clock::now();
+        emisor.protect(conexionEmisor, vista);
+        auto b = std::chrono::steady_clock::now();
+        latencias.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+    }
+    percentiles(latencias, "Ofuscar 240 B         :");
+
+    // Loopback: el emisor marca la hora, ofusca y envia en lotes de 32; el receptor
+    // recibe con recvmmsg, recupera y mide la latencia de extremo a extremo.
+    UdpSocket entrada;
+    entrada.bindLoopback();
+    entrada.setReceiveBuffer(8 * 1024 * 1024);
+    entrada.setReceiveTimeout(200);
+    UdpSocket salida;
+    salida.connectLoopback(entrada.port());
+
+    latencias.clear();
+    size_t correctos = 0;
+    std::thread hiloReceptor([&] {
+        std::vector<uint8_t> buffers(UdpSocket::MAX_BATCH * (cabecera + carga));
+        PacketView recibidos[UdpSocket::MAX_BATCH];
+        PacketView cargas[UdpSocket::MAX_BATCH];
+        for (size_t i = 0; i < UdpSocket::MAX_BATCH; ++i) {
+            recibidos[i] = { buffers.data() + i * (cabecera + carga), 0, cabecera + carga };
+        }
+        while (latencias.size() < totalPaquetes) {
+            size_t n = entrada.receiveBatch(recibidos, UdpSocket::MAX_BATCH);
+            if (n == 0) break;
+            for (size_t i = 0; i < n; ++i) {
+                cargas[i] = { recibidos[i].data + cabecera, recibidos[i].length - cabecera, carga };
+                std::memcpy(&cargas[i].sequence, recibidos[i].data, 8);
+            }
+            receptor.unprotectBatch(conexionReceptor, cargas, n);
+            auto ahora = std::chrono::steady_clock::now().time_since_epoch().count();
+            for (size_t i = 0; i < n; ++i) {
+                int64_t enviado;
+                std::memcpy(&enviado, recibidos[i].data + 8, 8);
+                latencias.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::duration(ahora - enviado)).count()));
+                correctos += cargas[i].data[0] == 0x5A && cargas[i].data[carga - 1] == 0x5A;
+            }
+        }
+        });
+
+    std::vector<uint8_t> buffers(lote * (cabecera + carga), 0x5A);
+    PacketView enviados[lote];
+    PacketView cargas[lote];
+    auto inicio = std::chrono::steady_clock::now();
+    for (size_t enviadosTotal = 0; enviadosTotal < totalPaquetes; enviadosTotal += lote) {
+        // Ritmo objetivo: 1M paquetes/s => un lote de 32 cada 32 us
+        auto objetivo = inicio + std::chrono::microseconds(enviadosTotal);
+        while (std::chrono::steady_clock::now() < objetivo) {
+            std::this_thread::yield();
+        }
+        auto ahora = std::chrono::steady_clock::now().time_since_epoch().count();
+        for (size_t i = 0; i < lote; ++i) {
+            uint8_t* p = buffers.data() + i * (cabecera + carga);
+            std::memset(p + cabecera, 0x5A, carga);
+            cargas[i] = { p + cabecera, carga, carga };
+            enviados[i] = { p, cabecera + carga, cabecera + carga };
+        }
+        emisor.protectBatch(conexionEmisor, cargas, lote);
+        for (size_t i = 0; i < lote; ++i) {
+            std::memcpy(enviados[i].data, &cargas[i].sequence, 8);
+            std::memcpy(enviados[i].data + 8, &ahora, 8);
+        }
+        salida.sendBatch(enviados, lote);
+    }
+    auto fin = std::chrono::steady_clock::now();
+    hiloReceptor.join();
+
+    std::cout << "Ritmo de envio        : " << totalPaquetes / std::chrono::duration<double>(fin - inicio).count() << " paquetes/s" << std::endl;
+    std::cout << "Recibidos / correctos : " << latencias.size() << " / " << correctos << " de " << totalPaquetes << std::endl;
+    if (!latencias.empty()) {
+        percentiles(latencias, "Loopback extremo a extremo:");
+    }
+    cryptoGen.secureWipe(key);
+}
+
+void testKeystreamPrefetcher() {
+    std::cout << "\n--- Prueba de precalculo de flujo de clave CTR ---\n";
+
+    CryptoGenerator cryptoGen;
+    auto key = cryptoGen.generateKey(128);
+    auto iv = cryptoGen.generateIV(16);
+    AES aes(key);
+    TripleDES tdes(std::bitset<64>(0x133457799BBCDFF1ULL), std::bitset<64>(0x0E329232EA6D0D73ULL));
+    const uint64_t desIv = 0x0123456789ABCDEFULL;
+
+    KeystreamPrefetcher<AesCtrKeystream> aesPrefetch(AesCtrKeystream(aes, iv.data()), 64 * 1024);
+    KeystreamPrefetcher<DesCtrKeystream> desPrefetch(DesCtrKeystream(tdes, desIv), 64 * 1024);
+    aesPrefetch.waitUntilFull();
+    desPrefetch.waitUntilFull();
+
+    // Mensajes de 1 KB separados por pausas, como el trafico de un servidor de juego
+    const size_t mensajes = 2000;
+    const size_t tamano = 1024;
+    std::vector<uint8_t> texto(mensajes * tamano);
+    for (size_t i = 0; i < texto.size(); ++i) texto[i] = static_cast<uint8_t>(i * 7);
+    std::vector<uint8_t> directo(texto.size());
+    std::vector<uint8_t> precalculado(texto.size());
+    std::string textoDes(reinterpret_cast<const char*>(texto.data()), texto.size());
+
+    auto medir = [&](const char* titulo, auto&& cifrarMensaje) {
+        std::vector<uint32_t> ns;
+        for (size_t m = 0; m < mensajes; ++m) {
+            auto a = std::chrono::steady_clock::now();
+            cifrarMensaje(m);
+            auto b = std::chrono::steady_clock::now();
+            ns.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        std::sort(ns.begin(), ns.end());
+        std::cout << titulo << " p50 " << ns[ns.size() / 2] << " ns, p99 " << ns[ns.size() * 99 / 100] << " ns" << std::endl;
+        };
+
+    // AES-CTR: el contador del mensaje m es iv + m * 64 bloques
+    medir("AES-CTR directo      :", [&](size_t m) {
+        uint8_t contador[16];
+        std::memcpy(contador, iv.data(), 16);
+        uint64_t carry = m * (tamano / 16);
+        for (int i = 15; i >= 0 && carry; --i) {
+            uint64_t sum = contador[i] + (carry & 0xFF);
+            contador[i] = static_cast<uint8_t>(sum);
+            carry = (carry >> 8) + (sum >> 8);
+        }
+        aes.cryptCTR(texto.data() + m * tamano, directo.data() + m * tamano, tamano, contador);
+        });
+    medir("AES-CTR precalculado :", [&](size_t m) {
+        aesPrefetch.crypt(texto.data() + m * tamano, precalculado.data() + m * tamano, tamano);
+        });
+    std::cout << "Mismo resultado AES  : " << (directo == precalculado ? "si" : "no") << std::endl;
+
+    std::string desDirecto;
+    medir("3DES-CTR directo     :", [&](size_t m) {
+        desDirecto = tdes.cryptCTR(textoDes.substr(m * tamano, tamano), desIv + m * (tamano / 8));
+        });
+    medir("3DES-CTR precalculado:", [&](size_t m) {
+        desPrefetch.crypt(texto.data() + m * tamano, precalculado.data() + m * tamano, tamano);
+        });
+    std::cout << "Mismo resultado 3DES : "
+        << (tdes.cryptCTR(textoDes, desIv) == std::string(reinterpret_cast<const char*>(precalculado.data()), precalculado.size()) ? "si" : "no")
+        << std::endl;
+
+    auto stats = desPrefetch.stats();
+    std::cout << "Anillo 3DES: capacidad " << stats.capacity << " B, nivel " << stats.fill
+        << " B, minimo " << stats.lowWatermark << " B, paradas " << stats.stalls
+        << " (" << stats.stallNanoseconds / 1000 << " us)" << std::endl;
+    cryptoGen.secureWipe(key);
+}
+
+void testNGramScorer() {
+    std::cout << "\n--- Prueba de modelo de cuadrigramas ---\n";
+
+    auto t0 = std::chrono::steady_clock::now();
+    NGramModel espanol = NGramCorpus::loadOrBuild("es", "modelo_es.ngr");
+    NGramModel ingles = NGramCorpus::loadOrBuild("en", "modelo_en.ngr");
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << "Modelos cargados en " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+        << " ms (" << espanol.corpusLetters() << " y " << ingles.corpusLetters() << " letras de corpus)" << std::endl;
+
+    NGramScorer scorerEs(espanol);
+    NGramScorer scorerEn(ingles);
+    std::string frase = "El ataque comienza cuando salga la luna";
+    std::cout << "\"" << frase << "\" -> es " << scorerEs.scorePerNgram(frase) << ", en " << scorerEn.scorePerNgram(frase) << std::endl;
+
+    // Romper Cesar en frases cortas: palabras comunes frente a cuadrigramas
+    const std::vector<std::string> frases = {
+        "Mi amigo llega hoy", "Nos vemos en el puerto", "Guarda bien la llave del cofre",
+        "El tesoro esta bajo el arbol", "Al amanecer atacamos la torre", "Cuidado con el dragon rojo",
+        "La reunion cambia de lugar", "Trae comida para todos", "Busca el mapa en la biblioteca",
+        "Vuelve antes de que anochezca",
+    };
+    CesarEncryption cesar;
+    int aciertosPalabras = 0;
+    int aciertosModelo = 0;
+    int pruebas = 0;
+    double tiempoPalabras = 0.0;
+    double tiempoModelo = 0.0;
+    for (const std::string& original : frases) {
+        for (int clave = 1; clave < 26; ++clave) {
+            std::string cifrado = cesar.encode(original, clave);
+
+            auto a = std::chrono::steady_clock::now();
+            int clavePalabras = cesar.evaluatePossibleKey(cifrado);
+            auto b = std::chrono::steady_clock::now();
+            int claveModelo = 0;
+            double mejor = -1e300;
+            for (int k = 0; k < 26; ++k) {
+                double puntuacion = scorerEs.score(cesar.encode(cifrado, 26 - k));
+                if (puntuacion > mejor) {
+                    mejor = puntuacion;
+                    claveModelo = k;
+                }
+            }
+            auto c = std::chrono::steady_clock::now();
+
+            tiempoPalabras += std::chrono::duration<double, std::micro>(b - a).count();
+            tiempoModelo += std::chrono::duration<double, std::micro>(c - b).count();
+            aciertosPalabras += clavePalabras == clave;
+            aciertosModelo += claveModelo == clave;
+            ++pruebas;
+        }
+    }
+    std::cout << "evaluatePossibleKey: " << aciertosPalabras << "/" << pruebas << " aciertos, "
+        << tiempoPalabras / pruebas << " us por texto" << std::endl;
+    std::cout << "Cuadrigramas       : " << aciertosModelo << "/" << pruebas << " aciertos, "
+        << tiempoModelo / pruebas << " us por texto (26 claves)" << std::endl;
+
+    // Rendimiento del evaluador sobre un texto largo
+    std::string largo;
+    while (largo.size() < 8 * 1024 * 1024) largo += frase + ". ";
+    auto d = std::chrono::steady_clock::now();
+    double total = scorerEs.score(largo);
+    auto e = std::chrono::steady_clock::now();
+    std::cout << "Evaluacion de 8 MB : " << largo.size() / (1024.0 * 1024.0) / std::chrono::duration<double>(e - d).count()
+        << " MB/s (puntuacion " << total << ")" << std::endl;
+}
+
+void testSubstitutionSolver() {
+    std::cout << "\n--- Prueba de ruptura de sustitucion monoalfabetica ---\n";
+
+    // El corpus de ejemplo es corto y comparte vocabulario con este mensaje; para textos
+    // arbitrarios de ~300 letras hace falta un corpus grande (TTC_CORPUS_ES=libro.txt)
+    std::string corpus = NGramCorpus::corpusFromEnvironment("es");
+    NGramModel espanol = corpus.empty()
+        ? NGramCorpus::loadOrBuild("es", "modelo_es.ngr")
+        : NGramCorpus::loadOrBuild("es", "modelo_es_corpus.ngr", { corpus });
+    std::cout << "Modelo: " << espanol.corpusLetters() << " letras ("
+        << (corpus.empty() ? "corpus de ejemplo" : corpus) << ")" << std::endl;
+    std::string original =
+        "Los jugadores del servidor norte han encontrado una forma de duplicar objetos raros usando un "
+        "error en el sistema de comercio. Si no corregimos el fallo antes del torneo del sabado, la economia "
+        "del juego quedara destruida y muchos usuarios perderan la confianza en nosotros.";
+
+    std::mt19937_64 rng(std::random_device{}());
+    std::string clave = SubstitutionCipher::randomKey(rng);
+    std::string cifrado = SubstitutionCipher::encode(original, clave);
+    std::cout << "Clave secreta : " << clave << std::endl;
+    std::cout << "Texto cifrado : " << cifrado.substr(0, 80) << "..." << std::endl;
+
+    SubstitutionSolver solver(espanol);
+    SubstitutionSolver::Options opciones;
+    opciones.timeBudget = std::chrono::milliseconds(1000);
+    auto resultados = solver.solve(cifrado, opciones);
+
+    const auto& stats = solver.stats();
+    std::cout << "Cadenas: " << stats.chains << ", movimientos: " << stats.moves
+        << " (" << stats.moves / stats.seconds / 1e6 << " M/s) en " << stats.seconds << " s" << std::endl;
+    for (size_t i = 0; i < resultados.size() && i < 3; ++i) {
+        std::cout << "#" << i + 1 << " clave " << resultados[i].key << " puntuacion " << resultados[i].score << std::endl;
+    }
+    if (!resultados.empty()) {
+        size_t aciertos = 0;
+        for (size_t i = 0; i < original.size(); ++i) aciertos += original[i] == resultados[0].plaintext[i];
+        std::cout << "Texto recuperado: " << resultados[0].plaintext.substr(0, 80) << "..." << std::endl;
+        std::cout << "Caracteres correctos: " << aciertos << "/" << original.size() << std::endl;
+    }
+}
+
+void testBlobClassifier() {
+    std::cout << "\n--- Prueba de clasificador de blobs cifrados ---\n";
+    namespace fs = std::filesystem;
+
+    std::string mensaje =
+        "El equipo de operaciones ha detectado accesos extranos en el servidor de partidas durante la "
+        "madrugada. Hay que cambiar todas las claves antes del torneo y revisar los registros de cada sala.";
+    std::mt19937_64 rng(7);
+
+    CesarEncryption cesar;
+    Vigenere vigenere("LLAVE");
+    XOREncoder xorEncoder;
+    AsciiBinary ab;
+    std::string xorCifrado = xorEncoder.encode(mensaje, "k3y!");
+    std::ostringstream hex;
+    for (unsigned char c : xorEncoder.encode(mensaje, "Z")) {
+        hex << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(c) << ' ';
+    }
+    std::string aleatorio(4096, '\0');
+    for (char& c : aleatorio) c = static_cast<char>(rng());
+
+    const std::string dir = "triaje_blobs";
+    fs::create_directories(dir);
+    std::vector<std::pair<std::string, std::string>> blobs = {
+        { "nota.txt", mensaje },
+        { "cesar.bin", cesar.encode(mensaje, 7) },
+        { "vigenere.bin", vigenere.encode(mensaje) },
+        { "xor.bin", xorCifrado },
+        { "binario.txt", ab.stringToBinary(mensaje) },
+        { "volcado.hex", hex.str() },
+        { "adjunto.b64", "TWVuc2FqZSBwYXJhIGVsIGVxdWlwbzogZWwgc2Vydmlkb3IgZGUgcHJ1ZWJhcyBjYW1iaWEgZGUgZGlyZWNjaW9uIGVsIGx1bmVzLiBVc2FkIGxhIGNsYXZlIG51ZXZhLg==" },
+        { "sustitucion.bin", SubstitutionCipher::encode(mensaje, SubstitutionCipher::randomKey(rng)) },
+        { "aes.bin", aleatorio },
+    };
+    for (const auto& blob : blobs) {
+        std::ofstream(dir + "/" + blob.first, std::ios::binary) << blob.second;
+    }
+
+    NGramModel espanol = NGramCorpus::loadOrBuild("es", "modelo_es.ngr");
+    BlobClassifier clasificador(espanol);
+    auto inicio = std::chrono::steady_clock::now();
+    auto informe = clasificador.processDirectory(dir);
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    BlobClassifier::printReport(informe, std::cout);
+    std::cout << informe.size() << " blobs en " << segundos * 1000 << " ms" << std::endl;
+    fs::remove_all(dir);
+
+    // Rendimiento de la pasada de análisis sobre una captura grande.
+    std::vector<uint8_t> captura(64 * 1024 * 1024);
+    for (size_t i = 0; i < captura.size(); ++i) captura[i] = static_cast<uint8_t>(mensaje[i % mensaje.size()] ^ (i >> 12));
+    inicio = std::chrono::steady_clock::now();
+    BlobFeatures f = BlobClassifier::analyze(captura.data(), captura.size());
+    segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cout << "Analisis de 64 MB: " << captura.size() / segundos / 1e9 << " GB/s (entropia "
+        << f.entropy << ", tipo " << BlobClassifier::kindName(BlobClassifier::classify(f).first) << ")" << std::endl;
+}
+
+void testCribDragger() {
+    std::cout << "\n--- Prueba de arrastre de cribs sobre mensajes con la misma clave ---\n";
+
+    // Muchos mensajes cortos cifrados con XOR contra el mismo flujo de clave.
+    std::string corpus = NGramCorpus::sample("es");
+    std::mt19937_64 rng(2024);
+    const size_t mensajes = 2000;
+    std::vector<uint8_t> flujo(120);
+    for (auto& b : flujo) b = static_cast<uint8_t>(rng());
+    std::vector<std::string> originales;
+    std::vector<std::vector<uint8_t>> cifrados;
+    for (size_t m = 0; m < mensajes; ++m) {
+        size_t longitud = 60 + rng() % 61;
+        size_t inicio = rng() % (corpus.size() - longitud);
+        originales.push_back(corpus.substr(inicio, longitud));
+        std::vector<uint8_t> c(longitud);
+        for (size_t i = 0; i < longitud; ++i) c[i] = static_cast<uint8_t>(originales.back()[i] ^ flujo[i]);
+        cifrados.push_back(std::move(c));
+    }
+
+    CribDragger dragger(cifrados);
+    const std::vector<std::string> cribs = { " de la ", " que ", " los ", " las ", " del ", " el ", " en ", " por ", " cada " };
+    CribDragger::Options opciones;
+    opciones.minSupport = 0.97;
+    for (int ronda = 1; ronda <= 6; ++ronda) {
+        size_t nuevos = 0;
+        double segundos = 0.0;
+        uint64_t comparaciones = 0;
+        for (const auto& crib : cribs) {
+            for (const auto& hit : dragger.drag(crib, opciones)) {
+                // Se relee la clave: una aceptación anterior de esta ronda puede contradecirla.
+                bool coherente = true;
+                for (size_t b = 0; b < hit.crib.size(); ++b) {
+                    int k = dragger.keyByte(hit.offset + b);
+                    if (k >= 0 && k != (cifrados[hit.message][hit.offset + b] ^ static_cast<uint8_t>(hit.crib[b]))) coherente = false;
+                }
+                if (coherente) nuevos += dragger.accept(hit);
+            }
+            segundos += dragger.stats().seconds;
+            comparaciones += dragger.stats().comparisons;
+        }
+        std::cout << "Ronda " << ronda << ": +" << nuevos << " bytes de clave (" << dragger.knownKeyBytes() << "/"
+            << dragger.maxLength() << "), " << cribs.size() << " cribs en " << segundos * 1000 << " ms, "
+            << comparaciones / 1e6 << " M comparaciones" << std::endl;
+        if (nuevos == 0) break;
+    }
+
+    size_t correctos = 0;
+    for (size_t p = 0; p < flujo.size(); ++p) correctos += dragger.keyByte(p) == flujo[p];
+    std::cout << "Bytes de clave correctos: " << correctos << "/" << flujo.size() << std::endl;
+    for (size_t m = 0; m < 3; ++m) {
+        std::cout << "Mensaje " << m << ": " << dragger.plaintext(m) << std::endl;
+    }
+}
+
+void testBreachFilter() {
+    std::cout << "\n--- Prueba de filtro de contrasenas filtradas ---\n";
+
+    // Lista de ejemplo: contraseñas en claro y, en otro archivo, sus SHA-1 en hexadecimal.
+    const size_t filtradas = 1000000;
+    std::mt19937_64 rng(99);
+    const char* comunes[] = { "123456", "password", "qwerty123", "Password1!", "Dragon2024#", "Admin123$" };
+    {
+        std::ofstream claro("filtradas.txt", std::ios::binary);
+        std::ofstream resumenes("filtradas_sha1.txt", std::ios::binary);
+        for (const char* c : comunes) claro << c << "\n";
+        CryptoGenerator hexer;
+        for (size_t i = 0; i < filtradas; ++i) {
+            std::string p = "user" + std::to_string(rng() % 100000000) + "!Aa";
+            if (i % 2) claro << p << "\n";
+            else resumenes << hexer.toHex(SHA1::hash(p)) << ":" << (rng() % 50 + 1) << "\n";
+        }
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    BreachFilterBuilder builder(filtradas + 16, 16.0);
+    builder.addFile("filtradas.txt");
+    builder.addFile("filtradas_sha1.txt");
+    builder.write("filtradas.bloom");
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cout << "Filtro compilado: " << builder.entryCount() << " entradas en " << segundos << " s" << std::endl;
+
+    BreachFilter filtro("filtradas.bloom");
+    CryptoGenerator generador;
+    generador.setBreachFilter(&filtro);
+    std::cout << "Tamano: " << filtro.blockCount() * BreachFilter::BLOCK_SIZE / 1024 << " KB, falsos positivos esperados: "
+        << filtro.falsePositiveRate() * 100 << " %" << std::endl;
+    for (const char* c : { "Password1!", "Dragon2024#", "Zq8#kLm2!vRt" }) {
+        std::cout << c << " -> " << (generador.validatePassword(c) ? "aceptada" : "rechazada") << std::endl;
+    }
+
+    // Falsos positivos medidos y rendimiento con contraseñas que no están en la lista.
+    const size_t pruebas = 1000000;
+    std::vector<std::string> candidatas(pruebas);
+    for (auto& c : candidatas) c = "Nueva" + std::to_string(rng()) + "#x";
+    size_t positivos = 0;
+    inicio = std::chrono::steady_clock::now();
+    for (const auto& c : candidatas) positivos += !generador.validatePassword(c);
+    segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cout << "validatePassword: " << pruebas / segundos / 1e6 << " M contrasenas/s, falsos positivos medidos: "
+        << 100.0 * positivos / pruebas << " %" << std::endl;
+
+    std::unique_ptr<bool[]> resultados(new bool[pruebas]);
+    inicio = std::chrono::steady_clock::now();
+    filtro.containsBatch(candidatas.data(), pruebas, resultados.get());
+    segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cout << "containsBatch: " << pruebas / segundos / 1e6 << " M contrasenas/s" << std::endl;
+
+    std::remove("filtradas.txt");
+    std::remove("filtradas_sha1.txt");
+    std::remove("filtradas.bloom");
+}
+
+// ================= HERRAMIENTAS =================
+
+/**
+ * @brief Compila un filtro de contraseñas filtradas desde la línea de comandos:
+ *        breach-filter <salida> <bits por entrada> <lista> [lista...]
+ */
+int buildBreachFilter(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "Uso: " << argv[0] << " breach-filter <salida.bloom> <bits por entrada> <lista> [lista...]\n";
+        return 1;
+    }
+    try {
+        // Primera pasada: contar líneas para dimensionar el filtro.
+        uint64_t lineas = 0;
+        for (int i = 4; i < argc; ++i) {
+            std::ifstream in(argv[i], std::ios::binary);
+            if (!in) throw std::runtime_error(std::string("No se pudo abrir la lista: ") + argv[i]);
+            std::string linea;
+            while (std::getline(in, linea)) ++lineas;
+        }
+        BreachFilterBuilder builder(std::max<uint64_t>(lineas, 1), std::stod(argv[3]));
+        for (int i = 4; i < argc; ++i) {
+            std::cout << argv[i] << ": " << builder.addFile(argv[i]) << " entradas\n";
+        }
+        builder.write(argv[2]);
+        std::cout << "Filtro escrito en " << argv[2] << " (" << builder.entryCount() << " entradas, "
+            << builder.falsePositiveRate() * 100 << " % de falsos positivos esperados)\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+void testSecureArena() {
+    std::cout << "\n--- Prueba de arena segura para claves ---\n";
+
+    CryptoGenerator generador;
+    SecureArena arena;
+    std::cout << "Bloques de " << arena.slotSize() << " bytes, memoria bloqueada: "
+        << (arena.isLocked() ? "si" : "no (limite RLIMIT_MEMLOCK)") << std::endl;
+
+    const size_t iteraciones = 1000000;
+    auto medir = [&](const char* nombre, auto&& cuerpo) {
+        auto inicio = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iteraciones; ++i) cuerpo();
+        double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        std::cout << std::left << std::setw(40) << nombre << std::right << std::fixed << std::setprecision(2)
+            << iteraciones / segundos / 1e6 << " M/s" << std::defaultfloat << std::endl;
+    };
+
+    // Sólo reserva y borrado: lo que cambia entre las dos rutas.
+    medir("vector<uint8_t>(32) + secureWipe", [&] {
+        std::vector<uint8_t> clave(32);
+        clave[0] = 1;
+        generador.secureWipe(clave);
+        });
+    medir("arena.acquire(32)", [&] {
+        SecureBuffer clave = arena.acquire(32);
+        clave[0] = 1;
+        });
+    // Ruta completa de generateKey (incluye el generador aleatorio).
+    medir("generateKey(256)", [&] {
+        std::vector<uint8_t> clave = generador.generateKey(256);
+        generador.secureWipe(clave);
+        });
+    medir("generateKey(256, arena)", [&] {
+        SecureBuffer clave = generador.generateKey(256, arena);
+        });
+
+    // Muchas claves vivas a la vez: la arena crece por losas, sin llamadas por clave.
+    {
+        std::vector<SecureBuffer> claves;
+        for (int i = 0; i < 5000; ++i) claves.push_back(generador.generateKey(128, arena));
+        std::cout << "5000 claves vivas: " << arena.slotsInUse() << " bloques en " << arena.slabCount() << " losas" << std::endl;
+    }
+    std::cout << "Tras liberarlas: " << arena.slotsInUse() << " bloques en uso" << std::endl;
+
+    // Subclaves DES en la arena: mismo resultado que el núcleo con std::array.
+    std::bitset<64> claveDes(0x133457799BBCDFF1ULL);
+    SecureBuffer subclaves = DESKernel::makeSchedule(claveDes, arena);
+    DESKernel::Schedule normal = DESKernel::makeSchedule(claveDes);
+    uint64_t bloque = 0x0123456789ABCDEFULL;
+    std::cout << "DES con subclaves en la arena: "
+        << (DESKernel::cryptBlock(bloque, DESKernel::subkeys(subclaves)) == DESKernel::cryptBlock(bloque, normal.data())
+            ? "coincide" : "NO coincide") << std::endl;
+}
+
+void testRandomnessTests() {
+    std::cout << "\n--- Prueba de bateria de aleatoriedad ---\n";
+
+    auto medir = [](const char* nombre, uint64_t bytes, const std::function<size_t(uint8_t*, size_t)>& fuente) {
+        auto inicio = std::chrono::steady_clock::now();
+        auto resultados = RandomnessTests::run(fuente, bytes);
+        double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        std::cout << "\n" << nombre << ": " << bytes / (1024 * 1024) << " MB en " << segundos << " s ("
+            << bytes / segundos / 1e6 << " MB/s) -> " << (RandomnessTests::allPassed(resultados) ? "PASA" : "FALLA") << "\n";
+        RandomnessTests::printResults(resultados, std::cout);
+    };
+
+    CryptoGenerator generador;
+    medir("CryptoGenerator::generateBytes", 64ull << 20, [&](uint8_t* out, size_t n) {
+        std::vector<uint8_t> bytes = generador.generateBytes(static_cast<unsigned int>(n));
+        std::memcpy(out, bytes.data(), n);
+        return n;
+        });
+
+    medir("generateRandomKey", 4ull << 20, [](uint8_t* out, size_t n) {
+        for (size_t i = 0; i < n; i += 8) {
+            std::string clave = generateRandomKey();
+            std::memcpy(out + i, clave.data(), std::min<size_t>(8, n - i));
+        }
+        return n;
+        });
+
+    // Generador defectuoso: byte bajo de un congruencial lineal (periodo 256 en los bits bajos).
+    uint32_t lcg = 1;
+    medir("LCG (byte bajo)", 16ull << 20, [&](uint8_t* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            lcg = lcg * 1103515245u + 12345u;
+            out[i] = static_cast<uint8_t>(lcg);
+        }
+        return n;
+        });
+
+    // Velocidad del análisis con una fuente casi gratuita (xorshift).
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+    medir("xorshift64 (velocidad del analisis)", 1024ull << 20, [&](uint8_t* out, size_t n) {
+        for (size_t i = 0; i < n; i += 8) {
+            estado ^= estado << 13;
+            estado ^= estado >> 7;
+            estado ^= estado << 17;
+            std::memcpy(out + i, &estado, std::min<size_t>(8, n - i));
+        }
+        return n;
+        });
+}
+
+/**
+ * @brief Pasa la batería de aleatoriedad a un archivo o a la entrada estándar:
+ *        randomness <archivo|-> [bytes maximos]. Devuelve 1 si alguna prueba falla.
+ */
+int runRandomnessTests(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " randomness <archivo|-> [bytes maximos]\n";
+        return 2;
+    }
+    std::string ruta = argv[2];
+    FILE* entrada = ruta == "-" ? stdin : std::fopen(ruta.c_str(), "rb");
+    if (!entrada) {
+        std::cerr << "Error: no se pudo abrir " << ruta << "\n";
+        return 2;
+    }
+    uint64_t maximo = argc > 3 ? std::stoull(argv[3]) : UINT64_MAX;
+    int codigo = 0;
+    try {
+        auto resultados = RandomnessTests::run([&](uint8_t* out, size_t n) {
+            return std::fread(out, 1, n, entrada);
+            }, maximo);
+        RandomnessTests::printResults(resultados, std::cout);
+        codigo = RandomnessTests::allPassed(resultados) ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        codigo = 2;
+    }
+    if (entrada != stdin) std::fclose(entrada);
+    return codigo;
+}
+
+/**
+ * @brief Genera una tabla arcoíris desde la línea de comandos:
+ *        rainbow-build <salida> <claro hex> <clave hex> <mascara hex> <longitud> <cadenas> [tabla]
+ */
+int buildRainbowTable(int argc, char* argv[]) {
+    if (argc < 8) {
+        std::cerr << "Uso: " << argv[0] << " rainbow-build <salida.rt> <texto claro hex> <clave base hex>"
+            " <mascara de bits desconocidos hex> <longitud de cadena> <cadenas> [numero de tabla]\n";
+        return 1;
+    }
+    try {
+        DESKeySpace espacio(std::stoull(argv[4], nullptr, 16), std::stoull(argv[5], nullptr, 16));
+        RainbowTableBuilder builder(std::stoull(argv[3], nullptr, 16), espacio,
+            static_cast<uint32_t>(std::stoul(argv[6])), argc > 8 ? static_cast<uint32_t>(std::stoul(argv[8])) : 0);
+        RainbowTableBuilder::Stats stats = builder.build(std::stoull(argv[7]));
+        builder.write(argv[2]);
+        std::cout << "Tabla escrita en " << argv[2] << ": " << stats.entries << " de " << stats.chains
+            << " cadenas, " << stats.fileBytes << " bytes\n"
+            << "Construccion: " << stats.seconds << " s, " << stats.chains / stats.seconds << " cadenas/s, "
+            << stats.encryptions / stats.seconds / 1e6 << " M cifrados/s\n"
+            << "Exito estimado: " << stats.successProbability * 100 << " % de " << espacio.size() << " claves\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Busca la clave de un cifrado en una o varias tablas arcoíris:
+ *        rainbow-lookup <cifrado hex> <tabla> [tabla...]. Devuelve 1 si no la encuentra.
+ */
+int lookupRainbowTable(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Uso: " << argv[0] << " rainbow-lookup <cifrado hex> <tabla.rt> [tabla.rt...]\n";
+        return 2;
+    }
+    try {
+        uint64_t cifrado = std::stoull(argv[2], nullptr, 16);
+        for (int i = 3; i < argc; ++i) {
+            RainbowTable tabla(argv[i]);
+            RainbowTable::LookupResult r = tabla.lookup(cifrado);
+            std::cout << argv[i] << ": " << r.encryptions << " cifrados, " << r.falseAlarms
+                << " falsas alarmas, " << r.seconds << " s\n";
+            if (r.found) {
+                std::cout << "Clave: " << std::hex << std::setw(16) << std::setfill('0') << r.key << std::dec << "\n";
+                return 0;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+    std::cout << "Clave no encontrada en las tablas.\n";
+    return 1;
+}
+
+/**
+ * @brief Proceso trabajador de la búsqueda repartida:
+ *        keysearch-worker <puerto> [terminar tras N rangos]
+ */
+int runKeySearchWorker(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " keysearch-worker <puerto> [terminar tras N rangos]\n";
+        return 2;
+    }
+    try {
+        return KeySearchWorker::run(static_cast<uint16_t>(std::stoul(argv[2])), argc > 3 ? std::stoul(argv[3]) : 0);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+}
+
+/**
+ * @brief Lanza @p workers procesos trabajadores de este mismo ejecutable contra un
+ *        coordinador local y muestra los mejores candidatos.
+ *
+ * @param failingWorker Si no es 0, el primer trabajador muere tras ese número de rangos.
+ */
+std::vector<KeyCandidate> runShardedSearch(const KeySearchJob& job, unsigned workers,
+    const KeySearchCoordinator::Options& opciones, unsigned failingWorker = 0) {
+    KeySearchCoordinator coordinador(job, opciones);
+    std::string ejecutable = WorkerProcess::currentExecutable();
+    std::vector<WorkerProcess> procesos;
+    for (unsigned i = 0; i < workers; ++i) {
+        std::vector<std::string> args = { ejecutable, "keysearch-worker", std::to_string(coordinador.port()) };
+        if (i == 0 && failingWorker) args.push_back(std::to_string(failingWorker));
+        procesos.push_back(WorkerProcess::spawn(args));
+    }
+    std::vector<KeyCandidate> mejores = coordinador.run();
+    for (WorkerProcess& proceso : procesos) proceso.wait();
+
+    const KeySearchCoordinator::Stats& stats = coordinador.stats();
+    std::cout << job.size() << " claves en " << stats.leases << " rangos, " << workers << " procesos: "
+        << stats.leasesIssued << " entregas (" << stats.leasesReissued << " repetidas, "
+        << stats.workersLost << " trabajadores perdidos), " << std::fixed << std::setprecision(2)
+        << stats.seconds << " s, " << stats.keysPerSecond / 1e6 << " M claves/s" << std::defaultfloat << std::endl;
+    for (size_t i = 0; i < mejores.size() && i < 3; ++i) {
+        std::string texto = job.decode(mejores[i].index);
+        for (char& c : texto) {
+            if (!std::isprint(static_cast<unsigned char>(c))) c = '.';
+        }
+        std::cout << "  " << job.keyText(mejores[i].index) << "  " << std::fixed << std::setprecision(3)
+            << mejores[i].score << std::defaultfloat << "  " << texto << std::endl;
+    }
+    return mejores;
+}
+
+/**
+ * @brief Búsqueda de claves repartida entre procesos desde la línea de comandos:
+ *        keysearch <procesos> xor <cifrado hex> <bytes de clave>
+ *        keysearch <procesos> vigenere <texto cifrado> <longitud maxima>
+ *        keysearch <procesos> des <claro hex> <cifrado hex> <clave base hex> <mascara hex>
+ */
+int runKeySearch(int argc, char* argv[]) {
+    if (argc < 6) {
+        std::cerr << "Uso: " << argv[0] << " keysearch <procesos> xor <cifrado hex> <bytes de clave>\n"
+            << "     " << argv[0] << " keysearch <procesos> vigenere <texto cifrado> <longitud maxima>\n"
+            << "     " << argv[0] << " keysearch <procesos> des <claro hex> <cifrado hex> <clave base hex> <mascara hex>\n";
+        return 2;
+    }
+    try {
+        unsigned procesos = static_cast<unsigned>(std::stoul(argv[2]));
+        std::string tipo = argv[3];
+        KeySearchJob job;
+        if (tipo == "xor") {
+            XOREncoder xorEncoder;
+            job = KeySearchJob::xorBytes(xorEncoder.HexToBytes(argv[4]), static_cast<unsigned>(std::stoul(argv[5])));
+        }
+        else if (tipo == "vigenere") {
+            job = KeySearchJob::vigenere(argv[4], static_cast<unsigned>(std::stoul(argv[5])));
+        }
+        else if (tipo == "des" && argc >= 8) {
+            DESKeySpace espacio(std::stoull(argv[6], nullptr, 16), std::stoull(argv[7], nullptr, 16));
+            job = KeySearchJob::desSubspace(espacio, std::stoull(argv[4], nullptr, 16), std::stoull(argv[5], nullptr, 16));
+        }
+        else {
+            std::cerr << "Tipo de busqueda desconocido: " << tipo << "\n";
+            return 2;
+        }
+        runShardedSearch(job, std::max(1u, procesos), KeySearchCoordinator::Options());
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
+
+/**
+ * @brief Cifrado incremental de un log que solo crece:
+ *        logcrypt <log> <salida> <xor|aes|3des> <clave hex> [--follow]
+ *        logcrypt --decrypt <salida> <clave hex>
+ */
+int runLogCrypt(int argc, char* argv[]) {
+    if (argc >= 4 && std::string(argv[2]) == "--decrypt") {
+        try {
+            std::vector<uint8_t> texto = IncrementalLogCipher::readPlaintext(argv[3], CryptoGenerator().fromHex(argc > 4 ? argv[4] : ""));
+            std::cout.write(reinterpret_cast<const char*>(texto.data()), static_cast<std::streamsize>(texto.size()));
+            return 0;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 2;
+        }
+    }
+    if (argc < 6) {
+        std::cerr << "Uso: " << argv[0] << " logcrypt <log> <salida> <xor|aes|3des> <clave hex> [--follow]\n"
+            << "     " << argv[0] << " logcrypt --decrypt <salida> <clave hex>\n";
+        return 2;
+    }
+    try {
+        std::string tipo = argv[4];
+        LogCipherKind cifrador;
+        if (tipo == "xor") cifrador = LogCipherKind::Xor;
+        else if (tipo == "aes") cifrador = LogCipherKind::AesCtr;
+        else if (tipo == "3des") cifrador = LogCipherKind::TripleDesCtr;
+        else {
+            std::cerr << "Cifrador desconocido: " << tipo << "\n";
+            return 2;
+        }
+        IncrementalLogCipher log(argv[2], argv[3], cifrador, CryptoGenerator().fromHex(argv[5]));
+        auto mostrar = [](const IncrementalLogCipher::SyncStats& s) {
+            std::cerr << "+" << s.bytes << " bytes (posicion " << s.position << ")" << (s.recovered ? ", salida recortada" : "") << "\n";
+        };
+        if (argc > 6 && std::string(argv[6]) == "--follow") {
+            std::atomic<bool> parar{ false };
+            log.follow(parar, mostrar);
+        }
+        else {
+            mostrar(log.sync());
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
+
+/**
+ * @brief Tablas arcoíris sobre la práctica de clave aleatoria DES: se conocen todos los
+ *        bits de la clave salvo 24 y se recupera la clave a partir del cifrado.
+ */
+void testRainbowTable() {
+    std::cout << "\n--- Prueba de tablas arcoiris (DES con espacio de claves reducido) ---\n";
+
+    std::bitset<64> plaintext("0100100001100101011011000110110001101111001000010000000000000000");
+    uint64_t claveReal = stringToBitset(generateRandomKey()).to_ullong();
+    DESKeySpace espacio = DESKeySpace::lowBits(claveReal, 24);
+    std::cout << "Clave base (bits conocidos): " << std::hex << espacio.base() << ", mascara: " << espacio.mask()
+        << std::dec << " (" << espacio.bits() << " bits, " << espacio.size() << " claves)" << std::endl;
+
+    const uint32_t longitud = 1024;
+    const uint64_t cadenas = 32768;
+    std::vector<std::string> rutas;
+    for (uint32_t tabla = 0; tabla < 3; ++tabla) {
+        RainbowTableBuilder builder(plaintext.to_ullong(), espacio, longitud, tabla);
+        RainbowTableBuilder::Stats stats = builder.build(cadenas);
+        rutas.push_back("rainbow_demo_" + std::to_string(tabla) + ".rt");
+        builder.write(rutas.back());
+        std::cout << "Tabla " << tabla << ": " << stats.entries << " de " << stats.chains << " cadenas, "
+            << stats.fileBytes / 1024 << " KiB, " << std::fixed << std::setprecision(2) << stats.seconds << " s ("
+            << stats.encryptions / stats.seconds / 1e6 << " M cifrados/s), exito estimado "
+            << stats.successProbability * 100 << " %" << std::defaultfloat << std::endl;
+    }
+
+    std::vector<RainbowTable> tablas;
+    double fallo = 1.0;
+    for (const std::string& ruta : rutas) {
+        tablas.emplace_back(ruta);
+        fallo *= 1.0 - tablas.back().successProbability();
+    }
+    std::cout << "Exito estimado con " << tablas.size() << " tablas: " << std::fixed << std::setprecision(1)
+        << (1.0 - fallo) * 100 << " %" << std::defaultfloat << std::endl;
+
+    // Claves al azar del espacio: la primera es la de la práctica.
+    std::mt19937_64 rng(std::random_device{}());
+    const int pruebas = 20;
+    int aciertos = 0;
+    double segundos = 0.0;
+    uint64_t cifrados = 0;
+    for (int i = 0; i < pruebas; ++i) {
+        uint64_t clave = i == 0 ? claveReal : espacio.keyAt(rng() & (espacio.size() - 1));
+        uint64_t cifrado = DES(std::bitset<64>(clave)).encode(plaintext).to_ullong();
+        for (const RainbowTable& tabla : tablas) {
+            RainbowTable::LookupResult r = tabla.lookup(cifrado);
+            segundos += r.seconds;
+            cifrados += r.encryptions;
+            if (r.found) {
+                ++aciertos;
+                if (i == 0) std::cout << "Clave de la practica recuperada: " << std::hex << r.key << std::dec
+                    << (r.key == clave ? " (correcta)" : " (ERROR)") << std::endl;
+                break;
+            }
+        }
+    }
+    std::cout << "Recuperadas " << aciertos << " de " << pruebas << " claves; " << std::fixed << std::setprecision(3)
+        << segundos / pruebas << " s y " << cifrados / pruebas << " cifrados por clave de media"
+        << std::defaultfloat << std::endl;
+    for (const std::string& ruta : rutas) std::remove(ruta.c_str());
+}
+
+/**
+ * @brief Encuentro a medio camino contra doble DES con 22 bits desconocidos en cada clave:
+ *        primero con la tabla en memoria y después con un presupuesto pequeño (series en disco).
+ */
+void testMeetInTheMiddle() {
+    std::cout << "\n--- Prueba de encuentro a medio camino (doble DES) ---\n";
+
+    uint64_t clave1 = stringToBitset(generateRandomKey()).to_ullong();
+    uint64_t clave2 = stringToBitset(generateRandomKey()).to_ullong();
+    DESKeySpace espacio1 = DESKeySpace::lowBits(clave1, 22);
+    DESKeySpace espacio2 = DESKeySpace::lowBits(clave2, 22);
+
+    // Dos pares: el primero para el encuentro, el segundo descarta falsos positivos.
+    std::vector<MeetInTheMiddle::KnownPair> pares;
+    for (const char* texto : { "Hola DES", "2DES lab" }) {
+        uint64_t claro = DESKernel::load64(reinterpret_cast<const uint8_t*>(texto));
+        pares.push_back({ claro, MeetInTheMiddle::encrypt(claro, clave1, clave2) });
+    }
+    std::cout << "Claves reales: " << std::hex << clave1 << " / " << clave2 << std::dec
+        << " (2^" << espacio1.bits() + espacio2.bits() << " parejas candidatas)" << std::endl;
+
+    MeetInTheMiddle ataque(espacio1, espacio2);
+    for (size_t presupuesto : { size_t(1) << 30, size_t(32) << 20 }) {
+        MeetInTheMiddle::Options opciones;
+        opciones.memoryBudget = presupuesto;
+        std::vector<MeetInTheMiddle::Solution> soluciones = ataque.attack(pares, opciones);
+        const MeetInTheMiddle::Stats& stats = ataque.stats();
+        std::cout << "Presupuesto " << (presupuesto >> 20) << " MiB: " << stats.passes << " pasada(s), "
+            << stats.spillRuns << " series en disco (" << (stats.spilledBytes >> 20) << " MiB), "
+            << stats.collisions << " coincidencias, " << std::fixed << std::setprecision(2) << stats.seconds
+            << " s, " << std::scientific << stats.candidatePairsPerSecond << " parejas/s" << std::defaultfloat << std::endl;
+        for (const MeetInTheMiddle::Solution& s : soluciones) {
+            std::cout << "  k1 = " << std::hex << s.key1 << ", k2 = " << s.key2 << std::dec
+                << (s.key1 == clave1 && s.key2 == clave2 ? " (correcta)" : "") << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief Búsqueda de claves repartida entre procesos trabajadores locales; uno de ellos
+ *        muere a mitad para que el coordinador vuelva a entregar su rango.
+ */
+void testShardedKeySearch() {
+    std::cout << "\n--- Prueba de busqueda de claves repartida entre procesos ---\n";
+
+    KeySearchCoordinator::Options opciones;
+    opciones.leaseSize = 1 << 20;
+
+    std::string mensaje = "En un lugar de la Mancha, de cuyo nombre no quiero acordarme, no ha mucho tiempo";
+    XOREncoder xorEncoder;
+    std::string cifradoXor = xorEncoder.encode(mensaje, "k3Y");
+    std::cout << "\nXOR con clave de 3 bytes (un trabajador muere tras 2 rangos):\n";
+    runShardedSearch(KeySearchJob::xorBytes(std::vector<uint8_t>(cifradoXor.begin(), cifradoXor.end()), 3), 3, opciones, 2);
+
+    Vigenere vigenere("SOL");
+    std::cout << "\nVigenere hasta 4 letras:\n";
+    opciones.leaseSize = 1 << 16;
+    runShardedSearch(KeySearchJob::vigenere(vigenere.encode(mensaje), 4), 3, opciones);
+
+    std::bitset<64> plaintext("0100100001100101011011000110110001101111001000010000000000000000");
+    uint64_t clave = stringToBitset(generateRandomKey()).to_ullong();
+    uint64_t cifrado = DES(std::bitset<64>(clave)).encode(plaintext).to_ullong();
+    std::cout << "\nDES con 24 bits desconocidos (clave real " << std::hex << clave << std::dec << "):\n";
+    opciones.leaseSize = 1 << 20;
+    runShardedSearch(KeySearchJob::desSubspace(DESKeySpace::lowBits(clave, 24), plaintext.to_ullong(), cifrado), 3, opciones);
+}
+
+/**
+ * @brief Planificador de trabajos de ruptura: varias búsquedas a la vez con prioridades,
+ *        plazos, cancelación y progreso.
+ */
+void testCrackScheduler() {
+    std::cout << "\n--- Prueba del planificador de trabajos de ruptura ---\n";
+
+    std::string mensaje = "En un lugar de la Mancha, de cuyo nombre no quiero acordarme, no ha mucho tiempo";
+    XOREncoder xorEncoder;
+    std::string xor2 = xorEncoder.encode(mensaje, "k3");
+    std::string xor3 = xorEncoder.encode(mensaje, "k3Y");
+    Vigenere vigenere("SOL");
+    std::string textoVigenere = vigenere.encode(mensaje);
+
+    std::vector<KeySearchJob> busquedas = {
+        KeySearchJob::xorBytes(std::vector<uint8_t>(xor3.begin(), xor3.end()), 3),
+        KeySearchJob::xorBytes(std::vector<uint8_t>(xor2.begin(), xor2.end()), 2),
+        KeySearchJob::vigenere(textoVigenere, 4),
+        KeySearchJob::vigenere(textoVigenere, 6),
+        KeySearchJob::xorBytes(std::vector<uint8_t>(xor3.begin(), xor3.end()), 3),
+    };
+    std::vector<CrackJobOptions> opciones(busquedas.size());
+    opciones[0] = { "XOR 3 bytes (exhaustivo)", 1, std::chrono::milliseconds(0), 3 };
+    opciones[1] = { "XOR 2 bytes (bruteForce_2Byte)", 4, std::chrono::milliseconds(0), 3 };
+    opciones[2] = { "Vigenere <= 4 (breakEncode)", 2, std::chrono::milliseconds(0), 3 };
+    opciones[3] = { "Vigenere <= 6, plazo 1.5 s", 1, std::chrono::milliseconds(1500), 3 };
+    opciones[4] = { "XOR 3 bytes (se cancela)", 1, std::chrono::milliseconds(0), 3 };
+
+    CrackScheduler planificador(2);
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < busquedas.size(); ++i) ids.push_back(planificador.submit(busquedas[i], opciones[i]));
+
+    auto mostrar = [&]() {
+        for (const CrackJobStatus& s : planificador.statuses()) {
+            std::cout << "  #" << s.id << " " << std::left << std::setw(32) << s.name << std::right << std::setw(14)
+                << CrackScheduler::stateName(s.state) << std::fixed << std::setprecision(1) << std::setw(7)
+                << 100.0 * s.keysTried / s.totalKeys << " %" << std::setw(8) << s.keysPerSecond / 1e6 << " M/s  ETA "
+                << std::setw(6) << s.etaSeconds << " s" << std::defaultfloat << std::endl;
+        }
+    };
+    for (int tick = 1; tick <= 3; ++tick) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        if (tick == 2) planificador.cancel(ids[4]);
+        std::cout << "t = " << tick * 400 << " ms\n";
+        mostrar();
+    }
+    planificador.waitAll();
+    std::cout << "Final:\n";
+    mostrar();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        CrackJobStatus s = planificador.status(ids[i]);
+        if (s.best.empty()) continue;
+        std::string texto = busquedas[i].decode(s.best[0].index).substr(0, 40);
+        for (char& c : texto) {
+            if (!std::isprint(static_cast<unsigned char>(c))) c = '.';
+        }
+        std::cout << "  #" << s.id << " mejor clave " << busquedas[i].keyText(s.best[0].index) << ": " << texto << std::endl;
+    }
+
+    // Un trabajo cuya busqueda lanza: termina como fallido sin tumbar el grupo de hilos
+    uint64_t fallido = planificador.submit(1000000, [](uint64_t first, uint64_t count, size_t) {
+        if (first + count > 5000) throw std::runtime_error("memoria agotada en la porcion");
+        return std::vector<KeyCandidate>{ KeyCandidate{ first, static_cast<double>(first) } };
+        }, CrackJobOptions{ "Busqueda que lanza", 1, std::chrono::milliseconds(0), 3 });
+    planificador.wait(fallido);
+    CrackJobStatus s = planificador.status(fallido);
+    std::cout << "  #" << s.id << " " << s.name << ": " << CrackScheduler::stateName(s.state) << " (" << s.error
+        << "), " << s.keysTried << " claves y " << s.best.size() << " candidatos parciales" << std::endl;
+}
+
+/**
+ * @brief Sumideros de resultados: los ataques entregan sus candidatos a un top-K, a
+ *        ficheros JSON-lines/CSV con buffer por hilo o a un sumidero nulo, en lugar de
+ *        escribir cada uno en consola.
+ */
+void testResultSinks() {
+    std::cout << "\n--- Prueba de sumideros de resultados ---\n";
+
+    XOREncoder xorEncoder;
+    std::string corto = xorEncoder.encode("Hola", "k3");
+    std::vector<unsigned char> bytesCorto(corto.begin(), corto.end());
+    std::string largo = xorEncoder.encode("En un lugar de la Mancha, de cuyo nombre no quiero acordarme", "k3");
+    std::vector<unsigned char> bytesLargo(largo.begin(), largo.end());
+
+    auto medir = [](const char* nombre, const std::function<void()>& ataque) {
+        auto inicio = std::chrono::steady_clock::now();
+        ataque();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        std::cout << "  " << std::left << std::setw(34) << nombre << std::right << std::fixed
+            << std::setprecision(2) << std::setw(9) << ms << " ms" << std::defaultfloat << "\n";
+    };
+
+    std::cout << "\nXOR 2 bytes sobre un texto de 4 bytes (muchos candidatos imprimibles):\n";
+    NullSink nulo;
+    medir("NullSink", [&] { xorEncoder.bruteForce_2Byte(bytesCorto, nulo); });
+    std::ofstream enFichero("candidatos.txt", std::ios::binary);
+    medir("std::endl por candidato -> .txt", [&] {
+        // Lo que hacía el bucle original por cada candidato: un vaciado del flujo por línea
+        std::string texto(bytesCorto.size(), '\0');
+        for (int b1 = 0; b1 < 256; ++b1) {
+            for (int b2 = 0; b2 < 256; ++b2) {
+                for (size_t i = 0; i < bytesCorto.size(); ++i) texto[i] = static_cast<char>(bytesCorto[i] ^ (i % 2 ? b2 : b1));
+                if (!xorEncoder.isValidText(texto)) continue;
+                enFichero << "Clave 2 bytes : 0x" << std::hex << std::setw(2) << std::setfill('0') << b1
+                    << " 0x" << std::setw(2) << b2 << std::dec << std::setfill(' ') << std::endl;
+                enFichero << "Texto posible : " << texto << std::endl;
+            }
+        }
+    });
+    {
+        std::ofstream salida("candidatos.jsonl", std::ios::binary);
+        JsonLinesSink json(salida);
+        medir("JsonLinesSink -> candidatos.jsonl", [&] { xorEncoder.bruteForce_2Byte(bytesCorto, json); });
+    }
+    {
+        std::ofstream salida("candidatos.csv", std::ios::binary);
+        CsvSink csv(salida);
+        medir("CsvSink -> candidatos.csv", [&] { xorEncoder.bruteForce_2Byte(bytesCorto, csv); });
+    }
+    TopKSink mejores(3);
+    medir("TopKSink(3)", [&] { xorEncoder.bruteForce_2Byte(bytesCorto, mejores); });
+    std::cout << "  Candidatos: " << nulo.count() << "\n";
+
+    std::cout << "\nXOR 2 bytes sobre el texto largo, top-3:\n";
+    TopKSink topXor(3);
+    xorEncoder.bruteForce_2Byte(bytesLargo, topXor);
+    for (const AttackResult& r : topXor.results()) {
+        std::cout << "  " << r.key << " (" << std::setprecision(3) << r.score << "): " << r.plaintext << "\n";
+    }
+
+    std::cout << "\n4 hilos compartiendo un JsonLinesSink (un buffer por hilo):\n";
+    std::ostringstream compartido;
+    {
+        JsonLinesSink json(compartido);
+        std::vector<std::thread> hilos;
+        for (int h = 0; h < 4; ++h) {
+            hilos.emplace_back([&] { xorEncoder.bruteForce_2Byte(bytesCorto, json); });
+        }
+        for (std::thread& hilo : hilos) hilo.join();
+    }
+    std::string lineas = compartido.str();
+    std::cout << "  Lineas escritas: " << std::count(lineas.begin(), lineas.end(), '\n')
+        << " (esperadas " << 4 * nulo.count() << ")\n";
+
+    CesarEncryption cesar;
+    TopKSink topCesar(1);
+    cesar.bruteForceAttack(cesar.encode("el perro de la casa que ladra se escapa", 7), topCesar);
+    std::cout << "\nCesar, mejor clave: " << topCesar.results().front().key << " -> "
+        << topCesar.results().front().plaintext << "\n";
+
+    Vigenere vigenere("SOL");
+    TopKSink topVigenere(3);
+    Vigenere::breakEncode(vigenere.encode("EL PERRO DE LA CASA QUE LADRA SE ESCAPA POR LA PUERTA"), 3, topVigenere);
+    std::cout << "Vigenere, mejores claves:";
+    for (const AttackResult& r : topVigenere.results()) std::cout << " " << r.key << " (" << r.score << ")";
+    std::cout << "\n";
+}
+
+/**
+ * @brief Cifrado incremental de un log que crece: solo se cifran los bytes añadidos y el
+ *        estado (posición, nonce, id de clave) persiste en un fichero lateral.
+ */
+void testIncrementalLogCipher() {
+    std::cout << "\n--- Prueba de cifrado incremental de logs ---\n";
+
+    CryptoGenerator generador;
+    std::vector<uint8_t> claveAes = generador.generateKey(128);
+    const std::string log = "app_demo.log";
+    const std::string salida = "app_demo.log.enc";
+    std::filesystem::remove(IncrementalLogCipher::statePath(salida));
+
+    auto escribir = [&](size_t bytes) {
+        std::ofstream out(log, std::ios::binary | std::ios::app);
+        static uint64_t linea = 0;
+        std::string texto;
+        while (texto.size() < bytes) {
+            texto += "2026-10-18 12:00:00 INFO peticion " + std::to_string(++linea) + " atendida en 3 ms\n";
+        }
+        out << texto;
+    };
+    auto leer = [](const std::string& ruta) {
+        std::ifstream in(ruta, std::ios::binary);
+        std::vector<uint8_t> datos(static_cast<size_t>(std::filesystem::file_size(ruta)));
+        in.read(reinterpret_cast<char*>(datos.data()), static_cast<std::streamsize>(datos.size()));
+        return datos;
+    };
+    auto ms = [](double s) { return s * 1000.0; };
+
+    std::ofstream(log, std::ios::binary | std::ios::trunc);
+    escribir(32 << 20);
+    IncrementalLogCipher cifrador(log, salida, LogCipherKind::AesCtr, claveAes);
+    IncrementalLogCipher::SyncStats s = cifrador.sync();
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Primera sincronizacion: " << s.bytes << " bytes en " << ms(s.seconds) << " ms\n";
+
+    escribir(4096);
+    s = cifrador.sync();
+    std::cout << "Tras anadir 4 KiB:      " << s.bytes << " bytes en " << ms(s.seconds) << " ms\n";
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<uint8_t> completo = leer(log);
+    uint8_t iv[AES::BLOCK_SIZE] = {};
+    AES(claveAes).cryptCTR(completo.data(), completo.data(), completo.size(), iv);
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cout << "Recifrar todo el log:   " << completo.size() << " bytes en " << ms(total) << " ms\n";
+
+    // Caída entre escribir la salida y guardar el estado: la salida va por delante
+    {
+        std::ofstream basura(salida, std::ios::binary | std::ios::app);
+        basura << "bytes cifrados sin estado guardado";
+    }
+    escribir(1000);
+    s = cifrador.sync();
+    std::cout << "Tras una caida simulada: " << s.bytes << " bytes, salida recortada: " << (s.recovered ? "si" : "no") << "\n";
+    std::cout << "Descifrado == log: " << (IncrementalLogCipher::readPlaintext(salida, claveAes) == leer(log) ? "si" : "no") << "\n";
+
+    try {
+        IncrementalLogCipher otra(log, salida, LogCipherKind::AesCtr, generador.generateKey(128));
+    }
+    catch (const std::invalid_argument& e) {
+        std::cout << "Con otra clave: " << e.what() << "\n";
+    }
+
+    std::cout << "\nSeguimiento del log (un hilo escribe 10 lineas cada 50 ms):\n";
+    std::atomic<bool> parar{ false };
+    std::thread escritor([&] {
+        for (int i = 0; i < 10; ++i) {
+            escribir(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        parar = true;
+    });
+    int sincronizaciones = 0;
+    uint64_t seguidos = cifrador.follow(parar, [&](const IncrementalLogCipher::SyncStats&) { ++sincronizaciones; },
+        std::chrono::milliseconds(50));
+    escritor.join();
+    std::cout << "  " << seguidos << " bytes en " << sincronizaciones << " sincronizaciones; descifrado == log: "
+        << (IncrementalLogCipher::readPlaintext(salida, claveAes) == leer(log) ? "si" : "no") << "\n";
+
+    std::cout << "\nAnadidos en trozos de 7, 13 y 1000 bytes, comparado con cifrar de una vez:\n";
+    std::string texto(3020, '\0');
+    for (size_t i = 0; i < texto.size(); ++i) texto[i] = "En un lugar de la Mancha "[i % 25];
+    std::vector<std::pair<std::string, LogCipherKind>> cifradores = {
+        { "XOR", LogCipherKind::Xor }, { "AES-CTR", LogCipherKind::AesCtr }, { "3DES-CTR", LogCipherKind::TripleDesCtr } };
+    for (const auto& c : cifradores) {
+        std::vector<uint8_t> clave = c.second == LogCipherKind::TripleDesCtr ? generador.generateKey(192) : generador.generateKey(128);
+        std::ofstream(log, std::ios::binary | std::ios::trunc);
+        std::filesystem::remove(IncrementalLogCipher::statePath(salida));
+        IncrementalLogCipher trozos(log, salida, c.second, clave);
+        size_t escrito = 0;
+        for (size_t trozo : { 7, 13, 1000, 1000, 1000 }) {
+            std::ofstream(log, std::ios::binary | std::ios::app) << texto.substr(escrito, trozo);
+            escrito += trozo;
+            trozos.sync();
+        }
+        bool igual = IncrementalLogCipher::readPlaintext(salida, clave) == std::vector<uint8_t>(texto.begin(), texto.end());
+        std::string deUnaVez = "-";
+        if (c.second == LogCipherKind::Xor) {
+            XOREncoder xorEncoder;
+            std::vector<uint8_t> cifrado = leer(salida);
+            deUnaVez = xorEncoder.encode(texto, std::string(clave.begin(), clave.end())) == std::string(cifrado.begin(), cifrado.end()) ? "si" : "no";
+        }
+        std::cout << "  " << std::left << std::setw(9) << c.first << std::right << " descifrado correcto: " << (igual ? "si" : "no")
+            << ", igual a XOREncoder::encode: " << deUnaVez << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
+
+/**
+ * @brief César y Vigenère sobre UTF-8 con alfabeto configurable (español de 27 letras con Ñ)
+ *        y ruta rápida para los tramos ASCII.
+ */
+void testAlphabetCipher() {
+    std::cout << "\n--- Prueba de Cesar y Vigenere con UTF-8 (alfabeto espanol) ---\n";
+
+    AlphabetCipher espanol(Alphabet::spanish());
+    std::string frase = "El ni\xC3\xB1" "o Mu\xC3\xB1" "oz comi\xC3\xB3" " ping\xC3\xBC" "ino en la monta\xC3\xB1" "a, \xC2\xBF" "qu\xC3\xA9" " m\xC3\xA1s?";
+    std::cout << "Alfabeto de " << espanol.alphabet().size() << " letras\n";
+    std::cout << "Texto:             " << frase << "\n";
+    std::string cesar = espanol.encodeCaesar(frase, 1);
+    std::cout << "Cesar +1:          " << cesar << "\n";
+    std::cout << "Descifrado:        " << espanol.decodeCaesar(cesar, 1) << "\n";
+    CesarEncryption cesarAscii;
+    std::cout << "CesarEncryption +1: " << cesarAscii.encode(frase, 1) << "\n";
+
+    std::string clave = "\xC3\x91" "and\xC3\xBA";
+    std::string vigenere = espanol.encodeVigenere(frase, clave);
+    std::cout << "Vigenere (" << clave << "): " << vigenere << "\n";
+    std::cout << "Descifrado:        " << espanol.decodeVigenere(vigenere, clave) << "\n";
+
+    try {
+        espanol.encodeCaesar("texto \xC3( roto", 3);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cout << "Entrada no valida: " << e.what() << "\n";
+    }
+
+    // Rendimiento: texto casi todo ASCII (una letra no ASCII cada ~40 bytes) frente a solo ASCII
+    std::string base = "En un lugar de la Mancha, de cuyo nombre no quiero acordarme, no ha mucho tiempo que viv\xC3\xAD"
+        "a un hidalgo de los de lanza en astillero, adarga antigua, roc\xC3\xAD" "n flaco y galgo corredor. "
+        "A\xC3\xB1" "os despu\xC3\xA9" "s, el ping\xC3\xBC" "ino so\xC3\xB1" "aba con la monta\xC3\xB1" "a. ";
+    std::string mixto;
+    while (mixto.size() < (4u << 20)) mixto += base;
+    std::string ascii = mixto;
+    for (char& c : ascii) {
+        if (static_cast<unsigned char>(c) >= 0x80) c = 'x';
+    }
+
+    auto medir = [](const char* nombre, size_t bytes, const std::function<std::string()>& cifrar) {
+        // Mejor de 5 pasadas: la máquina puede estar ocupada con otra cosa
+        double mejor = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < 5; ++i) {
+            auto inicio = std::chrono::steady_clock::now();
+            cifrar();
+            mejor = std::min(mejor, std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+        }
+        double mbs = bytes / mejor / 1e6;
+        std::cout << "  " << std::left << std::setw(40) << nombre << std::right << std::fixed << std::setprecision(0)
+            << std::setw(7) << mbs << " MB/s" << std::defaultfloat << "\n";
+        return mbs;
+    };
+
+    std::cout << "\nRendimiento sobre " << (mixto.size() >> 20) << " MiB:\n";
+    AlphabetCipher ingles(Alphabet::english());
+    medir("Cesar, texto solo ASCII", ascii.size(), [&] { return espanol.encodeCaesar(ascii, 3); });
+    medir("Cesar, texto con UTF-8", mixto.size(), [&] { return espanol.encodeCaesar(mixto, 3); });
+    medir("Vigenere, texto con UTF-8", mixto.size(), [&] { return espanol.encodeVigenere(mixto, clave); });
+    espanol.setHardwareAcceleration(false);
+    medir("Cesar, texto con UTF-8 (sin AVX2)", mixto.size(), [&] { return espanol.encodeCaesar(mixto, 3); });
+    medir("Cesar ingles, texto solo ASCII", ascii.size(), [&] { return ingles.encodeCaesar(ascii, 3); });
+    medir("CesarEncryption::encode, solo ASCII", ascii.size(), [&] { return cesarAscii.encode(ascii, 3); });
+    Vigenere vigenereAscii("NANDU");
+    medir("Vigenere::encode, solo ASCII", ascii.size(), [&] { return vigenereAscii.encode(ascii); });
+
+    // La proporción se mide alternando los dos textos, para que la carga de la máquina
+    // afecte a ambos por igual
+    espanol.setHardwareAcceleration(true);
+    double soloAscii = std::numeric_limits<double>::infinity();
+    double conUtf8 = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < 15; ++i) {
+        for (double* mejor : { &soloAscii, &conUtf8 }) {
+            const std::string& texto = mejor == &soloAscii ? ascii : mixto;
+            auto inicio = std::chrono::steady_clock::now();
+            espanol.encodeCaesar(texto, 3);
+            *mejor = std::min(*mejor, std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count() / texto.size());
+        }
+    }
+    std::cout << "Texto con UTF-8 frente a solo ASCII (Cesar, pasadas alternas): " << std::fixed << std::setprecision(1)
+        << 100.0 * soloAscii / conUtf8 << " %" << std::defaultfloat << "\n";
+}
+
+void testKeySearchFramework() {
+    std::cout << "\n--- Prueba del marco de busqueda de claves (KeySearch) ---\n";
+
+    XOREncoder xorEncoder;
+    std::string frase = "En un lugar de la Mancha, de cuyo nombre no quiero acordarme";
+    std::string cifrado1 = xorEncoder.encode(frase, "k");
+    std::string cifrado2 = xorEncoder.encode(frase, "k3");
+    std::string cifradoDic = xorEncoder.encode(frase, "admin");
+    std::vector<unsigned char> bytes1(cifrado1.begin(), cifrado1.end());
+    std::vector<unsigned char> bytes2(cifrado2.begin(), cifrado2.end());
+    std::vector<unsigned char> bytesDic(cifradoDic.begin(), cifradoDic.end());
+    std::string vigenereTexto = Vigenere("SOL").encode("EL PERRO DE LA CASA QUE LADRA SE ESCAPA POR LA PUERTA");
+
+    auto informe = [](const char* nombre, const KeySearchStats& stats, uint64_t reservas, const AttackResult* mejor) {
+        std::cout << "  " << std::left << std::setw(26) << nombre << std::right << std::setw(9) << stats.candidates
+            << std::fixed << std::setprecision(2) << std::setw(9) << stats.candidatesPerSecond / 1e6 << " M/s"
+            << std::setprecision(4) << std::setw(10) << double(reservas) / std::max<uint64_t>(1, stats.candidates)
+            << " res/cand" << std::defaultfloat;
+        if (mejor) std::cout << "  -> " << mejor->key;
+        std::cout << "\n";
+    };
+    auto ejecutar = [&](const char* nombre, const std::function<KeySearchStats(ResultSink&)>& ataque) {
+        TopKSink mejor(1);
+        ataque(mejor);  // calienta las arenas y los buffers del top-1
+        TopKSink medido(1);
+        uint64_t antes = heapAllocations();
+        KeySearchStats stats = ataque(medido);
+        uint64_t reservas = heapAllocations() - antes;
+        std::vector<AttackResult> resultados = medido.results();
+        informe(nombre, stats, reservas, resultados.empty() ? nullptr : &resultados.front());
+    };
+
+    KeySearchOptions opciones;
+    opciones.minScore = 0.9;
+    std::cout << "\nAtaques portados (1 hilo, top-1; reservas del montón por candidato):\n";
+    ejecutar("XOR 1 byte", [&](ResultSink& sink) {
+        KeySearch search(ByteKeyGenerator(1), RepeatingXorDecoder(bytes1), LetterRatioScorer());
+        return search.run(sink, opciones);
+    });
+    ejecutar("XOR 2 bytes", [&](ResultSink& sink) {
+        KeySearch search(ByteKeyGenerator(2), RepeatingXorDecoder(bytes2), LetterRatioScorer());
+        return search.run(sink, opciones);
+    });
+    ejecutar("XOR diccionario", [&](ResultSink& sink) {
+        KeySearch search(WordListGenerator({ "clave", "admin", "1234", "password", "letmein" }),
+            RepeatingXorDecoder(bytesDic), LetterRatioScorer());
+        return search.run(sink, opciones);
+    });
+    ejecutar("Vigenere <= 4 letras", [&](ResultSink& sink) {
+        return Vigenere::breakEncode(vigenereTexto, 4, sink);
+    });
+
+    // Los bucles de antes: una std::string por candidato y el mejor copiado al vuelo
+    std::cout << "\nLos mismos recorridos con una std::string por candidato:\n";
+    {
+        uint64_t antes = heapAllocations();
+        auto inicio = std::chrono::steady_clock::now();
+        double mejorPuntuacion = 0.9;
+        std::string mejorClave;
+        for (int b1 = 0; b1 < 256; ++b1) {
+            for (int b2 = 0; b2 < 256; ++b2) {
+                std::string texto;
+                for (size_t i = 0; i < bytes2.size(); ++i) texto += static_cast<char>(bytes2[i] ^ (i % 2 ? b2 : b1));
+                if (!xorEncoder.isValidText(texto)) continue;
+                double puntuacion = LetterRatioScorer()(texto);
+                if (puntuacion > mejorPuntuacion) {
+                    mejorPuntuacion = puntuacion;
+                    mejorClave = std::to_string(b1) + "," + std::to_string(b2);
+                }
+            }
+        }
+        KeySearchStats stats;
+        stats.candidates = 65536;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        stats.candidatesPerSecond = stats.candidates / stats.seconds;
+        AttackResult mejor{ "xor-2byte", mejorClave, "", mejorPuntuacion };
+        informe("XOR 2 bytes", stats, heapAllocations() - antes, &mejor);
+    }
+    {
+        uint64_t antes = heapAllocations();
+        auto inicio = std::chrono::steady_clock::now();
+        uint64_t candidatos = 0;
+        double mejorPuntuacion = 0;
+        std::string mejorClave;
+        std::string clave;
+        std::function<void(size_t, size_t)> recorrer = [&](size_t pos, size_t longitud) {
+            if (pos == longitud) {
+                std::string descifrado = Vigenere(clave).decode(vigenereTexto);
+                double puntuacion = Vigenere::fitness(descifrado);
+                if (puntuacion > mejorPuntuacion) {
+                    mejorPuntuacion = puntuacion;
+                    mejorClave = clave;
+                }
+                ++candidatos;
+                return;
+            }
+            for (char c = 'A'; c <= 'Z'; ++c) {
+                clave[pos] = c;
+                recorrer(pos + 1, longitud);
+            }
+        };
+        for (size_t longitud = 1; longitud <= 4; ++longitud) {
+            clave.assign(longitud, 'A');
+            recorrer(0, longitud);
+        }
+        KeySearchStats stats;
+        stats.candidates = candidatos;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        stats.candidatesPerSecond = candidatos / stats.seconds;
+        AttackResult mejor{ "vigenere", mejorClave, "", mejorPuntuacion };
+        informe("Vigenere <= 4 letras", stats, heapAllocations() - antes, &mejor);
+    }
+
+    unsigned nucleos = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\nCon un hilo por nucleo (" << nucleos << "):\n";
+    opciones.threads = 0;
+    ejecutar("XOR 2 bytes", [&](ResultSink& sink) {
+        KeySearch search(ByteKeyGenerator(2), RepeatingXorDecoder(bytes2), LetterRatioScorer());
+        return search.run(sink, opciones);
+    });
+    ejecutar("Vigenere <= 4 letras", [&](ResultSink& sink) {
+        return Vigenere::breakEncode(vigenereTexto, 4, sink, 0);
+    });
+
+    std::cout << "\nbreakBruteForce (claves de hasta 3 letras) sobre KeySearch:";
+    breakBruteForce(vigenereTexto, 3);
+}
 
 // ================= MENÚ PRINCIPAL =================
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "breach-filter") {
+        return buildBreachFilter(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "randomness") {
+        return runRandomnessTests(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rainbow-build") {
+        return buildRainbowTable(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rainbow-lookup") {
+        return lookupRainbowTable(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "keysearch") {
+        return runKeySearch(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "keysearch-worker") {
+        return runKeySearchWorker(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "logcrypt") {
+        return runLogCrypt(argc, argv);
+    }
+
     int opcion;
 
     do {
@@ -190,6 +2179,31 @@ int main() {
         std::cout << "6. Cifrado Vigenere\n";
         std::cout << "7. Romper Vigenere (fuerza bruta)\n";
         std::cout << "8. Generador criptografico (contrasena y bytes aleatorios)\n";
+        std::cout << "9. Triple DES (EDE, CBC/CTR)\n";
+        std::cout << "10. AES (CBC/CTR/GCM)\n";
+        std::cout << "11. SHA-256, HMAC y PBKDF2\n";
+        std::cout << "12. Contenedor cifrado con acceso aleatorio\n";
+        std::cout << "13. Vistas de decodificacion perezosa\n";
+        std::cout << "14. Canalizacion de cifrado fusionada\n";
+        std::cout << "15. Cadenas ofuscadas en compilacion\n";
+        std::cout << "16. Paquete de assets cifrado\n";
+        std::cout << "17. Ofuscacion de paquetes UDP\n";
+        std::cout << "18. Precalculo de flujo de clave CTR\n";
+        std::cout << "19. Modelo de cuadrigramas\n";
+        std::cout << "20. Ruptura de sustitucion monoalfabetica\n";
+        std::cout << "21. Clasificador de blobs cifrados\n";
+        std::cout << "22. Arrastre de cribs (XOR con clave reutilizada)\n";
+        std::cout << "23. Filtro de contrasenas filtradas\n";
+        std::cout << "24. Arena segura para claves\n";
+        std::cout << "25. Bateria de pruebas de aleatoriedad\n";
+        std::cout << "26. Tablas arcoiris (DES con espacio reducido)\n";
+        std::cout << "27. Encuentro a medio camino (doble DES)\n";
+        std::cout << "28. Busqueda de claves repartida entre procesos\n";
+        std::cout << "29. Planificador de trabajos de ruptura\n";
+        std::cout << "30. Sumideros de resultados (top-K, JSON, CSV)\n";
+        std::cout << "31. Cifrado incremental de logs\n";
+        std::cout << "32. Cesar y Vigenere UTF-8 (alfabeto espanol)\n";
+        std::cout << "33. Marco de busqueda de claves (KeySearch)\n";
         std::cout << "0. Salir\n";
         std::cout << "Seleccione una opcion: ";
         std::cin >> opcion;
@@ -220,6 +2234,81 @@ int main() {
         case 8:
             testCryptoGenerator();
             break;
+        case 9:
+            testTripleDes();
+            break;
+        case 10:
+            testAes();
+            break;
+        case 11:
+            testKeyDerivation();
+            break;
+        case 12:
+            testEncryptedContainer();
+            break;
+        case 13:
+            testDecodeViews();
+            break;
+        case 14:
+            testCipherPipeline();
+            break;
+        case 15:
+            testObfuscatedStrings();
+            break;
+        case 16:
+            testAssetPack();
+            break;
+        case 17:
+            testPacketObfuscation();
+            break;
+        case 18:
+            testKeystreamPrefetcher();
+            break;
+        case 19:
+            testNGramScorer();
+            break;
+        case 20:
+            testSubstitutionSolver();
+            break;
+        case 21:
+            testBlobClassifier();
+            break;
+        case 22:
+            testCribDragger();
+            break;
+        case 23:
+            testBreachFilter();
+            break;
+        case 24:
+            testSecureArena();
+            break;
+        case 25:
+            testRandomnessTests();
+            break;
+        case 26:
+            testRainbowTable();
+            break;
+        case 27:
+            testMeetInTheMiddle();
+            break;
+        case 28:
+            testShardedKeySearch();
+            break;
+        case 29:
+            testCrackScheduler();
+            break;
+        case 30:
+            testResultSinks();
+            break;
+        case 31:
+            testIncrementalLogCipher();
+            break;
+        case 32:
+            testAlphabetCipher();
+            break;
+        case 33:
+            testKeySearchFramework();
+            break;
         case 0:
             std::cout << "Saliendo del programa...\n";
             break;
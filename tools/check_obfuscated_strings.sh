@@ -0,0 +1,42 @@
+#!/bin/sh
+# Comprueba que un literal "..."_obf no deja el texto plano en el objeto compilado:
+# ni en los datos (strings) ni en los nombres de símbolo (nm -C), que codifican el valor
+# del parámetro de plantilla. Uso: tools/check_obfuscated_strings.sh  (CXX=clang++ opcional)
+set -eu
+
+CXX=${CXX:-g++}
+RAIZ=$(cd "$(dirname "$0")/.." && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+TEXTO="secret-host-name.example:1234"
+cat > "$TMP/literal.cpp" <<CPP
+#include "ObfuscatedString.h"
+#include <cstdio>
+int main() {
+    using namespace obfuscation::literals;
+    std::puts("$TEXTO"_obf.c_str());
+    return 0;
+}
+CPP
+
+# Los 8 primeros caracteres tal como nm -C muestra un char[] de plantilla: (char)115, (char)101, ...
+CODIGOS=$(printf '%s' "$TEXTO" | head -c 8 | od -An -tu1 | awk '{ for (i = 1; i <= NF; ++i) printf "%s(char)%s", (i > 1 ? ", " : ""), $i }')
+
+FALLOS=0
+for OPCIONES in "-O0 -g" "-O2" "-O2 -g"; do
+    $CXX -std=c++20 $OPCIONES -I "$RAIZ/include" -c "$TMP/literal.cpp" -o "$TMP/literal.o"
+    $CXX "$TMP/literal.o" -o "$TMP/literal"
+    if [ "$("$TMP/literal")" != "$TEXTO" ]; then
+        echo "FALLO ($OPCIONES): el literal no se descifra bien"; FALLOS=1
+    fi
+    if strings -a "$TMP/literal.o" | grep -qF "$TEXTO"; then
+        echo "FALLO ($OPCIONES): strings muestra el texto plano"; FALLOS=1
+    fi
+    if nm -C "$TMP/literal.o" | grep -qF -e "$TEXTO" -e "$CODIGOS"; then
+        echo "FALLO ($OPCIONES): nm -C muestra el texto plano en un nombre de simbolo"; FALLOS=1
+    fi
+done
+
+[ "$FALLOS" -eq 0 ] && echo "OK: el texto plano no aparece en el objeto"
+exit "$FALLOS"